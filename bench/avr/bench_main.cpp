@@ -0,0 +1,170 @@
+/**
+ * @file bench_main.cpp
+ * @brief Cycle counts of the firmware hot paths on the ATmega328P.
+ *
+ * Each benchmark calls one function N times and measures every call with
+ * Timer1 running at the CPU clock (prescaler 1), interrupts disabled, minus
+ * the cost of an empty measurement. A setup step before each call (outside
+ * the measurement) puts the object into the state the case needs, e.g. a
+ * due ADC sample or a due step.
+ *
+ * Results go to the serial port (115200 baud) as
+ *   BENCH,<name>,<calls>,<min>,<avg>,<max>
+ * framed by BENCH_BEGIN / BENCH_END; a call longer than 65535 cycles is
+ * reported as 65535. Afterwards the CPU sleeps with interrupts off, which
+ * ends a simavr run. The same image runs on a board.
+ */
+#include <Arduino.h>
+#include <avr/sleep.h>
+#include "CurrentSensor.h"
+#include "MovingAverage.h"
+#include "StepperDriver.h"
+#include "KeypadShield.h"
+#include "Lcd1602.h"
+
+float baselineCurrent = 0.0f;   // normally defined by the sketch
+
+namespace {
+
+constexpr uint16_t CALLS = 200;
+
+/** @brief Cycles of an empty measurement, subtracted from every result. */
+uint16_t overhead = 0;
+
+/**
+ * @brief Measure one call of body() in CPU cycles.
+ *
+ * @return Cycles, saturated at 65535.
+ */
+template <typename Body>
+uint16_t measure(Body body) {
+  uint8_t sreg = SREG;
+  cli();
+  TIFR1 = _BV(TOV1);
+  uint16_t t0 = TCNT1;
+  body();
+  uint16_t t1 = TCNT1;
+  bool ovf = TIFR1 & _BV(TOV1);
+  SREG = sreg;
+  if (ovf) return 0xFFFF;
+  uint16_t d = t1 - t0;
+  return d > overhead ? d - overhead : 0;
+}
+
+/**
+ * @brief Run a benchmark and print its line.
+ *
+ * @param name   Benchmark name (flash string).
+ * @param prep   Called before each measured call, not measured.
+ * @param body   The measured call.
+ */
+template <typename Prep, typename Body>
+void bench(const __FlashStringHelper* name, Prep prep, Body body) {
+  uint16_t mn = 0xFFFF, mx = 0;
+  uint32_t sum = 0;
+  for (uint16_t i = 0; i < CALLS; ++i) {
+    prep();
+    uint16_t c = measure(body);
+    if (c < mn) mn = c;
+    if (c > mx) mx = c;
+    sum += c;
+  }
+  Serial.print(F("BENCH,"));
+  Serial.print(name);
+  Serial.print(',');
+  Serial.print(CALLS);
+  Serial.print(',');
+  Serial.print(mn);
+  Serial.print(',');
+  Serial.print((sum + CALLS / 2) / CALLS);
+  Serial.print(',');
+  Serial.println(mx);
+  Serial.flush();
+}
+
+// The components, wired like in the sketch.
+CurrentSensor        sensor(A3, 5.0f, 1023.0f, 2.545f, 40000UL, 200UL);
+MovingAverage<200>   avg200;
+StepperDriver        stepper(12, 13, 11, 200.0f, 16, 8.0f, 10.0f);
+KeypadShield         keys(A0, 80);
+Lcd1602              lcd(8, 9, 4, 5, 6, 7, 10, false);
+
+}  // namespace
+
+void setup() {
+  Serial.begin(115200);
+
+  // Timer1: normal mode, clk/1, as the cycle counter
+  TCCR1A = 0;
+  TCCR1B = _BV(CS10);
+  overhead = 0;
+  overhead = measure([] {});
+
+  lcd.begin();
+  keys.begin();
+  sensor.begin();
+  stepper.enable(true);
+
+  Serial.println(F("BENCH_BEGIN"));
+
+  // CurrentSensor::update(): a 1 µs sampling interval makes every call
+  // sample; a window of 1 µs makes every call close the window as well.
+  sensor.setTiming(1000000UL, 1UL);
+  sensor.setEnabled(true);
+  bench(F("CurrentSensor::update/sample"), [] {}, [] { sensor.update(); });
+  sensor.setEnabled(false);
+  sensor.setTiming(1UL, 1UL);
+  sensor.setEnabled(true);
+  bench(F("CurrentSensor::update/sample+close"), [] {}, [] { sensor.update(); });
+  sensor.setEnabled(false);
+  sensor.setTiming(1000000UL, 1000000UL);
+  sensor.setEnabled(true);
+  sensor.update();   // takes the first sample
+  bench(F("CurrentSensor::update/idle"), [] {}, [] { sensor.update(); });
+  sensor.setEnabled(false);
+
+  // MovingAverage<200>::update() with a changing input.
+  static float x = 0.0f;
+  bench(F("MovingAverage<200>::update"), [] { x += 0.0137f; if (x > 1.0f) x = 0.0f; },
+        [] { avg200.update(x); });
+
+  // StepperDriver::update(): at 10 mm/s the period is 250 µs; waiting 300 µs
+  // before each call makes it step, calling back-to-back at 0.01 mm/s does not.
+  stepper.setSpeedMmPerSec(10.0f);
+  bench(F("StepperDriver::update/step"), [] { delayMicroseconds(300); }, [] { stepper.update(); });
+  stepper.setSpeedMmPerSec(0.0f);
+  stepper.setSpeedMmPerSec(0.01f);
+  stepper.update();   // first step after the start
+  bench(F("StepperDriver::update/no-step"), [] {}, [] { stepper.update(); });
+  stepper.setSpeedMmPerSec(0.0f);
+
+  // KeypadShield::update() (the poll): sampling when its period has passed, idle otherwise.
+  bench(F("KeypadShield::update/sample"), [] { delay(11); }, [] { keys.update(); });
+  bench(F("KeypadShield::update/idle"), [] {}, [] { keys.update(); });
+
+  // Lcd1602::title2() writes the framebuffer only; the bus transfer is
+  // drained outside. Lcd1602::service() is measured on the pass that finds
+  // the refresh interval elapsed and queues the changed cells.
+  bench(F("Lcd1602::title2"), [] { lcd.flush(); },
+        [] { lcd.title2(F("MOD1: Etching"), F("I=0.1234 A")); });
+  static bool alt = false;
+  bench(F("Lcd1602::service/diff"),
+        [] {
+          lcd.flush();
+          alt = !alt;
+          if (alt) lcd.title2(F("MOD1: Etching"), F("I=0.1234 A"));
+          else     lcd.title2(F("MOD2: 30V ON"),  F("I=0.5678 A"));
+          delay(50);
+        },
+        [] { lcd.service(); });
+
+  Serial.println(F("BENCH_END"));
+  Serial.flush();
+
+  cli();
+  set_sleep_mode(SLEEP_MODE_PWR_DOWN);
+  sleep_enable();
+  sleep_cpu();
+}
+
+void loop() {}
@@ -0,0 +1,9 @@
+/**
+ * @file firmware.cpp
+ * @brief Translation unit holding the unmodified sketch, for its AVR footprint.
+ *
+ * Built like the host runner builds it (host/firmware/sketch.cpp): the .ino
+ * is plain C++ apart from its extension, and the Arduino core supplies
+ * main().
+ */
+#include "TipEtcingControler2.4_doc.ino"
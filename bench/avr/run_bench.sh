@@ -0,0 +1,97 @@
+#!/bin/sh
+# Build the hot-path benchmarks for the ATmega328P, run them under simavr and
+# store the results for comparison between commits.
+#
+# usage: bench/avr/run_bench.sh -a ARDUINO_AVR_DIR [-c BASELINE.csv] [-o OUT.csv]
+#
+#   -a  Arduino AVR core package (cores/arduino, variants/standard), e.g.
+#       ~/.arduino15/packages/arduino/hardware/avr/1.8.6
+#   -c  earlier results file to compare with (prints the change per line)
+#   -o  results file (default bench/avr/results/<commit>.csv)
+#
+# The build goes to _avr_bench/ in the repository root (ignored by git).
+#
+# Results file format (CSV):
+#   cycles,<benchmark>,<calls>,<min>,<avg>,<max>
+#   size,<component>,<text>,<data>,<bss>      object sizes, flash = text + data, SRAM = data + bss
+#   image,<text>,<data>,<bss>                 linked benchmark image
+#   firmware,<text>,<data>,<bss>              linked sketch (all of projectCode)
+set -e
+
+here=$(cd "$(dirname "$0")" && pwd)
+root=$(cd "$here/../.." && pwd)
+build="$root/_avr_bench"
+core=""
+baseline=""
+out=""
+
+while getopts "a:c:o:" opt; do
+  case "$opt" in
+    a) core="$OPTARG" ;;
+    c) baseline="$OPTARG" ;;
+    o) out="$OPTARG" ;;
+    *) sed -n '5,12p' "$0"; exit 2 ;;
+  esac
+done
+[ -n "$core" ] || { echo "run_bench.sh: -a ARDUINO_AVR_DIR is required" >&2; exit 2; }
+
+for tool in avr-g++ avr-size simavr; do
+  command -v "$tool" >/dev/null || { echo "run_bench.sh: $tool not found" >&2; exit 1; }
+done
+
+rev=$(git -C "$root" rev-parse --short HEAD 2>/dev/null || echo unknown)
+git -C "$root" diff --quiet HEAD -- projectCode bench 2>/dev/null || rev="$rev-dirty"
+[ -n "$out" ] || out="$here/results/$rev.csv"
+mkdir -p "$(dirname "$out")"
+
+cmake -S "$here" -B "$build" \
+      -DCMAKE_TOOLCHAIN_FILE="$here/avr-toolchain.cmake" \
+      -DARDUINO_AVR_DIR="$core" >/dev/null
+cmake --build "$build" --target tipetch_bench tipetch_firmware >/dev/null
+
+elf="$build/tipetch_bench.elf"
+tmp="$out.tmp"
+: > "$tmp"
+
+# simavr echoes the UART line by line; keep what follows the BENCH tag.
+timeout 120 simavr -m atmega328p -f 16000000 "$elf" 2>&1 |
+  sed -n 's/.*\(BENCH[_,].*\)/\1/p' | tr -d '\r' |
+  awk -F, '$1 == "BENCH" { print "cycles," $2 "," $3 "," $4 "," $5 "," $6 }
+           $1 == "BENCH_END" { done = 1 }
+           END { if (!done) exit 1 }' >> "$tmp" ||
+  { echo "run_bench.sh: benchmark did not complete under simavr" >&2; rm -f "$tmp"; exit 1; }
+
+# Component objects (compiled, not linked) and the linked image.
+find "$build/CMakeFiles/components.dir" -name '*.o' | sort | while read -r obj; do
+  name=$(basename "$obj" .cpp.o)
+  avr-size --format=berkeley "$obj" | awk -v n="$name" 'NR == 2 { print "size," n "," $1 "," $2 "," $3 }'
+done >> "$tmp"
+avr-size --format=berkeley "$elf" | awk 'NR == 2 { print "image," $1 "," $2 "," $3 }' >> "$tmp"
+avr-size --format=berkeley "$build/tipetch_firmware.elf" |
+  awk 'NR == 2 { print "firmware," $1 "," $2 "," $3 }' >> "$tmp"
+
+mv "$tmp" "$out"
+echo "results: $out"
+
+if [ -z "$baseline" ]; then
+  column -t -s, "$out" 2>/dev/null || cat "$out"
+  exit 0
+fi
+
+# Side by side with the baseline: avg cycles for benchmarks, flash for sizes,
+# and static SRAM (data + bss) for the linked images.
+awk -F, '
+  function key()   { return ($1 == "image" || $1 == "firmware") ? $1 : $1 "," $2 }
+  function flash() { return ($1 == "cycles") ? $5 : ($1 == "size") ? $3 + $4 : $2 + $3 }
+  function sram()  { return $3 + $4 }
+  function linked() { return $1 == "image" || $1 == "firmware" }
+  function show(what, k, v, unit) {
+    if (k in base) printf "%-12s %-32s %8d -> %8d %s  (%+d)\n", what, name, base[k], v, unit, v - base[k]
+    else           printf "%-12s %-32s %8s -> %8d %s\n", what, name, "new", v, unit
+  }
+  NR == FNR { base[key()] = flash(); if (linked()) base[key() ",sram"] = sram(); next }
+  {
+    name = linked() ? "-" : $2
+    show($1, key(), flash(), ($1 == "cycles") ? "cyc" : "B")
+    if (linked()) show($1 " ram", key() ",sram", sram(), "B")
+  }' "$baseline" "$out"
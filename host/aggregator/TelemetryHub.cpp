@@ -0,0 +1,386 @@
+#include "TelemetryHub.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+ * @file TelemetryHub.cpp
+ * @brief epoll reader, block pool and decoding workers of TelemetryHub.
+ */
+
+namespace {
+
+/** @brief Blocks a worker decodes for one device before the next device's turn. */
+constexpr size_t BATCH_BLOCKS = 8;
+
+/** @brief stdio buffer of each output file. */
+constexpr size_t OUT_BUFFER = 64 * 1024;
+
+/** @brief Events taken per epoll_wait(). */
+constexpr int MAX_EVENTS = 64;
+
+uint64_t clockNs(clockid_t clock) {
+  timespec ts;
+  clock_gettime(clock, &ts);
+  return uint64_t(ts.tv_sec) * 1000000000u + uint64_t(ts.tv_nsec);
+}
+
+/** @brief Create a directory and its missing parents, like mkdir -p. */
+bool makeDirs(const std::string& dir) {
+  for (size_t pos = dir.find('/', 1); ; pos = dir.find('/', pos + 1)) {
+    const std::string part = dir.substr(0, pos);
+    if (mkdir(part.c_str(), 0777) != 0 && errno != EEXIST) return false;
+    if (pos == std::string::npos) return true;
+  }
+}
+
+}  // namespace
+
+TelemetryHub::TelemetryHub(const HubConfig& cfg) : cfg_(cfg) {
+  cfg_.blockSize    = std::max<size_t>(cfg_.blockSize, 64);
+  cfg_.poolBlocks   = std::max<size_t>(cfg_.poolBlocks, 1);
+  cfg_.deviceBlocks = std::max<size_t>(cfg_.deviceBlocks, 1);
+  cfg_.flushMs      = std::max(cfg_.flushMs, 1u);
+
+  storage_.resize(cfg_.blockSize * cfg_.poolBlocks);
+  blocks_.resize(cfg_.poolBlocks);
+  for (size_t i = 0; i < blocks_.size(); ++i) {
+    blocks_[i].data = storage_.data() + i * cfg_.blockSize;
+    blocks_[i].next = free_;
+    free_ = &blocks_[i];
+  }
+  // Created here so that stop() works even before run().
+  wakeFd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+}
+
+TelemetryHub::~TelemetryHub() {
+  for (auto& d : devices_) {
+    if (d->out) fclose(d->out);
+  }
+  if (epoll_ >= 0) close(epoll_);
+  if (wakeFd_ >= 0) close(wakeFd_);
+}
+
+bool TelemetryHub::addDevice(const std::string& name, int fd) {
+  std::unique_ptr<Device> d(new Device);
+  d->name = name;
+  d->fd   = fd;
+
+  if (devices_.empty() && !makeDirs(cfg_.outDir)) {
+    error_ = cfg_.outDir + ": " + std::strerror(errno);
+    return false;
+  }
+  const std::string path = cfg_.outDir + "/" + name + ".csv";
+  d->out = fopen(path.c_str(), "w");
+  if (!d->out) {
+    error_ = path + ": " + std::strerror(errno);
+    return false;
+  }
+  d->outBuf.reset(new char[OUT_BUFFER]);
+  setvbuf(d->out, d->outBuf.get(), _IOFBF, OUT_BUFFER);
+  devices_.push_back(std::move(d));
+  return true;
+}
+
+bool TelemetryHub::run() {
+  if (wakeFd_ < 0) {
+    error_ = std::string("eventfd: ") + std::strerror(errno);
+    return false;
+  }
+  epoll_ = epoll_create1(EPOLL_CLOEXEC);
+  if (epoll_ < 0) {
+    error_ = std::string("epoll_create1: ") + std::strerror(errno);
+    return false;
+  }
+  epoll_event ev{};
+  ev.events   = EPOLLIN;
+  ev.data.ptr = nullptr;   // the wake-up eventfd
+  epoll_ctl(epoll_, EPOLL_CTL_ADD, wakeFd_, &ev);
+
+  startNs_ = clockNs(CLOCK_MONOTONIC);
+  const uint64_t startUnixUs = clockNs(CLOCK_REALTIME) / 1000;
+  for (auto& d : devices_) {
+    ev.data.ptr = d.get();
+    if (epoll_ctl(epoll_, EPOLL_CTL_ADD, d->fd, &ev) < 0) {
+      error_ = d->name + ": epoll_ctl: " + std::strerror(errno);
+      return false;
+    }
+    fprintf(d->out, "# device=%s\n# start_unix_us=%llu\n"
+                    "host_us,seq,t_us,window,i_uA,vpp_mV,steps,mode_id,phase,flags,key\n",
+            d->name.c_str(), (unsigned long long)startUnixUs);
+  }
+  openPorts_ = devices_.size();
+
+  const unsigned n = cfg_.workers ? cfg_.workers : std::max(1u, std::thread::hardware_concurrency());
+  for (unsigned i = 0; i < n; ++i) workers_.emplace_back(&TelemetryHub::worker_, this);
+
+  // Reader: only moves bytes from the ports into the device queues.
+  bool ok = true;
+  epoll_event events[MAX_EVENTS];
+  uint64_t nextFlush = startNs_ + cfg_.flushMs * 1000000ull;
+  while (!stop_ && openPorts_ > 0) {
+    const int k = epoll_wait(epoll_, events, MAX_EVENTS, (int)cfg_.flushMs);
+    if (k < 0 && errno != EINTR) {
+      error_ = std::string("epoll_wait: ") + std::strerror(errno);
+      ok = false;
+      break;
+    }
+    for (int i = 0; i < k; ++i) {
+      Device* d = static_cast<Device*>(events[i].data.ptr);
+      if (d) {
+        if (d->reading) readDevice_(*d);
+        continue;
+      }
+      uint64_t v;
+      while (read(wakeFd_, &v, sizeof(v)) > 0) {}
+      resumePaused_();
+    }
+
+    const uint64_t now = clockNs(CLOCK_MONOTONIC);
+    if (now >= nextFlush) {
+      nextFlush = now + cfg_.flushMs * 1000000ull;
+      std::lock_guard<std::mutex> lk(mutex_);
+      for (auto& d : devices_) {
+        d->flushReq = true;
+        scheduleLocked_(*d);
+      }
+    }
+  }
+
+  // Let the workers decode everything that was read, then close the files.
+  {
+    std::lock_guard<std::mutex> lk(mutex_);
+    draining_ = true;
+  }
+  work_.notify_all();
+  for (std::thread& t : workers_) t.join();
+  workers_.clear();
+
+  for (auto& d : devices_) {
+    if (fclose(d->out) != 0 && ok) {
+      error_ = d->name + ": " + std::strerror(errno);
+      ok = false;
+    }
+    d->out = nullptr;
+  }
+  close(epoll_);
+  epoll_ = -1;
+  return ok;
+}
+
+void TelemetryHub::stop() {
+  stop_ = true;
+  wake_();
+}
+
+void TelemetryHub::wake_() {
+  const uint64_t one = 1;
+  ssize_t r = write(wakeFd_, &one, sizeof(one));
+  (void)r;   // a full counter already means "wake up"
+}
+
+/**
+ * @brief Read once from a ready port into a pool block and queue it.
+ *
+ * Level-triggered: a port with more data pending is reported again by the
+ * next epoll_wait(), after the other ready ports had their turn.
+ */
+void TelemetryHub::readDevice_(Device& d) {
+  if (d.paused) return;
+
+  Block* b;
+  {
+    std::lock_guard<std::mutex> lk(mutex_);
+    b = free_;
+    if (!b) {
+      ++pausedCount_;
+    } else {
+      free_ = b->next;
+      peakBlocks_ = std::max(peakBlocks_, ++inUse_);
+    }
+  }
+  if (!b) {
+    pause_(d);
+    return;
+  }
+
+  const ssize_t n = read(d.fd, b->data, cfg_.blockSize);
+  if (n > 0) {
+    b->len  = (size_t)n;
+    b->t_ns = clockNs(CLOCK_MONOTONIC);
+    b->next = nullptr;
+    d.bytes += (uint64_t)n;
+
+    bool full;
+    {
+      std::lock_guard<std::mutex> lk(mutex_);
+      if (d.tail) d.tail->next = b;
+      else        d.head = b;
+      d.tail = b;
+      full = ++d.queued >= cfg_.deviceBlocks;
+      if (full) ++pausedCount_;
+      scheduleLocked_(d);
+    }
+    if (full) pause_(d);
+    return;
+  }
+
+  // Nothing after all, or the port is gone (0 or EIO once the other end of
+  // a pty closes, EIO/ENXIO when a USB adapter is unplugged).
+  const bool gone = n == 0 || (errno != EAGAIN && errno != EINTR);
+  {
+    std::lock_guard<std::mutex> lk(mutex_);
+    b->next = free_;
+    free_ = b;
+    --inUse_;
+    if (gone) {
+      d.flushReq = true;
+      scheduleLocked_(d);
+    }
+  }
+  if (gone) {
+    epoll_ctl(epoll_, EPOLL_CTL_DEL, d.fd, nullptr);
+    d.reading = false;
+    --openPorts_;
+  }
+}
+
+/**
+ * @brief Take a port out of the epoll set until the workers catch up.
+ *
+ * The caller has already counted it in pausedCount_ (under the lock, so a
+ * worker releasing blocks at the same time is sure to see it and wake us).
+ */
+void TelemetryHub::pause_(Device& d) {
+  epoll_event ev{};
+  ev.events   = 0;
+  ev.data.ptr = &d;
+  epoll_ctl(epoll_, EPOLL_CTL_MOD, d.fd, &ev);
+  d.paused = true;
+  ++d.pauses;
+}
+
+/**
+ * @brief Put paused ports back once their queue is half empty and the pool
+ *        has a free block.
+ */
+void TelemetryHub::resumePaused_() {
+  std::lock_guard<std::mutex> lk(mutex_);
+  if (!pausedCount_ || !free_) return;
+  for (auto& p : devices_) {
+    Device& d = *p;
+    if (!d.paused || d.queued > cfg_.deviceBlocks / 2) continue;
+    epoll_event ev{};
+    ev.events   = EPOLLIN;
+    ev.data.ptr = &d;
+    epoll_ctl(epoll_, EPOLL_CTL_MOD, d.fd, &ev);
+    d.paused = false;
+    --pausedCount_;
+  }
+}
+
+/** @brief Put a device in the run queue unless it is already there or with a worker. */
+void TelemetryHub::scheduleLocked_(Device& d) {
+  if (d.scheduled) return;
+  d.scheduled = true;
+  runQueue_.push_back(&d);
+  work_.notify_one();
+}
+
+void TelemetryHub::worker_() {
+  std::unique_lock<std::mutex> lk(mutex_);
+  for (;;) {
+    work_.wait(lk, [this] { return !runQueue_.empty() || draining_; });
+    if (runQueue_.empty()) return;   // draining and nothing left
+
+    Device& d = *runQueue_.front();
+    runQueue_.pop_front();
+    Block* batch = d.head;
+    Block* last  = nullptr;
+    size_t n = 0;
+    for (Block* b = d.head; b && n < BATCH_BLOCKS; b = b->next, ++n) last = b;
+    if (last) {
+      d.head = last->next;
+      if (!d.head) d.tail = nullptr;
+      last->next = nullptr;
+      d.queued -= n;
+    }
+    const bool flush = d.flushReq;
+    d.flushReq = false;
+    lk.unlock();
+
+    for (Block* b = last ? batch : nullptr; b; b = b->next) decode_(d, *b);
+    if (flush && d.dirty) {
+      fflush(d.out);
+      d.dirty = false;
+    }
+
+    lk.lock();
+    if (last) {
+      last->next = free_;
+      free_ = batch;
+      inUse_ -= n;
+      if (pausedCount_) wake_();
+    }
+    // Back to the end of the queue: one batch per device per turn.
+    if (d.head || d.flushReq) runQueue_.push_back(&d);
+    else                      d.scheduled = false;
+  }
+}
+
+/** @brief Decode one block and write the records it completes. */
+void TelemetryHub::decode_(Device& d, const Block& b) {
+  const unsigned long long hostUs = (b.t_ns - startNs_) / 1000;
+  uint64_t frames = 0, records = 0;
+  TelemetrySample s;
+
+  for (size_t i = 0; i < b.len; ++i) {
+    if (!d.frames.push(b.data[i], d.frame)) continue;
+    ++frames;
+    if (!d.records.push(d.frame, s)) continue;
+
+    d.t64 = d.haveT ? d.t64 + uint32_t(s.t_us - d.lastT) : s.t_us;
+    d.lastT = s.t_us;
+    d.haveT = true;
+    fprintf(d.out, "%llu,%u,%llu,%u,%d,%u,%d,%u,%u,%u,%u\n",
+            hostUs, s.seq, (unsigned long long)d.t64, s.window, s.i_uA, s.vpp_mV, s.steps,
+            s.modeId, s.phase, s.flags, s.key ? 1 : 0);
+    ++records;
+  }
+
+  if (records) d.dirty = true;
+  d.frameCount  += frames;
+  d.recordCount += records;
+  d.lost         = d.records.lost();
+  d.deviceDrops  = d.records.deviceDrops();
+  d.rxErrors     = d.frames.errors();
+}
+
+std::vector<HubDeviceStats> TelemetryHub::stats() const {
+  std::vector<HubDeviceStats> out;
+  out.reserve(devices_.size());
+  for (const auto& d : devices_) {
+    HubDeviceStats s;
+    s.name        = d->name;
+    s.bytes       = d->bytes;
+    s.frames      = d->frameCount;
+    s.records     = d->recordCount;
+    s.lost        = d->lost;
+    s.deviceDrops = d->deviceDrops;
+    s.rxErrors    = d->rxErrors;
+    s.pauses      = d->pauses;
+    s.open        = d->reading;
+    out.push_back(s);
+  }
+  return out;
+}
+
+size_t TelemetryHub::peakBlocks() const {
+  std::lock_guard<std::mutex> lk(mutex_);
+  return peakBlocks_;
+}
@@ -0,0 +1,180 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "FrameCodec.h"
+#include "TipTelemetry.h"
+
+/**
+ * @file TelemetryHub.h
+ * @brief Telemetry capture from many devices at once.
+ *
+ * One thread waits on all serial ports with epoll and only moves bytes: each
+ * read() lands in a block of a fixed pool, stamped with CLOCK_MONOTONIC, and
+ * is queued on its device. A pool of workers decodes the queues (frames,
+ * key/delta records) and writes one CSV file per device. A device is handled
+ * by one worker at a time, in arrival order, and goes back to the end of the
+ * run queue after a batch of blocks, so a busy port cannot starve the others.
+ *
+ * Memory is bounded by the pool: when a device has deviceBlocks blocks
+ * waiting, or the pool is empty, its port is taken out of the epoll set and
+ * left to fill up in the kernel (and then on the device, which drops records
+ * and says so in its next key record). It is put back once the workers have
+ * caught up. Nothing is dropped on the host side.
+ */
+
+/** @brief TelemetryHub settings. */
+struct HubConfig {
+  std::string outDir       = ".";   ///< Directory of the per-device files (created if missing).
+  unsigned    workers      = 0;     ///< Decoding threads (0 = one per CPU).
+  size_t      blockSize    = 4096;  ///< Bytes per read buffer.
+  size_t      poolBlocks   = 1024;  ///< Read buffers shared by all devices.
+  size_t      deviceBlocks = 64;    ///< Read buffers a device may have queued.
+  unsigned    flushMs      = 1000;  ///< Interval of the output file flushes.
+};
+
+/** @brief Counters of one device. */
+struct HubDeviceStats {
+  std::string name;
+  uint64_t    bytes       = 0;      ///< Bytes read.
+  uint64_t    frames      = 0;      ///< Valid frames.
+  uint64_t    records     = 0;      ///< Telemetry records written.
+  uint32_t    lost        = 0;      ///< Records missing from the sequence.
+  uint16_t    deviceDrops = 0;      ///< Drops reported by the device (last key record).
+  uint32_t    rxErrors    = 0;      ///< Discarded frames.
+  uint64_t    pauses      = 0;      ///< Times the port was paused for backpressure.
+  bool        open        = false;  ///< Port still being read.
+};
+
+/**
+ * @brief Reads telemetry from many serial ports into per-device files.
+ *
+ * Usage: addDevice() for each port, then run() until stop() or until every
+ * port has reached end of file. The hub never writes to the ports, so the
+ * caller may send requests (e.g. MSG_TELEM_CTRL) before and after run();
+ * their replies are skipped by the decoder.
+ *
+ * Each file, DIR/<name>.csv, starts with '#' lines (device, start time) and
+ * has one line per record:
+ *
+ *   host_us,seq,t_us,window,i_uA,vpp_mV,steps,mode_id,phase,flags,key
+ *
+ * host_us is the CLOCK_MONOTONIC time (µs since run()) of the read that
+ * completed the record, so it never goes backwards within a file; t_us is the
+ * device time with the 32-bit micros() wraps removed.
+ */
+class TelemetryHub {
+public:
+  explicit TelemetryHub(const HubConfig& cfg);
+  TelemetryHub(const TelemetryHub&) = delete;
+  TelemetryHub& operator=(const TelemetryHub&) = delete;
+  ~TelemetryHub();
+
+  /**
+   * @brief Register a port (before run()).
+   *
+   * @param name  Device name (file name of its output).
+   * @param fd    Open, non-blocking descriptor; the caller keeps ownership.
+   * @return false if the output directory or file cannot be created.
+   */
+  bool addDevice(const std::string& name, int fd);
+
+  /**
+   * @brief Read all ports until stop() or end of file on all of them.
+   *
+   * Returns once every byte read has been decoded and written.
+   *
+   * @return false if epoll or the worker threads could not be set up.
+   */
+  bool run();
+
+  /** @brief Ask run() to return (async-signal-safe). */
+  void stop();
+
+  /** @brief Counters of all devices (may be called while running). */
+  std::vector<HubDeviceStats> stats() const;
+
+  /** @brief Largest number of pool blocks in use at once. */
+  size_t peakBlocks() const;
+
+  /** @brief Reason of the last failure. */
+  const std::string& lastError() const { return error_; }
+
+private:
+  /** @brief One read() worth of bytes. */
+  struct Block {
+    Block*   next = nullptr;
+    uint8_t* data = nullptr;
+    size_t   len  = 0;
+    uint64_t t_ns = 0;   ///< CLOCK_MONOTONIC at the read.
+  };
+
+  struct Device {
+    std::string name;
+    int         fd  = -1;
+    FILE*       out = nullptr;
+    std::unique_ptr<char[]> outBuf;
+
+    // reader thread
+    bool paused = false;        ///< Out of the epoll set.
+
+    // under mutex_
+    Block* head      = nullptr;
+    Block* tail      = nullptr;
+    size_t queued    = 0;
+    bool   scheduled = false;   ///< In the run queue or with a worker.
+    bool   flushReq  = false;
+
+    // the worker holding the device
+    FrameDecoder     frames;
+    TelemetryDecoder records;
+    Frame            frame;
+    bool             haveT = false;
+    uint32_t         lastT = 0;
+    uint64_t         t64   = 0;
+    bool             dirty = false;
+
+    std::atomic<uint64_t> bytes{0}, frameCount{0}, recordCount{0}, pauses{0};
+    std::atomic<uint32_t> lost{0}, rxErrors{0};
+    std::atomic<uint16_t> deviceDrops{0};
+    std::atomic<bool>     reading{true};   ///< Not yet at end of file.
+  };
+
+  void readDevice_(Device& d);
+  void pause_(Device& d);
+  void resumePaused_();
+  void scheduleLocked_(Device& d);
+  void worker_();
+  void decode_(Device& d, const Block& b);
+  void wake_();
+
+  HubConfig cfg_;
+  std::vector<std::unique_ptr<Device>> devices_;
+  std::string error_;
+
+  int epoll_ = -1;
+  int wakeFd_ = -1;
+  std::atomic<bool> stop_{false};
+  uint64_t startNs_ = 0;
+  size_t openPorts_ = 0;       ///< Devices not yet at end of file (reader thread).
+
+  std::vector<uint8_t> storage_;
+  std::vector<Block>   blocks_;
+
+  mutable std::mutex      mutex_;
+  std::condition_variable work_;
+  Block*                  free_ = nullptr;
+  size_t                  inUse_ = 0;
+  size_t                  peakBlocks_ = 0;
+  size_t                  pausedCount_ = 0;
+  std::deque<Device*>     runQueue_;
+  bool                    draining_ = false;
+  std::vector<std::thread> workers_;
+};
@@ -0,0 +1,388 @@
+#include "TraceFile.h"
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace tracefile {
+
+namespace {
+
+/** @brief Bits needed for x (0 for 0). */
+inline uint8_t bitsFor(uint64_t x) {
+  return x ? (uint8_t)(64 - __builtin_clzll(x)) : 0;
+}
+
+inline uint32_t zigzag(int32_t d) { return ((uint32_t)d << 1) ^ (uint32_t)(d >> 31); }
+inline int32_t  unzigzag(uint32_t z) { return (int32_t)(z >> 1) ^ -(int32_t)(z & 1); }
+
+/** @brief Appends fixed-width fields to a byte vector, LSB first. */
+class BitWriter {
+public:
+  explicit BitWriter(std::vector<uint8_t>& out) : out_(out) {}
+
+  void put(uint32_t v, uint8_t bits) {
+    if (!bits) return;
+    acc_ |= (uint64_t)v << n_;
+    n_ += bits;
+    while (n_ >= 8) {
+      out_.push_back((uint8_t)acc_);
+      acc_ >>= 8;
+      n_ -= 8;
+    }
+  }
+
+  void flush() {
+    if (n_) out_.push_back((uint8_t)acc_);
+    acc_ = 0;
+    n_ = 0;
+  }
+
+private:
+  std::vector<uint8_t>& out_;
+  uint64_t acc_ = 0;
+  uint8_t  n_ = 0;
+};
+
+/**
+ * @brief Field of `bits` (<= 32) bits at bit position pos.
+ *
+ * Reads 8 bytes at once; the writer pads every chunk so this stays inside
+ * the file.
+ */
+inline uint32_t getBits(const uint8_t* p, uint64_t pos, uint8_t bits) {
+  if (!bits) return 0;
+  uint64_t w;
+  memcpy(&w, p + (pos >> 3), sizeof(w));
+  return (uint32_t)((w >> (pos & 7)) & ((1ULL << bits) - 1));
+}
+
+/** @brief Padding after a chunk's packed deltas (see getBits()). */
+constexpr size_t CHUNK_PAD = 8;
+
+/** @brief Largest time step a chunk can hold; a longer gap starts a new chunk. */
+constexpr uint64_t MAX_STEP_US = 0xFFFFFFFFULL;
+
+}  // namespace
+
+size_t lowerBound(const Column<uint64_t>& t, uint64_t t_us) {
+  return (size_t)(std::lower_bound(t.begin(), t.end(), t_us) - t.begin());
+}
+
+// ---------------------------------------------------------------------------
+// TraceWriter
+// ---------------------------------------------------------------------------
+
+TraceWriter::~TraceWriter() {
+  if (f_) fclose(f_);
+}
+
+bool TraceWriter::open(const char* path, uint32_t chunk) {
+  f_ = fopen(path, "wb");
+  if (!f_) {
+    perror(path);
+    return false;
+  }
+  path_  = path;
+  chunk_ = chunk > 1 ? chunk : 2;
+  FileHeader h = {};   // rewritten by close()
+  writeAligned_(&h, sizeof(h));
+  return ok_;
+}
+
+void TraceWriter::meta(const char* key, const std::string& value) {
+  meta_ += key;
+  meta_ += '=';
+  meta_ += value;
+  meta_ += '\n';
+}
+
+void TraceWriter::sample(uint64_t t_us, uint16_t adc) {
+  if (samples_ && t_us < lastT_) {
+    if (ok_) fprintf(stderr, "%s: reading at %llu us goes back in time\n", path_.c_str(), (unsigned long long)t_us);
+    ok_ = false;
+    return;
+  }
+  if (!t_.empty() && (t_.size() >= chunk_ || t_us - t_.back() > MAX_STEP_US)) flushChunk_();
+  if (!samples_) t0_ = t_us;
+  t_.push_back(t_us);
+  adc_.push_back(adc);
+  lastT_ = t_us;
+  ++samples_;
+}
+
+void TraceWriter::window(uint64_t t_us, float irms, float vpp, uint16_t adcMin, uint16_t adcMax) {
+  if (!winT_.empty() && t_us < winT_.back()) ok_ = false;
+  winT_.push_back(t_us);
+  winIrms_.push_back(irms);
+  winVpp_.push_back(vpp);
+  winMin_.push_back(adcMin);
+  winMax_.push_back(adcMax);
+}
+
+void TraceWriter::step(uint64_t t_us, int32_t pos) {
+  if (!stepT_.empty() && t_us < stepT_.back()) ok_ = false;
+  stepT_.push_back(t_us);
+  stepPos_.push_back(pos);
+}
+
+void TraceWriter::event(uint64_t t_us, uint8_t id, int16_t arg) {
+  if (!evT_.empty() && t_us < evT_.back()) ok_ = false;
+  evT_.push_back(t_us);
+  evId_.push_back(id);
+  evArg_.push_back(arg);
+}
+
+void TraceWriter::flushChunk_() {
+  const size_t n = t_.size();
+  if (!n) return;
+
+  ChunkEntry c = {};
+  c.t0_us = t_.front();
+  c.t1_us = t_.back();
+  c.first = samples_ - n;
+  c.offset = pos_;
+  c.count = (uint32_t)n;
+  c.adc0 = adc_[0];
+
+  uint64_t dtMin = MAX_STEP_US, dtMax = 0;
+  uint32_t zMax = 0;
+  for (size_t i = 1; i < n; ++i) {
+    const uint64_t dt = t_[i] - t_[i - 1];
+    dtMin = std::min(dtMin, dt);
+    dtMax = std::max(dtMax, dt);
+    zMax |= zigzag((int32_t)adc_[i] - (int32_t)adc_[i - 1]);
+  }
+  if (n < 2) dtMin = 0;
+  uint64_t unit = 0;
+  for (size_t i = 1; i < n && unit != 1; ++i) unit = std::gcd(unit, t_[i] - t_[i - 1] - dtMin);
+  if (!unit) unit = 1;
+  c.dtBase = (uint32_t)dtMin;
+  c.dtUnit = (uint32_t)unit;
+  c.dtBits = bitsFor((dtMax - dtMin) / unit);
+  c.dvBits = bitsFor(zMax);
+
+  packed_.clear();
+  BitWriter bw(packed_);
+  for (size_t i = 1; i < n; ++i) bw.put((uint32_t)((t_[i] - t_[i - 1] - dtMin) / unit), c.dtBits);
+  for (size_t i = 1; i < n; ++i) bw.put(zigzag((int32_t)adc_[i] - (int32_t)adc_[i - 1]), c.dvBits);
+  bw.flush();
+  c.size = (uint32_t)packed_.size();
+  packed_.resize(packed_.size() + CHUNK_PAD, 0);
+  writeAligned_(packed_.data(), packed_.size());
+
+  chunks_.push_back(c);
+  t_.clear();
+  adc_.clear();
+}
+
+void TraceWriter::writeAligned_(const void* p, size_t n) {
+  static const uint8_t zeros[8] = {};
+  if (n && fwrite(p, 1, n, f_) != n) ok_ = false;
+  const size_t pad = (8 - (pos_ + n) % 8) % 8;
+  if (pad && fwrite(zeros, 1, pad, f_) != pad) ok_ = false;
+  pos_ += n + pad;
+}
+
+void TraceWriter::section_(uint32_t id, uint32_t elemSize, const void* p, size_t count) {
+  if (!count) return;
+  sections_.push_back({ id, elemSize, pos_, (uint64_t)count });
+  writeAligned_(p, (size_t)elemSize * count);
+}
+
+bool TraceWriter::close() {
+  if (!f_) return false;
+  flushChunk_();
+
+  section_(SEC_META, 1, meta_.data(), meta_.size());
+  section_(SEC_CHUNKS, sizeof(ChunkEntry), chunks_.data(), chunks_.size());
+  section_(SEC_WIN_T, sizeof(uint64_t), winT_.data(), winT_.size());
+  section_(SEC_WIN_IRMS, sizeof(float), winIrms_.data(), winIrms_.size());
+  section_(SEC_WIN_VPP, sizeof(float), winVpp_.data(), winVpp_.size());
+  section_(SEC_WIN_MIN, sizeof(uint16_t), winMin_.data(), winMin_.size());
+  section_(SEC_WIN_MAX, sizeof(uint16_t), winMax_.data(), winMax_.size());
+  section_(SEC_STEP_T, sizeof(uint64_t), stepT_.data(), stepT_.size());
+  section_(SEC_STEP_POS, sizeof(int32_t), stepPos_.data(), stepPos_.size());
+  section_(SEC_EV_T, sizeof(uint64_t), evT_.data(), evT_.size());
+  section_(SEC_EV_ID, sizeof(uint8_t), evId_.data(), evId_.size());
+  section_(SEC_EV_ARG, sizeof(int16_t), evArg_.data(), evArg_.size());
+
+  FileHeader h = {};
+  memcpy(h.magic, MAGIC, sizeof(MAGIC));
+  h.version      = VERSION;
+  h.byteOrder    = ENDIAN_MARK;
+  h.sectionCount = (uint32_t)sections_.size();
+  h.sectionTable = pos_;
+  h.samples      = samples_;
+  h.t0_us        = t0_;
+  h.t1_us        = lastT_;
+  writeAligned_(sections_.data(), sections_.size() * sizeof(SectionEntry));
+
+  if (fseek(f_, 0, SEEK_SET) != 0 || fwrite(&h, sizeof(h), 1, f_) != 1) ok_ = false;
+  if (fclose(f_) != 0) ok_ = false;
+  f_ = nullptr;
+  if (!ok_) fprintf(stderr, "%s: write failed\n", path_.c_str());
+  return ok_;
+}
+
+// ---------------------------------------------------------------------------
+// TraceFile
+// ---------------------------------------------------------------------------
+
+bool TraceFile::isTraceFile(const char* path) {
+  char magic[sizeof(MAGIC)];
+  FILE* f = fopen(path, "rb");
+  if (!f) return false;
+  const bool ok = fread(magic, sizeof(magic), 1, f) == 1 && !memcmp(magic, MAGIC, sizeof(MAGIC));
+  fclose(f);
+  return ok;
+}
+
+bool TraceFile::open(const char* path) {
+  close();
+  fd_ = ::open(path, O_RDONLY);
+  if (fd_ < 0) {
+    perror(path);
+    return false;
+  }
+  struct stat st;
+  if (fstat(fd_, &st) != 0 || (size_t)st.st_size < sizeof(FileHeader)) {
+    fprintf(stderr, "%s: not a trace file\n", path);
+    close();
+    return false;
+  }
+  size_ = (size_t)st.st_size;
+  void* m = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd_, 0);
+  if (m == MAP_FAILED) {
+    perror(path);
+    size_ = 0;
+    close();
+    return false;
+  }
+  base_ = (const uint8_t*)m;
+  hdr_  = (const FileHeader*)base_;
+
+  const char* err = nullptr;
+  if (memcmp(hdr_->magic, MAGIC, sizeof(MAGIC)) != 0)  err = "not a trace file";
+  else if (hdr_->byteOrder != ENDIAN_MARK)               err = "written with another byte order";
+  else if (hdr_->version != VERSION)                    err = "unsupported version";
+  else if (hdr_->sectionTable % 8 || hdr_->sectionTable > size_ ||
+           (size_ - hdr_->sectionTable) / sizeof(SectionEntry) < hdr_->sectionCount) err = "truncated";
+  if (!err) {
+    sections_ = (const SectionEntry*)(base_ + hdr_->sectionTable);
+    for (uint32_t i = 0; i < hdr_->sectionCount && !err; ++i) {
+      const SectionEntry& s = sections_[i];
+      if (s.offset % 8 || s.offset > size_ || !s.elemSize || (size_ - s.offset) / s.elemSize < s.count) err = "corrupt section table";
+    }
+  }
+  if (!err) {
+    uint64_t next = 0;
+    for (const ChunkEntry& c : chunks()) {
+      if (c.first != next || !c.count || !c.dtUnit || c.dtBits > 32 || c.dvBits > 32 ||
+          c.offset > size_ || size_ - c.offset < (uint64_t)c.size + CHUNK_PAD ||
+          (uint64_t)c.size * 8 < (uint64_t)(c.count - 1) * (c.dtBits + c.dvBits)) {
+        err = "corrupt chunk index";
+        break;
+      }
+      next += c.count;
+    }
+    if (!err && next != hdr_->samples) err = "corrupt chunk index";
+  }
+  if (err) {
+    fprintf(stderr, "%s: %s\n", path, err);
+    close();
+    return false;
+  }
+  return true;
+}
+
+void TraceFile::close() {
+  if (base_) munmap((void*)base_, size_);
+  if (fd_ >= 0) ::close(fd_);
+  fd_ = -1;
+  base_ = nullptr;
+  size_ = 0;
+  hdr_ = nullptr;
+  sections_ = nullptr;
+}
+
+const SectionEntry* TraceFile::find_(uint32_t id) const {
+  if (!hdr_) return nullptr;
+  for (uint32_t i = 0; i < hdr_->sectionCount; ++i) {
+    if (sections_[i].id == id) return &sections_[i];
+  }
+  return nullptr;
+}
+
+bool TraceFile::meta(const char* key, std::string& value) const {
+  const Column<char> m = metaText();
+  const size_t klen = strlen(key);
+  size_t i = 0;
+  while (i < m.size) {
+    size_t e = i;
+    while (e < m.size && m[e] != '\n') ++e;
+    if (e - i > klen && m[i + klen] == '=' && !memcmp(&m[i], key, klen)) {
+      value.assign(&m[i + klen + 1], e - i - klen - 1);
+      return true;
+    }
+    i = e + 1;
+  }
+  return false;
+}
+
+size_t TraceFile::chunkOf_(uint64_t sample) const {
+  const Column<ChunkEntry> c = chunks();
+  auto it = std::upper_bound(c.begin(), c.end(), sample,
+                             [](uint64_t s, const ChunkEntry& e) { return s < e.first; });
+  return it == c.begin() ? 0 : (size_t)(it - c.begin()) - 1;
+}
+
+size_t TraceFile::read(uint64_t first, size_t n, uint64_t* t_us, uint16_t* adc) const {
+  const Column<ChunkEntry> chunks = this->chunks();
+  if (first >= samples()) return 0;
+  n = (size_t)std::min<uint64_t>(n, samples() - first);
+
+  size_t done = 0;
+  for (size_t ci = chunkOf_(first); done < n && ci < chunks.size; ++ci) {
+    const ChunkEntry& c = chunks[ci];
+    const uint8_t* p = base_ + c.offset;
+    const uint64_t vBase = (uint64_t)(c.count - 1) * c.dtBits;
+    uint64_t t = c.t0_us;
+    int32_t  v = c.adc0;
+    for (uint32_t k = 0; k < c.count && done < n; ++k) {
+      if (k) {
+        t += c.dtBase + (uint64_t)c.dtUnit * getBits(p, (uint64_t)(k - 1) * c.dtBits, c.dtBits);
+        v += unzigzag(getBits(p, vBase + (uint64_t)(k - 1) * c.dvBits, c.dvBits));
+      }
+      if (c.first + k < first) continue;
+      if (t_us) t_us[done] = t;
+      if (adc)  adc[done] = (uint16_t)v;
+      ++done;
+    }
+  }
+  return done;
+}
+
+uint64_t TraceFile::sampleAt(uint64_t t_us) const {
+  const Column<ChunkEntry> c = chunks();
+  if (c.empty() || t_us < c[0].t0_us) return 0;
+  // last chunk starting at or before t_us
+  auto it = std::upper_bound(c.begin(), c.end(), t_us,
+                             [](uint64_t t, const ChunkEntry& e) { return t < e.t0_us; });
+  const ChunkEntry& e = *(it - 1);
+  if (t_us >= e.t1_us) return e.first + e.count - 1;
+
+  const uint8_t* p = base_ + e.offset;
+  uint64_t t = e.t0_us;
+  uint32_t k = 1;
+  for (; k < e.count; ++k) {
+    t += e.dtBase + (uint64_t)e.dtUnit * getBits(p, (uint64_t)(k - 1) * e.dtBits, e.dtBits);
+    if (t > t_us) break;
+  }
+  return e.first + k - 1;
+}
+
+}  // namespace tracefile
@@ -0,0 +1,279 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+/**
+ * @file TraceFile.h
+ * @brief Binary columnar trace files (.ttr): writer and memory-mapped reader.
+ *
+ * One file holds one run: the ADC readings of the current sensor, the sensor
+ * windows, the axis positions and the firmware events, each as its own
+ * column, plus key=value metadata (the same keys as the '#' annotations of
+ * the text traces: mode, baseline_A, start_z_mm, contact_us, break_us).
+ *
+ * Layout (little endian, every section starts 8-byte aligned):
+ *
+ *   FileHeader                      magic, version, section table offset
+ *   sample chunks                   packed readings, 4096 per chunk by default
+ *   sections                        metadata, chunk index, fixed-width columns
+ *   SectionEntry[sectionCount]      id, element size, offset, count
+ *
+ * Readings are stored per chunk as the first time and reading followed by
+ * two bit-packed arrays of count - 1 deltas: time steps minus the smallest
+ * step of the chunk, in units of their common divisor (0 bits when the
+ * sampling is regular, few when it falls on a coarse grid), and reading
+ * changes zigzag coded (a 50 Hz signal sampled at 5 kHz needs 4-6 bits
+ * instead of a text line of ~12 bytes). The chunk index gives the time span
+ * and first sample number of each chunk, so a time or sample number is
+ * found by binary search and only one chunk is decoded.
+ *
+ * The other columns are plain arrays, exposed by the reader as pointers into
+ * the mapping (no copy, no parsing): opening a file costs one mmap() and a
+ * look at the section table, whatever its size.
+ */
+namespace tracefile {
+
+/** @brief File magic. */
+constexpr char MAGIC[8] = { 'T', 'I', 'P', 'T', 'R', 'A', 'C', 'E' };
+/** @brief Format version written and understood. */
+constexpr uint16_t VERSION = 1;
+/** @brief Byte order marker (0x0102 as written by a little-endian host). */
+constexpr uint16_t ENDIAN_MARK = 0x0102;
+/** @brief Default readings per chunk. */
+constexpr uint32_t CHUNK_SAMPLES = 4096;
+
+/** @brief Section IDs. */
+enum SectionId : uint32_t {
+  SEC_META     = 1,   ///< "key=value\n" lines (char).
+  SEC_CHUNKS   = 2,   ///< ChunkEntry per sample chunk.
+  SEC_WIN_T    = 10,  ///< Sensor window end time (uint64_t, µs).
+  SEC_WIN_IRMS = 11,  ///< RMS current of the window (float, A).
+  SEC_WIN_VPP  = 12,  ///< Peak-to-peak voltage of the window (float, V).
+  SEC_WIN_MIN  = 13,  ///< Smallest reading of the window (uint16_t).
+  SEC_WIN_MAX  = 14,  ///< Largest reading of the window (uint16_t).
+  SEC_STEP_T   = 20,  ///< Time of an axis position change (uint64_t, µs).
+  SEC_STEP_POS = 21,  ///< Axis position after it (int32_t, steps).
+  SEC_EV_T     = 30,  ///< Event time (uint64_t, µs).
+  SEC_EV_ID    = 31,  ///< Event ID, EV_* in ProtocolDefs.h (uint8_t).
+  SEC_EV_ARG   = 32,  ///< Event argument (int16_t).
+};
+
+/** @brief File header (64 bytes). */
+struct FileHeader {
+  char     magic[8];
+  uint16_t version;
+  uint16_t byteOrder;
+  uint32_t sectionCount;
+  uint64_t sectionTable;   ///< File offset of the SectionEntry array.
+  uint64_t samples;        ///< Total readings.
+  uint64_t t0_us;          ///< Time of the first reading.
+  uint64_t t1_us;          ///< Time of the last reading.
+  uint64_t reserved[2];
+};
+
+/** @brief Section table entry (24 bytes). */
+struct SectionEntry {
+  uint32_t id;
+  uint32_t elemSize;       ///< Bytes per element.
+  uint64_t offset;         ///< File offset of the first element.
+  uint64_t count;          ///< Number of elements.
+};
+
+/** @brief Chunk index entry (56 bytes). */
+struct ChunkEntry {
+  uint64_t t0_us;          ///< Time of the first reading.
+  uint64_t t1_us;          ///< Time of the last reading.
+  uint64_t first;          ///< Number of the first reading in the run.
+  uint64_t offset;         ///< File offset of the packed deltas.
+  uint32_t count;          ///< Readings in the chunk.
+  uint32_t size;           ///< Bytes of packed deltas (without padding).
+  uint32_t dtBase;         ///< Smallest time step (µs).
+  uint32_t dtUnit;         ///< Common divisor of the steps above dtBase (µs, >= 1).
+  uint16_t adc0;           ///< First reading.
+  uint8_t  dtBits;         ///< Bits per time step, (step - dtBase) / dtUnit.
+  uint8_t  dvBits;         ///< Bits per zigzag reading change.
+  uint32_t reserved;
+};
+
+static_assert(sizeof(FileHeader) == 64, "FileHeader layout");
+static_assert(sizeof(SectionEntry) == 24, "SectionEntry layout");
+static_assert(sizeof(ChunkEntry) == 56, "ChunkEntry layout");
+
+/**
+ * @brief Read-only view of a column inside the mapping.
+ */
+template <typename T>
+struct Column {
+  const T* data = nullptr;
+  size_t   size = 0;
+
+  const T* begin() const { return data; }
+  const T* end() const { return data + size; }
+  const T& operator[](size_t i) const { return data[i]; }
+  bool empty() const { return size == 0; }
+};
+
+/** @brief First index of a sorted time column with t[i] >= t_us. */
+size_t lowerBound(const Column<uint64_t>& t, uint64_t t_us);
+
+/**
+ * @brief Streams one run into a .ttr file.
+ *
+ * Readings are packed and written chunk by chunk as they arrive; windows,
+ * positions, events and metadata are kept until close() (they are small
+ * next to the readings). Times must not go backwards within a column.
+ */
+class TraceWriter {
+public:
+  ~TraceWriter();
+
+  /**
+   * @brief Create the file.
+   *
+   * @param path   Output path.
+   * @param chunk  Readings per chunk (> 1).
+   * @return false (and a message on stderr) if it cannot be created.
+   */
+  bool open(const char* path, uint32_t chunk = CHUNK_SAMPLES);
+
+  /** @brief Add a metadata entry (written at close()). */
+  void meta(const char* key, const std::string& value);
+
+  /** @brief Append one ADC reading. */
+  void sample(uint64_t t_us, uint16_t adc);
+
+  /** @brief Append the result of a sensor window. */
+  void window(uint64_t t_us, float irms, float vpp, uint16_t adcMin, uint16_t adcMax);
+
+  /** @brief Append an axis position. */
+  void step(uint64_t t_us, int32_t pos);
+
+  /** @brief Append a firmware event. */
+  void event(uint64_t t_us, uint8_t id, int16_t arg);
+
+  /**
+   * @brief Write the remaining chunk, the columns and the index.
+   *
+   * @return false if anything could not be written or a time went backwards.
+   */
+  bool close();
+
+private:
+  void flushChunk_();
+  void writeAligned_(const void* p, size_t n);
+  void section_(uint32_t id, uint32_t elemSize, const void* p, size_t count);
+
+  FILE*       f_ = nullptr;
+  std::string path_;
+  uint64_t    pos_ = 0;          ///< Bytes written so far.
+  bool        ok_ = true;
+  uint32_t    chunk_ = CHUNK_SAMPLES;
+
+  std::vector<uint64_t>     t_;  ///< Readings of the open chunk.
+  std::vector<uint16_t>     adc_;
+  std::vector<uint8_t>      packed_;
+  std::vector<ChunkEntry>   chunks_;
+  uint64_t                  samples_ = 0;
+  uint64_t                  lastT_ = 0;
+  uint64_t                  t0_ = 0;
+
+  std::string               meta_;
+  std::vector<uint64_t>     winT_;
+  std::vector<float>        winIrms_, winVpp_;
+  std::vector<uint16_t>     winMin_, winMax_;
+  std::vector<uint64_t>     stepT_;
+  std::vector<int32_t>      stepPos_;
+  std::vector<uint64_t>     evT_;
+  std::vector<uint8_t>      evId_;
+  std::vector<int16_t>      evArg_;
+  std::vector<SectionEntry> sections_;
+};
+
+/**
+ * @brief Memory-mapped .ttr file.
+ */
+class TraceFile {
+public:
+  TraceFile() = default;
+  TraceFile(const TraceFile&) = delete;
+  TraceFile& operator=(const TraceFile&) = delete;
+  ~TraceFile() { close(); }
+
+  /**
+   * @brief Map a file and check its header and section table.
+   *
+   * @return false (and a message on stderr) if it is not a valid .ttr file.
+   */
+  bool open(const char* path);
+
+  /** @brief Unmap the file. */
+  void close();
+
+  /** @brief True if the file at path starts with the .ttr magic. */
+  static bool isTraceFile(const char* path);
+
+  /** @brief Number of readings. */
+  uint64_t samples() const { return hdr_ ? hdr_->samples : 0; }
+  /** @brief Time of the first reading (µs). */
+  uint64_t startUs() const { return hdr_ ? hdr_->t0_us : 0; }
+  /** @brief Time of the last reading (µs). */
+  uint64_t endUs() const { return hdr_ ? hdr_->t1_us : 0; }
+  /** @brief Size of the file in bytes. */
+  size_t fileSize() const { return size_; }
+
+  /**
+   * @brief Value of a metadata key.
+   *
+   * @return false if the key is not present.
+   */
+  bool meta(const char* key, std::string& value) const;
+  /** @brief All metadata as "key=value\n" lines. */
+  Column<char> metaText() const { return column<char>(SEC_META); }
+
+  /** @brief Chunk index. */
+  Column<ChunkEntry> chunks() const { return column<ChunkEntry>(SEC_CHUNKS); }
+
+  /**
+   * @brief A fixed-width column, pointing into the mapping.
+   *
+   * @return An empty column if the section is missing or its element size
+   *         is not sizeof(T).
+   */
+  template <typename T>
+  Column<T> column(uint32_t id) const {
+    const SectionEntry* s = find_(id);
+    if (!s || s->elemSize != sizeof(T)) return {};
+    return { (const T*)(base_ + s->offset), (size_t)s->count };
+  }
+
+  /**
+   * @brief Decode readings first .. first + n - 1.
+   *
+   * Decoding starts at the chunk holding `first`; either output may be null.
+   *
+   * @return Number of readings decoded (fewer at the end of the run).
+   */
+  size_t read(uint64_t first, size_t n, uint64_t* t_us, uint16_t* adc) const;
+
+  /**
+   * @brief Number of the last reading at or before t_us (sample and hold).
+   *
+   * @return 0 if t_us is before the first reading.
+   */
+  uint64_t sampleAt(uint64_t t_us) const;
+
+private:
+  const SectionEntry* find_(uint32_t id) const;
+  size_t chunkOf_(uint64_t sample) const;
+
+  int                 fd_ = -1;
+  const uint8_t*      base_ = nullptr;
+  size_t              size_ = 0;
+  const FileHeader*   hdr_ = nullptr;
+  const SectionEntry* sections_ = nullptr;
+};
+
+}  // namespace tracefile
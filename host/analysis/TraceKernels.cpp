@@ -0,0 +1,479 @@
+#include "TraceKernels.h"
+#include <cmath>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define KERNELS_X86 1
+#include <immintrin.h>
+#define TARGET_SSE41 __attribute__((target("sse4.1")))
+#define TARGET_AVX2  __attribute__((target("avx2")))
+#else
+#define KERNELS_X86 0
+#endif
+
+/**
+ * @file TraceKernels.cpp
+ * @brief Scalar references and SSE4.1/AVX2 versions of the trace kernels.
+ *
+ * Compiled with -ffp-contract=off: a fused multiply-add would round once
+ * where the firmware rounds twice.
+ */
+
+namespace kernels {
+
+namespace {
+
+// ---------------------------------------------------------------------------
+// Scalar references (the firmware's arithmetic, operation by operation)
+// ---------------------------------------------------------------------------
+
+/** @brief One window of CurrentSensor::update(). */
+void windowScalar(const uint16_t* a, size_t win, float c, float kCal, const WindowOut& out, size_t w) {
+  int   adcMin = 1023, adcMax = 0;
+  float sumV = 0.0f, sumV2 = 0.0f;
+  for (size_t i = 0; i < win; ++i) {
+    int adc = a[i];
+    if (adc < adcMin) adcMin = adc;
+    if (adc > adcMax) adcMax = adc;
+    float v = adc * c;
+    sumV  += v;
+    sumV2 += v * v;
+  }
+  float meanV  = sumV  / (float)win;
+  float meanV2 = sumV2 / (float)win;
+  float var = meanV2 - meanV * meanV;
+  if (var < 0.0f) var = 0.0f;
+  if (out.meanV) out.meanV[w] = meanV;
+  if (out.var)   out.var[w]   = var;
+  if (out.irms)  out.irms[w]  = kCal * sqrtf(var);
+  if (out.min)   out.min[w]   = (uint16_t)adcMin;
+  if (out.max)   out.max[w]   = (uint16_t)adcMax;
+}
+
+/** @brief MovingAverage::toFixed_(). */
+inline int32_t toFixedScalar(float x, float scale) {
+  float xm = x * scale;
+  if (xm > 32767.0f) xm = 32767.0f;
+  if (xm < -32768.0f) xm = -32768.0f;
+  return (int16_t)lroundf(xm);
+}
+
+void movingAverageScalar(const float* x, size_t n, int len, int scale, float* out) {
+  const float sc = (float)scale;
+  int32_t sum = 0;
+  for (size_t i = 0; i < n; ++i) {
+    sum += toFixedScalar(x[i], sc);
+    if (i >= (size_t)len) sum -= toFixedScalar(x[i - len], sc);
+    int denom = i + 1 < (size_t)len ? (int)(i + 1) : len;
+    out[i] = ((float)sum / (float)denom) / sc;
+  }
+}
+
+/** @brief Goertzel over one window. */
+float goertzelScalar(const uint16_t* a, size_t win, float coeff, float c, float kCal) {
+  float s1 = 0.0f, s2 = 0.0f;
+  for (size_t i = 0; i < win; ++i) {
+    float v = a[i] * c;
+    float t = coeff * s1;
+    t = v + t;
+    float s = t - s2;
+    s2 = s1;
+    s1 = s;
+  }
+  float p = s1 * s1 + s2 * s2;
+  float q = coeff * s1;
+  p = p - q * s2;
+  if (p < 0.0f) p = 0.0f;
+  return (kCal * sqrtf(2.0f * p)) / (float)win;
+}
+
+#if KERNELS_X86
+
+// ---------------------------------------------------------------------------
+// SSE4.1: four windows per vector
+// ---------------------------------------------------------------------------
+
+/** @brief Sample i of four windows starting win apart. */
+TARGET_SSE41 inline __m128i load4(const uint16_t* a, size_t win, size_t i) {
+  return _mm_setr_epi32(a[i], a[win + i], a[2 * win + i], a[3 * win + i]);
+}
+
+TARGET_SSE41 size_t windowSse41(const uint16_t* adc, size_t nw, size_t win, float c, float kCal,
+                                const WindowOut& out) {
+  const __m128 vc = _mm_set1_ps(c), vn = _mm_set1_ps((float)win), vk = _mm_set1_ps(kCal);
+  const __m128 zero = _mm_setzero_ps();
+  size_t w = 0;
+  for (; w + 4 <= nw; w += 4) {
+    const uint16_t* a = adc + w * win;
+    __m128i mn = _mm_set1_epi32(1023), mx = _mm_setzero_si128();
+    __m128 sumV = zero, sumV2 = zero;
+    for (size_t i = 0; i < win; ++i) {
+      __m128i q = load4(a, win, i);
+      mn = _mm_min_epi32(mn, q);
+      mx = _mm_max_epi32(mx, q);
+      __m128 v = _mm_mul_ps(_mm_cvtepi32_ps(q), vc);
+      sumV  = _mm_add_ps(sumV, v);
+      sumV2 = _mm_add_ps(sumV2, _mm_mul_ps(v, v));
+    }
+    __m128 meanV  = _mm_div_ps(sumV, vn);
+    __m128 meanV2 = _mm_div_ps(sumV2, vn);
+    __m128 var = _mm_sub_ps(meanV2, _mm_mul_ps(meanV, meanV));
+    var = _mm_blendv_ps(var, zero, _mm_cmplt_ps(var, zero));
+    if (out.meanV) _mm_storeu_ps(out.meanV + w, meanV);
+    if (out.var)   _mm_storeu_ps(out.var + w, var);
+    if (out.irms)  _mm_storeu_ps(out.irms + w, _mm_mul_ps(vk, _mm_sqrt_ps(var)));
+    if (out.min)   _mm_storel_epi64((__m128i*)(out.min + w), _mm_packus_epi32(mn, mn));
+    if (out.max)   _mm_storel_epi64((__m128i*)(out.max + w), _mm_packus_epi32(mx, mx));
+  }
+  return w;
+}
+
+/** @brief toFixed_() of four values: scale, clamp, round half away from zero. */
+TARGET_SSE41 inline __m128i toFixed4(__m128 x, __m128 sc) {
+  const __m128 hi = _mm_set1_ps(32767.0f), lo = _mm_set1_ps(-32768.0f);
+  const __m128 half = _mm_set1_ps(0.5f), mhalf = _mm_set1_ps(-0.5f), one = _mm_set1_ps(1.0f);
+  __m128 xm = _mm_mul_ps(x, sc);
+  xm = _mm_blendv_ps(xm, hi, _mm_cmpgt_ps(xm, hi));
+  xm = _mm_blendv_ps(xm, lo, _mm_cmplt_ps(xm, lo));
+  __m128 t = _mm_round_ps(xm, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC);
+  __m128 d = _mm_sub_ps(xm, t);
+  t = _mm_add_ps(t, _mm_and_ps(_mm_cmpge_ps(d, half), one));
+  t = _mm_sub_ps(t, _mm_and_ps(_mm_cmple_ps(d, mhalf), one));
+  return _mm_cvttps_epi32(t);
+}
+
+TARGET_SSE41 void movingAverageSse41(const float* x, size_t n, int len, int scale, float* out) {
+  const __m128 sc = _mm_set1_ps((float)scale);
+  const __m128i vlen = _mm_set1_epi32(len), step = _mm_set1_epi32(4);
+  __m128i idx1 = _mm_setr_epi32(1, 2, 3, 4);   // i + 1 per lane
+  __m128i carry = _mm_setzero_si128();          // running sum before this block, in all lanes
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    __m128i d = toFixed4(_mm_loadu_ps(x + i), sc);
+    if (i >= (size_t)len) {
+      d = _mm_sub_epi32(d, toFixed4(_mm_loadu_ps(x + i - len), sc));
+    } else if (i + 4 > (size_t)len) {
+      // the window starts dropping samples inside this block
+      alignas(16) float old[4];
+      for (int k = 0; k < 4; ++k) old[k] = i + k >= (size_t)len ? x[i + k - len] : 0.0f;
+      d = _mm_sub_epi32(d, toFixed4(_mm_load_ps(old), sc));
+    }
+    // inclusive prefix sum of the four differences
+    d = _mm_add_epi32(d, _mm_slli_si128(d, 4));
+    d = _mm_add_epi32(d, _mm_slli_si128(d, 8));
+    __m128i sum = _mm_add_epi32(d, carry);
+    carry = _mm_shuffle_epi32(sum, _MM_SHUFFLE(3, 3, 3, 3));
+
+    __m128 denom = _mm_cvtepi32_ps(_mm_min_epi32(idx1, vlen));
+    _mm_storeu_ps(out + i, _mm_div_ps(_mm_div_ps(_mm_cvtepi32_ps(sum), denom), sc));
+    idx1 = _mm_add_epi32(idx1, step);
+  }
+  if (i < n) {
+    // finish the series with the scalar recurrence from the running sum
+    int32_t sum = _mm_cvtsi128_si32(carry);
+    const float s = (float)scale;
+    for (; i < n; ++i) {
+      sum += toFixedScalar(x[i], s);
+      if (i >= (size_t)len) sum -= toFixedScalar(x[i - len], s);
+      int denom = i + 1 < (size_t)len ? (int)(i + 1) : len;
+      out[i] = ((float)sum / (float)denom) / s;
+    }
+  }
+}
+
+TARGET_SSE41 size_t goertzelSse41(const uint16_t* adc, size_t nw, size_t win, float coeff, float c,
+                                  float kCal, float* irms) {
+  const __m128 vc = _mm_set1_ps(c), vq = _mm_set1_ps(coeff), vk = _mm_set1_ps(kCal);
+  const __m128 vn = _mm_set1_ps((float)win), two = _mm_set1_ps(2.0f), zero = _mm_setzero_ps();
+  size_t w = 0;
+  for (; w + 4 <= nw; w += 4) {
+    const uint16_t* a = adc + w * win;
+    __m128 s1 = zero, s2 = zero;
+    for (size_t i = 0; i < win; ++i) {
+      __m128 v = _mm_mul_ps(_mm_cvtepi32_ps(load4(a, win, i)), vc);
+      __m128 s = _mm_sub_ps(_mm_add_ps(v, _mm_mul_ps(vq, s1)), s2);
+      s2 = s1;
+      s1 = s;
+    }
+    __m128 p = _mm_add_ps(_mm_mul_ps(s1, s1), _mm_mul_ps(s2, s2));
+    p = _mm_sub_ps(p, _mm_mul_ps(_mm_mul_ps(vq, s1), s2));
+    p = _mm_blendv_ps(p, zero, _mm_cmplt_ps(p, zero));
+    __m128 r = _mm_mul_ps(vk, _mm_sqrt_ps(_mm_mul_ps(two, p)));
+    _mm_storeu_ps(irms + w, _mm_div_ps(r, vn));
+  }
+  return w;
+}
+
+// ---------------------------------------------------------------------------
+// AVX2: eight windows per vector
+// ---------------------------------------------------------------------------
+
+/** @brief Sample i of eight windows starting win apart. */
+TARGET_AVX2 inline __m256i load8(const uint16_t* a, size_t win, size_t i) {
+  return _mm256_setr_epi32(a[i], a[win + i], a[2 * win + i], a[3 * win + i],
+                           a[4 * win + i], a[5 * win + i], a[6 * win + i], a[7 * win + i]);
+}
+
+/**
+ * @brief Samples i..i+7 of eight windows, transposed: q[k] holds sample i+k
+ *        of each window.
+ *
+ * Eight 16-byte loads and a transpose are much cheaper than eight gathers.
+ */
+TARGET_AVX2 inline void load8x8(const uint16_t* a, size_t win, size_t i, __m256i q[8]) {
+  __m256i r[8];
+  for (int j = 0; j < 8; ++j) r[j] = _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i*)(a + j * win + i)));
+  __m256i t0 = _mm256_unpacklo_epi32(r[0], r[1]), t1 = _mm256_unpackhi_epi32(r[0], r[1]);
+  __m256i t2 = _mm256_unpacklo_epi32(r[2], r[3]), t3 = _mm256_unpackhi_epi32(r[2], r[3]);
+  __m256i t4 = _mm256_unpacklo_epi32(r[4], r[5]), t5 = _mm256_unpackhi_epi32(r[4], r[5]);
+  __m256i t6 = _mm256_unpacklo_epi32(r[6], r[7]), t7 = _mm256_unpackhi_epi32(r[6], r[7]);
+  __m256i u0 = _mm256_unpacklo_epi64(t0, t2), u1 = _mm256_unpackhi_epi64(t0, t2);
+  __m256i u2 = _mm256_unpacklo_epi64(t1, t3), u3 = _mm256_unpackhi_epi64(t1, t3);
+  __m256i u4 = _mm256_unpacklo_epi64(t4, t6), u5 = _mm256_unpackhi_epi64(t4, t6);
+  __m256i u6 = _mm256_unpacklo_epi64(t5, t7), u7 = _mm256_unpackhi_epi64(t5, t7);
+  q[0] = _mm256_permute2x128_si256(u0, u4, 0x20);
+  q[1] = _mm256_permute2x128_si256(u1, u5, 0x20);
+  q[2] = _mm256_permute2x128_si256(u2, u6, 0x20);
+  q[3] = _mm256_permute2x128_si256(u3, u7, 0x20);
+  q[4] = _mm256_permute2x128_si256(u0, u4, 0x31);
+  q[5] = _mm256_permute2x128_si256(u1, u5, 0x31);
+  q[6] = _mm256_permute2x128_si256(u2, u6, 0x31);
+  q[7] = _mm256_permute2x128_si256(u3, u7, 0x31);
+}
+
+/** @brief Accumulators of eight windows. */
+struct Acc8 {
+  __m256i mn, mx;
+  __m256  sumV, sumV2;
+};
+
+TARGET_AVX2 inline void accInit(Acc8& s) {
+  s.mn = _mm256_set1_epi32(1023);
+  s.mx = _mm256_setzero_si256();
+  s.sumV = s.sumV2 = _mm256_setzero_ps();
+}
+
+TARGET_AVX2 inline void accAdd(Acc8& s, __m256i q, __m256 vc) {
+  s.mn = _mm256_min_epi32(s.mn, q);
+  s.mx = _mm256_max_epi32(s.mx, q);
+  __m256 v = _mm256_mul_ps(_mm256_cvtepi32_ps(q), vc);
+  s.sumV  = _mm256_add_ps(s.sumV, v);
+  s.sumV2 = _mm256_add_ps(s.sumV2, _mm256_mul_ps(v, v));
+}
+
+TARGET_AVX2 void accStore(const Acc8& s, float win, float kCal, const WindowOut& out, size_t w) {
+  const __m256 vn = _mm256_set1_ps(win), zero = _mm256_setzero_ps();
+  __m256 meanV  = _mm256_div_ps(s.sumV, vn);
+  __m256 meanV2 = _mm256_div_ps(s.sumV2, vn);
+  __m256 var = _mm256_sub_ps(meanV2, _mm256_mul_ps(meanV, meanV));
+  var = _mm256_blendv_ps(var, zero, _mm256_cmp_ps(var, zero, _CMP_LT_OQ));
+  if (out.meanV) _mm256_storeu_ps(out.meanV + w, meanV);
+  if (out.var)   _mm256_storeu_ps(out.var + w, var);
+  if (out.irms)  _mm256_storeu_ps(out.irms + w, _mm256_mul_ps(_mm256_set1_ps(kCal), _mm256_sqrt_ps(var)));
+  if (out.min) {
+    __m256i p = _mm256_permute4x64_epi64(_mm256_packus_epi32(s.mn, s.mn), _MM_SHUFFLE(3, 1, 2, 0));
+    _mm_storeu_si128((__m128i*)(out.min + w), _mm256_castsi256_si128(p));
+  }
+  if (out.max) {
+    __m256i p = _mm256_permute4x64_epi64(_mm256_packus_epi32(s.mx, s.mx), _MM_SHUFFLE(3, 1, 2, 0));
+    _mm_storeu_si128((__m128i*)(out.max + w), _mm256_castsi256_si128(p));
+  }
+}
+
+/** @brief Adds one window block's samples in order, eight at a time. */
+TARGET_AVX2 inline void accWindow(Acc8& s, const uint16_t* a, size_t win, __m256 vc) {
+  size_t i = 0;
+  for (; i + 8 <= win; i += 8) {
+    __m256i q[8];
+    load8x8(a, win, i, q);
+    for (int k = 0; k < 8; ++k) accAdd(s, q[k], vc);
+  }
+  for (; i < win; ++i) accAdd(s, load8(a, win, i), vc);
+}
+
+TARGET_AVX2 size_t windowAvx2(const uint16_t* adc, size_t nw, size_t win, float c, float kCal,
+                              const WindowOut& out) {
+  const __m256 vc = _mm256_set1_ps(c);
+  size_t w = 0;
+  for (; w + 8 <= nw; w += 8) {
+    Acc8 sa;
+    accInit(sa);
+    accWindow(sa, adc + w * win, win, vc);
+    accStore(sa, (float)win, kCal, out, w);
+  }
+  return w;
+}
+
+/** @brief toFixed_() of eight values. */
+TARGET_AVX2 inline __m256i toFixed8(__m256 x, __m256 sc) {
+  const __m256 hi = _mm256_set1_ps(32767.0f), lo = _mm256_set1_ps(-32768.0f);
+  const __m256 half = _mm256_set1_ps(0.5f), mhalf = _mm256_set1_ps(-0.5f), one = _mm256_set1_ps(1.0f);
+  __m256 xm = _mm256_mul_ps(x, sc);
+  xm = _mm256_blendv_ps(xm, hi, _mm256_cmp_ps(xm, hi, _CMP_GT_OQ));
+  xm = _mm256_blendv_ps(xm, lo, _mm256_cmp_ps(xm, lo, _CMP_LT_OQ));
+  __m256 t = _mm256_round_ps(xm, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC);
+  __m256 d = _mm256_sub_ps(xm, t);
+  t = _mm256_add_ps(t, _mm256_and_ps(_mm256_cmp_ps(d, half, _CMP_GE_OQ), one));
+  t = _mm256_sub_ps(t, _mm256_and_ps(_mm256_cmp_ps(d, mhalf, _CMP_LE_OQ), one));
+  return _mm256_cvttps_epi32(t);
+}
+
+TARGET_AVX2 void movingAverageAvx2(const float* x, size_t n, int len, int scale, float* out) {
+  const __m256 sc = _mm256_set1_ps((float)scale);
+  const __m256i vlen = _mm256_set1_epi32(len), step = _mm256_set1_epi32(8);
+  const __m256i last = _mm256_set1_epi32(7);
+  __m256i idx1 = _mm256_setr_epi32(1, 2, 3, 4, 5, 6, 7, 8);
+  __m256i carry = _mm256_setzero_si256();
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    __m256i d = toFixed8(_mm256_loadu_ps(x + i), sc);
+    if (i >= (size_t)len) {
+      d = _mm256_sub_epi32(d, toFixed8(_mm256_loadu_ps(x + i - len), sc));
+    } else if (i + 8 > (size_t)len) {
+      alignas(32) float old[8];
+      for (int k = 0; k < 8; ++k) old[k] = i + k >= (size_t)len ? x[i + k - len] : 0.0f;
+      d = _mm256_sub_epi32(d, toFixed8(_mm256_load_ps(old), sc));
+    }
+    // prefix sum within each 128-bit half, then carry the low half into the high half
+    d = _mm256_add_epi32(d, _mm256_slli_si256(d, 4));
+    d = _mm256_add_epi32(d, _mm256_slli_si256(d, 8));
+    __m256i lowTop = _mm256_shuffle_epi32(d, _MM_SHUFFLE(3, 3, 3, 3));
+    d = _mm256_add_epi32(d, _mm256_permute2x128_si256(lowTop, lowTop, 0x08));
+    __m256i sum = _mm256_add_epi32(d, carry);
+    carry = _mm256_permutevar8x32_epi32(sum, last);
+
+    __m256 denom = _mm256_cvtepi32_ps(_mm256_min_epi32(idx1, vlen));
+    _mm256_storeu_ps(out + i, _mm256_div_ps(_mm256_div_ps(_mm256_cvtepi32_ps(sum), denom), sc));
+    idx1 = _mm256_add_epi32(idx1, step);
+  }
+  if (i < n) {
+    int32_t sum = _mm256_cvtsi256_si32(carry);
+    const float s = (float)scale;
+    for (; i < n; ++i) {
+      sum += toFixedScalar(x[i], s);
+      if (i >= (size_t)len) sum -= toFixedScalar(x[i - len], s);
+      int denom = i + 1 < (size_t)len ? (int)(i + 1) : len;
+      out[i] = ((float)sum / (float)denom) / s;
+    }
+  }
+}
+
+/** @brief One Goertzel step of eight windows. */
+TARGET_AVX2 inline void goertzelStep(__m256& s1, __m256& s2, __m256i q, __m256 vc, __m256 vq) {
+  __m256 v = _mm256_mul_ps(_mm256_cvtepi32_ps(q), vc);
+  __m256 s = _mm256_sub_ps(_mm256_add_ps(v, _mm256_mul_ps(vq, s1)), s2);
+  s2 = s1;
+  s1 = s;
+}
+
+TARGET_AVX2 size_t goertzelAvx2(const uint16_t* adc, size_t nw, size_t win, float coeff, float c,
+                                float kCal, float* irms) {
+  const __m256 vc = _mm256_set1_ps(c), vq = _mm256_set1_ps(coeff), vk = _mm256_set1_ps(kCal);
+  const __m256 vn = _mm256_set1_ps((float)win), two = _mm256_set1_ps(2.0f), zero = _mm256_setzero_ps();
+  size_t w = 0;
+  for (; w + 8 <= nw; w += 8) {
+    const uint16_t* a = adc + w * win;
+    __m256 s1 = zero, s2 = zero;
+    size_t i = 0;
+    for (; i + 8 <= win; i += 8) {
+      __m256i q[8];
+      load8x8(a, win, i, q);
+      for (int k = 0; k < 8; ++k) goertzelStep(s1, s2, q[k], vc, vq);
+    }
+    for (; i < win; ++i) goertzelStep(s1, s2, load8(a, win, i), vc, vq);
+    __m256 p = _mm256_add_ps(_mm256_mul_ps(s1, s1), _mm256_mul_ps(s2, s2));
+    p = _mm256_sub_ps(p, _mm256_mul_ps(_mm256_mul_ps(vq, s1), s2));
+    p = _mm256_blendv_ps(p, zero, _mm256_cmp_ps(p, zero, _CMP_LT_OQ));
+    __m256 r = _mm256_mul_ps(vk, _mm256_sqrt_ps(_mm256_mul_ps(two, p)));
+    _mm256_storeu_ps(irms + w, _mm256_div_ps(r, vn));
+  }
+  return w;
+}
+
+#endif  // KERNELS_X86
+
+/** @brief Requested instruction set, limited to what the CPU has. */
+Isa resolve(Isa isa) {
+  const Isa best = bestIsa();
+  if (isa == Isa::Best || (uint8_t)isa > (uint8_t)best) return best;
+  return isa;
+}
+
+}  // namespace
+
+Isa bestIsa() {
+#if KERNELS_X86
+  static const Isa best = __builtin_cpu_supports("avx2")   ? Isa::Avx2
+                        : __builtin_cpu_supports("sse4.1") ? Isa::Sse41
+                        : Isa::Scalar;
+  return best;
+#else
+  return Isa::Scalar;
+#endif
+}
+
+const char* isaName(Isa isa) {
+  switch (resolve(isa)) {
+    case Isa::Avx2:  return "avx2";
+    case Isa::Sse41: return "sse4.1";
+    default:         return "scalar";
+  }
+}
+
+size_t windowStats(const uint16_t* adc, size_t n, size_t win, const SensorScale& scale,
+                   const WindowOut& out, Isa isa) {
+  if (win == 0) return 0;
+  const size_t nw = n / win;
+  const float c = scale.vref / scale.adcMax;
+  size_t w = 0;
+#if KERNELS_X86
+  switch (resolve(isa)) {
+    case Isa::Avx2:  w = windowAvx2(adc, nw, win, c, scale.kCal, out); break;
+    case Isa::Sse41: w = windowSse41(adc, nw, win, c, scale.kCal, out); break;
+    default: break;
+  }
+#else
+  (void)isa;
+#endif
+  for (; w < nw; ++w) windowScalar(adc + w * win, win, c, scale.kCal, out, w);
+  return nw;
+}
+
+void movingAverage(const float* x, size_t n, int len, int scale, float* out, Isa isa) {
+  if (len < 1) len = 1;
+  if (len > 65535) len = 65535;
+#if KERNELS_X86
+  switch (resolve(isa)) {
+    case Isa::Avx2:  movingAverageAvx2(x, n, len, scale, out); return;
+    case Isa::Sse41: movingAverageSse41(x, n, len, scale, out); return;
+    default: break;
+  }
+#else
+  (void)isa;
+#endif
+  movingAverageScalar(x, n, len, scale, out);
+}
+
+float goertzelCoeff(float f_Hz, float fs_Hz) {
+  return 2.0f * cosf(6.28318530718f * f_Hz / fs_Hz);
+}
+
+size_t goertzel(const uint16_t* adc, size_t n, size_t win, float coeff, const SensorScale& scale,
+                float* irms, Isa isa) {
+  if (win == 0) return 0;
+  const size_t nw = n / win;
+  const float c = scale.vref / scale.adcMax;
+  size_t w = 0;
+#if KERNELS_X86
+  switch (resolve(isa)) {
+    case Isa::Avx2:  w = goertzelAvx2(adc, nw, win, coeff, c, scale.kCal, irms); break;
+    case Isa::Sse41: w = goertzelSse41(adc, nw, win, coeff, c, scale.kCal, irms); break;
+    default: break;
+  }
+#else
+  (void)isa;
+#endif
+  for (; w < nw; ++w) irms[w] = goertzelScalar(adc + w * win, win, coeff, c, scale.kCal);
+  return nw;
+}
+
+}  // namespace kernels
@@ -0,0 +1,115 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @file TraceKernels.h
+ * @brief Batch kernels for raw ADC traces with the arithmetic of the firmware.
+ *
+ * The kernels recompute, for a whole trace at once, what the firmware
+ * computes sample by sample: the window statistics of CurrentSensor::update()
+ * (mean, variance, min/max, RMS current), the fixed-point MovingAverage, and
+ * a Goertzel filter for the mains component. Each has a scalar reference
+ * written operation by operation like the firmware, and SSE4.1 / AVX2
+ * versions that return the same bits.
+ *
+ * Float sums depend on the order of the additions, so the vector versions
+ * do not split a window across lanes: each lane processes a different window
+ * (4 with SSE4.1, 8 with AVX2) in the firmware's order. The moving average
+ * accumulates integers, which vectorize along the series. No FMA is used
+ * anywhere: the firmware rounds every product.
+ *
+ * A time window of the sensor holds window_us / interval_us samples when the
+ * samples are evenly spaced; the kernels take the window in samples.
+ */
+namespace kernels {
+
+/** @brief Instruction set used by a kernel call. */
+enum class Isa : uint8_t { Scalar, Sse41, Avx2, Best };
+
+/** @brief Best instruction set of this CPU (Avx2, Sse41 or Scalar). */
+Isa bestIsa();
+
+/** @brief Name of an instruction set ("scalar", "sse4.1", "avx2"). */
+const char* isaName(Isa isa);
+
+/**
+ * @brief Conversion constants of the sensor (CurrentSensor constructor arguments).
+ */
+struct SensorScale {
+  float vref   = 5.0f;     ///< ADC reference voltage (V).
+  float adcMax = 1023.0f;  ///< ADC full scale.
+  float kCal   = 2.545f;   ///< A (RMS) per V (RMS).
+};
+
+/**
+ * @brief Per-window outputs of windowStats(); null pointers are not written.
+ *
+ * Each array receives one value per window.
+ */
+struct WindowOut {
+  float*    meanV = nullptr;  ///< <v> (V, bias included).
+  float*    var   = nullptr;  ///< <v²> - <v>², clamped at 0 (V²).
+  float*    irms  = nullptr;  ///< kCal * sqrt(var): CurrentSensor::lastIrms() (A).
+  uint16_t* min   = nullptr;  ///< Smallest ADC reading.
+  uint16_t* max   = nullptr;  ///< Largest ADC reading.
+};
+
+/**
+ * @brief Statistics of consecutive windows, as CurrentSensor closes them.
+ *
+ * @param adc    ADC readings (10 bit).
+ * @param n      Number of readings.
+ * @param win    Readings per window (> 0); a trailing partial window is ignored.
+ * @param scale  Conversion constants.
+ * @param out    Output arrays, n / win entries each.
+ * @param isa    Instruction set (Best = bestIsa()).
+ * @return Number of windows (n / win).
+ */
+size_t windowStats(const uint16_t* adc, size_t n, size_t win, const SensorScale& scale,
+                   const WindowOut& out, Isa isa = Isa::Best);
+
+/**
+ * @brief MovingAverage<N, SCALE>::update() over a series, starting from reset().
+ *
+ * out[i] is what update(x[i]) returns: the average of the last len fixed-point
+ * samples (fewer while the window fills), i.e. the filter with setLength(len).
+ *
+ * @param x      Input series.
+ * @param n      Length of the series.
+ * @param len    Window length (1..65535).
+ * @param scale  Fixed-point factor (SCALE template argument).
+ * @param out    Receives n averages.
+ * @param isa    Instruction set.
+ */
+void movingAverage(const float* x, size_t n, int len, int scale, float* out, Isa isa = Isa::Best);
+
+/**
+ * @brief Coefficient 2 cos(2π f / fs) of goertzel() (in float, as the kernels use it).
+ *
+ * @param f_Hz   Frequency to detect.
+ * @param fs_Hz  Sample rate.
+ */
+float goertzelCoeff(float f_Hz, float fs_Hz);
+
+/**
+ * @brief RMS current of one frequency component per window (Goertzel).
+ *
+ * With v the sample voltage: s = (v + c·s1) - s2 over the window, then
+ * P = (s1² + s2²) - (c·s1)·s2 and irms = kCal · sqrt(2·P) / win. For a window
+ * spanning whole periods this is the RMS of that component alone, unlike
+ * windowStats() which includes noise and harmonics.
+ *
+ * @param adc    ADC readings.
+ * @param n      Number of readings.
+ * @param win    Readings per window.
+ * @param coeff  goertzelCoeff() of the frequency.
+ * @param scale  Conversion constants.
+ * @param irms   Receives n / win values (A).
+ * @param isa    Instruction set.
+ * @return Number of windows.
+ */
+size_t goertzel(const uint16_t* adc, size_t n, size_t win, float coeff, const SensorScale& scale,
+                float* irms, Isa isa = Isa::Best);
+
+}  // namespace kernels
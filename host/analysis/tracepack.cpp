@@ -0,0 +1,198 @@
+/**
+ * @file tracepack.cpp
+ * @brief Conversion and inspection of binary trace files (.ttr).
+ *
+ * Usage: tracepack [options] TRACE...
+ *   (default)               convert text traces to .ttr, next to the input or
+ *                           into the -o directory
+ *   -o, --out-dir DIR       directory of the converted files
+ *       --window-us US      sensor window used for the window column of
+ *                           converted text traces (default 40000)
+ *       --chunk N           readings per chunk (default 4096)
+ *   -i, --info              print one CSV line per file: readings, duration,
+ *                           size, bits per reading, chunks, windows, axis
+ *                           positions, events and the metadata
+ *   -x, --extract           print a trace as text (the tracereplay format),
+ *                           limited to --from/--to
+ *       --from S, --to S    time range of --extract (s from the start)
+ *
+ * A text trace only holds readings, so its window column is computed from
+ * them like CurrentSensor does (kernels::windowStats() over consecutive
+ * --window-us windows); positions and events stay empty. etchsim
+ * --trace-bin writes all columns directly. Reading a .ttr costs one mmap():
+ * --info and --extract of a range decode only the chunks they touch.
+ */
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <getopt.h>
+#include "TraceFile.h"
+#include "TraceKernels.h"
+#include "TraceReplay.h"
+
+using namespace tracefile;
+
+namespace {
+
+/** @brief Output path: DIR/name.ttr or the input with its extension replaced. */
+std::string outPath(const char* in, const char* dir) {
+  std::string base = in;
+  const size_t slash = base.rfind('/');
+  if (dir) base = std::string(dir) + "/" + (slash == std::string::npos ? base : base.substr(slash + 1));
+  const size_t dot = base.rfind('.');
+  const size_t sep = base.rfind('/');
+  if (dot != std::string::npos && (sep == std::string::npos || dot > sep)) base.erase(dot);
+  return base + ".ttr";
+}
+
+bool convert(const char* in, const char* dir, uint64_t window_us, uint32_t chunk) {
+  Trace tr;
+  if (!loadTrace(in, tr)) return false;
+  const std::string out = outPath(in, dir);
+  TraceWriter w;
+  if (!w.open(out.c_str(), chunk)) return false;
+
+  char buf[32];
+  if (tr.mode) w.meta("mode", std::to_string(tr.mode));
+  if (tr.baseline_A >= 0.0f) {
+    snprintf(buf, sizeof(buf), "%.6f", tr.baseline_A);
+    w.meta("baseline_A", buf);
+  }
+  if (tr.startZ_mm >= 0.0f) {
+    snprintf(buf, sizeof(buf), "%.3f", tr.startZ_mm);
+    w.meta("start_z_mm", buf);
+  }
+  if (tr.contact_us != TRACE_NONE) w.meta("contact_us", std::to_string(tr.contact_us));
+  if (tr.break_us != TRACE_NONE)   w.meta("break_us", std::to_string(tr.break_us));
+
+  for (size_t i = 0; i < tr.t_us.size(); ++i) w.sample(tr.t_us[i], tr.adc[i]);
+
+  // windows as the sensor closes them: the readings of [start, start + window)
+  const kernels::SensorScale scale;
+  const float vPerCount = scale.vref / scale.adcMax;
+  size_t a = 0;
+  for (uint64_t end = tr.t_us.front() + window_us; a < tr.t_us.size(); end += window_us) {
+    const size_t b = (size_t)(std::lower_bound(tr.t_us.begin() + a, tr.t_us.end(), end) - tr.t_us.begin());
+    if (b == tr.t_us.size()) break;   // the last window is incomplete
+    if (b > a) {
+      float irms;
+      uint16_t lo, hi;
+      kernels::WindowOut o;
+      o.irms = &irms;
+      o.min = &lo;
+      o.max = &hi;
+      kernels::windowStats(tr.adc.data() + a, b - a, b - a, scale, o);
+      w.window(end, irms, (hi - lo) * vPerCount, lo, hi);
+    }
+    a = b;
+  }
+  if (!w.close()) return false;
+  fprintf(stderr, "%s -> %s\n", in, out.c_str());
+  return true;
+}
+
+bool info(const char* path) {
+  TraceFile tf;
+  if (!tf.open(path)) return false;
+  const Column<ChunkEntry> chunks = tf.chunks();
+  uint64_t packedBits = 0;
+  for (const ChunkEntry& c : chunks) packedBits += (uint64_t)(c.count - 1) * (c.dtBits + c.dvBits);
+  const double n = (double)tf.samples();
+
+  std::string meta(tf.metaText().begin(), tf.metaText().end());
+  std::replace(meta.begin(), meta.end(), '\n', ' ');
+  if (!meta.empty()) meta.pop_back();
+  printf("%s,%llu,%.3f,%zu,%.2f,%.2f,%zu,%zu,%zu,%zu,%s\n", path, (unsigned long long)tf.samples(),
+         (tf.endUs() - tf.startUs()) * 1e-6, tf.fileSize(), n ? packedBits / n : 0.0,
+         n ? tf.fileSize() * 8.0 / n : 0.0, chunks.size, tf.column<uint64_t>(SEC_WIN_T).size,
+         tf.column<uint64_t>(SEC_STEP_T).size, tf.column<uint64_t>(SEC_EV_T).size, meta.c_str());
+  return true;
+}
+
+bool extract(const char* path, double from_s, double to_s) {
+  TraceFile tf;
+  if (!tf.open(path)) return false;
+  printf("# tiptrace\n");
+  const Column<char> m = tf.metaText();
+  for (size_t i = 0; i < m.size; ++i) {
+    if (i == 0 || m[i - 1] == '\n') fputs("# ", stdout);
+    putchar(m[i]);
+  }
+  printf("t_us,adc\n");
+
+  const uint64_t from = (uint64_t)(from_s * 1e6), to = to_s < 0 ? UINT64_MAX : (uint64_t)(to_s * 1e6);
+  uint64_t i = tf.sampleAt(from), t0;
+  if (tf.read(i, 1, &t0, nullptr) == 1 && t0 < from) ++i;   // sampleAt() returns the reading at or before
+  std::vector<uint64_t> t(CHUNK_SAMPLES);
+  std::vector<uint16_t> adc(CHUNK_SAMPLES);
+  for (;;) {
+    const size_t n = tf.read(i, t.size(), t.data(), adc.data());
+    size_t k = 0;
+    for (; k < n && t[k] <= to; ++k) printf("%llu,%u\n", (unsigned long long)t[k], adc[k]);
+    if (k < n || n == 0) break;
+    i += n;
+  }
+  return true;
+}
+
+void usage(const char* argv0) {
+  fprintf(stderr,
+          "usage: %s [-o dir] [--window-us us] [--chunk n] TRACE...\n"
+          "       %s -i FILE.ttr...\n"
+          "       %s -x [--from s] [--to s] FILE.ttr\n", argv0, argv0, argv0);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const char* outDir = nullptr;
+  uint64_t windowUs = 40000;
+  uint32_t chunk = CHUNK_SAMPLES;
+  bool doInfo = false, doExtract = false;
+  double from = 0.0, to = -1.0;
+
+  static const option longOpts[] = {
+    { "out-dir",   required_argument, nullptr, 'o' },
+    { "window-us", required_argument, nullptr, 1 },
+    { "chunk",     required_argument, nullptr, 2 },
+    { "info",      no_argument,       nullptr, 'i' },
+    { "extract",   no_argument,       nullptr, 'x' },
+    { "from",      required_argument, nullptr, 3 },
+    { "to",        required_argument, nullptr, 4 },
+    { nullptr, 0, nullptr, 0 }
+  };
+  int c;
+  while ((c = getopt_long(argc, argv, "o:ix", longOpts, nullptr)) != -1) {
+    switch (c) {
+      case 'o': outDir = optarg; break;
+      case 1:   windowUs = strtoull(optarg, nullptr, 10); break;
+      case 2:   chunk = (uint32_t)strtoul(optarg, nullptr, 10); break;
+      case 'i': doInfo = true; break;
+      case 'x': doExtract = true; break;
+      case 3:   from = atof(optarg); break;
+      case 4:   to = atof(optarg); break;
+      default:  usage(argv[0]); return 2;
+    }
+  }
+  if (optind >= argc || windowUs == 0 || chunk < 2 || (doInfo && doExtract) ||
+      (doExtract && optind + 1 != argc)) {
+    usage(argv[0]);
+    return 2;
+  }
+
+  if (doExtract) return extract(argv[optind], from, to) ? 0 : 1;
+
+  int failed = 0;
+  if (doInfo) {
+    printf("file,samples,duration_s,bytes,packed_bits_per_sample,file_bits_per_sample,"
+           "chunks,windows,steps,events,meta\n");
+  }
+  for (int i = optind; i < argc; ++i) {
+    const bool ok = doInfo ? info(argv[i]) : convert(argv[i], outDir, windowUs, chunk);
+    if (!ok) ++failed;
+  }
+  return failed ? 1 : 0;
+}
@@ -0,0 +1,54 @@
+#include "FrameCodec.h"
+#include "Crc16.h"
+
+/**
+ * @file FrameCodec.cpp
+ * @brief Host-side framing: COBS, CRC16 and incremental decoding.
+ */
+
+std::vector<uint8_t> encodeFrame(uint8_t type, uint8_t reqId, const uint8_t* body, size_t len) {
+  std::vector<uint8_t> raw;
+  raw.reserve(PROTO_HEADER + len + 2);
+  raw.push_back(PROTO_VERSION);
+  raw.push_back(type);
+  raw.push_back(reqId);
+  raw.insert(raw.end(), body, body + len);
+
+  uint16_t crc = crc16(raw.data(), raw.size());
+  raw.push_back((uint8_t)crc);
+  raw.push_back((uint8_t)(crc >> 8));
+
+  std::vector<uint8_t> enc(cobsMaxEncoded(raw.size()) + 1);
+  size_t n = cobsEncode(raw.data(), raw.size(), enc.data());
+  enc[n++] = 0;
+  enc.resize(n);
+  return enc;
+}
+
+bool FrameDecoder::push(uint8_t b, Frame& out) {
+  if (b != 0) {
+    // longer than any valid frame: keep counting it as one error at the delimiter
+    if (buf_.size() < 1024) buf_.push_back(b);
+    return false;
+  }
+  if (buf_.empty()) return false;
+
+  size_t len = cobsDecode(buf_.data(), buf_.size(), buf_.data());
+  bool ok = len >= PROTO_HEADER + 2u;
+  if (ok) {
+    len -= 2;
+    ok = crc16(buf_.data(), len) == protoGetU16(buf_.data() + len);
+  }
+  if (!ok) {
+    ++errors_;
+    buf_.clear();
+    return false;
+  }
+
+  out.version = buf_[0];
+  out.type    = buf_[1];
+  out.reqId   = buf_[2];
+  out.body.assign(buf_.begin() + PROTO_HEADER, buf_.begin() + len);
+  buf_.clear();
+  return true;
+}
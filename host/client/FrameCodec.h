@@ -0,0 +1,54 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "ProtocolDefs.h"
+
+/**
+ * @brief One decoded protocol frame (see ProtocolDefs.h).
+ */
+struct Frame {
+  uint8_t              version = 0;  ///< Protocol version of the sender.
+  uint8_t              type    = 0;  ///< Message type.
+  uint8_t              reqId   = 0;  ///< Request ID (0 = unsolicited).
+  std::vector<uint8_t> body;         ///< Message body.
+};
+
+/**
+ * @brief Build the wire representation of a frame (COBS + CRC + delimiter).
+ *
+ * @param type   Message type.
+ * @param reqId  Request ID.
+ * @param body   Body bytes.
+ * @param len    Body length.
+ * @return Encoded bytes including the trailing 0x00.
+ */
+std::vector<uint8_t> encodeFrame(uint8_t type, uint8_t reqId, const uint8_t* body, size_t len);
+
+/**
+ * @brief Incremental frame decoder for a byte stream.
+ *
+ * Bytes are fed one at a time (or in blocks); whenever a 0x00 delimiter
+ * completes a valid frame it is returned. Malformed frames are counted and
+ * skipped; the decoder resynchronises on the next delimiter.
+ */
+class FrameDecoder {
+public:
+  /**
+   * @brief Feed one received byte.
+   *
+   * @param b    Byte from the stream.
+   * @param out  Receives the frame when one is complete.
+   * @return true if out holds a new valid frame.
+   */
+  bool push(uint8_t b, Frame& out);
+
+  /** @brief Number of discarded frames (COBS/CRC/length errors). */
+  uint32_t errors() const { return errors_; }
+
+private:
+  /** @brief Encoded bytes of the frame being received. */
+  std::vector<uint8_t> buf_;
+
+  /** @brief Discarded frame counter. */
+  uint32_t errors_ = 0;
+};
@@ -0,0 +1,363 @@
+#include "TipClient.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+
+/**
+ * @file TipClient.cpp
+ * @brief POSIX implementation of the host protocol client.
+ */
+
+namespace {
+
+/**
+ * @brief Map a numeric baud rate to a termios speed constant.
+ *
+ * @param baud Baud rate.
+ * @return Speed constant, or B0 if unsupported.
+ */
+speed_t toSpeed(unsigned baud) {
+  switch (baud) {
+    case 9600:   return B9600;
+    case 19200:  return B19200;
+    case 38400:  return B38400;
+    case 57600:  return B57600;
+    case 115200: return B115200;
+    case 230400: return B230400;
+#ifdef B250000
+    case 250000: return B250000;
+#endif
+#ifdef B500000
+    case 500000: return B500000;
+#endif
+#ifdef B1000000
+    case 1000000: return B1000000;
+#endif
+    default:     return B0;
+  }
+}
+
+}  // namespace
+
+int openSerial(const std::string& device, unsigned baud, std::string& error) {
+  speed_t sp = toSpeed(baud);
+  if (sp == B0) {
+    error = "unsupported baud rate";
+    return -1;
+  }
+
+  int fd = ::open(device.c_str(), O_RDWR | O_NOCTTY | O_NONBLOCK);
+  if (fd < 0) {
+    error = device + ": " + std::strerror(errno);
+    return -1;
+  }
+
+  termios tio{};
+  if (tcgetattr(fd, &tio) == 0) {
+    cfmakeraw(&tio);
+    tio.c_cflag |= CLOCAL | CREAD;
+    tio.c_cflag &= ~CRTSCTS;
+    cfsetispeed(&tio, sp);
+    cfsetospeed(&tio, sp);
+    tcsetattr(fd, TCSANOW, &tio);
+    tcflush(fd, TCIOFLUSH);
+  }
+  return fd;
+}
+
+TipClient::~TipClient() { close(); }
+
+bool TipClient::open(const std::string& device, unsigned baud) {
+  close();
+  int fd = openSerial(device, baud, error_);
+  if (fd < 0) return false;
+  attach(fd);
+  return true;
+}
+
+void TipClient::attach(int fd) {
+  close();
+  fd_ = fd;
+  int fl = fcntl(fd_, F_GETFL);
+  if (fl >= 0) fcntl(fd_, F_SETFL, fl | O_NONBLOCK);
+}
+
+void TipClient::close() {
+  if (fd_ >= 0) ::close(fd_);
+  fd_ = -1;
+  pending_.clear();
+}
+
+bool TipClient::readFrame(Frame& f, int timeoutMs) {
+  if (!pending_.empty()) {
+    f = std::move(pending_.front());
+    pending_.erase(pending_.begin());
+    return true;
+  }
+  if (fd_ < 0) {
+    error_ = "not open";
+    return false;
+  }
+
+  using Clock = std::chrono::steady_clock;
+  auto deadline = Clock::now() + std::chrono::milliseconds(timeoutMs);
+
+  for (;;) {
+    int left = (int)std::chrono::duration_cast<std::chrono::milliseconds>(deadline - Clock::now()).count();
+    if (left < 0) left = 0;
+
+    pollfd pfd{ fd_, POLLIN, 0 };
+    int r = ::poll(&pfd, 1, left);
+    if (r < 0 && errno != EINTR) {
+      error_ = std::strerror(errno);
+      return false;
+    }
+    if (r > 0) {
+      uint8_t buf[256];
+      ssize_t n = ::read(fd_, buf, sizeof(buf));
+      if (n == 0 || (n < 0 && errno != EAGAIN && errno != EINTR)) {
+        error_ = n == 0 ? "device closed" : std::strerror(errno);
+        return false;
+      }
+      Frame tmp;
+      for (ssize_t i = 0; i < n; ++i) {
+        if (dec_.push(buf[i], tmp)) pending_.push_back(std::move(tmp));
+      }
+      if (!pending_.empty()) {
+        f = std::move(pending_.front());
+        pending_.erase(pending_.begin());
+        return true;
+      }
+    }
+    if (Clock::now() >= deadline) {
+      error_ = "timeout";
+      return false;
+    }
+  }
+}
+
+bool TipClient::transact(uint8_t type, const std::vector<uint8_t>& body, Frame& reply) {
+  if (fd_ < 0) {
+    error_ = "not open";
+    return false;
+  }
+
+  if (++reqId_ == 0) reqId_ = 1;
+  std::vector<uint8_t> wire = encodeFrame(type, reqId_, body.data(), body.size());
+
+  size_t off = 0;
+  while (off < wire.size()) {
+    ssize_t n = ::write(fd_, wire.data() + off, wire.size() - off);
+    if (n < 0) {
+      if (errno == EAGAIN || errno == EINTR) {
+        pollfd pfd{ fd_, POLLOUT, 0 };
+        ::poll(&pfd, 1, timeoutMs_);
+        continue;
+      }
+      error_ = std::strerror(errno);
+      return false;
+    }
+    off += (size_t)n;
+  }
+
+  using Clock = std::chrono::steady_clock;
+  auto deadline = Clock::now() + std::chrono::milliseconds(timeoutMs_);
+  for (;;) {
+    int left = (int)std::chrono::duration_cast<std::chrono::milliseconds>(deadline - Clock::now()).count();
+    if (left <= 0 || !readFrame(reply, left)) {
+      error_ = "timeout";
+      return false;
+    }
+    if (reply.reqId == reqId_) return true;
+    if (unsolicited_) unsolicited_(reply);
+  }
+}
+
+bool TipClient::check_(const Frame& f, uint8_t type, size_t minBody) {
+  if (f.type == MSG_NACK) {
+    error_ = "rejected, error " + std::to_string(f.body.size() > 1 ? f.body[1] : 0);
+    return false;
+  }
+  if (f.type != type || f.body.size() < minBody) {
+    error_ = "unexpected reply";
+    return false;
+  }
+  return true;
+}
+
+bool TipClient::expectAck_(uint8_t type, const std::vector<uint8_t>& body) {
+  Frame f;
+  return transact(type, body, f) && check_(f, MSG_ACK, 1);
+}
+
+void TipClient::parseParam_(const Frame& f, TipParam& p) {
+  const uint8_t* b = f.body.data();
+  p.index    = b[PROTO_PARAM_INDEX];
+  p.isInt    = b[PROTO_PARAM_TYPE] != 0;
+  p.decimals = b[PROTO_PARAM_DECIMALS];
+  p.value    = protoGetF32(b + PROTO_PARAM_VALUE);
+  p.minVal   = protoGetF32(b + PROTO_PARAM_MIN);
+  p.maxVal   = protoGetF32(b + PROTO_PARAM_MAX);
+  p.name.assign(reinterpret_cast<const char*>(b + PROTO_PARAM_NAME),
+                strnlen(reinterpret_cast<const char*>(b + PROTO_PARAM_NAME), PROTO_PARAM_SIZE - PROTO_PARAM_NAME));
+}
+
+bool TipClient::ping(uint8_t* protoVersion, uint8_t* paramCount, uint8_t* modeCount) {
+  Frame f;
+  if (!transact(MSG_PING, {}, f) || !check_(f, MSG_PING | MSG_REPLY, 3)) return false;
+  if (protoVersion) *protoVersion = f.body[0];
+  if (paramCount)   *paramCount   = f.body[1];
+  if (modeCount)    *modeCount    = f.body[2];
+  return true;
+}
+
+bool TipClient::status(TipStatus& st) {
+  Frame f;
+  if (!transact(MSG_STATUS, {}, f) || !check_(f, MSG_STATUS | MSG_REPLY, PROTO_STATUS_SIZE)) return false;
+  const uint8_t* b = f.body.data();
+  st.t_ms      = protoGetU32(b + PROTO_STATUS_T_MS);
+  st.running   = b[PROTO_STATUS_RUNNING] != 0;
+  st.mode      = b[PROTO_STATUS_MODE];
+  st.modeId    = b[PROTO_STATUS_MODE_ID];
+  st.sensor    = b[PROTO_STATUS_SENSOR] != 0;
+  st.current_A = protoGetF32(b + PROTO_STATUS_I_A);
+  st.z_mm      = protoGetF32(b + PROTO_STATUS_Z_MM);
+  return true;
+}
+
+bool TipClient::getParam(uint8_t index, TipParam& p) {
+  Frame f;
+  if (!transact(MSG_PARAM_GET, { index }, f) || !check_(f, MSG_PARAM_GET | MSG_REPLY, PROTO_PARAM_SIZE)) return false;
+  parseParam_(f, p);
+  return true;
+}
+
+bool TipClient::setParam(uint8_t index, float value, TipParam* p) {
+  std::vector<uint8_t> body(5);
+  body[0] = index;
+  protoPutF32(body.data() + 1, value);
+
+  Frame f;
+  if (!transact(MSG_PARAM_SET, body, f) || !check_(f, MSG_PARAM_SET | MSG_REPLY, PROTO_PARAM_SIZE)) return false;
+  if (p) parseParam_(f, *p);
+  return true;
+}
+
+bool TipClient::saveParams()            { return expectAck_(MSG_PARAM_SAVE, {}); }
+bool TipClient::startMode(uint8_t index) { return expectAck_(MSG_MODE_START, { index }); }
+bool TipClient::stopMode()              { return expectAck_(MSG_MODE_STOP, {}); }
+
+bool TipClient::setTelemetry(bool enable, uint8_t decimation, TipTelemetryCtrl* st) {
+  Frame f;
+  if (!transact(MSG_TELEM_CTRL, { uint8_t(enable ? 1 : 0), decimation }, f) ||
+      !check_(f, MSG_TELEM_CTRL | MSG_REPLY, PROTO_TCTRL_SIZE)) return false;
+  if (st) {
+    const uint8_t* b = f.body.data();
+    st->enabled    = b[PROTO_TCTRL_ENABLED] != 0;
+    st->decimation = b[PROTO_TCTRL_DECIM];
+    st->drops      = protoGetU16(b + PROTO_TCTRL_DROPS);
+    st->seq        = protoGetU16(b + PROTO_TCTRL_SEQ);
+  }
+  return true;
+}
+
+bool TipClient::readLog(std::vector<TipEvent>& events, uint16_t* lost) {
+  events.clear();
+  uint8_t first = 0;
+  for (;;) {
+    Frame f;
+    if (!transact(MSG_LOG_DUMP, { first }, f) || !check_(f, MSG_LOG_DUMP | MSG_REPLY, PROTO_LOG_ENTRIES)) return false;
+    const uint8_t* b = f.body.data();
+    uint32_t now   = protoGetU32(b + PROTO_LOG_T_MS);
+    uint8_t  count = b[PROTO_LOG_COUNT];
+    size_t   n     = (f.body.size() - PROTO_LOG_ENTRIES) / PROTO_LOG_ENTRY_SIZE;
+    if (lost) *lost = protoGetU16(b + PROTO_LOG_LOST);
+
+    for (size_t i = 0; i < n; ++i) {
+      const uint8_t* e = b + PROTO_LOG_ENTRIES + i * PROTO_LOG_ENTRY_SIZE;
+      uint32_t t24 = e[0] | (uint32_t(e[1]) << 8) | (uint32_t(e[2]) << 16);
+      TipEvent ev;
+      ev.t_ms = now - ((now - t24) & 0xFFFFFFu);
+      ev.id   = e[3];
+      ev.arg  = int16_t(protoGetU16(e + 4));
+      events.push_back(ev);
+    }
+
+    first = uint8_t(b[PROTO_LOG_FIRST] + n);
+    if (n == 0 || first >= count) return true;
+  }
+}
+
+bool TipClient::readRuns(std::vector<TipRun>& runs) {
+  runs.clear();
+  unsigned first = 0, count = 0;
+  do {
+    Frame f;
+    if (!transact(MSG_RUN_READ, { uint8_t(first) }, f) || !check_(f, MSG_RUN_READ | MSG_REPLY, PROTO_RUNS_RECORDS)) return false;
+    const uint8_t* b = f.body.data();
+    count    = b[PROTO_RUNS_COUNT];
+    size_t n = (f.body.size() - PROTO_RUNS_RECORDS) / PROTO_RUN_SIZE;
+
+    for (size_t i = 0; i < n; ++i) {
+      const uint8_t* r = b + PROTO_RUNS_RECORDS + i * PROTO_RUN_SIZE;
+      TipRun run;
+      run.seq           = protoGetU16(r + PROTO_RUN_SEQ);
+      run.modeId        = r[PROTO_RUN_MODE_ID];
+      run.result        = r[PROTO_RUN_RESULT];
+      run.surfaceZ_mm   = protoGetU16(r + PROTO_RUN_SURFACE_Z) / 100.0f;
+      run.plunge_mm     = protoGetU16(r + PROTO_RUN_PLUNGE) / 100.0f;
+      run.etch_s        = protoGetU16(r + PROTO_RUN_ETCH_TIME) / 10.0f;
+      run.endCurrent_mA = protoGetU16(r + PROTO_RUN_END_I) / 100.0f;
+      run.retries       = r[PROTO_RUN_RETRIES];
+      run.pulses        = r[PROTO_RUN_PULSES];
+      runs.push_back(run);
+    }
+    first += PROTO_RUNS_MAX;
+  } while (first < count);
+  return true;
+}
+
+bool TipClient::readProfile(std::vector<TipProbe>& probes, bool clear) {
+  probes.clear();
+  unsigned id = 0, count = 1;
+  do {
+    Frame f;
+    if (!transact(MSG_PROF_DUMP, { uint8_t(id), uint8_t(clear ? 1 : 0) }, f) ||
+        !check_(f, MSG_PROF_DUMP | MSG_REPLY, PROTO_PROF_SIZE)) return false;
+    const uint8_t* b = f.body.data();
+    count = b[PROTO_PROF_PROBES];
+
+    TipProbe p;
+    p.id       = b[PROTO_PROF_PROBE];
+    p.count    = protoGetU16(b + PROTO_PROF_COUNT);
+    p.total_us = protoGetU32(b + PROTO_PROF_TOTAL) * (PROF_TICK_NS / 1000.0);
+    p.max_us   = protoGetU16(b + PROTO_PROF_MAX) * (PROF_TICK_NS / 1000.0);
+    for (unsigned i = 0; i < PROF_HIST_BINS; ++i) p.hist[i] = protoGetU16(b + PROTO_PROF_HIST + 2 * i);
+    probes.push_back(p);
+  } while (++id < count);
+  return true;
+}
+
+bool TipClient::readStepJitter(TipStepJitter& j, bool clear) {
+  Frame f;
+  if (!transact(MSG_STEP_JITTER, { uint8_t(clear ? 1 : 0) }, f) ||
+      !check_(f, MSG_STEP_JITTER | MSG_REPLY, PROTO_JIT_RECENT)) return false;
+  const uint8_t* b = f.body.data();
+  j.intervals = protoGetU32(b + PROTO_JIT_INTERVALS);
+  j.period_us = protoGetU32(b + PROTO_JIT_PERIOD_US);
+  j.mean_us   = protoGetF32(b + PROTO_JIT_MEAN_US);
+  j.sd_us     = protoGetF32(b + PROTO_JIT_SD_US);
+  j.maxDev_us = protoGetU32(b + PROTO_JIT_MAXDEV_US);
+  j.late      = protoGetU32(b + PROTO_JIT_LATE);
+  j.lost      = protoGetU16(b + PROTO_JIT_LOST);
+  size_t n = std::min<size_t>(b[PROTO_JIT_RECENT_N], (f.body.size() - PROTO_JIT_RECENT) / 4);
+  j.recent.clear();
+  for (size_t i = 0; i < n; ++i) j.recent.push_back(protoGetU32(b + PROTO_JIT_RECENT + 4 * i));
+  return true;
+}
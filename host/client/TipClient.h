@@ -0,0 +1,290 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+#include "FrameCodec.h"
+
+/**
+ * @brief Device status as reported by MSG_STATUS.
+ */
+struct TipStatus {
+  uint32_t t_ms    = 0;      ///< Device millis().
+  bool     running = false;  ///< A mode is running.
+  uint8_t  mode    = 0;      ///< Index of the running (or selected) mode.
+  uint8_t  modeId  = 0;      ///< ModeId of that mode.
+  bool     sensor  = false;  ///< Current sensor enabled.
+  float    current_A = 0;    ///< Baseline-corrected RMS current (A).
+  float    z_mm    = 0;      ///< Stepper position (mm).
+};
+
+/**
+ * @brief Parameter description and value as reported by MSG_PARAM_GET/SET.
+ */
+struct TipParam {
+  uint8_t     index    = 0;     ///< Table index.
+  bool        isInt    = false; ///< Integer parameter.
+  uint8_t     decimals = 0;     ///< Decimals shown on the device.
+  float       value    = 0;     ///< Current value.
+  float       minVal   = 0;     ///< Minimum.
+  float       maxVal   = 0;     ///< Maximum.
+  std::string name;             ///< Label.
+};
+
+/**
+ * @brief Telemetry stream state as reported by MSG_TELEM_CTRL.
+ */
+struct TipTelemetryCtrl {
+  bool     enabled    = false;  ///< Device is streaming.
+  uint8_t  decimation = 1;      ///< One record every N sensor windows.
+  uint16_t drops      = 0;      ///< Records dropped on the device since power-on.
+  uint16_t seq        = 0;      ///< Sequence number of the next record.
+};
+
+/**
+ * @brief One entry of the device event log (MSG_LOG_DUMP).
+ */
+struct TipEvent {
+  uint32_t t_ms = 0;  ///< Device millis() of the event (24-bit stamp extended with the reply time).
+  uint8_t  id   = 0;  ///< Event ID (EV_*).
+  int16_t  arg  = 0;  ///< Event argument.
+};
+
+/**
+ * @brief One run of the device run history (MSG_RUN_READ).
+ */
+struct TipRun {
+  uint16_t seq           = 0;  ///< Run number.
+  uint8_t  modeId        = 0;  ///< ModeId (Mod1 / Mod2).
+  uint8_t  result        = 0;  ///< RUN_* result.
+  float    surfaceZ_mm   = 0;  ///< Z at surface detection.
+  float    plunge_mm     = 0;  ///< Plunge depth after the surface.
+  float    etch_s        = 0;  ///< Duration of the 30 V etch.
+  float    endCurrent_mA = 0;  ///< Current at the end of the etch.
+  uint8_t  retries       = 0;  ///< Failed contact validations.
+  uint8_t  pulses        = 0;  ///< 9 V pulses applied.
+};
+
+/**
+ * @brief Loop profiler statistics of one probe (MSG_PROF_DUMP).
+ */
+struct TipProbe {
+  uint8_t  id       = 0;  ///< Probe (PROF_*).
+  uint16_t count    = 0;  ///< Passes.
+  double   total_us = 0;  ///< Sum of the durations (µs).
+  double   max_us   = 0;  ///< Longest pass (µs).
+  uint16_t hist[PROF_HIST_BINS] = {};  ///< log2 histogram (see PROF_HIST_BINS).
+};
+
+/**
+ * @brief Step timing statistics of the device (MSG_STEP_JITTER).
+ */
+struct TipStepJitter {
+  uint32_t intervals = 0;  ///< Step intervals analysed.
+  uint32_t period_us = 0;  ///< Commanded period of the latest step.
+  float    mean_us   = 0;  ///< Mean error against the commanded period (positive = late).
+  float    sd_us     = 0;  ///< Standard deviation of the error.
+  uint32_t maxDev_us = 0;  ///< Largest absolute error.
+  uint32_t late      = 0;  ///< Steps later than 10 % of their period.
+  uint16_t lost      = 0;  ///< Steps not analysed on the device.
+  std::vector<uint32_t> recent;  ///< Latest step intervals, newest first (0 = sequence start).
+};
+
+/**
+ * @brief Open a serial device raw 8N1, non-blocking, with flushed buffers.
+ *
+ * @param device  Path, e.g. "/dev/ttyACM0".
+ * @param baud    Baud rate (must match the firmware).
+ * @param error   Receives the reason on failure.
+ * @return File descriptor, or -1 on failure.
+ */
+int openSerial(const std::string& device, unsigned baud, std::string& error);
+
+/**
+ * @brief Host-side client for the tip etching controller serial protocol.
+ *
+ * Opens the serial device (POSIX termios, raw 8N1) and offers one blocking
+ * call per request type. Each call sends a frame with a fresh request ID and
+ * waits (with timeout) for the reply carrying the same ID. Frames with other
+ * IDs, e.g. unsolicited telemetry, are handed to the optional callback.
+ *
+ * All calls return false on error; lastError() describes the reason.
+ */
+class TipClient {
+public:
+  TipClient() = default;
+  ~TipClient();
+  TipClient(const TipClient&) = delete;
+  TipClient& operator=(const TipClient&) = delete;
+
+  /**
+   * @brief Open and configure a serial device.
+   *
+   * @param device  Path, e.g. "/dev/ttyACM0".
+   * @param baud    Baud rate (must match the firmware).
+   * @return true on success.
+   */
+  bool open(const std::string& device, unsigned baud = 115200);
+
+  /**
+   * @brief Use an already open file descriptor (pty, socket, pipe).
+   *
+   * The client takes ownership and closes it.
+   *
+   * @param fd File descriptor.
+   */
+  void attach(int fd);
+
+  /** @brief Close the device. */
+  void close();
+
+  /** @brief Reply timeout for each request (ms). */
+  void setTimeoutMs(int ms) { timeoutMs_ = ms; }
+
+  /**
+   * @brief Check that the device answers.
+   *
+   * @param protoVersion  Receives the device protocol version.
+   * @param paramCount    Receives the number of parameters.
+   * @param modeCount     Receives the number of modes.
+   */
+  bool ping(uint8_t* protoVersion = nullptr, uint8_t* paramCount = nullptr, uint8_t* modeCount = nullptr);
+
+  /** @brief Read the device status. */
+  bool status(TipStatus& st);
+
+  /** @brief Read a parameter by index. */
+  bool getParam(uint8_t index, TipParam& p);
+
+  /**
+   * @brief Set a parameter; the device clamps it to its range.
+   *
+   * @param index  Parameter index.
+   * @param value  Requested value.
+   * @param p      Optional: receives the stored value and description.
+   */
+  bool setParam(uint8_t index, float value, TipParam* p = nullptr);
+
+  /** @brief Persist the parameters to the device EEPROM. */
+  bool saveParams();
+
+  /** @brief Start a mode (menu index). */
+  bool startMode(uint8_t index);
+
+  /** @brief Stop the running mode. */
+  bool stopMode();
+
+  /**
+   * @brief Start or stop the telemetry stream.
+   *
+   * Records arrive as unsolicited frames; feed them to a TelemetryDecoder.
+   *
+   * @param enable      True to stream.
+   * @param decimation  One record every N sensor windows (>= 1).
+   * @param st          Optional: receives the stream state.
+   */
+  bool setTelemetry(bool enable, uint8_t decimation = 1, TipTelemetryCtrl* st = nullptr);
+
+  /**
+   * @brief Read the whole event log, oldest entry first.
+   *
+   * @param events  Receives the entries.
+   * @param lost    Optional: receives the number of entries overwritten on the device.
+   */
+  bool readLog(std::vector<TipEvent>& events, uint16_t* lost = nullptr);
+
+  /**
+   * @brief Read the run history, oldest run first.
+   *
+   * @param runs  Receives the runs.
+   */
+  bool readRuns(std::vector<TipRun>& runs);
+
+  /**
+   * @brief Read all loop profiler probes (firmware built with LOOP_PROFILE).
+   *
+   * @param probes  Receives the probes, in PROF_* order.
+   * @param clear   Reset each probe on the device after reading it.
+   */
+  bool readProfile(std::vector<TipProbe>& probes, bool clear = false);
+
+  /**
+   * @brief Read the step timing statistics (firmware built with STEP_JITTER).
+   *
+   * @param j      Receives the statistics.
+   * @param clear  Reset the statistics on the device after reading them.
+   */
+  bool readStepJitter(TipStepJitter& j, bool clear = false);
+
+  /**
+   * @brief Send a request and wait for its reply.
+   *
+   * @param type   Request type.
+   * @param body   Request body.
+   * @param reply  Receives the reply frame (MSG_ACK, MSG_NACK or type|MSG_REPLY).
+   * @return false on I/O error or timeout.
+   */
+  bool transact(uint8_t type, const std::vector<uint8_t>& body, Frame& reply);
+
+  /**
+   * @brief Wait for the next frame.
+   *
+   * @param f          Receives the frame.
+   * @param timeoutMs  Maximum wait (ms).
+   * @return false on timeout or I/O error.
+   */
+  bool readFrame(Frame& f, int timeoutMs);
+
+  /** @brief Callback for frames that are not the awaited reply. */
+  void onUnsolicited(std::function<void(const Frame&)> cb) { unsolicited_ = std::move(cb); }
+
+  /** @brief Description of the last error. */
+  const std::string& lastError() const { return error_; }
+
+  /** @brief Frames discarded by the decoder. */
+  uint32_t rxErrors() const { return dec_.errors(); }
+
+private:
+  /**
+   * @brief Run a request that must be answered by MSG_ACK.
+   *
+   * @param type  Request type.
+   * @param body  Request body.
+   */
+  bool expectAck_(uint8_t type, const std::vector<uint8_t>& body);
+
+  /**
+   * @brief Check a reply type and record an error otherwise.
+   *
+   * @param f         Reply frame.
+   * @param type      Expected type.
+   * @param minBody   Minimum body length.
+   */
+  bool check_(const Frame& f, uint8_t type, size_t minBody);
+
+  /**
+   * @brief Decode a parameter reply body.
+   */
+  static void parseParam_(const Frame& f, TipParam& p);
+
+  /** @brief Serial file descriptor, -1 if closed. */
+  int fd_ = -1;
+
+  /** @brief Reply timeout (ms). */
+  int timeoutMs_ = 500;
+
+  /** @brief Last request ID used (never 0). */
+  uint8_t reqId_ = 0;
+
+  /** @brief Incremental frame decoder. */
+  FrameDecoder dec_;
+
+  /** @brief Frames decoded but not consumed yet. */
+  std::vector<Frame> pending_;
+
+  /** @brief Unsolicited frame callback. */
+  std::function<void(const Frame&)> unsolicited_;
+
+  /** @brief Last error text. */
+  std::string error_;
+};
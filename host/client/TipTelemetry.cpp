@@ -0,0 +1,54 @@
+#include "TipTelemetry.h"
+
+/**
+ * @file TipTelemetry.cpp
+ * @brief Reconstruction of the key/delta telemetry stream.
+ */
+
+bool TelemetryDecoder::push(const Frame& f, TelemetrySample& s) {
+  const uint8_t* b = f.body.data();
+  uint16_t seq;
+
+  if (f.type == MSG_TELEM_KEY && f.body.size() >= PROTO_TKEY_SIZE) {
+    seq = protoGetU16(b + PROTO_TKEY_SEQ);
+  } else if (f.type == MSG_TELEM_DELTA && f.body.size() >= PROTO_TDELTA_SIZE) {
+    seq = protoGetU16(b + PROTO_TDELTA_SEQ);
+  } else {
+    return false;
+  }
+
+  if (synced_ && seq != nextSeq_) {
+    lost_ += uint16_t(seq - nextSeq_);
+    valid_ = false;
+  }
+  synced_  = true;
+  nextSeq_ = uint16_t(seq + 1);
+
+  if (f.type == MSG_TELEM_KEY) {
+    last_.t_us   = protoGetU32(b + PROTO_TKEY_T_US);
+    last_.window = protoGetU16(b + PROTO_TKEY_WINDOW);
+    last_.i_uA   = int32_t(protoGetU32(b + PROTO_TKEY_I_UA));
+    last_.vpp_mV = protoGetU16(b + PROTO_TKEY_VPP_MV);
+    last_.steps  = int32_t(protoGetU32(b + PROTO_TKEY_STEPS));
+    last_.modeId = b[PROTO_TKEY_MODE_ID];
+    last_.phase  = b[PROTO_TKEY_PHASE];
+    last_.flags  = b[PROTO_TKEY_FLAGS];
+    last_.key    = true;
+    deviceDrops_ = protoGetU16(b + PROTO_TKEY_DROPS);
+    valid_ = true;
+  } else {
+    if (!valid_) return false;
+    last_.t_us   += uint32_t(protoGetU16(b + PROTO_TDELTA_DT)) * PROTO_TDELTA_T_UNIT_US;
+    last_.window  = uint16_t(last_.window + b[PROTO_TDELTA_DWINDOW]);
+    last_.i_uA   += int16_t(protoGetU16(b + PROTO_TDELTA_DI_UA));
+    last_.vpp_mV  = uint16_t(last_.vpp_mV + int16_t(protoGetU16(b + PROTO_TDELTA_DVPP_MV)));
+    last_.steps  += int16_t(protoGetU16(b + PROTO_TDELTA_DSTEPS));
+    last_.phase   = b[PROTO_TDELTA_PHASE];
+    last_.flags   = b[PROTO_TDELTA_FLAGS];
+    last_.key     = false;
+  }
+
+  last_.seq = seq;
+  s = last_;
+  return true;
+}
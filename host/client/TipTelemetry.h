@@ -0,0 +1,65 @@
+#pragma once
+#include <cstdint>
+#include "FrameCodec.h"
+
+/**
+ * @brief One reconstructed telemetry record (absolute values).
+ */
+struct TelemetrySample {
+  uint16_t seq     = 0;      ///< Record sequence number.
+  uint32_t t_us    = 0;      ///< Sensor window end time (device micros(), 100 µs resolution).
+  uint16_t window  = 0;      ///< Sensor window sequence number.
+  int32_t  i_uA    = 0;      ///< Raw RMS current (µA).
+  uint16_t vpp_mV  = 0;      ///< Peak-to-peak voltage (mV).
+  int32_t  steps   = 0;      ///< Stepper position (steps).
+  uint8_t  modeId  = 0;      ///< ModeId of the running/selected mode.
+  uint8_t  phase   = 0;      ///< Mode phase (IMode::phase()).
+  uint8_t  flags   = 0;      ///< TELEM_* flags.
+  bool     key     = false;  ///< Decoded from a key record.
+};
+
+/**
+ * @brief Rebuilds absolute samples from the key/delta telemetry stream.
+ *
+ * Delta records are applied to the previous record. Until the first key
+ * record, and after a gap in the sequence numbers, deltas cannot be decoded
+ * and are skipped; the device sends a key record after each of its own drops,
+ * so decoding resumes with the next key record.
+ */
+class TelemetryDecoder {
+public:
+  /**
+   * @brief Decode one frame.
+   *
+   * @param f  Frame (MSG_TELEM_KEY or MSG_TELEM_DELTA; other types are ignored).
+   * @param s  Receives the sample.
+   * @return true if s holds a new sample.
+   */
+  bool push(const Frame& f, TelemetrySample& s);
+
+  /** @brief Records missing according to the sequence numbers. */
+  uint32_t lost() const { return lost_; }
+
+  /** @brief Records dropped on the device, as of the last key record. */
+  uint16_t deviceDrops() const { return deviceDrops_; }
+
+  /** @brief Forget the delta base (e.g. after reconnecting). */
+  void reset() { valid_ = false; }
+
+private:
+  /** @brief Last decoded sample (delta base). */
+  TelemetrySample last_;
+
+  /** @brief last_ is a valid base. */
+  bool valid_ = false;
+
+  /** @brief Sequence number expected next (only meaningful while synced_). */
+  uint16_t nextSeq_ = 0;
+
+  /** @brief At least one record has been seen. */
+  bool synced_ = false;
+
+  /** @brief Statistics. */
+  uint32_t lost_ = 0;
+  uint16_t deviceDrops_ = 0;
+};
@@ -0,0 +1,43 @@
+#pragma once
+/**
+ * @file Sketch.h
+ * @brief Entry points of the firmware sketch compiled for the host HAL.
+ *
+ * sketch.cpp compiles TipEtcingControler2.4_doc.ino unchanged, so the globals
+ * (lcd, ctrl, currentSensor, ...) and setup()/loop() are exactly the ones
+ * flashed to the board.
+ */
+
+#include <stdint.h>
+
+class ModeController;
+class RunLog;
+class StepperDriver;
+class CurrentSensor;
+
+/** @name Sketch globals used by the harnesses
+ *  @{ */
+extern ModeController ctrl;
+extern RunLog         runLog;
+extern StepperDriver  stepper;
+extern CurrentSensor  currentSensor;
+extern float          baselineCurrent;
+/** @} */
+
+/** @brief Pin assignment of the sketch (its constexpr constants, for the simulators). */
+struct SketchPins {
+  uint8_t step, dir, en, limit;
+  uint8_t relay1, relay2, sensor, keypad;
+};
+
+/** @brief Pin assignment of the sketch. */
+SketchPins sketchPins();
+
+/** @brief Arduino setup() of the sketch. */
+void setup();
+
+/** @brief Arduino loop() of the sketch. */
+void loop();
+
+/** @brief Bind hal::lcd() to the sketch's LCD bus pins (call before setup()). */
+void sketchAttachLcd();
@@ -0,0 +1,15 @@
+/**
+ * @file sketch.cpp
+ * @brief Translation unit holding the unmodified firmware sketch.
+ */
+#include "TipEtcingControler2.4_doc.ino"
+#include "Sketch.h"
+#include "HostHal.h"
+
+void sketchAttachLcd() {
+  hal::lcd().attach(LCD_RS, LCD_EN, LCD_D4, LCD_D5, LCD_D6, LCD_D7);
+}
+
+SketchPins sketchPins() {
+  return { PIN_STEP, PIN_DIR, PIN_EN, PIN_LIMIT, PIN_RELAY1, PIN_RELAY2, PIN_I_SENSOR, BTN_ADC };
+}
@@ -0,0 +1,153 @@
+#pragma once
+/**
+ * @file Arduino.h
+ * @brief Host stand-in for the Arduino core (AVR flavour) used by projectCode/.
+ *
+ * Provides the subset of the Arduino API the firmware uses, backed by the
+ * simulated board in HostHal.h: a virtual microsecond clock, digital pins,
+ * an ADC, the USB serial port and the EEPROM. Flash attributes (PROGMEM,
+ * F(), pgm_read_*) map to ordinary memory.
+ *
+ * Differences to the real target that matter for timing code:
+ *  - unsigned long is 64 bits wide and the virtual clock never wraps,
+ *  - int is 32 bits wide,
+ *  - time only advances when the simulation says so (see HostHal.h).
+ */
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+/** @brief Defined for firmware code that needs to know it runs on the host HAL. */
+#ifndef HOST_HAL
+#define HOST_HAL 1
+#endif
+
+typedef bool    boolean;
+typedef uint8_t byte;
+
+#define HIGH          0x1
+#define LOW           0x0
+#define INPUT         0x0
+#define OUTPUT        0x1
+#define INPUT_PULLUP  0x2
+
+#define DEC 10
+#define HEX 16
+#define OCT 8
+#define BIN 2
+
+/** @name Analog pins (ATmega328P numbering)
+ *  @{ */
+#define A0 14
+#define A1 15
+#define A2 16
+#define A3 17
+#define A4 18
+#define A5 19
+#define A6 20
+#define A7 21
+#define NUM_DIGITAL_PINS 22
+/** @} */
+
+/** @name Flash access (plain memory on the host)
+ *  @{ */
+#define PROGMEM
+#define PSTR(s) (s)
+class __FlashStringHelper;
+#define F(s) (reinterpret_cast<const __FlashStringHelper*>(PSTR(s)))
+#define pgm_read_byte(p)  (*(const uint8_t*)(p))
+#define pgm_read_word(p)  (*(const uint16_t*)(p))
+#define pgm_read_dword(p) (*(const uint32_t*)(p))
+#define pgm_read_float(p) (*(const float*)(p))
+#define pgm_read_ptr(p)   (*(void* const*)(p))
+#define memcpy_P  memcpy
+#define strlen_P  strlen
+#define strcmp_P  strcmp
+#define strncpy_P strncpy
+/** @} */
+
+/** @name Digital and analog I/O
+ *  @{ */
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t val);
+int  digitalRead(uint8_t pin);
+int  analogRead(uint8_t pin);
+void analogWrite(uint8_t pin, int val);
+/** @} */
+
+/** @name Time (virtual clock)
+ *  @{ */
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+/** @} */
+
+inline void noInterrupts() {}
+inline void interrupts() {}
+
+/**
+ * @brief Arduino Print base class (same formatting as the AVR core).
+ */
+class Print {
+public:
+  virtual ~Print() = default;
+  virtual size_t write(uint8_t b) = 0;
+  virtual size_t write(const uint8_t* buf, size_t n);
+  size_t write(const char* s) { return s ? write((const uint8_t*)s, strlen(s)) : 0; }
+  size_t write(const char* buf, size_t n) { return write((const uint8_t*)buf, n); }
+  virtual int availableForWrite() { return 0; }
+
+  size_t print(const __FlashStringHelper* s);
+  size_t print(const char* s);
+  size_t print(char c);
+  size_t print(unsigned char v, int base = DEC);
+  size_t print(int v, int base = DEC);
+  size_t print(unsigned int v, int base = DEC);
+  size_t print(long v, int base = DEC);
+  size_t print(unsigned long v, int base = DEC);
+  size_t print(double v, int digits = 2);
+
+  size_t println();
+  template <typename T> size_t println(T v) { size_t n = print(v); return n + println(); }
+  template <typename T> size_t println(T v, int f) { size_t n = print(v, f); return n + println(); }
+
+private:
+  size_t printNumber_(unsigned long n, uint8_t base);
+  size_t printFloat_(double v, uint8_t digits);
+};
+
+/**
+ * @brief Arduino Stream base class (input side).
+ */
+class Stream : public Print {
+public:
+  virtual int available() = 0;
+  virtual int read() = 0;
+  virtual int peek() = 0;
+};
+
+/**
+ * @brief Simulated USB serial port (see hal::serial* in HostHal.h).
+ *
+ * The TX side models the AVR core: a 63-byte buffer drained at the
+ * configured baud rate in virtual time; write() on a full buffer advances
+ * the clock until there is room, like the real blocking write.
+ */
+class HardwareSerial : public Stream {
+public:
+  void begin(unsigned long baud);
+  void end() {}
+  size_t write(uint8_t b) override;
+  using Print::write;
+  int availableForWrite() override;
+  int available() override;
+  int read() override;
+  int peek() override;
+  void flush();
+  explicit operator bool() const { return true; }
+};
+
+extern HardwareSerial Serial;
@@ -0,0 +1,18 @@
+#pragma once
+/**
+ * @file EEPROM.h
+ * @brief Host stand-in for the Arduino EEPROM library (1 KB, see hal::eeprom()).
+ */
+#include <Arduino.h>
+
+/**
+ * @brief Byte access to the simulated EEPROM.
+ */
+struct EEPROMClass {
+  uint8_t  read(int addr);
+  void     write(int addr, uint8_t v);
+  void     update(int addr, uint8_t v) { if (read(addr) != v) write(addr, v); }
+  uint16_t length() { return 1024; }
+};
+
+extern EEPROMClass EEPROM;
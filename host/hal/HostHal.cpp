@@ -0,0 +1,368 @@
+#include "HostHal.h"
+#include <Arduino.h>
+#include <EEPROM.h>
+#include <deque>
+
+/**
+ * @file HostHal.cpp
+ * @brief Simulated board behind the host Arduino.h / EEPROM.h.
+ */
+
+namespace {
+
+constexpr int ADC_IDLE_KEYPAD = 1023;   ///< Resistor ladder reading with no key pressed.
+constexpr int SERIAL_TX_BUF   = 63;     ///< AVR core: SERIAL_TX_BUFFER_SIZE - 1 usable bytes.
+
+/** @brief Complete state of the simulated board. */
+struct Board {
+  uint64_t t_us = 0;
+  uint32_t callCost_us = 1;
+  uint8_t  cycleFrac = 0;          ///< Charged cycles not yet making up a full µs.
+  uint64_t cycles = 0;             ///< Total cycles charged by the cost model.
+  hal::CostModel cost;
+
+  uint8_t level[NUM_DIGITAL_PINS] = {};
+  uint8_t mode[NUM_DIGITAL_PINS]  = {};
+  uint8_t input[NUM_DIGITAL_PINS] = {};
+  bool    inputSet[NUM_DIGITAL_PINS] = {};
+  int     pwm[NUM_DIGITAL_PINS] = {};
+  int     adc[NUM_DIGITAL_PINS] = {};
+  uint64_t adcPinReads[NUM_DIGITAL_PINS] = {};
+  hal::PinHook   pinHook;
+  hal::AdcSource adcSource;
+  uint64_t adcReads = 0;
+
+  unsigned long   baud = 0;
+  std::deque<uint8_t> rx;
+  std::deque<uint8_t> txBuf;      ///< Bytes still in the UART buffer.
+  std::vector<uint8_t> txOut;     ///< Bytes already on the wire.
+  uint64_t txDrained_us = 0;      ///< Virtual time up to which the TX buffer was drained.
+
+  std::vector<uint8_t> eeprom = std::vector<uint8_t>(1024, 0xFF);
+  uint64_t eepromWrites = 0;
+
+  LcdModel lcd;
+
+  Board() { adc[A0] = ADC_IDLE_KEYPAD; }
+};
+
+Board& board() {
+  static Board b;
+  return b;
+}
+
+/** @brief Move the bytes the UART has shifted out by now from txBuf to txOut. */
+void drainTx_() {
+  Board& b = board();
+  if (b.baud == 0 || b.txBuf.empty()) { b.txDrained_us = b.t_us; return; }
+  const uint64_t byteUs = (10ULL * 1000000ULL + b.baud - 1) / b.baud;
+  while (!b.txBuf.empty() && b.txDrained_us + byteUs <= b.t_us) {
+    b.txOut.push_back(b.txBuf.front());
+    b.txBuf.pop_front();
+    b.txDrained_us += byteUs;
+  }
+  if (b.txBuf.empty()) b.txDrained_us = b.t_us;
+}
+
+bool validPin_(uint8_t pin) { return pin < NUM_DIGITAL_PINS; }
+
+/** @brief Advance the clock by an AVR execution cost, if the cost model is on. */
+void charge_(uint32_t cycles) {
+  Board& b = board();
+  if (!b.cost.enabled || cycles == 0) return;
+  b.cycles += cycles;
+  uint32_t total = b.cycleFrac + cycles;
+  b.t_us += total / hal::AVR_CYCLES_PER_US;
+  b.cycleFrac = (uint8_t)(total % hal::AVR_CYCLES_PER_US);
+}
+
+/** @brief Set a pin level and notify the LCD model and the pin hook. */
+void writePin_(uint8_t pin, uint8_t val) {
+  if (!validPin_(pin)) return;
+  Board& b = board();
+  b.level[pin] = val ? HIGH : LOW;
+  b.lcd.pinChanged(pin, b.level[pin], b.t_us);
+  if (b.pinHook) b.pinHook(pin, b.level[pin], b.t_us);
+}
+
+}  // namespace
+
+// ---------------------------------------------------------------------------
+// hal:: control interface
+// ---------------------------------------------------------------------------
+
+namespace hal {
+
+void reset() { board() = Board(); }
+
+uint64_t nowUs() { return board().t_us; }
+void advanceUs(uint64_t us) { board().t_us += us; }
+void setCallCostUs(uint32_t us) { board().callCost_us = us; }
+uint32_t callCostUs() { return board().callCost_us; }
+
+void setCostModel(const CostModel& m) { board().cost = m; }
+const CostModel& costModel() { return board().cost; }
+void chargeCycles(uint32_t cycles) { charge_(cycles); }
+uint64_t cycles() { return board().cycles; }
+
+void fastPinWrite(uint8_t pin, uint8_t level) {
+  charge_(board().cost.fastPinWrite);
+  writePin_(pin, level);
+}
+
+void onPinWrite(PinHook hook) { board().pinHook = std::move(hook); }
+uint8_t pinLevel(uint8_t pin) { return validPin_(pin) ? board().level[pin] : LOW; }
+uint8_t pinModeOf(uint8_t pin) { return validPin_(pin) ? board().mode[pin] : INPUT; }
+int pwmValue(uint8_t pin) { return validPin_(pin) ? board().pwm[pin] : 0; }
+
+void setInput(uint8_t pin, uint8_t level) {
+  if (!validPin_(pin)) return;
+  board().input[pin] = level ? HIGH : LOW;
+  board().inputSet[pin] = true;
+}
+
+void setAnalog(uint8_t pin, int value) {
+  if (validPin_(pin)) board().adc[pin] = value;
+}
+int analogValue(uint8_t pin) { return validPin_(pin) ? board().adc[pin] : 0; }
+void setAdcSource(AdcSource src) { board().adcSource = std::move(src); }
+AdcSource adcSource() { return board().adcSource; }
+uint64_t adcReads() { return board().adcReads; }
+uint64_t adcReads(uint8_t pin) { return validPin_(pin) ? board().adcPinReads[pin] : 0; }
+
+void serialInject(const std::vector<uint8_t>& bytes) {
+  board().rx.insert(board().rx.end(), bytes.begin(), bytes.end());
+}
+
+std::vector<uint8_t> serialTake() {
+  drainTx_();
+  std::vector<uint8_t> out;
+  out.swap(board().txOut);
+  return out;
+}
+
+unsigned long serialBaud() { return board().baud; }
+
+std::vector<uint8_t>& eeprom() { return board().eeprom; }
+uint64_t eepromWrites() { return board().eepromWrites; }
+
+LcdModel& lcd() { return board().lcd; }
+
+}  // namespace hal
+
+// ---------------------------------------------------------------------------
+// Arduino core
+// ---------------------------------------------------------------------------
+
+void pinMode(uint8_t pin, uint8_t mode) {
+  charge_(board().cost.pinMode);
+  if (!validPin_(pin)) return;
+  board().mode[pin] = mode;
+}
+
+void digitalWrite(uint8_t pin, uint8_t val) {
+  charge_(board().cost.digitalWrite);
+  writePin_(pin, val);
+}
+
+int digitalRead(uint8_t pin) {
+  charge_(board().cost.digitalRead);
+  if (!validPin_(pin)) return LOW;
+  Board& b = board();
+  if (b.mode[pin] == OUTPUT) return b.level[pin];
+  if (b.inputSet[pin]) return b.input[pin];
+  return b.mode[pin] == INPUT_PULLUP ? HIGH : LOW;
+}
+
+int analogRead(uint8_t pin) {
+  Board& b = board();
+  charge_(b.cost.analogRead);   // the conversion is waited for: sample taken at its end
+  ++b.adcReads;
+  if (validPin_(pin)) ++b.adcPinReads[pin];
+  if (b.adcSource) return b.adcSource(pin, b.t_us);
+  return validPin_(pin) ? b.adc[pin] : 0;
+}
+
+void analogWrite(uint8_t pin, int val) {
+  charge_(board().cost.analogWrite);
+  if (!validPin_(pin)) return;
+  board().pwm[pin] = val;
+  board().mode[pin] = OUTPUT;
+}
+
+unsigned long micros() {
+  Board& b = board();
+  if (b.cost.enabled) charge_(b.cost.micros);
+  else                b.t_us += b.callCost_us;
+  return (unsigned long)b.t_us;
+}
+
+unsigned long millis() {
+  Board& b = board();
+  if (b.cost.enabled) charge_(b.cost.millis);
+  else                b.t_us += b.callCost_us;
+  return (unsigned long)(b.t_us / 1000);
+}
+
+void delay(unsigned long ms) { board().t_us += (uint64_t)ms * 1000; }
+void delayMicroseconds(unsigned int us) { board().t_us += us; }
+
+// ---------------------------------------------------------------------------
+// Print (same output as the AVR core)
+// ---------------------------------------------------------------------------
+
+size_t Print::write(const uint8_t* buf, size_t n) {
+  size_t done = 0;
+  while (n--) {
+    if (!write(*buf++)) break;
+    ++done;
+  }
+  return done;
+}
+
+size_t Print::print(const __FlashStringHelper* s) { return print(reinterpret_cast<const char*>(s)); }
+size_t Print::print(const char* s) { return write(s); }
+size_t Print::print(char c) { return write((uint8_t)c); }
+size_t Print::print(unsigned char v, int base) { return print((unsigned long)v, base); }
+size_t Print::print(int v, int base) { return print((long)v, base); }
+size_t Print::print(unsigned int v, int base) { return print((unsigned long)v, base); }
+
+size_t Print::print(long v, int base) {
+  if (base == 0) return write((uint8_t)v);
+  if (base == 10 && v < 0) {
+    size_t n = print('-');
+    return n + printNumber_((unsigned long)0 - (unsigned long)v, 10);
+  }
+  return printNumber_((unsigned long)v, (uint8_t)base);
+}
+
+size_t Print::print(unsigned long v, int base) {
+  if (base == 0) return write((uint8_t)v);
+  return printNumber_(v, (uint8_t)base);
+}
+
+size_t Print::print(double v, int digits) { return printFloat_(v, (uint8_t)digits); }
+
+size_t Print::println() { return write("\r\n"); }
+
+size_t Print::printNumber_(unsigned long n, uint8_t base) {
+  char buf[8 * sizeof(long) + 1];
+  char* str = &buf[sizeof(buf) - 1];
+  *str = '\0';
+  if (base < 2) base = 10;
+  do {
+    charge_(board().cost.printDigit);
+    char c = (char)(n % base);
+    n /= base;
+    *--str = c < 10 ? c + '0' : c + 'A' - 10;
+  } while (n);
+  return write(str);
+}
+
+size_t Print::printFloat_(double number, uint8_t digits) {
+  if (isnan(number)) return print("nan");
+  if (isinf(number)) return print("inf");
+  if (number > 4294967040.0) return print("ovf");
+  if (number < -4294967040.0) return print("ovf");
+
+  size_t n = 0;
+  if (number < 0.0) {
+    n += print('-');
+    number = -number;
+  }
+
+  charge_(board().cost.printFloat + (uint32_t)digits * board().cost.printFloatDigit);
+
+  double rounding = 0.5;
+  for (uint8_t i = 0; i < digits; ++i) rounding /= 10.0;
+  number += rounding;
+
+  unsigned long intPart = (unsigned long)number;
+  double remainder = number - (double)intPart;
+  n += print(intPart);
+
+  if (digits > 0) n += print('.');
+  while (digits-- > 0) {
+    remainder *= 10.0;
+    unsigned int toPrint = (unsigned int)remainder;
+    n += print(toPrint);
+    remainder -= toPrint;
+  }
+  return n;
+}
+
+// ---------------------------------------------------------------------------
+// Serial
+// ---------------------------------------------------------------------------
+
+HardwareSerial Serial;
+
+void HardwareSerial::begin(unsigned long baud) {
+  board().baud = baud;
+  board().txDrained_us = board().t_us;
+}
+
+size_t HardwareSerial::write(uint8_t c) {
+  Board& b = board();
+  charge_(b.cost.serialWrite);
+  drainTx_();
+  while ((int)b.txBuf.size() >= SERIAL_TX_BUF && b.baud) {
+    // the AVR core spins until the UART has made room; so does the clock
+    b.t_us += 1;
+    drainTx_();
+  }
+  b.txBuf.push_back(c);
+  return 1;
+}
+
+int HardwareSerial::availableForWrite() {
+  charge_(board().cost.serialPoll);
+  drainTx_();
+  return SERIAL_TX_BUF - (int)board().txBuf.size();
+}
+
+int HardwareSerial::available() {
+  charge_(board().cost.serialPoll);
+  return (int)board().rx.size();
+}
+
+int HardwareSerial::read() {
+  Board& b = board();
+  charge_(b.cost.serialPoll);
+  if (b.rx.empty()) return -1;
+  int c = b.rx.front();
+  b.rx.pop_front();
+  return c;
+}
+
+int HardwareSerial::peek() {
+  return board().rx.empty() ? -1 : board().rx.front();
+}
+
+void HardwareSerial::flush() {
+  Board& b = board();
+  while (!b.txBuf.empty() && b.baud) {
+    b.t_us += 1;
+    drainTx_();
+  }
+}
+
+// ---------------------------------------------------------------------------
+// EEPROM
+// ---------------------------------------------------------------------------
+
+EEPROMClass EEPROM;
+
+uint8_t EEPROMClass::read(int addr) {
+  charge_(board().cost.eepromRead);
+  auto& m = board().eeprom;
+  return (addr >= 0 && (size_t)addr < m.size()) ? m[addr] : 0xFF;
+}
+
+void EEPROMClass::write(int addr, uint8_t v) {
+  charge_(board().cost.eepromWrite);
+  auto& m = board().eeprom;
+  if (addr < 0 || (size_t)addr >= m.size()) return;
+  m[addr] = v;
+  ++board().eepromWrites;
+}
@@ -0,0 +1,159 @@
+#pragma once
+/**
+ * @file HostHal.h
+ * @brief Control side of the simulated board behind the host Arduino.h.
+ *
+ * The firmware sees Arduino.h; a test harness or simulator drives the board
+ * through the functions here:
+ *  - clock:  virtual microseconds, advanced explicitly (advanceUs()) and by
+ *            delay()/delayMicroseconds(); every micros()/millis() call also
+ *            advances it by callCostUs() so that busy-wait loops terminate,
+ *            or, with the cost model on, every call by its AVR cost,
+ *  - pins:   levels and modes of all digital pins, input levels set by the
+ *            harness, a hook observing every digitalWrite(),
+ *  - ADC:    a per-pin value or a callback computing the reading,
+ *  - serial: bytes injected into RX, bytes drained from TX,
+ *  - EEPROM: 1 KB of memory, erased to 0xFF,
+ *  - LCD:    an HD44780 model decoding the 4-bit bus (LcdModel.h).
+ *
+ * All state is global, like the hardware it stands for; reset() restores
+ * power-on state.
+ */
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+#include "LcdModel.h"
+
+namespace hal {
+
+/**
+ * @brief Restore power-on state (clock 0, pins, ADC, serial, EEPROM erased, LCD).
+ *
+ * Global constructors of the sketch (e.g. StepperDriver) configure pins
+ * before main() runs and are not repeated; harnesses running the sketch
+ * start from the initial state instead of calling reset().
+ */
+void reset();
+
+/** @name Clock
+ *  @{ */
+/** @brief Current virtual time (µs). */
+uint64_t nowUs();
+/** @brief Advance the virtual time. */
+void advanceUs(uint64_t us);
+/** @brief Time added by every micros()/millis() call (µs, default 1). */
+void setCallCostUs(uint32_t us);
+/** @brief Current per-call cost. */
+uint32_t callCostUs();
+/** @} */
+
+/** @name AVR cost model
+ *  @{ */
+/** @brief CPU clock of the target (ATmega328P at 16 MHz). */
+constexpr uint32_t AVR_CYCLES_PER_US = 16;
+
+/**
+ * @brief Execution costs of the Arduino core on the ATmega328P (CPU cycles).
+ *
+ * When enabled, every HAL call advances the virtual clock by its cost, and
+ * the firmware's SIM_CYCLES() annotations (SimCycles.h) charge the float and
+ * bookkeeping work of the hot paths, so loop time, sample rate and step
+ * timing come out close to the real board. Values are for the stock AVR core
+ * built with avr-gcc -Os; the annotations in the firmware are estimates from
+ * the libgcc soft-float routines (fadd ~110, fmul ~150, fdiv ~480 cycles).
+ *
+ * When disabled (default), micros()/millis() advance the clock by
+ * callCostUs() and all other calls are free.
+ */
+struct CostModel {
+  bool     enabled         = false;
+  uint16_t digitalWrite    = 56;    ///< Port/bit lookup, PWM check, SREG save.
+  uint16_t digitalRead     = 52;
+  uint16_t pinMode         = 64;
+  uint16_t analogWrite     = 90;
+  uint16_t analogRead      = 1800;  ///< 13 ADC clocks at prescaler 128, plus setup (~112 µs).
+  uint16_t micros          = 56;
+  uint16_t millis          = 36;
+  uint16_t fastPinWrite    = 8;     ///< FastPin: read-modify-write of PORTx with cli/sei.
+  uint16_t serialWrite     = 72;    ///< HardwareSerial::write() into a non-full buffer.
+  uint16_t serialPoll      = 24;    ///< available(), availableForWrite(), read().
+  uint16_t eepromRead      = 24;
+  uint16_t eepromWrite     = 32;    ///< Starting a write; the 3.4 ms cycle is not modelled.
+  uint16_t printDigit      = 620;   ///< One digit of Print::print(long): 32-bit divmod.
+  uint16_t printFloat      = 400;   ///< Print::print(double) rounding and split.
+  uint16_t printFloatDigit = 420;   ///< Per decimal: fmul, conversion, fsub.
+  uint16_t loopOverhead    = 200;   ///< Calls and returns of one loop() pass (charged by harnesses).
+};
+
+/** @brief Install a cost model (enabled = true turns cycle charging on). */
+void setCostModel(const CostModel& m);
+/** @brief Cost model in use. */
+const CostModel& costModel();
+/** @brief Advance the clock by a number of AVR cycles (no-op with the model off). */
+void chargeCycles(uint32_t cycles);
+/** @brief Total cycles charged since reset(). */
+uint64_t cycles();
+/** @brief Pin write as done by FastPin on the AVR (costs fastPinWrite). */
+void fastPinWrite(uint8_t pin, uint8_t level);
+/** @} */
+
+/** @name Pins
+ *  @{ */
+/** @brief Observer of digitalWrite(): pin, new level, virtual time. */
+using PinHook = std::function<void(uint8_t pin, uint8_t level, uint64_t t_us)>;
+/** @brief Install (or clear) the digitalWrite() observer. */
+void onPinWrite(PinHook hook);
+/** @brief Level of a pin as last written or set. */
+uint8_t pinLevel(uint8_t pin);
+/** @brief Mode set by pinMode(). */
+uint8_t pinModeOf(uint8_t pin);
+/** @brief Drive an input pin from outside (e.g. the homing limit switch). */
+void setInput(uint8_t pin, uint8_t level);
+/** @brief Last analogWrite() value of a pin. */
+int pwmValue(uint8_t pin);
+/** @} */
+
+/** @name ADC
+ *  @{ */
+/** @brief ADC callback: pin, virtual time → 10-bit reading. */
+using AdcSource = std::function<int(uint8_t pin, uint64_t t_us)>;
+/** @brief Set a constant reading for a pin (default 0; A0 idles at 1023 = no key). */
+void setAnalog(uint8_t pin, int value);
+/** @brief Constant reading set by setAnalog() (for ADC callbacks handling only some pins). */
+int analogValue(uint8_t pin);
+/** @brief Compute readings with a callback instead (clears with nullptr). */
+void setAdcSource(AdcSource src);
+/** @brief Callback installed by setAdcSource() (empty if none), e.g. to wrap it. */
+AdcSource adcSource();
+/** @brief Number of analogRead() calls since reset(). */
+uint64_t adcReads();
+/** @brief Number of analogRead() calls of one pin since reset(). */
+uint64_t adcReads(uint8_t pin);
+/** @} */
+
+/** @name Serial
+ *  @{ */
+/** @brief Queue bytes for the firmware to receive. */
+void serialInject(const std::vector<uint8_t>& bytes);
+/** @brief Take the bytes the UART has shifted out so far. */
+std::vector<uint8_t> serialTake();
+/** @brief Baud rate passed to Serial.begin() (0 before). */
+unsigned long serialBaud();
+/** @} */
+
+/** @name EEPROM
+ *  @{ */
+/** @brief The 1 KB EEPROM contents. */
+std::vector<uint8_t>& eeprom();
+/** @brief Number of EEPROM byte writes since reset(). */
+uint64_t eepromWrites();
+/** @} */
+
+/** @name LCD
+ *  @{ */
+/** @brief The LCD model; attach it to the bus pins before setup(). */
+LcdModel& lcd();
+/** @} */
+
+}  // namespace hal
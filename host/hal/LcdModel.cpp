@@ -0,0 +1,101 @@
+#include "LcdModel.h"
+#include <cstring>
+
+/**
+ * @file LcdModel.cpp
+ * @brief HD44780 bus decoder and DDRAM model.
+ */
+
+void LcdModel::attach(uint8_t rs, uint8_t en, uint8_t d4, uint8_t d5, uint8_t d6, uint8_t d7) {
+  reset();
+  rs_ = rs; en_ = en;
+  d_[0] = d4; d_[1] = d5; d_[2] = d6; d_[3] = d7;
+}
+
+void LcdModel::reset() {
+  rs_ = en_ = 0xFF;
+  for (uint8_t& p : d_) p = 0xFF;
+  memset(level_, 0, sizeof(level_));
+  memset(ddram_, ' ', sizeof(ddram_));
+  memset(cgram_, 0, sizeof(cgram_));
+  fourBit_ = haveHigh_ = toCgram_ = displayOn_ = false;
+  increment_ = true;
+  high_ = init8_ = addr_ = 0;
+  bytes_ = lastUs_ = 0;
+}
+
+void LcdModel::pinChanged(uint8_t pin, uint8_t level, uint64_t t_us) {
+  if (en_ == 0xFF || pin >= sizeof(level_)) return;
+  bool falling = (pin == en_ && level_[pin] && !level);
+  level_[pin] = level;
+  if (!falling) return;
+
+  uint8_t n = 0;
+  for (uint8_t i = 0; i < 4; ++i) {
+    if (level_[d_[i]]) n |= (uint8_t)(1u << i);
+  }
+  bool rs = level_[rs_] != 0;
+  lastUs_ = t_us;
+
+  if (!fourBit_) {
+    // 8-bit interface: D4..D7 carry the upper half of a complete instruction
+    ++init8_;
+    if (!rs && n == 0x2) fourBit_ = true;
+    return;
+  }
+  if (!haveHigh_) {
+    high_ = n;
+    haveHigh_ = true;
+    return;
+  }
+  haveHigh_ = false;
+  byte_((uint8_t)((high_ << 4) | n), rs);
+}
+
+void LcdModel::byte_(uint8_t v, bool rs) {
+  ++bytes_;
+  if (rs) {
+    if (toCgram_) {
+      cgram_[addr_ & 0x3F] = v;
+      addr_ = (uint8_t)((addr_ + (increment_ ? 1 : -1)) & 0x3F);
+    } else {
+      ddram_[addr_ & 0x7F] = v;
+      addr_ = (uint8_t)((addr_ + (increment_ ? 1 : -1)) & 0x7F);
+    }
+    return;
+  }
+
+  if (v & 0x80) {                 // set DDRAM address
+    addr_ = v & 0x7F;
+    toCgram_ = false;
+  } else if (v & 0x40) {          // set CGRAM address
+    addr_ = v & 0x3F;
+    toCgram_ = true;
+  } else if (v & 0x20) {          // function set
+    if (!(v & 0x10)) fourBit_ = true;
+  } else if (v & 0x10) {          // cursor/display shift: not used by the firmware
+  } else if (v & 0x08) {          // display control
+    displayOn_ = (v & 0x04) != 0;
+  } else if (v & 0x04) {          // entry mode
+    increment_ = (v & 0x02) != 0;
+  } else if (v & 0x02) {          // return home
+    addr_ = 0;
+    toCgram_ = false;
+  } else if (v & 0x01) {          // clear display
+    memset(ddram_, ' ', sizeof(ddram_));
+    addr_ = 0;
+    toCgram_ = false;
+    increment_ = true;
+  }
+}
+
+std::string LcdModel::line(uint8_t row, bool raw) const {
+  std::string s;
+  const uint8_t base = row ? 0x40 : 0x00;
+  for (uint8_t i = 0; i < 16; ++i) {
+    uint8_t c = ddram_[base + i];
+    if (!raw && c < 8) c = (uint8_t)('0' + c);
+    s.push_back((char)c);
+  }
+  return s;
+}
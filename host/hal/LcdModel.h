@@ -0,0 +1,75 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+/**
+ * @brief Behavioural model of an HD44780 16x2 display on a 4-bit bus.
+ *
+ * The model watches the bus pins through the HAL pin hook: on every falling
+ * edge of EN it latches D4..D7 as one nibble, pairs nibbles to bytes (after
+ * the 8-bit → 4-bit init sequence) and executes them as instructions
+ * (RS low) or DDRAM/CGRAM data (RS high). Only the instructions the firmware
+ * uses are modelled: clear, home, entry mode, display control, function set,
+ * CGRAM and DDRAM address.
+ */
+class LcdModel {
+public:
+  LcdModel() { reset(); }
+
+  /**
+   * @brief Bind the model to the bus pins.
+   *
+   * @param rs  Register select pin.
+   * @param en  Enable pin.
+   * @param d4  Data pins D4..D7.
+   */
+  void attach(uint8_t rs, uint8_t en, uint8_t d4, uint8_t d5, uint8_t d6, uint8_t d7);
+
+  /** @brief Return to power-on state (detached, blank). */
+  void reset();
+
+  /**
+   * @brief Feed a pin change (called by the HAL for every digitalWrite()).
+   *
+   * @param pin    Pin number.
+   * @param level  New level.
+   * @param t_us   Virtual time.
+   */
+  void pinChanged(uint8_t pin, uint8_t level, uint64_t t_us);
+
+  /**
+   * @brief Visible text of a line; CGRAM characters (0..7) appear as '0'..'7'
+   *        when raw is false.
+   *
+   * @param row  0 or 1.
+   * @param raw  Return the character codes unchanged.
+   */
+  std::string line(uint8_t row, bool raw = false) const;
+
+  /** @brief Display on (instruction 0x08 | 0x04). */
+  bool displayOn() const { return displayOn_; }
+
+  /** @brief Bytes received (instructions + data). */
+  uint64_t bytes() const { return bytes_; }
+
+  /** @brief Time of the last byte (µs). */
+  uint64_t lastByteUs() const { return lastUs_; }
+
+private:
+  /** @brief Execute a complete byte. */
+  void byte_(uint8_t v, bool rs);
+
+  uint8_t  rs_ = 0xFF, en_ = 0xFF, d_[4] = { 0xFF, 0xFF, 0xFF, 0xFF };
+  uint8_t  level_[32] = {};
+  bool     fourBit_ = false;     ///< Function set to 4-bit seen.
+  bool     haveHigh_ = false;    ///< High nibble latched, waiting for the low one.
+  uint8_t  high_ = 0;
+  uint8_t  init8_ = 0;           ///< 8-bit-mode nibbles seen before 4-bit mode.
+  uint8_t  ddram_[0x80];         ///< Display data RAM.
+  uint8_t  cgram_[64] = {};      ///< Character generator RAM.
+  uint8_t  addr_ = 0;            ///< Address counter.
+  bool     toCgram_ = false;     ///< Data goes to CGRAM.
+  bool     increment_ = true;    ///< Entry mode I/D.
+  bool     displayOn_ = false;
+  uint64_t bytes_ = 0, lastUs_ = 0;
+};
@@ -0,0 +1,155 @@
+#include "EtchCell.h"
+#include <Arduino.h>
+#include <cmath>
+#include "HostHal.h"
+
+/**
+ * @file EtchCell.cpp
+ * @brief Implementation of the etching cell plant model.
+ */
+
+namespace {
+constexpr uint32_t CHATTER_US = 250;     ///< Half period of the relay contact chatter.
+constexpr float    PICKUP_PHASE = 0.3f;  ///< Phase of the pickup against the cell current (rad).
+}
+
+EtchCell::EtchCell(const Config& cfg)
+  : cfg_(cfg), rng_(cfg.seed) {
+  steps_ = lroundf(cfg_.startZ_mm * cfg_.stepsPerMm);
+  newTip();
+}
+
+void EtchCell::attach(const Pins& pins) {
+  pins_ = pins;
+  lastUs_ = hal::nowUs();
+  stepLevel_ = hal::pinLevel(pins_.step);
+  vSteady_ = vOld_ = relayVoltage_();
+
+  hal::onPinWrite([this](uint8_t pin, uint8_t level, uint64_t t) { pinWrite_(pin, level, t); });
+  hal::setAdcSource([this](uint8_t pin, uint64_t t) {
+    return pin == pins_.sensor ? sample_(t) : hal::analogValue(pin);
+  });
+  moved_(lastUs_);
+}
+
+void EtchCell::newTip() {
+  std::uniform_real_distribution<float> u(-1.0f, 1.0f);
+  surface_mm_    = cfg_.surface_mm + cfg_.surfaceJitter_mm * u(rng_);
+  breakCharge_C_ = cfg_.breakCharge_C * (1.0f + cfg_.breakJitter * u(rng_));
+  neck_    = 1.0f;
+  broken_  = false;
+  wetted_  = false;
+  lost_mm_ = 0.0f;
+  contactUs_ = breakUs_ = cutoffUs_ = 0;
+  qAfterBreak_ = 0.0f;
+  lostSteps_ = 0;
+  moved_(hal::nowUs());
+}
+
+void EtchCell::setIdleVoltage(float v) {
+  advance_(hal::nowUs());
+  cfg_.idleVoltage_V = v;
+  vSteady_ = relayVoltage_();
+}
+
+float EtchCell::relayVoltage_() const {
+  auto energized = [](uint8_t pin) {
+    return hal::pinModeOf(pin) == OUTPUT && hal::pinLevel(pin) == LOW;
+  };
+  if (energized(pins_.relay2)) return cfg_.relay30_V;
+  if (energized(pins_.relay1)) return cfg_.relay9_V;
+  return cfg_.idleVoltage_V;
+}
+
+float EtchCell::voltageAt_(uint64_t t_us) const {
+  uint64_t since = t_us - relayChangeUs_;
+  if (relayChangeUs_ != 0 && since < cfg_.bounce_us && ((since / CHATTER_US) & 1)) {
+    return vOld_;
+  }
+  return vSteady_;
+}
+
+float EtchCell::voltage() const { return voltageAt_(hal::nowUs()); }
+
+float EtchCell::currentAt_(uint64_t t_us) const {
+  if (!wetted_) return 0.0f;
+  float immersed = endZ_() - surface_mm_;
+  if (immersed < 0.0f) immersed = 0.0f;   // held by the meniscus above the surface
+  float g = (broken_ ? cfg_.gApex_S : cfg_.gContact_S * neck_) + cfg_.gPerMm_S * immersed;
+  return voltageAt_(t_us) * g;
+}
+
+float EtchCell::current() const { return currentAt_(hal::nowUs()); }
+
+void EtchCell::advance_(uint64_t t_us) {
+  if (t_us <= lastUs_) return;
+  float dt = (t_us - lastUs_) * 1e-6f;
+  float q  = currentAt_(lastUs_) * dt;
+  lastUs_ = t_us;
+  if (q <= 0.0f) return;
+
+  if (broken_) {
+    qAfterBreak_ += q;
+    return;
+  }
+  neck_ -= q / breakCharge_C_;
+  if (neck_ <= 0.0f) {
+    // the neck sits at the surface line: everything below it drops off
+    neck_    = 0.0f;
+    broken_  = true;
+    breakUs_ = t_us;
+    lost_mm_ = tipZ() - surface_mm_;
+    if (lost_mm_ < 0.0f) lost_mm_ = 0.0f;
+  }
+}
+
+void EtchCell::moved_(uint64_t t_us) {
+  float end = endZ_();
+  if (!wetted_ && end >= surface_mm_) {
+    wetted_ = true;
+    if (contactUs_ == 0) contactUs_ = t_us ? t_us : 1;
+  } else if (wetted_ && end < surface_mm_ - cfg_.meniscus_mm) {
+    wetted_ = false;    // meniscus torn off
+  }
+  hal::setInput(pins_.limit, tipZ() <= 0.0f ? LOW : HIGH);
+}
+
+void EtchCell::pinWrite_(uint8_t pin, uint8_t level, uint64_t t_us) {
+  advance_(t_us);
+
+  if (pin == pins_.step) {
+    bool rising = level && !stepLevel_;
+    stepLevel_ = level;
+    if (!rising) return;
+    if (hal::pinLevel(pins_.en) != LOW) {    // TMC2209 disabled: the pulse is ignored
+      ++lostSteps_;
+      return;
+    }
+    int dir = hal::pinLevel(pins_.dir) ? 1 : -1;
+    steps_ += dir;
+    moved_(t_us);
+    if (stepHook_) stepHook_(t_us, dir);
+    return;
+  }
+
+  if (pin == pins_.relay1 || pin == pins_.relay2) {
+    float v = relayVoltage_();
+    if (v == vSteady_) return;
+    if (broken_ && v < vSteady_ && cutoffUs_ == 0) cutoffUs_ = t_us;
+    if (t_us != relayChangeUs_) vOld_ = vSteady_;   // both coils switched together: one transition
+    vSteady_ = v;
+    relayChangeUs_ = t_us;
+  }
+}
+
+int EtchCell::sample_(uint64_t t_us) {
+  advance_(t_us);
+  const float w = 2.0f * (float)M_PI * (float)fmod(cfg_.mains_Hz * (double)t_us * 1e-6, 1.0);
+  float v = (float)M_SQRT2 / cfg_.sensorA_per_V *
+            (currentAt_(t_us) * sinf(w) + cfg_.pickup_A * sinf(w + PICKUP_PHASE));
+  float code = 511.5f + v * (1023.0f / 5.0f) + cfg_.noise_counts * noise_(rng_);
+  long c = lroundf(code);
+  if (c < 0) c = 0;
+  if (c > 1023) c = 1023;
+  return (int)c;
+}
@@ -0,0 +1,194 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <random>
+
+/**
+ * @brief Plant model of the etching cell: wire, electrolyte, relays, sensor.
+ *
+ * EtchCell stands in for everything the firmware talks to through its pins
+ * in MOD1/MOD2/HOME:
+ *  - the Z axis: STEP pulses (while EN is LOW) move the tip, DIR HIGH is +Z
+ *    (down, towards the electrolyte); the homing switch closes (LOW) at Z <= 0,
+ *  - the relays: relay 1 energized (LOW) applies 9 V, relay 2 energized applies
+ *    30 V; a released pair applies idleVoltage_V. A relay change chatters
+ *    between the old and the new voltage for bounce_us,
+ *  - the electrolyte: the tip touches the surface at surface_mm; once wetted,
+ *    the meniscus stays attached until the tip is lifted more than
+ *    meniscus_mm above the surface,
+ *  - the etch: the neck at the meniscus thins in proportion to the charge
+ *    passed (breakCharge_C to break); when it breaks, the immersed part drops
+ *    off and only the apex keeps conducting,
+ *  - the sensor: the AC current (RMS) appears as a mains-frequency sine on the
+ *    current transformer output, biased at mid-scale, with mains pickup and
+ *    Gaussian noise, quantized by the 10-bit ADC.
+ *
+ * The model is advanced lazily: every pin write and ADC read brings it up to
+ * the current virtual time, integrating the etch charge in between.
+ */
+class EtchCell {
+public:
+  /** @brief Pins of the firmware the cell is wired to. */
+  struct Pins {
+    uint8_t step, dir, en;     ///< Stepper driver inputs.
+    uint8_t limit;             ///< Homing switch (active LOW).
+    uint8_t relay1, relay2;    ///< Relay coils (active LOW): 9 V and 30 V.
+    uint8_t sensor;            ///< Current transformer ADC input.
+  };
+
+  /** @brief Physical parameters; defaults describe a typical W/PtIr bench setup. */
+  struct Config {
+    float stepsPerMm     = 400.0f;  ///< Axis resolution (200 full steps × 16 / 8 mm lead).
+    float startZ_mm      = 20.0f;   ///< Tip position at power-on.
+    float surface_mm     = 42.0f;   ///< Electrolyte surface position.
+    float surfaceJitter_mm = 0.5f;  ///< Uniform jitter of the surface per tip (±).
+    float meniscus_mm    = 0.8f;    ///< Lift above the surface at which the meniscus tears.
+    float gContact_S     = 0.010f;  ///< Conductance of the wetted meniscus region.
+    float gPerMm_S       = 0.004f;  ///< Conductance per mm of immersed wire.
+    float gApex_S        = 0.001f;  ///< Conductance left after the drop-off.
+    float breakCharge_C  = 80.0f;   ///< Charge through the neck until it breaks.
+    float breakJitter    = 0.10f;   ///< Relative jitter of breakCharge_C per tip (±).
+    float relay9_V       = 9.0f;    ///< Voltage with relay 1 energized.
+    float relay30_V      = 30.0f;   ///< Voltage with relay 2 energized.
+    float idleVoltage_V  = 0.0f;    ///< Voltage with both relays released (see idleVoltageFor()).
+    uint32_t bounce_us   = 3000;    ///< Contact chatter after a relay change.
+    float mains_Hz       = 50.0f;   ///< Frequency of the etching current.
+    float sensorA_per_V  = 2.545f;  ///< Current transformer: A (RMS) per V (RMS).
+    float pickup_A       = 0.010f;  ///< Mains pickup always present on the sensor (RMS).
+    float noise_counts   = 1.5f;    ///< ADC noise (standard deviation, counts).
+    uint32_t seed        = 1;       ///< Random seed (noise, per-tip jitter).
+  };
+
+  /**
+   * @brief Create the model.
+   *
+   * @param cfg Physical parameters.
+   */
+  explicit EtchCell(const Config& cfg);
+
+  /**
+   * @brief Voltage with both relays released under which a mode can run.
+   *
+   * MOD2 searches for the surface with both relays released, so it needs
+   * wiring that leaves the 9 V supply on the cell; MOD1 ends the etch by
+   * releasing them, so its cell must go dead. The simulators use this
+   * unless --idle-volts is given.
+   *
+   * @param mode  Menu index of the mode (1 = MOD1, 2 = MOD2).
+   * @param cfg   Physical parameters.
+   * @return Idle voltage (V).
+   */
+  static float idleVoltageFor(int mode, const Config& cfg) { return mode == 2 ? cfg.relay9_V : 0.0f; }
+
+  /**
+   * @brief Change the voltage with both relays released, from now on.
+   *
+   * @param v Idle voltage (V).
+   */
+  void setIdleVoltage(float v);
+
+  /**
+   * @brief Connect the model to the HAL: pin hook, ADC source, limit switch.
+   *
+   * Replaces any pin hook or ADC source installed before; ADC pins other
+   * than the sensor keep their constant hal::setAnalog() values.
+   *
+   * @param pins Firmware pin assignment.
+   */
+  void attach(const Pins& pins);
+
+  /**
+   * @brief Mount a fresh wire: unbroken neck, dry tip, new surface and break charge.
+   *
+   * The axis position is kept, like changing the wire on the bench.
+   */
+  void newTip();
+
+  /** @brief Tip position (mm, +Z down), as moved by the STEP pulses. */
+  float tipZ() const { return steps_ / cfg_.stepsPerMm; }
+
+  /** @brief Electrolyte surface of the current tip (mm). */
+  float surfaceZ() const { return surface_mm_; }
+
+  /** @brief Voltage applied to the cell right now (including chatter). */
+  float voltage() const;
+
+  /** @brief RMS current through the cell at the current state (A). */
+  float current() const;
+
+  /** @brief Remaining neck cross-section (1 = intact, 0 = broken). */
+  float neck() const { return neck_; }
+
+  /** @brief True once the immersed part has dropped off. */
+  bool broken() const { return broken_; }
+
+  /** @brief Virtual time of the drop-off (µs); valid if broken(). */
+  uint64_t breakUs() const { return breakUs_; }
+
+  /** @brief First time the tip touched the electrolyte (µs; 0 = not yet). */
+  uint64_t contactUs() const { return contactUs_; }
+
+  /** @brief Time the voltage was first lowered after the drop-off (µs; 0 = not yet). */
+  uint64_t cutoffUs() const { return cutoffUs_; }
+
+  /** @brief Charge passed after the drop-off (C): over-etching of the apex. */
+  float chargeAfterBreak() const { return qAfterBreak_; }
+
+  /** @brief Steps received while the driver was disabled (lost). */
+  uint32_t lostSteps() const { return lostSteps_; }
+
+  /** @brief Observer of executed steps: time, direction (+1/-1). */
+  using StepHook = std::function<void(uint64_t t_us, int dir)>;
+
+  /** @brief Install (or clear) the step observer. */
+  void onStep(StepHook hook) { stepHook_ = std::move(hook); }
+
+private:
+  /** @brief Integrate the etch from the last update to t_us. */
+  void advance_(uint64_t t_us);
+
+  /** @brief React to a firmware pin write. */
+  void pinWrite_(uint8_t pin, uint8_t level, uint64_t t_us);
+
+  /** @brief Produce an ADC reading of the sensor input. */
+  int sample_(uint64_t t_us);
+
+  /** @brief Steady voltage selected by the relay pins. */
+  float relayVoltage_() const;
+
+  /** @brief Voltage at t_us, including relay chatter. */
+  float voltageAt_(uint64_t t_us) const;
+
+  /** @brief Cell current at t_us (A RMS). */
+  float currentAt_(uint64_t t_us) const;
+
+  /** @brief Position of the wire end (mm): the tip, or the neck once broken. */
+  float endZ_() const { return tipZ() - lost_mm_; }
+
+  /** @brief Update the wetting state and the homing switch after the tip moved. */
+  void moved_(uint64_t t_us);
+
+  Config   cfg_;
+  Pins     pins_ = {};
+  std::mt19937 rng_;
+  std::normal_distribution<float> noise_{0.0f, 1.0f};
+
+  long     steps_ = 0;            ///< Axis position in steps.
+  float    surface_mm_ = 0.0f;
+  float    breakCharge_C_ = 0.0f;
+  float    neck_ = 1.0f;
+  bool     broken_ = false;
+  bool     wetted_ = false;
+  float    lost_mm_ = 0.0f;       ///< Length that dropped off at the break.
+  uint8_t  stepLevel_ = 0;        ///< Last level of the STEP pin.
+
+  float    vSteady_ = 0.0f;       ///< Voltage selected by the relays.
+  float    vOld_ = 0.0f;          ///< Voltage before the last relay change.
+  uint64_t relayChangeUs_ = 0;    ///< Time of the last relay change.
+
+  uint64_t lastUs_ = 0;           ///< Time the model was last advanced to.
+  uint64_t contactUs_ = 0, breakUs_ = 0, cutoffUs_ = 0;
+  float    qAfterBreak_ = 0.0f;
+  uint32_t lostSteps_ = 0;
+  StepHook stepHook_;
+};
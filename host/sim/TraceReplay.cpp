@@ -0,0 +1,256 @@
+#include "TraceReplay.h"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "HostHal.h"
+#include "EventLog.h"
+#include "ModeController.h"
+#include "ParamTable.h"
+#include "Sketch.h"
+#include "StepperDriver.h"
+#include "TraceFile.h"
+
+namespace {
+
+/** @brief Time after the last sample a replay may still take to reach a decision. */
+constexpr uint64_t TAIL_US = 1000000ULL;
+
+/** @brief Virtual time per pass after the run when idle passes were skipped. */
+constexpr uint32_t SETTLE_PASS_US = 50;
+
+/** @brief Longest gap between two passes when idle passes are skipped. */
+constexpr uint64_t MAX_GAP_US = 1000;
+
+/** @brief Shortest gap, while something was due but did not happen yet. */
+constexpr uint64_t MIN_GAP_US = 10;
+
+/**
+ * @brief Next time the sensor or the stepper is due, from when they last acted.
+ *
+ * Only reads public state of the firmware: the sensor samples every
+ * sampleIntervalUs() while enabled, the stepper steps at the period of its
+ * speed. A deadline in the past (just enabled, just started to move) gives
+ * a pass right away.
+ *
+ * The sensor keeps a fixed sampling grid, so its next sample is due one
+ * interval after the start of the pass that took the last one (the reading
+ * itself comes a few µs into the pass; counting from there would let the
+ * passes fall behind the grid).
+ */
+struct DueTracker {
+  uint64_t passStart = 0;    ///< Start of the pass in progress.
+  bool     read = false;     ///< The sensor was read in this pass.
+  uint64_t lastRead = 0;     ///< Start of the pass of the last sensor reading.
+  uint64_t lastStep = 0;     ///< Time of the last STEP rising edge.
+
+  /** @brief Start of the next pass, at the end of the current one (now). */
+  uint64_t next(uint64_t now) {
+    if (read) lastRead = passStart;
+    read = false;
+    uint64_t t = now + MAX_GAP_US;
+    if (currentSensor.isEnabled()) t = std::min<uint64_t>(t, lastRead + currentSensor.sampleIntervalUs());
+    const float stepsPerSec = fabsf(stepper.speedMmPerSec()) * stepper.stepsPerMm();
+    if (stepsPerSec >= 1.0f) t = std::min<uint64_t>(t, lastStep + (uint64_t)(1000000.0f / stepsPerSec));
+    passStart = std::max(t, now + MIN_GAP_US);
+    return passStart;
+  }
+};
+
+/** @brief Read a binary trace: the readings and the metadata annotations. */
+bool loadTraceFile(const char* path, Trace& tr) {
+  tracefile::TraceFile tf;
+  if (!tf.open(path)) return false;
+  tr.path = path;
+  std::string v;
+  if (tf.meta("mode", v))       tr.mode = atoi(v.c_str());
+  if (tf.meta("baseline_A", v)) tr.baseline_A = (float)atof(v.c_str());
+  if (tf.meta("start_z_mm", v)) tr.startZ_mm = (float)atof(v.c_str());
+  if (tf.meta("contact_us", v)) tr.contact_us = strtoll(v.c_str(), nullptr, 10);
+  if (tf.meta("break_us", v))   tr.break_us = strtoll(v.c_str(), nullptr, 10);
+  tr.t_us.resize(tf.samples());
+  tr.adc.resize(tf.samples());
+  tf.read(0, tr.t_us.size(), tr.t_us.data(), tr.adc.data());
+  if (tr.t_us.empty()) {
+    fprintf(stderr, "%s: no samples\n", path);
+    return false;
+  }
+  return true;
+}
+
+}  // namespace
+
+bool loadTrace(const char* path, Trace& tr) {
+  if (tracefile::TraceFile::isTraceFile(path)) return loadTraceFile(path, tr);
+  FILE* f = fopen(path, "r");
+  if (!f) {
+    perror(path);
+    return false;
+  }
+  tr.path = path;
+  char line[256];
+  unsigned lineNo = 0;
+  while (fgets(line, sizeof(line), f)) {
+    ++lineNo;
+    const char* s = line;
+    while (*s == ' ' || *s == '\t') ++s;
+    if (*s == '#') {
+      ++s;
+      while (*s == ' ') ++s;
+      if      (!strncmp(s, "mode=", 5))        tr.mode = atoi(s + 5);
+      else if (!strncmp(s, "baseline_A=", 11)) tr.baseline_A = (float)atof(s + 11);
+      else if (!strncmp(s, "start_z_mm=", 11)) tr.startZ_mm = (float)atof(s + 11);
+      else if (!strncmp(s, "contact_us=", 11)) tr.contact_us = strtoll(s + 11, nullptr, 10);
+      else if (!strncmp(s, "break_us=", 9))    tr.break_us = strtoll(s + 9, nullptr, 10);
+      continue;
+    }
+    if (!isdigit((unsigned char)*s)) continue;   // blank line or column header
+
+    char* end;
+    unsigned long long t = strtoull(s, &end, 10);
+    if (*end != ',') {
+      fprintf(stderr, "%s:%u: expected t_us,adc\n", path, lineNo);
+      fclose(f);
+      return false;
+    }
+    long v = strtol(end + 1, nullptr, 10);
+    if (!tr.t_us.empty() && t < tr.t_us.back()) {
+      fprintf(stderr, "%s:%u: time goes backwards\n", path, lineNo);
+      fclose(f);
+      return false;
+    }
+    tr.t_us.push_back(t);
+    tr.adc.push_back((uint16_t)(v < 0 ? 0 : v > 1023 ? 1023 : v));
+  }
+  fclose(f);
+  if (tr.t_us.empty()) {
+    fprintf(stderr, "%s: no samples\n", path);
+    return false;
+  }
+  return true;
+}
+
+RunOutcome runMode(int mode, const RunOptions& opt) {
+  RunOutcome r;
+  const uint64_t t0 = hal::nowUs();
+
+  gEventLog.clear();
+  ctrl.startMode((uint8_t)mode);
+
+  while (ctrl.isRunning()) {
+    const int64_t pass = (int64_t)(hal::nowUs() - t0);
+    if (opt.timeout_us && (uint64_t)pass >= opt.timeout_us) {
+      ctrl.stopMode();
+      break;
+    }
+    loop();
+
+    // everything logged during this pass is stamped with the pass start
+    bool decided = false;
+    for (uint8_t i = 0; i < gEventLog.count(); ++i) {
+      const LogEntry& e = gEventLog.at(i);
+      if (opt.verbose) fprintf(stderr, "  %10.3f s  ev %2u  arg %d\n", pass * 1e-6, e.id, e.arg);
+      switch (e.id) {
+        case EV_SURFACE:
+          r.surface_us = pass;
+          ++r.surfaceHits;
+          if (opt.touched && !opt.touched(pass)) ++r.falseTriggers;
+          break;
+        case EV_CONTACT_OK:    r.contactOk_us = pass; break;
+        case EV_CONTACT_RETRY: ++r.retries; break;
+        case EV_ETCH_END:
+          r.etchEnd_us = pass;
+          r.result = "ok";
+          decided = opt.stopAtEtchEnd;
+          break;
+        case EV_Z_LIMIT:
+          r.result = "zlimit";
+          decided = opt.stopAtEtchEnd;
+          break;
+        default: break;
+      }
+    }
+    gEventLog.clear();
+    if (decided) {
+      ctrl.stopMode();
+      break;
+    }
+    const uint64_t now = hal::nowUs();
+    const uint64_t next = opt.nextPass ? opt.nextPass(now) : now + opt.loop_us;
+    if (next > now) hal::advanceUs(next - now);
+  }
+  r.end_us = (int64_t)(hal::nowUs() - t0);
+  if (!strcmp(r.result, "eot") && (!opt.timeout_us || (uint64_t)r.end_us < opt.timeout_us)) r.result = "stopped";
+
+  // let the controller settle in the menu before the next run
+  for (int i = 0; i < 100; ++i) {
+    loop();
+    hal::advanceUs(opt.loop_us ? opt.loop_us : SETTLE_PASS_US);
+  }
+  gEventLog.clear();
+  return r;
+}
+
+RunOutcome replayTrace(const Trace& tr, int mode, uint32_t loop_us, bool verbose) {
+  const SketchPins pins = sketchPins();
+  const uint8_t sensor = pins.sensor;
+  const uint8_t step = pins.step;
+  const uint64_t t0 = hal::nowUs();
+  size_t idx = 0;
+  DueTracker due;
+  due.passStart = due.lastRead = due.lastStep = t0;
+
+  // sample and hold: the latest sample at or before the reading
+  hal::setAdcSource([&tr, &idx, &due, sensor, t0](uint8_t pin, uint64_t t) -> int {
+    if (pin != sensor) return hal::analogValue(pin);
+    due.read = true;
+    const uint64_t rel = t - t0;
+    while (idx + 1 < tr.t_us.size() && tr.t_us[idx + 1] <= rel) ++idx;
+    return tr.adc[idx];
+  });
+
+  RunOptions opt;
+  if (loop_us == 0) {
+    hal::onPinWrite([&due, step](uint8_t pin, uint8_t level, uint64_t t) {
+      if (pin == step && level) due.lastStep = t;
+    });
+    opt.nextPass = [&due](uint64_t now) { return due.next(now); };
+  }
+  opt.loop_us       = loop_us;
+  opt.timeout_us    = tr.t_us.back() + TAIL_US;
+  opt.stopAtEtchEnd = true;
+  opt.verbose       = verbose;
+  if (tr.contact_us != TRACE_NONE) {
+    const int64_t contact = tr.contact_us;
+    opt.touched = [contact](int64_t t) { return t >= contact; };
+  }
+  RunOutcome r = runMode(mode, opt);
+  hal::setAdcSource(nullptr);
+  hal::onPinWrite(nullptr);
+  return r;
+}
+
+bool setParamByName(const char* spec, bool quiet) {
+  const char* eq = strchr(spec, '=');
+  if (!eq) return false;
+  const size_t n = (size_t)(eq - spec);
+  for (uint8_t i = 0; i < PARAM_COUNT; ++i) {
+    ParamDesc d;
+    paramDesc(i, d);
+    if (strlen(d.name) != n) continue;
+    size_t k = 0;
+    for (; k < n; ++k) {
+      char a = (char)toupper((unsigned char)spec[k]);
+      char b = (char)toupper((unsigned char)d.name[k]);
+      if (a == '_') a = ' ';
+      if (a != b) break;
+    }
+    if (k < n) continue;
+    float v = paramSet(d, (float)atof(eq + 1));
+    if (!quiet) fprintf(stderr, "%s = %g %s\n", d.name, v, d.units);
+    return true;
+  }
+  return false;
+}
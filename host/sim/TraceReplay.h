@@ -0,0 +1,108 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+/**
+ * @file TraceReplay.h
+ * @brief Running MOD1/MOD2 of the host sketch and scoring the run, on a
+ *        recorded sensor trace or on whatever drives the pins.
+ *
+ * Shared by tracereplay and sweep. The sketch must have been set up (setup())
+ * and be idle in the menu.
+ */
+
+/** @brief Not set (annotation missing, event not seen). */
+constexpr int64_t TRACE_NONE = -1;
+
+/**
+ * @brief One recorded run: ADC readings of the current sensor from the start
+ *        of the mode, plus the annotations of the trace file.
+ */
+struct Trace {
+  std::string           path;
+  int                   mode = 0;            ///< 0 = not annotated.
+  float                 baseline_A = -1.0f;  ///< < 0 = not annotated.
+  float                 startZ_mm = -1.0f;   ///< < 0 = not annotated.
+  int64_t               contact_us = TRACE_NONE;  ///< Real contact with the electrolyte.
+  int64_t               break_us = TRACE_NONE;    ///< Real drop-off.
+  std::vector<uint64_t> t_us;
+  std::vector<uint16_t> adc;
+};
+
+/**
+ * @brief Read a trace file: text (format: see tracereplay.cpp) or binary
+ *        (.ttr, see TraceFile.h; recognized by its magic).
+ *
+ * @return false (with a message on stderr) if it cannot be read or holds no samples.
+ */
+bool loadTrace(const char* path, Trace& tr);
+
+/** @brief Outcome of one MOD1/MOD2 run, from the event log. Times from the mode start (µs). */
+struct RunOutcome {
+  const char* result = "eot";            ///< ok, zlimit, stopped or eot (time limit reached).
+  int64_t  surface_us = TRACE_NONE;      ///< Latest surface detection (the one that was kept).
+  int64_t  contactOk_us = TRACE_NONE;    ///< 30 V validation confirmed.
+  int64_t  etchEnd_us = TRACE_NONE;      ///< Etch end detected.
+  int64_t  end_us = 0;                   ///< Mode ended or was stopped.
+  unsigned surfaceHits = 0;              ///< Surface detections.
+  unsigned falseTriggers = 0;            ///< Surface detections before the real contact.
+  unsigned retries = 0;                  ///< Detections rejected by the 30 V validation.
+};
+
+/** @brief Settings of runMode(). */
+struct RunOptions {
+  uint32_t loop_us = 50;            ///< Virtual time per loop() pass.
+  uint64_t timeout_us = 0;          ///< Stop the mode after this long (0 = no limit).
+  bool     stopAtEtchEnd = false;   ///< Stop as soon as the etch end (or a Z limit) is detected.
+  bool     verbose = false;         ///< Print the events to stderr.
+  /** @brief True if the tip really touched the electrolyte at t (µs from start); unset = unknown. */
+  std::function<bool(int64_t t_us)> touched;
+  /** @brief Virtual time of the next pass, given the current one; unset = now + loop_us. */
+  std::function<uint64_t(uint64_t now_us)> nextPass;
+};
+
+/**
+ * @brief Start a mode like the menu does and run loop() until it ends.
+ *
+ * Events are stamped with the start of the loop() pass that logged them.
+ * The event log is cleared as it is consumed.
+ *
+ * @param mode  Mode index (1 = MOD1, 2 = MOD2).
+ * @param opt   Settings.
+ * @return The scored run.
+ */
+RunOutcome runMode(int mode, const RunOptions& opt);
+
+/**
+ * @brief Replay a trace: the sensor reads the latest sample at or before each
+ *        analogRead(); stops at the etch end or one second after the last sample.
+ *
+ * With loop_us 0 the passes in which nothing is due are skipped: the clock
+ * goes straight to the next sensor sample or step, or at most 1 ms ahead
+ * for the millis() timers of the modes. The sensor then samples exactly on
+ * its schedule, as it would with a short enough loop. The moving averages of
+ * the modes take one value per pass, so fewer passes make them slower: one
+ * pass per sample (200 µs while etching) is closer to the board (about
+ * 500 µs, see timingsim) than a fixed 50 µs loop.
+ *
+ * The caller sets baselineCurrent and the axis position beforehand.
+ *
+ * @param tr       Trace.
+ * @param mode     Mode index (1 or 2).
+ * @param loop_us  Virtual time per loop() pass, 0 = skip idle passes.
+ * @param verbose  Print the events to stderr.
+ */
+RunOutcome replayTrace(const Trace& tr, int mode, uint32_t loop_us = 0, bool verbose = false);
+
+/**
+ * @brief Set a parameter of the parameter table by its LCD name.
+ *
+ * '_' matches a space and case is ignored, e.g. "M1_ITHR=0.04".
+ *
+ * @param spec   "NAME=VALUE".
+ * @param quiet  Do not report the value stored.
+ * @return false if the name is unknown.
+ */
+bool setParamByName(const char* spec, bool quiet = false);
@@ -0,0 +1,300 @@
+/**
+ * @file etchsim.cpp
+ * @brief Closed-loop simulation of MOD1/MOD2 runs against the EtchCell plant.
+ *
+ * Usage: etchsim [options]
+ *   -m, --mode 1|2          mode to run (default 1)
+ *   -n, --runs N            number of tips to etch (default 10)
+ *   -s, --seed N            random seed (default 1)
+ *       --surface MM        electrolyte surface position (default 42)
+ *       --noise COUNTS      ADC noise, standard deviation (default 1.5)
+ *       --mains HZ          mains frequency (default 50)
+ *       --bounce MS         relay chatter after a change (default 3)
+ *       --break-charge C    charge to break the neck (default 80)
+ *       --idle-volts V      voltage with both relays released (default: 9 for
+ *                           MOD2, 0 for MOD1; see EtchCell::idleVoltageFor())
+ *       --loop-us US        virtual time per loop() pass (default 50)
+ *       --trace-dir DIR     write the sensor samples of each run to DIR/runN.trace
+ *       --trace-bin         write binary traces (DIR/runN.ttr) instead, with
+ *                           the sensor windows, axis positions and events
+ *
+ * The sketch boots, runs HOME (homing + baseline) and then etches one tip per
+ * run: HOME is run again (from the second run on), a new wire is mounted in
+ * the plant and the mode is started like from the menu. Each run prints one
+ * CSV line combining the firmware's run record with what the plant observed
+ * (true surface, drop-off time, the time the voltage was actually removed).
+ * A summary goes to stderr.
+ *
+ * With --trace-dir, every ADC reading of the sensor during a run is written
+ * in the format read by tracereplay, annotated with the plant's contact and
+ * drop-off times, so the detection logic can be re-run offline on it.
+ * --trace-bin writes the columnar format of TraceFile.h, which also holds
+ * each sensor window (end time, Irms, Vpp, reading range), every change of
+ * the axis position and the firmware events, stamped with the loop pass
+ * they occurred in.
+ */
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <getopt.h>
+#include "EtchCell.h"
+#include "EventLog.h"
+#include "HostHal.h"
+#include "Sketch.h"
+#include "ModeController.h"
+#include "RunLog.h"
+#include "StepperDriver.h"
+#include "TraceFile.h"
+
+namespace {
+
+/** @brief Simulated time limits. */
+constexpr uint64_t HOME_TIMEOUT_US = 120ULL * 1000000ULL;
+constexpr uint64_t RUN_TIMEOUT_US  = 3600ULL * 1000000ULL;
+
+uint32_t gLoopUs = 50;
+
+/** @brief Trace of the running run (nullptr when not recording) and its start. */
+FILE*    gTrace = nullptr;
+uint64_t gTraceT0 = 0;
+
+/** @brief Binary trace of the running run (--trace-bin) and what was recorded last. */
+tracefile::TraceWriter* gBin = nullptr;
+uint16_t gBinSeq = 0;
+long     gBinPos = 0;
+int      gWinMin = 1023, gWinMax = 0;   ///< Reading range of the sensor window in progress.
+
+/** @brief Record the sensor window, axis position and events of the last loop() pass. */
+void recordPass() {
+  const uint64_t t = hal::nowUs() - gTraceT0;
+  if (currentSensor.windowSeq() != gBinSeq) {
+    gBinSeq = currentSensor.windowSeq();
+    const uint64_t end = currentSensor.windowEndUs();
+    if (end >= gTraceT0 && gWinMin <= gWinMax) {
+      gBin->window(end - gTraceT0, currentSensor.lastIrms(), currentSensor.lastVpp(),
+                   (uint16_t)gWinMin, (uint16_t)gWinMax);
+    }
+    gWinMin = 1023;
+    gWinMax = 0;
+  }
+  if (stepper.positionSteps() != gBinPos) {
+    gBinPos = stepper.positionSteps();
+    gBin->step(t, (int32_t)gBinPos);
+  }
+  for (uint8_t i = 0; i < gEventLog.count(); ++i) gBin->event(t, gEventLog.at(i).id, gEventLog.at(i).arg);
+  gEventLog.clear();
+}
+
+/**
+ * @brief Run loop() until done() is true or the time limit is reached.
+ *
+ * @return false on timeout.
+ */
+template <typename Pred>
+bool runUntil(Pred done, uint64_t timeout_us) {
+  const uint64_t end = hal::nowUs() + timeout_us;
+  while (!done()) {
+    if (hal::nowUs() >= end) return false;
+    loop();
+    if (gBin) recordPass();
+    hal::advanceUs(gLoopUs);
+  }
+  return true;
+}
+
+void usage(const char* argv0) {
+  fprintf(stderr,
+          "usage: %s [-m 1|2] [-n runs] [-s seed] [--surface mm] [--noise counts]\n"
+          "          [--mains Hz] [--bounce ms] [--break-charge C] [--idle-volts V]\n"
+          "          [--loop-us us] [--trace-dir dir [--trace-bin]]\n", argv0);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  EtchCell::Config cfg;
+  int mode = 1, runs = 10;
+  float idleVolts = -1.0f;   // per mode unless given
+  const char* traceDir = nullptr;
+  bool traceBin = false;
+
+  static const option longOpts[] = {
+    { "mode",         required_argument, nullptr, 'm' },
+    { "runs",         required_argument, nullptr, 'n' },
+    { "seed",         required_argument, nullptr, 's' },
+    { "surface",      required_argument, nullptr, 1 },
+    { "noise",        required_argument, nullptr, 2 },
+    { "mains",        required_argument, nullptr, 3 },
+    { "bounce",       required_argument, nullptr, 4 },
+    { "break-charge", required_argument, nullptr, 5 },
+    { "idle-volts",   required_argument, nullptr, 6 },
+    { "loop-us",      required_argument, nullptr, 7 },
+    { "trace-dir",    required_argument, nullptr, 8 },
+    { "trace-bin",    no_argument,       nullptr, 9 },
+    { nullptr, 0, nullptr, 0 }
+  };
+  int c;
+  while ((c = getopt_long(argc, argv, "m:n:s:", longOpts, nullptr)) != -1) {
+    switch (c) {
+      case 'm': mode = atoi(optarg); break;
+      case 'n': runs = atoi(optarg); break;
+      case 's': cfg.seed = (uint32_t)strtoul(optarg, nullptr, 0); break;
+      case 1:   cfg.surface_mm = (float)atof(optarg); break;
+      case 2:   cfg.noise_counts = (float)atof(optarg); break;
+      case 3:   cfg.mains_Hz = (float)atof(optarg); break;
+      case 4:   cfg.bounce_us = (uint32_t)(atof(optarg) * 1000.0); break;
+      case 5:   cfg.breakCharge_C = (float)atof(optarg); break;
+      case 6:   idleVolts = (float)atof(optarg); break;
+      case 7:   gLoopUs = (uint32_t)atoi(optarg); break;
+      case 8:   traceDir = optarg; break;
+      case 9:   traceBin = true; break;
+      default:  usage(argv[0]); return 2;
+    }
+  }
+  if ((mode != 1 && mode != 2) || runs <= 0 || gLoopUs == 0 || (traceBin && !traceDir)) {
+    usage(argv[0]);
+    return 2;
+  }
+
+  cfg.idleVoltage_V = idleVolts >= 0.0f ? idleVolts : EtchCell::idleVoltageFor(mode, cfg);
+
+  const auto wall0 = std::chrono::steady_clock::now();
+  const SketchPins p = sketchPins();
+  EtchCell cell(cfg);
+  cell.attach({ p.step, p.dir, p.en, p.limit, p.relay1, p.relay2, p.sensor });
+  sketchAttachLcd();
+
+  if (traceDir) {
+    // tap the plant's sensor readings on their way to the firmware
+    hal::AdcSource plant = hal::adcSource();
+    const uint8_t sensor = p.sensor;
+    hal::setAdcSource([plant, sensor](uint8_t pin, uint64_t t) {
+      int v = plant(pin, t);
+      if (gTrace && pin == sensor) fprintf(gTrace, "%llu,%d\n", (unsigned long long)(t - gTraceT0), v);
+      if (gBin && pin == sensor) {
+        gBin->sample(t - gTraceT0, (uint16_t)v);
+        if (v < gWinMin) gWinMin = v;
+        if (v > gWinMax) gWinMax = v;
+      }
+      return v;
+    });
+  }
+
+  setup();   // HOME starts automatically
+  if (!runUntil([] { return !ctrl.isRunning(); }, HOME_TIMEOUT_US)) {
+    fprintf(stderr, "HOME did not complete\n");
+    return 1;
+  }
+
+  printf("run,mode,result,surface_mm,detected_mm,err_mm,retries,etch_s,end_mA,"
+         "break_s,cutoff_ms,q_after_break_mC,pulses,run_s\n");
+
+  int ok = 0, aborted = 0, timeouts = 0, cut = 0;
+  double latSum = 0.0, latMax = 0.0;
+
+  for (int r = 0; r < runs; ++r) {
+    // Every run starts from home, whatever the last one left (an abort at
+    // the Z limit leaves the axis at the bottom). Homing drives the axis
+    // with STEP pulses, so the plant follows it.
+    if (r > 0) {
+      ctrl.startMode(0);   // HOME (menu index 0)
+      if (!runUntil([] { return !ctrl.isRunning(); }, HOME_TIMEOUT_US)) {
+        fprintf(stderr, "HOME did not complete before run %d\n", r);
+        runs = r;
+        break;
+      }
+    }
+    cell.newTip();
+    const uint64_t t0 = hal::nowUs();
+    tracefile::TraceWriter bin;
+    if (traceBin) {
+      const std::string path = std::string(traceDir) + "/run" + std::to_string(r) + ".ttr";
+      if (!bin.open(path.c_str())) return 1;
+      char buf[32];
+      bin.meta("mode", std::to_string(mode));
+      snprintf(buf, sizeof(buf), "%.6f", baselineCurrent);
+      bin.meta("baseline_A", buf);
+      snprintf(buf, sizeof(buf), "%.3f", stepper.positionMm());
+      bin.meta("start_z_mm", buf);
+      gBin = &bin;
+      gTraceT0 = t0;
+      gBinSeq = currentSensor.windowSeq();
+      gBinPos = stepper.positionSteps();
+      gWinMin = 1023;
+      gWinMax = 0;
+      gEventLog.clear();
+    } else if (traceDir) {
+      const std::string path = std::string(traceDir) + "/run" + std::to_string(r) + ".trace";
+      gTrace = fopen(path.c_str(), "w");
+      if (!gTrace) {
+        perror(path.c_str());
+        return 1;
+      }
+      gTraceT0 = t0;
+      fprintf(gTrace, "# tiptrace\n# mode=%d\n# baseline_A=%.6f\n# start_z_mm=%.3f\nt_us,adc\n",
+              mode, baselineCurrent, stepper.positionMm());
+    }
+    // The run's record is the one with a new run number: a run that left no
+    // record must not be reported with the previous run's.
+    uint8_t rec[PROTO_RUN_SIZE] = {};
+    const bool hadRec = runLog.count() > 0 && runLog.read(runLog.count() - 1, rec);
+    const uint16_t prevSeq = protoGetU16(rec + PROTO_RUN_SEQ);
+
+    ctrl.startMode((uint8_t)mode);
+
+    bool finished = runUntil([] { return !ctrl.isRunning(); }, RUN_TIMEOUT_US);
+    if (!finished) {
+      ctrl.stopMode();
+      ++timeouts;
+    }
+    runUntil([] { return !runLog.saving(); }, 1000000ULL);
+    const double run_s = (hal::nowUs() - t0) * 1e-6;
+
+    if (gTrace) {
+      if (cell.contactUs() > t0) fprintf(gTrace, "# contact_us=%llu\n", (unsigned long long)(cell.contactUs() - t0));
+      if (cell.broken()) fprintf(gTrace, "# break_us=%llu\n", (unsigned long long)(cell.breakUs() - t0));
+      fclose(gTrace);
+      gTrace = nullptr;
+    }
+    if (gBin) {
+      if (cell.contactUs() > t0) bin.meta("contact_us", std::to_string(cell.contactUs() - t0));
+      if (cell.broken()) bin.meta("break_us", std::to_string(cell.breakUs() - t0));
+      gBin = nullptr;
+      if (!bin.close()) return 1;
+    }
+
+    bool haveRec = finished && runLog.count() > 0 && runLog.read(runLog.count() - 1, rec) &&
+                   (!hadRec || protoGetU16(rec + PROTO_RUN_SEQ) != prevSeq);
+    if (!haveRec) memset(rec, 0, sizeof(rec));
+    const char* result = !finished ? "timeout"
+                       : !haveRec ? "norecord"
+                       : rec[PROTO_RUN_RESULT] == RUN_OK ? "ok" : "abort";
+    if (haveRec) (rec[PROTO_RUN_RESULT] == RUN_OK ? ok : aborted)++;
+
+    const double detected = protoGetU16(rec + PROTO_RUN_SURFACE_Z) * 0.01;
+    const double break_s  = cell.broken() ? (cell.breakUs() - t0) * 1e-6 : -1.0;
+    double cutoff_ms = -1.0;
+    if (cell.broken() && cell.cutoffUs()) {
+      cutoff_ms = (cell.cutoffUs() - cell.breakUs()) * 1e-3;
+      latSum += cutoff_ms;
+      if (cutoff_ms > latMax) latMax = cutoff_ms;
+      ++cut;
+    }
+
+    printf("%d,%d,%s,%.3f,%.2f,%.3f,%u,%.1f,%.2f,%.2f,%.1f,%.2f,%u,%.1f\n",
+           r, mode, result, cell.surfaceZ(), detected, detected - cell.surfaceZ(),
+           rec[PROTO_RUN_RETRIES], protoGetU16(rec + PROTO_RUN_ETCH_TIME) * 0.1,
+           protoGetU16(rec + PROTO_RUN_END_I) * 0.01, break_s, cutoff_ms,
+           cell.chargeAfterBreak() * 1e3, rec[PROTO_RUN_PULSES], run_s);
+    fflush(stdout);
+  }
+
+  const double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - wall0).count();
+  const double virt = hal::nowUs() * 1e-6;
+  fprintf(stderr, "%d runs: %d ok, %d aborted, %d timed out; cutoff latency mean %.1f ms, max %.1f ms\n",
+          runs, ok, aborted, timeouts, cut ? latSum / cut : 0.0, latMax);
+  fprintf(stderr, "simulated %.0f s in %.2f s (%.0fx real time)\n", virt, wall, wall > 0 ? virt / wall : 0.0);
+  return 0;
+}
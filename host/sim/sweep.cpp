@@ -0,0 +1,679 @@
+/**
+ * @file sweep.cpp
+ * @brief Parallel parameter sweep of the MOD1/MOD2 detection logic over
+ *        recorded traces and simulated tips.
+ *
+ * Usage: sweep [options] [TRACE...]
+ *   -m, --mode 1|2          mode to evaluate (default 1)
+ *   -a, --axis SPEC         a swept setting, repeatable:
+ *                             NAME=LO:HI:STEP  grid from LO to HI
+ *                             NAME=V1,V2,...   listed values
+ *   -r, --random N          N random configurations drawn from the axes
+ *                           (uniform in LO..HI, or one of the listed values)
+ *                           instead of the full grid
+ *   -n, --sim N             also run every configuration on N simulated tips
+ *   -s, --seed N            seed of the random configurations and of the
+ *                           simulated tips (default 1)
+ *   -j, --jobs N            worker processes (default: number of cores)
+ *       --rank KEYS         ranking order, comma separated from fail, false,
+ *                           cutoff, detect, cycle (default: all in this order)
+ *       --top N             print only the N best configurations
+ *       --loop-us US        simulated tips: virtual time per loop() pass (default
+ *                           50); traces skip the idle passes like tracereplay
+ *       --noise COUNTS      simulated tips: ADC noise (default 1.5)
+ *       --mains HZ          simulated tips: mains frequency (default 50)
+ *       --idle-volts V      simulated tips: voltage with both relays released
+ *                           (default: 9 for MOD2, 0 for MOD1)
+ *
+ * Axes (settings not swept keep the firmware's values):
+ *   surface     surface detection threshold (A, I_THRESHOLD)
+ *   etch        etch end threshold of the mode (A, M1/M2 Ithr)
+ *   retract     MOD1 retract speed while etching (mm/s)
+ *   avg         long moving average length (samples, <= IAvg_t size)
+ *   avgs        short moving average length (samples, <= IAvg_s size)
+ *   detect_win  sensor window of surface detection/validation (ms)
+ *   etch_win    sensor window of the etch end detection (ms)
+ *
+ * Every configuration is evaluated on every trace (replayed like tracereplay
+ * does, up to the etch end) and on every simulated tip (closed loop against
+ * EtchCell like etchsim, the whole cycle). One CSV line per configuration,
+ * best first:
+ *   fail       runs that did not end with an etch end (Z limit, timeout),
+ *   early      etch ends detected before the real break,
+ *   false      surface detections before the real contact, per run,
+ *   detect_ms  mean delay of the surface detection after the contact,
+ *   cutoff_ms  mean and maximum delay of the etch end after the break,
+ *   cycle_s    mean run time (traces: up to the etch end).
+ * fail and early are ranked together.
+ *
+ * The sketch is one set of globals, so the workers are processes: after
+ * setup() (and HOME with a plant, for the baseline) the tool forks one worker
+ * per core, and each job runs in a fork of its worker, i.e. from the same
+ * booted state; results are identical for any number of workers. Jobs
+ * (configuration x trace/tip) are split into contiguous ranges, one per
+ * worker, in shared memory; a worker takes jobs from the front of its range
+ * and, when it runs dry, steals the back half of the largest remaining
+ * range. Workers share nothing else, so the sweep scales
+ * with the number of cores.
+ */
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include <getopt.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "EtchCell.h"
+#include "HostHal.h"
+#include "ModeController.h"
+#include "Modes.h"
+#include "Parameters.h"
+#include "Sketch.h"
+#include "TraceReplay.h"
+
+/** @name Sketch globals tuned by the sweep (defined in the .ino)
+ *  @{ */
+extern Mod1Mode mod1;
+extern Mod2Mode mod2;
+extern IAvg_t   Iavg;
+extern IAvg_s   IavgS;
+/** @} */
+
+namespace {
+
+/** @brief Simulated time limits. */
+constexpr uint64_t HOME_TIMEOUT_US = 120ULL * 1000000ULL;
+constexpr uint64_t RUN_TIMEOUT_US  = 3600ULL * 1000000ULL;
+
+int      gMode = 1;
+uint32_t gLoopUs = 50;
+
+// ---------------------------------------------------------------------------
+// Settings
+// ---------------------------------------------------------------------------
+
+/** @brief A firmware setting that can be swept. */
+struct Knob {
+  const char* name;
+  bool        integer;
+  float (*get)();
+  void  (*set)(float v);
+};
+
+const Knob KNOBS[] = {
+  { "surface", false,
+    [] { return gMode == 1 ? mod1.surfaceThreshold() : mod2.surfaceThreshold(); },
+    [](float v) { mod1.setSurfaceThreshold(v); mod2.setSurfaceThreshold(v); } },
+  { "etch", false,
+    [] { return gMode == 1 ? gParams.mod1.etchingThreshold_A : gParams.mod2.etchingThreshold_A; },
+    [](float v) { (gMode == 1 ? gParams.mod1.etchingThreshold_A : gParams.mod2.etchingThreshold_A) = v; } },
+  { "retract", false,
+    [] { return gParams.mod1.retractSpeed_mm_s; },
+    [](float v) { gParams.mod1.retractSpeed_mm_s = v; } },
+  { "avg", true,
+    [] { return (float)Iavg.length(); },
+    [](float v) { Iavg.setLength((int)v); } },
+  { "avgs", true,
+    [] { return (float)IavgS.length(); },
+    [](float v) { IavgS.setLength((int)v); } },
+  { "detect_win", false,
+    [] { return gTimingDetect.window_us * 1e-3f; },
+    [](float v) { gTimingDetect.window_us = (unsigned long)lroundf(v * 1000.0f); } },
+  { "etch_win", false,
+    [] { return gTimingEtchEnd.window_us * 1e-3f; },
+    [](float v) { gTimingEtchEnd.window_us = (unsigned long)lroundf(v * 1000.0f); } },
+};
+constexpr size_t KNOB_COUNT = sizeof(KNOBS) / sizeof(KNOBS[0]);
+
+/** @brief A swept setting: a list of values, or a range for random draws. */
+struct Axis {
+  size_t             knob;
+  std::vector<float> values;    ///< Grid points or listed values.
+  bool               range;     ///< Given as LO:HI:STEP.
+  float              lo, hi;
+};
+
+/**
+ * @brief Parse NAME=LO:HI:STEP or NAME=V1,V2,...
+ *
+ * @return false on a syntax error or an unknown name.
+ */
+bool parseAxis(const char* spec, Axis& a) {
+  const char* eq = strchr(spec, '=');
+  if (!eq) return false;
+  const std::string name(spec, eq);
+  a.knob = KNOB_COUNT;
+  for (size_t k = 0; k < KNOB_COUNT; ++k)
+    if (name == KNOBS[k].name) a.knob = k;
+  if (a.knob == KNOB_COUNT) return false;
+
+  const char* s = eq + 1;
+  a.range = strchr(s, ':') != nullptr;
+  if (a.range) {
+    float step = 0.0f;
+    if (sscanf(s, "%f:%f:%f", &a.lo, &a.hi, &step) != 3 || step <= 0.0f || a.hi < a.lo) return false;
+    for (int i = 0;; ++i) {
+      float v = a.lo + i * step;
+      if (v > a.hi + step * 1e-3f) break;
+      a.values.push_back(v);
+    }
+  } else {
+    char* end;
+    for (;;) {
+      a.values.push_back(strtof(s, &end));
+      if (end == s) return false;
+      if (*end != ',') break;
+      s = end + 1;
+    }
+    if (*end) return false;
+    a.lo = *std::min_element(a.values.begin(), a.values.end());
+    a.hi = *std::max_element(a.values.begin(), a.values.end());
+  }
+  if (KNOBS[a.knob].integer)
+    for (float& v : a.values) v = roundf(v);
+  return true;
+}
+
+/** @brief Values of all knobs for one configuration. */
+using Config = std::vector<float>;
+
+/** @brief Apply a configuration to the sketch. */
+void applyConfig(const Config& c) {
+  for (size_t k = 0; k < KNOB_COUNT; ++k) KNOBS[k].set(c[k]);
+}
+
+// ---------------------------------------------------------------------------
+// Jobs and work stealing
+// ---------------------------------------------------------------------------
+
+/** @brief Result of one job, written by a worker into shared memory. */
+struct JobResult {
+  uint8_t  done;
+  uint8_t  ok;            ///< Etch end detected.
+  uint8_t  early;         ///< Etch end detected before the real break.
+  uint32_t falseTriggers;
+  uint32_t retries;
+  double   detect_ms;     ///< NAN if unknown.
+  double   cutoff_ms;     ///< NAN if unknown or early.
+  double   cycle_s;
+};
+
+/**
+ * @brief Job range of one worker: next job (low 32 bits) and end (high 32 bits).
+ *
+ * The owner takes jobs from the front, thieves split off the back; both with
+ * a compare-and-swap of the packed pair, so a job is handed out exactly once.
+ */
+struct alignas(64) WorkRange {
+  std::atomic<uint64_t> v;
+  std::atomic<uint32_t> steals;
+  std::atomic<uint32_t> jobs;
+  std::atomic<uint64_t> busy_us;
+};
+static_assert(std::atomic<uint64_t>::is_always_lock_free,
+              "the work ranges live in memory shared between processes");
+
+inline uint64_t pack(uint32_t next, uint32_t end) { return (uint64_t)end << 32 | next; }
+inline uint32_t nextOf(uint64_t v) { return (uint32_t)v; }
+inline uint32_t endOf(uint64_t v)  { return (uint32_t)(v >> 32); }
+
+/** @brief Take the next job of the own range. */
+bool takeJob(WorkRange& r, uint32_t& job) {
+  uint64_t v = r.v.load();
+  while (nextOf(v) < endOf(v)) {
+    if (r.v.compare_exchange_weak(v, pack(nextOf(v) + 1, endOf(v)))) {
+      job = nextOf(v);
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * @brief Steal from the fullest other range: its back half becomes the own range.
+ *
+ * @return false when no work is left anywhere.
+ */
+bool stealJob(WorkRange* ranges, unsigned workers, unsigned self, uint32_t& job) {
+  for (;;) {
+    unsigned victim = workers;
+    uint32_t most = 0;
+    uint64_t seen = 0;
+    for (unsigned w = 0; w < workers; ++w) {
+      if (w == self) continue;
+      uint64_t v = ranges[w].v.load();
+      uint32_t n = endOf(v) - nextOf(v);
+      if (nextOf(v) < endOf(v) && n > most) {
+        most = n;
+        victim = w;
+        seen = v;
+      }
+    }
+    if (victim == workers) return false;
+
+    const uint32_t b = nextOf(seen), e = endOf(seen);
+    const uint32_t k = (e - b + 1) / 2;   // back half, at least one job
+    if (!ranges[victim].v.compare_exchange_strong(seen, pack(b, e - k))) continue;
+    job = e - k;
+    ranges[self].v.store(pack(e - k + 1, e));
+    ranges[self].steals.fetch_add(1);
+    return true;
+  }
+}
+
+/** @brief Everything a worker needs to run a job. */
+struct Sweep {
+  std::vector<Config> configs;
+  std::vector<Trace>  traces;
+  unsigned            tips = 0;
+  uint32_t            seed = 1;
+  EtchCell::Config    cell;
+  float               baseline_A = 0.0f;
+
+  unsigned runsPerConfig() const { return (unsigned)traces.size() + tips; }
+};
+
+/** @brief Evaluate one configuration on one trace or simulated tip. */
+JobResult runJob(const Sweep& sw, uint32_t job) {
+  JobResult res = {};
+  res.done = 1;
+  res.detect_ms = res.cutoff_ms = NAN;
+  const unsigned item = job % sw.runsPerConfig();
+  applyConfig(sw.configs[job / sw.runsPerConfig()]);
+
+  int64_t contact = TRACE_NONE, brk = TRACE_NONE;
+  RunOutcome r;
+  if (item < sw.traces.size()) {
+    const Trace& tr = sw.traces[item];
+    baselineCurrent = tr.baseline_A >= 0.0f ? tr.baseline_A : sw.baseline_A;
+    stepper.setPositionMm(tr.startZ_mm >= 0.0f ? tr.startZ_mm : 30.0f);
+    r = replayTrace(tr, gMode);
+    contact = tr.contact_us;
+    brk     = tr.break_us;
+    res.cycle_s = (r.etchEnd_us != TRACE_NONE ? r.etchEnd_us : r.end_us) * 1e-6;
+  } else {
+    EtchCell::Config cc = sw.cell;
+    cc.seed      = sw.seed + (item - (unsigned)sw.traces.size());
+    cc.startZ_mm = 30.0f;
+    EtchCell cell(cc);
+    const SketchPins p = sketchPins();
+    cell.attach({ p.step, p.dir, p.en, p.limit, p.relay1, p.relay2, p.sensor });
+    stepper.setPositionMm(30.0f);
+    baselineCurrent = sw.baseline_A;
+
+    RunOptions opt;
+    opt.loop_us    = gLoopUs;
+    opt.timeout_us = RUN_TIMEOUT_US;
+    opt.touched    = [&cell](int64_t) { return cell.contactUs() != 0; };
+    const uint64_t t0 = hal::nowUs();
+    r = runMode(gMode, opt);
+    if (cell.contactUs()) contact = (int64_t)(cell.contactUs() - t0);
+    if (cell.broken())    brk     = (int64_t)(cell.breakUs() - t0);
+    res.cycle_s = r.end_us * 1e-6;
+    hal::onPinWrite(nullptr);
+    hal::setAdcSource(nullptr);
+  }
+
+  res.ok            = r.etchEnd_us != TRACE_NONE;
+  res.falseTriggers = r.falseTriggers;
+  res.retries       = r.retries;
+  if (contact != TRACE_NONE && r.surface_us != TRACE_NONE) res.detect_ms = (r.surface_us - contact) * 1e-3;
+  if (res.ok && brk != TRACE_NONE) {
+    if (r.etchEnd_us < brk) res.early = 1;
+    else                    res.cutoff_ms = (r.etchEnd_us - brk) * 1e-3;
+  } else if (res.ok && item >= sw.traces.size()) {
+    res.early = 1;   // the plant never broke: cut off before the break
+  }
+  return res;
+}
+
+/**
+ * @brief Worker process: run jobs until no range has any left.
+ *
+ * Each job runs in a child forked from the worker, so every job starts from
+ * the same booted sketch (clock, sensor, axis) whichever worker takes it and
+ * the results do not depend on the number of workers.
+ */
+void worker(const Sweep& sw, WorkRange* ranges, unsigned workers, unsigned self, JobResult* results) {
+  const auto w0 = std::chrono::steady_clock::now();
+  uint32_t job;
+  while (takeJob(ranges[self], job) || stealJob(ranges, workers, self, job)) {
+    pid_t pid = fork();
+    if (pid == 0) {
+      results[job] = runJob(sw, job);
+      _exit(0);
+    }
+    if (pid > 0) waitpid(pid, nullptr, 0);
+    ranges[self].jobs.fetch_add(1);
+  }
+  ranges[self].busy_us.store((uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - w0).count());
+}
+
+// ---------------------------------------------------------------------------
+// Ranking
+// ---------------------------------------------------------------------------
+
+/** @brief Aggregated figures of one configuration. */
+struct Score {
+  size_t   config;
+  unsigned runs = 0, fail = 0, early = 0;
+  double   falseRate = 0.0, retries = 0.0;
+  double   detect_ms = NAN, cutoff_ms = NAN, cutoffMax_ms = NAN, cycle_s = NAN;
+
+  /** @brief Value of a ranking key (smaller is better, NAN last). */
+  double key(char k) const {
+    switch (k) {
+      case 'f': return fail + early;
+      case 'F': return falseRate;
+      case 'c': return cutoff_ms;
+      case 'd': return detect_ms;
+      case 'y': return cycle_s;
+    }
+    return 0.0;
+  }
+};
+
+Score aggregate(const JobResult* res, unsigned n, size_t config) {
+  Score s;
+  s.config = config;
+  s.runs = n;
+  double det = 0.0, cut = 0.0, cyc = 0.0, cutMax = 0.0;
+  unsigned nDet = 0, nCut = 0, nCyc = 0, falses = 0, retries = 0;
+  for (unsigned i = 0; i < n; ++i) {
+    const JobResult& r = res[i];
+    if (!r.ok) ++s.fail;
+    if (r.early) ++s.early;
+    falses  += r.falseTriggers;
+    retries += r.retries;
+    if (!std::isnan(r.detect_ms)) { det += r.detect_ms; ++nDet; }
+    if (!std::isnan(r.cutoff_ms)) {
+      cut += r.cutoff_ms;
+      cutMax = std::max(cutMax, r.cutoff_ms);
+      ++nCut;
+    }
+    if (r.ok) { cyc += r.cycle_s; ++nCyc; }
+  }
+  s.falseRate = n ? (double)falses / n : 0.0;
+  s.retries   = n ? (double)retries / n : 0.0;
+  if (nDet) s.detect_ms = det / nDet;
+  if (nCut) { s.cutoff_ms = cut / nCut; s.cutoffMax_ms = cutMax; }
+  if (nCyc) s.cycle_s = cyc / nCyc;
+  return s;
+}
+
+/**
+ * @brief Parse the ranking order.
+ *
+ * @return Key codes for Score::key(), empty on an unknown name.
+ */
+std::string parseRank(const char* spec) {
+  static const struct { const char* name; char code; } NAMES[] = {
+    { "fail", 'f' }, { "false", 'F' }, { "cutoff", 'c' }, { "detect", 'd' }, { "cycle", 'y' },
+  };
+  std::string keys;
+  std::string s(spec);
+  size_t pos = 0;
+  while (pos <= s.size()) {
+    size_t comma = s.find(',', pos);
+    if (comma == std::string::npos) comma = s.size();
+    const std::string name = s.substr(pos, comma - pos);
+    char code = 0;
+    for (const auto& n : NAMES)
+      if (name == n.name) code = n.code;
+    if (!code) return std::string();
+    keys += code;
+    pos = comma + 1;
+  }
+  return keys;
+}
+
+void printField(double v, const char* fmt) {
+  if (std::isnan(v)) printf(",");
+  else               printf(fmt, v);
+}
+
+void usage(const char* argv0) {
+  fprintf(stderr,
+          "usage: %s [-m 1|2] -a NAME=LO:HI:STEP|NAME=V1,V2... [-a ...] [-r configs]\n"
+          "          [-n tips] [-s seed] [-j workers] [--rank keys] [--top n] [--loop-us us]\n"
+          "          [--noise counts] [--mains Hz] [--idle-volts V] [TRACE...]\n"
+          "axes:", argv0);
+  for (const Knob& k : KNOBS) fprintf(stderr, " %s", k.name);
+  fprintf(stderr, "\n");
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  Sweep sw;
+  std::vector<Axis> axes;
+  unsigned randomConfigs = 0, workers = std::max(1u, std::thread::hardware_concurrency());
+  size_t top = 0;
+  std::string rank = "fFcdy";
+  float idleVolts = -1.0f;   // per mode unless given
+
+  static const option longOpts[] = {
+    { "mode",       required_argument, nullptr, 'm' },
+    { "axis",       required_argument, nullptr, 'a' },
+    { "random",     required_argument, nullptr, 'r' },
+    { "sim",        required_argument, nullptr, 'n' },
+    { "seed",       required_argument, nullptr, 's' },
+    { "jobs",       required_argument, nullptr, 'j' },
+    { "rank",       required_argument, nullptr, 1 },
+    { "top",        required_argument, nullptr, 2 },
+    { "loop-us",    required_argument, nullptr, 3 },
+    { "noise",      required_argument, nullptr, 4 },
+    { "mains",      required_argument, nullptr, 5 },
+    { "idle-volts", required_argument, nullptr, 6 },
+    { nullptr, 0, nullptr, 0 }
+  };
+  int c;
+  while ((c = getopt_long(argc, argv, "m:a:r:n:s:j:", longOpts, nullptr)) != -1) {
+    switch (c) {
+      case 'm': gMode = atoi(optarg); break;
+      case 'a': {
+        Axis a;
+        if (!parseAxis(optarg, a)) {
+          fprintf(stderr, "bad axis: %s\n", optarg);
+          usage(argv[0]);
+          return 2;
+        }
+        axes.push_back(a);
+        break;
+      }
+      case 'r': randomConfigs = (unsigned)atoi(optarg); break;
+      case 'n': sw.tips = (unsigned)atoi(optarg); break;
+      case 's': sw.seed = (uint32_t)strtoul(optarg, nullptr, 0); break;
+      case 'j': workers = (unsigned)atoi(optarg); break;
+      case 1:
+        rank = parseRank(optarg);
+        if (rank.empty()) {
+          fprintf(stderr, "bad ranking: %s\n", optarg);
+          return 2;
+        }
+        break;
+      case 2:   top = (size_t)atoi(optarg); break;
+      case 3:   gLoopUs = (uint32_t)atoi(optarg); break;
+      case 4:   sw.cell.noise_counts = (float)atof(optarg); break;
+      case 5:   sw.cell.mains_Hz = (float)atof(optarg); break;
+      case 6:   idleVolts = (float)atof(optarg); break;
+      default:  usage(argv[0]); return 2;
+    }
+  }
+  for (int i = optind; i < argc; ++i) {
+    Trace tr;
+    if (!loadTrace(argv[i], tr)) return 1;
+    sw.traces.push_back(std::move(tr));
+  }
+  if ((gMode != 1 && gMode != 2) || workers == 0 || gLoopUs == 0 || sw.runsPerConfig() == 0) {
+    usage(argv[0]);
+    return 2;
+  }
+  sw.cell.idleVoltage_V = idleVolts >= 0.0f ? idleVolts : EtchCell::idleVoltageFor(gMode, sw.cell);
+
+  // boot the sketch; with a plant, HOME measures the baseline for the simulated tips
+  const SketchPins p = sketchPins();
+  if (sw.tips) {
+    EtchCell home(sw.cell);
+    home.attach({ p.step, p.dir, p.en, p.limit, p.relay1, p.relay2, p.sensor });
+    setup();
+    const uint64_t end = hal::nowUs() + HOME_TIMEOUT_US;
+    while (ctrl.isRunning() && hal::nowUs() < end) {
+      loop();
+      hal::advanceUs(gLoopUs);
+    }
+    if (ctrl.isRunning()) {
+      fprintf(stderr, "HOME did not complete\n");
+      return 1;
+    }
+    sw.baseline_A = baselineCurrent;
+    hal::onPinWrite(nullptr);
+    hal::setAdcSource(nullptr);
+  } else {
+    setup();
+    ctrl.stopMode();
+  }
+
+  // configurations: the grid of the axes, or random draws from them
+  Config defaults(KNOB_COUNT);
+  for (size_t k = 0; k < KNOB_COUNT; ++k) defaults[k] = KNOBS[k].get();
+  if (randomConfigs) {
+    std::mt19937 rng(sw.seed);
+    for (unsigned i = 0; i < randomConfigs; ++i) {
+      Config cfg = defaults;
+      for (const Axis& a : axes) {
+        float v;
+        if (a.range) v = std::uniform_real_distribution<float>(a.lo, a.hi)(rng);
+        else         v = a.values[std::uniform_int_distribution<size_t>(0, a.values.size() - 1)(rng)];
+        cfg[a.knob] = KNOBS[a.knob].integer ? roundf(v) : v;
+      }
+      sw.configs.push_back(cfg);
+    }
+  } else {
+    sw.configs.push_back(defaults);
+    for (const Axis& a : axes) {
+      std::vector<Config> next;
+      for (const Config& base : sw.configs)
+        for (float v : a.values) {
+          Config cfg = base;
+          cfg[a.knob] = v;
+          next.push_back(cfg);
+        }
+      sw.configs.swap(next);
+    }
+  }
+
+  const uint64_t jobs64 = (uint64_t)sw.configs.size() * sw.runsPerConfig();
+  if (jobs64 > 0xFFFFFFFFULL) {
+    fprintf(stderr, "too many jobs (%llu)\n", (unsigned long long)jobs64);
+    return 2;
+  }
+  const uint32_t jobs = (uint32_t)jobs64;
+  workers = (unsigned)std::min<uint64_t>(workers, jobs);
+
+  // shared memory: one work range per worker, one result per job
+  const size_t rangeBytes = sizeof(WorkRange) * workers;
+  const size_t shmBytes = rangeBytes + sizeof(JobResult) * jobs;
+  void* shm = mmap(nullptr, shmBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+  if (shm == MAP_FAILED) {
+    perror("mmap");
+    return 1;
+  }
+  WorkRange* ranges = static_cast<WorkRange*>(shm);
+  JobResult* results = reinterpret_cast<JobResult*>(static_cast<char*>(shm) + rangeBytes);
+  for (unsigned w = 0; w < workers; ++w) {
+    WorkRange* r = new (&ranges[w]) WorkRange;
+    r->v.store(pack((uint32_t)((uint64_t)jobs * w / workers), (uint32_t)((uint64_t)jobs * (w + 1) / workers)));
+    r->steals.store(0);
+    r->jobs.store(0);
+    r->busy_us.store(0);
+  }
+
+  fprintf(stderr, "%zu configurations x %u runs = %u jobs on %u workers\n",
+          sw.configs.size(), sw.runsPerConfig(), jobs, workers);
+  fflush(stdout);
+  fflush(stderr);
+
+  const auto wall0 = std::chrono::steady_clock::now();
+  std::vector<pid_t> pids;
+  for (unsigned w = 0; w < workers; ++w) {
+    pid_t pid = fork();
+    if (pid < 0) {
+      perror("fork");
+      break;
+    }
+    if (pid == 0) {
+      worker(sw, ranges, workers, w, results);
+      _exit(0);
+    }
+    pids.push_back(pid);
+  }
+  bool crashed = pids.size() != workers;
+  for (pid_t pid : pids) {
+    int st = 0;
+    waitpid(pid, &st, 0);
+    if (!WIFEXITED(st) || WEXITSTATUS(st) != 0) crashed = true;
+  }
+  const double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - wall0).count();
+  for (uint32_t j = 0; j < jobs; ++j)
+    if (!results[j].done) crashed = true;
+  if (crashed) {
+    fprintf(stderr, "a worker failed; results incomplete\n");
+    return 1;
+  }
+
+  // rank the configurations
+  std::vector<Score> scores;
+  for (size_t i = 0; i < sw.configs.size(); ++i)
+    scores.push_back(aggregate(results + i * sw.runsPerConfig(), sw.runsPerConfig(), i));
+  std::stable_sort(scores.begin(), scores.end(), [&rank](const Score& a, const Score& b) {
+    for (char k : rank) {
+      const double x = a.key(k), y = b.key(k);
+      if (std::isnan(x) || std::isnan(y)) {
+        if (std::isnan(x) != std::isnan(y)) return std::isnan(y);
+        continue;
+      }
+      if (x != y) return x < y;
+    }
+    return false;
+  });
+
+  printf("rank");
+  for (const Knob& k : KNOBS) printf(",%s", k.name);
+  printf(",runs,fail,early,false,retries,detect_ms,cutoff_ms,cutoff_max_ms,cycle_s\n");
+  for (size_t i = 0; i < scores.size() && (!top || i < top); ++i) {
+    const Score& s = scores[i];
+    printf("%zu", i + 1);
+    for (size_t k = 0; k < KNOB_COUNT; ++k)
+      printf(KNOBS[k].integer ? ",%.0f" : ",%.4g", sw.configs[s.config][k]);
+    printf(",%u,%u,%u,%.3f,%.3f", s.runs, s.fail, s.early, s.falseRate, s.retries);
+    printField(s.detect_ms, ",%.1f");
+    printField(s.cutoff_ms, ",%.1f");
+    printField(s.cutoffMax_ms, ",%.1f");
+    printField(s.cycle_s, ",%.1f");
+    printf("\n");
+  }
+
+  uint64_t busy = 0, busyMax = 0;
+  uint32_t steals = 0;
+  for (unsigned w = 0; w < workers; ++w) {
+    busy += ranges[w].busy_us.load();
+    busyMax = std::max<uint64_t>(busyMax, ranges[w].busy_us.load());
+    steals += ranges[w].steals.load();
+  }
+  fprintf(stderr, "%u jobs in %.2f s (%.1f jobs/s), %u steals, worker utilization %.0f %%\n",
+          jobs, wall, wall > 0 ? jobs / wall : 0.0, steals,
+          busyMax ? 100.0 * busy / ((double)busyMax * workers) : 0.0);
+  munmap(shm, shmBytes);
+  return 0;
+}
@@ -0,0 +1,243 @@
+/**
+ * @file timingsim.cpp
+ * @brief Loop timing of the firmware under the AVR cost model.
+ *
+ * Usage: timingsim [options]
+ *   -m, --modes LIST        menu indexes to run after HOME, e.g. "1,2" (default 1)
+ *   -s, --seed N            plant random seed (default 1)
+ *       --idle-volts V      cell voltage with both relays released (default: per
+ *                           mode, 9 for MOD2 and 0 otherwise)
+ *       --no-cost           cost model off (loop time = --loop-us)
+ *       --loop-us US        virtual time per loop() pass without the cost model (default 50)
+ *
+ * The sketch runs against the EtchCell plant with hal::CostModel enabled, so
+ * each loop() pass takes as long as its Arduino calls and SIM_CYCLES()
+ * annotations would on the ATmega328P. For every mode and phase
+ * (IMode::phase()) the tool reports:
+ *  - loop time: mean, median, 99th percentile and maximum,
+ *  - sampling: ADC samples of the current sensor taken vs. scheduled by its
+ *    interval while it was enabled, and the resulting shortfall,
+ *  - stepping: deviation of each step interval from the commanded period
+ *    (mean, standard deviation, maximum) and steps later than 10 %, measured
+ *    on the simulated STEP pin by the firmware's StepJitter analyser.
+ *
+ * In a STEP_JITTER build the recorder inside StepperDriver runs as well; its
+ * totals (from micros() at each step) are printed for comparison.
+ */
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <getopt.h>
+#include <map>
+#include <string>
+#include <vector>
+#include "CurrentSensor.h"
+#include "EtchCell.h"
+#include "HostHal.h"
+#include "ModeController.h"
+#include "Sketch.h"
+#include "StepJitter.h"
+#include "StepperDriver.h"
+
+namespace {
+
+constexpr uint64_t HOME_TIMEOUT_US = 120ULL * 1000000ULL;
+constexpr uint64_t RUN_TIMEOUT_US  = 3600ULL * 1000000ULL;
+
+/** @brief Loop time histogram resolution and range. */
+constexpr uint32_t HIST_BIN_US = 10;
+constexpr uint32_t HIST_BINS   = 10000;   // 100 ms
+
+/** @brief Timing statistics of one mode phase. */
+struct PhaseStats {
+  uint64_t loops = 0, time_us = 0, maxLoop_us = 0;
+  std::vector<uint32_t> hist = std::vector<uint32_t>(HIST_BINS + 1, 0);
+
+  double   adcScheduled = 0.0;
+  uint64_t adcTaken = 0;
+
+  StepJitter jitter;
+
+  void addLoop(uint64_t dt) {
+    ++loops;
+    time_us += dt;
+    if (dt > maxLoop_us) maxLoop_us = dt;
+    ++hist[dt / HIST_BIN_US < HIST_BINS ? dt / HIST_BIN_US : HIST_BINS];
+  }
+
+  /** @brief Loop time below which a fraction q of the passes fall (bin upper edge). */
+  uint64_t percentile(double q) const {
+    uint64_t want = (uint64_t)ceil(q * loops), seen = 0;
+    for (uint32_t i = 0; i <= HIST_BINS; ++i) {
+      seen += hist[i];
+      if (seen >= want && seen) return i < HIST_BINS ? (uint64_t)(i + 1) * HIST_BIN_US : maxLoop_us;
+    }
+    return maxLoop_us;
+  }
+};
+
+/** @brief Statistics keyed by "MODE/phase" in order of first appearance. */
+std::map<std::string, PhaseStats> gStats;
+std::vector<std::string> gOrder;
+
+PhaseStats& stats(const std::string& key) {
+  auto it = gStats.find(key);
+  if (it == gStats.end()) {
+    gOrder.push_back(key);
+    it = gStats.emplace(key, PhaseStats()).first;
+  }
+  return it->second;
+}
+
+/** @brief Key of what the firmware is doing right now. */
+std::string currentKey() {
+  if (!ctrl.isRunning()) return "MENU";
+  IMode* m = ctrl.mode(ctrl.currentIndex());
+  return std::string(m->name()) + "/" + std::to_string(m->phase());
+}
+
+uint32_t gLoopUs = 50;
+bool     gCost = true;
+uint8_t  gSensorPin = 0;
+
+/** @brief Phase that received the previous step. */
+PhaseStats* gStepPhase = nullptr;
+
+/**
+ * @brief Run loop() with timing bookkeeping until done() or the time limit.
+ *
+ * @return false on timeout.
+ */
+template <typename Pred>
+bool runUntil(Pred done, uint64_t timeout_us) {
+  const uint64_t end = hal::nowUs() + timeout_us;
+  while (!done()) {
+    if (hal::nowUs() >= end) return false;
+    PhaseStats& s = stats(currentKey());
+    const uint64_t t0 = hal::nowUs();
+    const uint64_t a0 = hal::adcReads(gSensorPin);
+    const bool sensing = currentSensor.isEnabled();
+    const unsigned long interval = currentSensor.sampleIntervalUs();
+
+    if (gCost) hal::chargeCycles(hal::costModel().loopOverhead);
+    loop();
+    if (!gCost) hal::advanceUs(gLoopUs);
+    if (stepper.speedMmPerSec() == 0.0f && gStepPhase) gStepPhase->jitter.gap();   // a pause is not a late step
+
+    const uint64_t dt = hal::nowUs() - t0;
+    s.addLoop(dt);
+    if (sensing) {
+      s.adcScheduled += (double)dt / interval;
+      s.adcTaken     += hal::adcReads(gSensorPin) - a0;
+    }
+  }
+  return true;
+}
+
+void usage(const char* argv0) {
+  fprintf(stderr, "usage: %s [-m 1,2] [-s seed] [--idle-volts V] [--no-cost] [--loop-us us]\n", argv0);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  EtchCell::Config cfg;
+  std::vector<int> modes = { 1 };
+  float idleVolts = -1.0f;   // per mode unless given
+
+  static const option longOpts[] = {
+    { "modes",      required_argument, nullptr, 'm' },
+    { "seed",       required_argument, nullptr, 's' },
+    { "idle-volts", required_argument, nullptr, 1 },
+    { "no-cost",    no_argument,       nullptr, 2 },
+    { "loop-us",    required_argument, nullptr, 3 },
+    { nullptr, 0, nullptr, 0 }
+  };
+  int c;
+  while ((c = getopt_long(argc, argv, "m:s:", longOpts, nullptr)) != -1) {
+    switch (c) {
+      case 'm':
+        modes.clear();
+        for (char* tok = strtok(optarg, ","); tok; tok = strtok(nullptr, ",")) modes.push_back(atoi(tok));
+        break;
+      case 's': cfg.seed = (uint32_t)strtoul(optarg, nullptr, 0); break;
+      case 1:   idleVolts = (float)atof(optarg); break;
+      case 2:   gCost = false; break;
+      case 3:   gLoopUs = (uint32_t)atoi(optarg); break;
+      default:  usage(argv[0]); return 2;
+    }
+  }
+  if (gLoopUs == 0) { usage(argv[0]); return 2; }
+
+  hal::CostModel cost;
+  cost.enabled = gCost;
+  hal::setCostModel(cost);
+
+  const SketchPins p = sketchPins();
+  gSensorPin = p.sensor;
+  EtchCell cell(cfg);
+  cell.attach({ p.step, p.dir, p.en, p.limit, p.relay1, p.relay2, p.sensor });
+  sketchAttachLcd();
+
+  // Step intervals are compared with the period commanded at the time of the
+  // step (computed like StepperDriver::update()); a change of speed or phase,
+  // or a stop, starts a new sequence.
+  cell.onStep([](uint64_t t, int) {
+    float v = fabsf(stepper.speedMmPerSec()) * stepper.stepsPerMm();
+    if (v < 1.0f) return;
+    PhaseStats& s = stats(currentKey());
+    if (&s != gStepPhase) {
+      s.jitter.gap();
+      gStepPhase = &s;
+    }
+    s.jitter.onStep((uint32_t)t, (uint32_t)(1000000.0f / v));
+    s.jitter.service();
+  });
+
+  setup();
+  if (!runUntil([] { return !ctrl.isRunning(); }, HOME_TIMEOUT_US)) {
+    fprintf(stderr, "HOME did not complete\n");
+    return 1;
+  }
+  for (int m : modes) {
+    if (m <= 0 || m >= ctrl.modeCount()) { usage(argv[0]); return 2; }
+    cell.setIdleVoltage(idleVolts >= 0.0f ? idleVolts : EtchCell::idleVoltageFor(m, cfg));
+    cell.newTip();
+    ctrl.startMode((uint8_t)m);
+    if (!runUntil([] { return !ctrl.isRunning(); }, RUN_TIMEOUT_US)) {
+      fprintf(stderr, "mode %d did not complete\n", m);
+      ctrl.stopMode();
+    }
+  }
+
+  printf("%-10s %8s %9s | %7s %6s %6s %7s | %9s %9s %6s | %6s %8s %8s %8s %5s\n",
+         "phase", "time_s", "loops", "mean_us", "p50", "p99", "max_us",
+         "adc_sched", "adc_taken", "short%", "steps", "err_us", "sd_us", "maxdev", "late");
+  for (const std::string& k : gOrder) {
+    const PhaseStats& s = gStats[k];
+    if (!s.loops) continue;
+    double shortfall = s.adcScheduled > 0 ? 100.0 * (1.0 - s.adcTaken / s.adcScheduled) : 0.0;
+    StepJitterStats j;
+    s.jitter.stats(j);
+    printf("%-10s %8.2f %9llu | %7.1f %6llu %6llu %7llu | %9.0f %9llu %6.1f | %6u %8.1f %8.1f %8u %5u\n",
+           k.c_str(), s.time_us * 1e-6, (unsigned long long)s.loops,
+           (double)s.time_us / s.loops, (unsigned long long)s.percentile(0.5),
+           (unsigned long long)s.percentile(0.99), (unsigned long long)s.maxLoop_us,
+           s.adcScheduled, (unsigned long long)s.adcTaken, shortfall,
+           (unsigned)j.intervals, j.mean_us, j.sd_us, (unsigned)j.maxDev_us, (unsigned)j.late);
+  }
+#if STEP_JITTER
+  StepJitterStats fj;
+  stepper.jitter()->service();
+  stepper.jitter()->stats(fj);
+  printf("firmware StepJitter: %u intervals, error mean %+.1f us, sd %.1f us, max %u us, %u late, %u lost\n",
+         (unsigned)fj.intervals, fj.mean_us, fj.sd_us, (unsigned)fj.maxDev_us, (unsigned)fj.late, (unsigned)fj.lost);
+#endif
+  if (gCost) {
+    printf("AVR cycles charged: %llu (%.1f %% of the simulated time)\n",
+           (unsigned long long)hal::cycles(),
+           100.0 * hal::cycles() / hal::AVR_CYCLES_PER_US / (double)hal::nowUs());
+  }
+  return 0;
+}
@@ -0,0 +1,162 @@
+/**
+ * @file tracereplay.cpp
+ * @brief Offline replay of recorded sensor traces through the MOD1/MOD2 detection logic.
+ *
+ * Usage: tracereplay [options] TRACE...
+ *   -m, --mode 1|2          mode to run (default: the trace's mode= annotation, else 1)
+ *   -b, --baseline A        baseline current (default: the trace's baseline_A=, else 0)
+ *   -z, --start-z MM        axis position at the start (default: start_z_mm=, else 30)
+ *   -p, --param NAME=VALUE  set a parameter before the runs (name as on the LCD,
+ *                           '_' for a space, e.g. M1_ITHR=0.04); repeatable
+ *       --loop-us US        run loop() every US µs of virtual time instead of
+ *                           skipping the passes in which nothing is due
+ *   -v, --verbose           print the firmware events of each trace to stderr
+ *
+ * A trace is the stream of ADC readings of the current sensor during one run,
+ * as recorded on the bench or by etchsim --trace-dir:
+ *
+ *   # tiptrace
+ *   # mode=1
+ *   # baseline_A=0.0102
+ *   # contact_us=5120000
+ *   # break_us=388420000
+ *   t_us,adc
+ *   0,512
+ *   180,530
+ *   ...
+ *
+ * t_us counts from the start of the mode. '#' lines may appear anywhere and
+ * carry the annotations: contact_us (the tip really touched the electrolyte)
+ * and break_us (the neck really broke) are the reference the detection is
+ * scored against; both are optional. Binary traces (.ttr, TraceFile.h) are
+ * read as well, with the same annotations as metadata.
+ *
+ * The sketch is the one built for the board (CurrentSensor windowing and
+ * timing profiles, MovingAverage, the MOD1/MOD2 state machines and
+ * thresholds, gParams). Each trace starts the mode like the menu does; every
+ * analogRead() of the sensor returns the latest trace sample at or before
+ * that virtual time. The replay is open loop: moving the axis does not change
+ * the recorded current, so the run is only meaningful up to the etch end.
+ *
+ * Per trace one CSV line goes to stdout: when the surface was detected, how
+ * many detections came before the real contact (false triggers), how often
+ * the 30 V validation rejected one, when the etch end was detected and its
+ * latency after the real break (negative: cut off before the break). Times
+ * are resolved to one loop() pass.
+ *
+ * By default the clock jumps from one pass to the next sensor sample or
+ * step (at most 1 ms), so the sketch runs about once per sample instead of
+ * every 50 µs (see replayTrace()). The moving averages count passes, so the
+ * etch end comes later than with --loop-us 50 (closer to the board's loop).
+ */
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include <getopt.h>
+#include "HostHal.h"
+#include "ModeController.h"
+#include "Sketch.h"
+#include "StepperDriver.h"
+#include "TraceReplay.h"
+
+namespace {
+
+uint32_t gLoopUs = 0;     // skip idle passes
+bool     gVerbose = false;
+
+/** @brief Print a time in seconds, or an empty field. */
+void printSec(int64_t us) {
+  if (us == TRACE_NONE) printf(",");
+  else            printf(",%.3f", us * 1e-6);
+}
+
+void usage(const char* argv0) {
+  fprintf(stderr,
+          "usage: %s [-m 1|2] [-b baseline_A] [-z start_mm] [-p NAME=VALUE]...\n"
+          "          [--loop-us us] [-v] TRACE...\n", argv0);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  int   mode = 0;
+  float baseline = -1.0f, startZ = -1.0f;
+  std::vector<const char*> params;
+
+  static const option longOpts[] = {
+    { "mode",     required_argument, nullptr, 'm' },
+    { "baseline", required_argument, nullptr, 'b' },
+    { "start-z",  required_argument, nullptr, 'z' },
+    { "param",    required_argument, nullptr, 'p' },
+    { "loop-us",  required_argument, nullptr, 1 },
+    { "verbose",  no_argument,       nullptr, 'v' },
+    { nullptr, 0, nullptr, 0 }
+  };
+  int c;
+  while ((c = getopt_long(argc, argv, "m:b:z:p:v", longOpts, nullptr)) != -1) {
+    switch (c) {
+      case 'm': mode = atoi(optarg); break;
+      case 'b': baseline = (float)atof(optarg); break;
+      case 'z': startZ = (float)atof(optarg); break;
+      case 'p': params.push_back(optarg); break;
+      case 1:   gLoopUs = (uint32_t)atoi(optarg); break;
+      case 'v': gVerbose = true; break;
+      default:  usage(argv[0]); return 2;
+    }
+  }
+  if (optind >= argc || (mode != 0 && mode != 1 && mode != 2)) {
+    usage(argv[0]);
+    return 2;
+  }
+
+  setup();          // HOME starts automatically; the traces bring their own baseline
+  ctrl.stopMode();
+  for (const char* p : params) {
+    if (!setParamByName(p)) {
+      fprintf(stderr, "unknown parameter: %s\n", p);
+      return 2;
+    }
+  }
+
+  printf("trace,mode,result,samples,duration_s,surface_s,hits,false_triggers,retries,"
+         "contact_s,detect_ms,etch_end_s,break_s,cutoff_ms\n");
+
+  int failed = 0;
+  double virt = 0.0, wall = 0.0;
+  for (int i = optind; i < argc; ++i) {
+    Trace tr;
+    if (!loadTrace(argv[i], tr)) {
+      ++failed;
+      continue;
+    }
+    const int m = mode ? mode : tr.mode ? tr.mode : 1;
+    baselineCurrent = baseline >= 0.0f ? baseline : tr.baseline_A >= 0.0f ? tr.baseline_A : 0.0f;
+    stepper.setPositionMm(startZ >= 0.0f ? startZ : tr.startZ_mm >= 0.0f ? tr.startZ_mm : 30.0f);
+
+    const uint64_t v0 = hal::nowUs();
+    const auto w0 = std::chrono::steady_clock::now();
+    const RunOutcome r = replayTrace(tr, m, gLoopUs, gVerbose);
+    wall += std::chrono::duration<double>(std::chrono::steady_clock::now() - w0).count();
+    virt += (hal::nowUs() - v0) * 1e-6;
+
+    printf("%s,%d,%s,%zu,%.3f", tr.path.c_str(), m, r.result, tr.t_us.size(), tr.t_us.back() * 1e-6);
+    printSec(r.surface_us);
+    printf(",%u,", r.surfaceHits);
+    if (tr.contact_us != TRACE_NONE) printf("%u", r.falseTriggers);
+    printf(",%u", r.retries);
+    printSec(tr.contact_us);
+    if (tr.contact_us != TRACE_NONE && r.surface_us != TRACE_NONE) printf(",%.1f", (r.surface_us - tr.contact_us) * 1e-3);
+    else                                                printf(",");
+    printSec(r.etchEnd_us);
+    printSec(tr.break_us);
+    if (tr.break_us != TRACE_NONE && r.etchEnd_us != TRACE_NONE) printf(",%.1f", (r.etchEnd_us - tr.break_us) * 1e-3);
+    else                                             printf(",");
+    printf("\n");
+    fflush(stdout);
+  }
+
+  fprintf(stderr, "replayed %.0f s in %.0f ms (%.0fx real time)\n", virt, wall * 1e3,
+          wall > 0 ? virt / wall : 0.0);
+  return failed ? 1 : 0;
+}
@@ -0,0 +1,145 @@
+/**
+ * @file tipagg.cpp
+ * @brief Capture telemetry from many controllers at once (TelemetryHub).
+ *
+ * Usage: tipagg [options] DEVICE...
+ *   DEVICE                  NAME=PATH, or PATH (named after its last component)
+ *   -o, --out-dir DIR       directory of the NAME.csv files, created with its
+ *                           parents if missing (default .)
+ *   -j, --workers N         decoding threads (default: one per CPU)
+ *   -b, --baud N            baud rate (default 115200)
+ *   -d, --decimation N      send MSG_TELEM_CTRL to start streaming, one record
+ *                           every N windows, and to stop it on exit (default:
+ *                           the devices are assumed to be streaming already)
+ *       --pool N            read buffers of 4 KiB shared by all devices (default 1024)
+ *       --queue N           read buffers one device may have waiting (default 64)
+ *
+ * Runs until SIGINT/SIGTERM or until every port has closed, then prints one
+ * CSV line per device on stdout: bytes, frames, records, records lost in the
+ * sequence, drops reported by the device, discarded frames and backpressure
+ * pauses. The files are in the tipctl stream format with a host_us column in
+ * front (see TelemetryHub.h).
+ */
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <getopt.h>
+#include <unistd.h>
+#include "TelemetryHub.h"
+#include "TipClient.h"
+
+namespace {
+
+TelemetryHub* gHub = nullptr;
+
+void usage(const char* argv0) {
+  fprintf(stderr,
+          "usage: %s [-o dir] [-j workers] [-b baud] [-d decimation] [--pool n] [--queue n] "
+          "[NAME=]DEVICE...\n", argv0);
+}
+
+/** @brief Write a MSG_TELEM_CTRL request (the reply is skipped by the hub). */
+bool telemetryCtrl(int fd, bool enable, uint8_t decimation) {
+  const uint8_t body[2] = { uint8_t(enable ? 1 : 0), decimation };
+  const std::vector<uint8_t> f = encodeFrame(MSG_TELEM_CTRL, 1, body, sizeof(body));
+  return write(fd, f.data(), f.size()) == (ssize_t)f.size();
+}
+
+struct Port {
+  std::string name;
+  std::string path;
+  int         fd = -1;
+};
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  HubConfig cfg;
+  unsigned baud = 115200;
+  unsigned decimation = 0;
+
+  static const option longOpts[] = {
+    { "out-dir",    required_argument, nullptr, 'o' },
+    { "workers",    required_argument, nullptr, 'j' },
+    { "baud",       required_argument, nullptr, 'b' },
+    { "decimation", required_argument, nullptr, 'd' },
+    { "pool",       required_argument, nullptr, 1 },
+    { "queue",      required_argument, nullptr, 2 },
+    { nullptr, 0, nullptr, 0 }
+  };
+  int c;
+  while ((c = getopt_long(argc, argv, "o:j:b:d:", longOpts, nullptr)) != -1) {
+    switch (c) {
+      case 'o': cfg.outDir = optarg; break;
+      case 'j': cfg.workers = (unsigned)strtoul(optarg, nullptr, 10); break;
+      case 'b': baud = (unsigned)strtoul(optarg, nullptr, 10); break;
+      case 'd': decimation = (unsigned)strtoul(optarg, nullptr, 10); break;
+      case 1:   cfg.poolBlocks = strtoul(optarg, nullptr, 10); break;
+      case 2:   cfg.deviceBlocks = strtoul(optarg, nullptr, 10); break;
+      default:  usage(argv[0]); return 2;
+    }
+  }
+  if (optind >= argc || decimation > 255) {
+    usage(argv[0]);
+    return 2;
+  }
+
+  std::vector<Port> ports;
+  for (int i = optind; i < argc; ++i) {
+    Port p;
+    const char* eq = strchr(argv[i], '=');
+    p.path = eq ? eq + 1 : argv[i];
+    p.name = eq ? std::string(argv[i], size_t(eq - argv[i])) : p.path.substr(p.path.rfind('/') + 1);
+    ports.push_back(p);
+  }
+
+  TelemetryHub hub(cfg);
+  int rc = 0;
+  for (Port& p : ports) {
+    std::string err;
+    p.fd = openSerial(p.path, baud, err);
+    if (p.fd < 0 || !hub.addDevice(p.name, p.fd)) {
+      fprintf(stderr, "tipagg: %s\n", p.fd < 0 ? err.c_str() : hub.lastError().c_str());
+      rc = 1;
+      break;
+    }
+    if (decimation && !telemetryCtrl(p.fd, true, (uint8_t)decimation)) {
+      fprintf(stderr, "tipagg: %s: start request not sent\n", p.name.c_str());
+    }
+  }
+
+  const bool ran = rc == 0;
+  if (ran) {
+    gHub = &hub;
+    struct sigaction sa{};
+    sa.sa_handler = [](int) { gHub->stop(); };
+    sigaction(SIGINT, &sa, nullptr);
+    sigaction(SIGTERM, &sa, nullptr);
+
+    if (!hub.run()) {
+      fprintf(stderr, "tipagg: %s\n", hub.lastError().c_str());
+      rc = 1;
+    }
+    signal(SIGINT, SIG_DFL);
+    signal(SIGTERM, SIG_DFL);
+  }
+
+  for (const Port& p : ports) {
+    if (p.fd < 0) continue;
+    if (decimation) telemetryCtrl(p.fd, false, 1);   // fails harmlessly on a closed port
+    close(p.fd);
+  }
+
+  if (!ran) return rc;
+  printf("device,bytes,frames,records,lost,device_drops,rx_errors,pauses\n");
+  for (const HubDeviceStats& s : hub.stats()) {
+    printf("%s,%llu,%llu,%llu,%u,%u,%u,%llu\n", s.name.c_str(), (unsigned long long)s.bytes,
+           (unsigned long long)s.frames, (unsigned long long)s.records, s.lost, s.deviceDrops,
+           s.rxErrors, (unsigned long long)s.pauses);
+  }
+  fprintf(stderr, "tipagg: peak %zu of %zu read buffers in use\n", hub.peakBlocks(), cfg.poolBlocks);
+  return rc;
+}
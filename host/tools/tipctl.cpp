@@ -0,0 +1,272 @@
+/**
+ * @file tipctl.cpp
+ * @brief Command-line front end for TipClient.
+ *
+ * Usage:
+ *     tipctl [-d device] [-b baud] command [args]
+ *
+ * Commands:
+ *     ping               check the link and show protocol/table sizes
+ *     status             show mode, current and position
+ *     params             list all parameters
+ *     get <idx>          show one parameter
+ *     set <idx> <value>  set a parameter (clamped by the device)
+ *     save               persist parameters to EEPROM
+ *     start <mode>       start a mode (menu index)
+ *     stop               stop the running mode
+ *     stream [decim]     print telemetry as CSV until interrupted
+ *     log                dump the device event log
+ *     runs               print the run history as CSV
+ *     prof [clear]       show the loop profiler (LOOP_PROFILE firmware), optionally reset it
+ *     jitter [clear]     show the step timing statistics (STEP_JITTER firmware), optionally reset them
+ */
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "TipClient.h"
+#include "TipTelemetry.h"
+
+namespace {
+
+void usage() {
+  std::fprintf(stderr,
+    "usage: tipctl [-d device] [-b baud] ping|status|params|get N|set N V|save|start N|stop|stream [D]|log|runs|prof [clear]|jitter [clear]\n");
+}
+
+void printParam(const TipParam& p) {
+  std::printf("%2u  %-12s  %.*f  [%g .. %g]\n",
+              p.index, p.name.c_str(), p.decimals, p.value, p.minVal, p.maxVal);
+}
+
+const char* eventName(uint8_t id) {
+  switch (id) {
+    case EV_BOOT:          return "boot";
+    case EV_MODE_START:    return "mode-start";
+    case EV_MODE_STOP:     return "mode-stop";
+    case EV_STATE:         return "state";
+    case EV_RELAY:         return "relay";
+    case EV_SURFACE:       return "surface";
+    case EV_CONTACT_OK:    return "contact-ok";
+    case EV_CONTACT_RETRY: return "contact-retry";
+    case EV_ETCH_END:      return "etch-end";
+    case EV_Z_LIMIT:       return "z-limit";
+    case EV_HOME_SWITCH:   return "home-switch";
+    case EV_BASELINE:      return "baseline";
+    case EV_PULSE:         return "pulse";
+    case EV_RUN_LOST:      return "run-lost";
+    default:               return "?";
+  }
+}
+
+/**
+ * @brief Print the device event log, one event per line.
+ */
+bool dumpLog(TipClient& c) {
+  std::vector<TipEvent> events;
+  uint16_t lost = 0;
+  if (!c.readLog(events, &lost)) return false;
+  if (lost) std::printf("(%u older events overwritten)\n", lost);
+
+  uint32_t prev = events.empty() ? 0 : events.front().t_ms;
+  for (const TipEvent& e : events) {
+    std::printf("%10u ms  +%6u  %-13s ", e.t_ms, e.t_ms - prev, eventName(e.id));
+    if (e.id == EV_STATE) std::printf("mode %d state %d\n", (e.arg >> 8) & 0xFF, e.arg & 0xFF);
+    else                  std::printf("%d\n", e.arg);
+    prev = e.t_ms;
+  }
+  return true;
+}
+
+/**
+ * @brief Print the run history as CSV, oldest run first.
+ */
+bool dumpRuns(TipClient& c) {
+  std::vector<TipRun> runs;
+  if (!c.readRuns(runs)) return false;
+  std::printf("run,mode_id,result,surface_z_mm,plunge_mm,etch_s,end_current_mA,retries,pulses\n");
+  for (const TipRun& r : runs) {
+    std::printf("%u,%u,%s,%.2f,%.2f,%.1f,%.2f,%u,%u\n",
+                r.seq, r.modeId, r.result == RUN_OK ? "ok" : "abort",
+                r.surfaceZ_mm, r.plunge_mm, r.etch_s, r.endCurrent_mA, r.retries, r.pulses);
+  }
+  return true;
+}
+
+const char* probeName(uint8_t id) {
+  switch (id) {
+    case PROF_LOOP:    return "loop";
+    case PROF_SENSOR:  return "sensor";
+    case PROF_KEYS:    return "keys";
+    case PROF_MODE:    return "mode-step";
+    case PROF_STEPPER: return "stepper";
+    case PROF_LCD:     return "lcd";
+    case PROF_HOST:    return "host";
+    case PROF_STORE:   return "store";
+    default:           return "?";
+  }
+}
+
+/**
+ * @brief Print the loop profiler: one line per probe, then the histograms.
+ *
+ * @param c      Connected client.
+ * @param clear  Reset the probes after reading them.
+ */
+bool dumpProfile(TipClient& c, bool clear) {
+  std::vector<TipProbe> probes;
+  if (!c.readProfile(probes, clear)) return false;
+
+  std::printf("%-10s %6s %9s %9s %9s\n", "probe", "n", "avg_us", "max_us", "total_ms");
+  for (const TipProbe& p : probes) {
+    std::printf("%-10s %6u %9.1f %9.1f %9.1f\n", probeName(p.id), p.count,
+                p.count ? p.total_us / p.count : 0.0, p.max_us, p.total_us / 1000.0);
+  }
+
+  // Bin k >= 1 holds 2^(k-1) .. 2^k - 1 ticks.
+  std::printf("\n%-10s", "from_us");
+  for (unsigned k = 0; k < PROF_HIST_BINS; ++k) {
+    double from = k ? (1u << (k - 1)) * (PROF_TICK_NS / 1000.0) : 0.0;
+    std::printf(" %6g", from);
+  }
+  std::printf("\n");
+  for (const TipProbe& p : probes) {
+    std::printf("%-10s", probeName(p.id));
+    for (unsigned k = 0; k < PROF_HIST_BINS; ++k) std::printf(" %6u", p.hist[k]);
+    std::printf("\n");
+  }
+  return true;
+}
+
+/**
+ * @brief Print the step timing statistics and the latest step intervals.
+ *
+ * @param c      Connected client.
+ * @param clear  Reset the statistics after reading them.
+ */
+bool dumpJitter(TipClient& c, bool clear) {
+  TipStepJitter j;
+  if (!c.readStepJitter(j, clear)) return false;
+  std::printf("intervals %u  period %u us  error mean %+.1f us  sd %.1f us  max %u us  late %u  lost %u\n",
+              j.intervals, j.period_us, j.mean_us, j.sd_us, j.maxDev_us, j.late, j.lost);
+  std::printf("recent intervals (us, newest first):");
+  for (uint32_t v : j.recent) {
+    if (v) std::printf(" %u", v);
+    else   std::printf(" |");
+  }
+  std::printf("\n");
+  return true;
+}
+
+volatile std::sig_atomic_t gStop = 0;
+
+/**
+ * @brief Stream telemetry records to stdout as CSV until SIGINT.
+ *
+ * @param c           Connected client.
+ * @param decimation  One record every N sensor windows.
+ */
+bool stream(TipClient& c, uint8_t decimation) {
+  TelemetryDecoder dec;
+  auto print = [&](const Frame& f) {
+    TelemetrySample s;
+    if (!dec.push(f, s)) return;
+    std::printf("%u,%u,%u,%d,%u,%d,%u,%u,%u,%u\n",
+                s.seq, s.t_us, s.window, s.i_uA, s.vpp_mV, s.steps,
+                s.modeId, s.phase, s.flags, s.key ? 1 : 0);
+  };
+  // Records arriving while a request waits for its reply.
+  c.onUnsolicited(print);
+
+  std::signal(SIGINT, [](int) { gStop = 1; });
+  std::printf("seq,t_us,window,i_uA,vpp_mV,steps,mode_id,phase,flags,key\n");
+  if (!c.setTelemetry(true, decimation)) return false;
+
+  Frame f;
+  while (!gStop) {
+    if (c.readFrame(f, 200)) print(f);
+  }
+
+  TipTelemetryCtrl st;
+  bool ok = c.setTelemetry(false, 1, &st);
+  std::fprintf(stderr, "tipctl: %u lost on the link, %u dropped on the device\n",
+               dec.lost(), ok ? st.drops : dec.deviceDrops());
+  return ok;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  std::string dev  = "/dev/ttyACM0";
+  unsigned    baud = 115200;
+
+  int i = 1;
+  for (; i < argc && argv[i][0] == '-'; ++i) {
+    if (!std::strcmp(argv[i], "-d") && i + 1 < argc)      dev  = argv[++i];
+    else if (!std::strcmp(argv[i], "-b") && i + 1 < argc) baud = (unsigned)std::strtoul(argv[++i], nullptr, 10);
+    else { usage(); return 2; }
+  }
+  if (i >= argc) { usage(); return 2; }
+
+  std::string cmd = argv[i++];
+  auto arg = [&](int k) -> const char* { return i + k < argc ? argv[i + k] : nullptr; };
+
+  TipClient c;
+  if (!c.open(dev, baud)) {
+    std::fprintf(stderr, "tipctl: %s\n", c.lastError().c_str());
+    return 1;
+  }
+
+  bool ok = false;
+  if (cmd == "ping") {
+    uint8_t ver, np, nm;
+    if ((ok = c.ping(&ver, &np, &nm))) std::printf("protocol %u, %u parameters, %u modes\n", ver, np, nm);
+  } else if (cmd == "status") {
+    TipStatus st;
+    if ((ok = c.status(st))) {
+      std::printf("t=%u ms  %s mode %u (id %u)  sensor %s  I=%.4f A  Z=%.3f mm\n",
+                  st.t_ms, st.running ? "running" : "menu", st.mode, st.modeId,
+                  st.sensor ? "on" : "off", st.current_A, st.z_mm);
+    }
+  } else if (cmd == "params") {
+    uint8_t np = 0;
+    ok = c.ping(nullptr, &np, nullptr);
+    for (uint8_t k = 0; ok && k < np; ++k) {
+      TipParam p;
+      if ((ok = c.getParam(k, p))) printParam(p);
+    }
+  } else if (cmd == "get" && arg(0)) {
+    TipParam p;
+    if ((ok = c.getParam((uint8_t)std::atoi(arg(0)), p))) printParam(p);
+  } else if (cmd == "set" && arg(0) && arg(1)) {
+    TipParam p;
+    if ((ok = c.setParam((uint8_t)std::atoi(arg(0)), (float)std::atof(arg(1)), &p))) printParam(p);
+  } else if (cmd == "save") {
+    ok = c.saveParams();
+  } else if (cmd == "start" && arg(0)) {
+    ok = c.startMode((uint8_t)std::atoi(arg(0)));
+  } else if (cmd == "stop") {
+    ok = c.stopMode();
+  } else if (cmd == "log") {
+    ok = dumpLog(c);
+  } else if (cmd == "runs") {
+    ok = dumpRuns(c);
+  } else if (cmd == "jitter") {
+    ok = dumpJitter(c, arg(0) && !std::strcmp(arg(0), "clear"));
+  } else if (cmd == "prof") {
+    ok = dumpProfile(c, arg(0) && !std::strcmp(arg(0), "clear"));
+  } else if (cmd == "stream") {
+    ok = stream(c, (uint8_t)(arg(0) ? std::atoi(arg(0)) : 1));
+  } else {
+    usage();
+    return 2;
+  }
+
+  if (!ok) {
+    std::fprintf(stderr, "tipctl: %s\n", c.lastError().c_str());
+    return 1;
+  }
+  return 0;
+}
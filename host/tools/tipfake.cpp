@@ -0,0 +1,330 @@
+/**
+ * @file tipfake.cpp
+ * @brief Simulated controllers on pseudo-terminals, for testing tipagg.
+ *
+ * Usage: tipfake [options]
+ *   -n, --devices N         pseudo-terminals to create (default 8)
+ *   -r, --rate R            records per second per device at decimation 1
+ *                           (default 25: one per 40 ms sensor window)
+ *   -t, --time S            seconds to run, then close the terminals (default 10)
+ *   -b, --baud N            line rate per device, N / 10 bytes/s as on an 8N1
+ *                           link (0 = as fast as the pty takes it; default 115200)
+ *       --always            stream from the start instead of waiting for a
+ *                           MSG_TELEM_CTRL request
+ *
+ * Prints one "devNN=/dev/pts/M" line per terminal on stdout (the tipagg
+ * device syntax), then behaves like TelemetryStreamer: a key record first,
+ * every 32 records and after a drop, delta records otherwise, and records
+ * that do not fit the 64-byte transmit buffer dropped and counted. A slow
+ * reader therefore shows up as sequence gaps and device drops, exactly as
+ * with a real controller. MSG_TELEM_CTRL requests are answered.
+ *
+ * At the end the transmit buffers are drained, the terminals closed once the
+ * reader has taken everything (the reader sees end of file) and one CSV line
+ * per device printed on stderr: records generated, sent and dropped, and the
+ * drops followed by a sent record (the ones a reader can see as sequence
+ * gaps). A reader that lost nothing has records == sent and lost == gaps.
+ */
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <getopt.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <termios.h>
+#include <unistd.h>
+#include "FrameCodec.h"
+
+namespace {
+
+/** @brief Transmit buffer of the simulated device (the Arduino serial buffer). */
+constexpr size_t TX_BUFFER = 64;
+
+/** @brief Records between key records (TelemetryStreamer::KEY_INTERVAL). */
+constexpr uint8_t KEY_INTERVAL = 32;
+
+/** @brief Longest wait for the reader to empty the terminals at the end (ms). */
+constexpr int DRAIN_MS = 5000;
+
+volatile std::sig_atomic_t gStop = 0;
+
+uint64_t nowNs() {
+  timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return uint64_t(ts.tv_sec) * 1000000000u + uint64_t(ts.tv_nsec);
+}
+
+struct Sample {
+  uint32_t t_us   = 0;
+  uint16_t window = 0;
+  int32_t  i_uA   = 0;
+  uint16_t vpp_mV = 0;
+  int32_t  steps  = 0;
+};
+
+/** @brief One simulated controller. */
+struct FakeDevice {
+  std::string  name;
+  std::string  path;
+  int          master = -1;
+  int          slave  = -1;   ///< Kept open so the master never sees EIO.
+  FrameDecoder rx;
+  Frame        req;
+
+  bool     enabled  = false;
+  uint8_t  decim    = 1;
+  uint64_t nextNs   = 0;      ///< Time of the next record.
+  uint32_t rng      = 1;
+
+  Sample   cur, base;
+  uint16_t seq      = 0;
+  uint16_t drops    = 0;
+  uint8_t  sinceKey = 0;
+  bool     needKey  = true;
+
+  std::vector<uint8_t> tx;    ///< Frames not yet written to the master.
+  bool     limited  = true;   ///< Line rate applies.
+  double   credit   = 0.0;    ///< Bytes the line may carry now.
+
+  uint64_t records  = 0;
+  uint64_t sent     = 0;
+  uint64_t dropped  = 0;      ///< drops, without the 16-bit wrap.
+  uint64_t gaps     = 0;      ///< Drops followed by a sent record.
+};
+
+uint32_t nextRandom(uint32_t& s) {
+  s ^= s << 13;
+  s ^= s >> 17;
+  s ^= s << 5;
+  return s;
+}
+
+/** @brief Move queued bytes to the master within the line rate. */
+void transmit(FakeDevice& d) {
+  if (d.tx.empty()) return;
+  size_t n = d.tx.size();
+  if (d.limited) n = std::min(n, (size_t)d.credit);
+  if (n == 0) return;
+  const ssize_t w = write(d.master, d.tx.data(), n);
+  if (w <= 0) return;   // the pty is full: the reader is behind
+  d.tx.erase(d.tx.begin(), d.tx.begin() + w);
+  if (d.limited) d.credit -= (double)w;
+}
+
+/**
+ * @brief Queue a frame unless the transmit buffer is too full (like HostLink::send).
+ *
+ * The line drains the buffer meanwhile, as the UART does on the device.
+ */
+bool send(FakeDevice& d, uint8_t type, uint8_t reqId, const uint8_t* body, size_t len, bool force) {
+  const std::vector<uint8_t> f = encodeFrame(type, reqId, body, len);
+  if (!force && d.tx.size() + f.size() > TX_BUFFER) {
+    transmit(d);
+    if (d.tx.size() + f.size() > TX_BUFFER) return false;
+  }
+  d.tx.insert(d.tx.end(), f.begin(), f.end());
+  return true;
+}
+
+/** @brief Produce one telemetry record, as TelemetryStreamer::service() does. */
+void record(FakeDevice& d, uint64_t t_ns) {
+  Sample s;
+  s.t_us   = uint32_t(t_ns / 1000) / PROTO_TDELTA_T_UNIT_US * PROTO_TDELTA_T_UNIT_US;
+  s.window = uint16_t(d.cur.window + d.decim);
+  s.i_uA   = std::max<int32_t>(0, d.cur.i_uA + int32_t(nextRandom(d.rng) % 201) - 100);
+  s.vpp_mV = uint16_t(std::max<int32_t>(0, d.cur.vpp_mV + int32_t(nextRandom(d.rng) % 21) - 10));
+  s.steps  = d.cur.steps + int32_t(nextRandom(d.rng) % 3);
+  d.cur = s;
+  const uint8_t flags = TELEM_SENSOR | TELEM_RUNNING;
+  ++d.records;
+
+  bool sent = false;
+  if (d.needKey || d.sinceKey >= KEY_INTERVAL) {
+    uint8_t b[PROTO_TKEY_SIZE];
+    protoPutU16(b + PROTO_TKEY_SEQ,    d.seq);
+    protoPutU32(b + PROTO_TKEY_T_US,   s.t_us);
+    protoPutU16(b + PROTO_TKEY_WINDOW, s.window);
+    protoPutU32(b + PROTO_TKEY_I_UA,   (uint32_t)s.i_uA);
+    protoPutU16(b + PROTO_TKEY_VPP_MV, s.vpp_mV);
+    protoPutU32(b + PROTO_TKEY_STEPS,  (uint32_t)s.steps);
+    b[PROTO_TKEY_MODE_ID] = 1;
+    b[PROTO_TKEY_PHASE]   = 1;
+    b[PROTO_TKEY_FLAGS]   = flags;
+    protoPutU16(b + PROTO_TKEY_DROPS,  d.drops);
+    if ((sent = send(d, MSG_TELEM_KEY, 0, b, sizeof(b), false))) {
+      d.sinceKey = 0;
+      d.needKey  = false;
+    }
+  } else {
+    uint8_t b[PROTO_TDELTA_SIZE];
+    protoPutU16(b + PROTO_TDELTA_SEQ,     d.seq);
+    protoPutU16(b + PROTO_TDELTA_DT,      uint16_t((s.t_us - d.base.t_us) / PROTO_TDELTA_T_UNIT_US));
+    b[PROTO_TDELTA_DWINDOW] = uint8_t(s.window - d.base.window);
+    protoPutU16(b + PROTO_TDELTA_DI_UA,   uint16_t(int16_t(s.i_uA - d.base.i_uA)));
+    protoPutU16(b + PROTO_TDELTA_DVPP_MV, uint16_t(int16_t(s.vpp_mV - d.base.vpp_mV)));
+    protoPutU16(b + PROTO_TDELTA_DSTEPS,  uint16_t(int16_t(s.steps - d.base.steps)));
+    b[PROTO_TDELTA_PHASE] = 1;
+    b[PROTO_TDELTA_FLAGS] = flags;
+    if ((sent = send(d, MSG_TELEM_DELTA, 0, b, sizeof(b), false))) ++d.sinceKey;
+  }
+
+  if (sent) {
+    d.base = s;
+    d.gaps = d.dropped;
+    ++d.sent;
+  } else {
+    ++d.drops;
+    ++d.dropped;
+    d.needKey = true;
+  }
+  ++d.seq;
+}
+
+/** @brief Answer the requests received from the reader. */
+void receive(FakeDevice& d, uint64_t now, double periodNs) {
+  uint8_t buf[256];
+  ssize_t n;
+  while ((n = read(d.master, buf, sizeof(buf))) > 0) {
+    for (ssize_t i = 0; i < n; ++i) {
+      if (!d.rx.push(buf[i], d.req) || d.req.type != MSG_TELEM_CTRL || d.req.body.size() < 2) continue;
+      const bool on = d.req.body[0] != 0;
+      d.decim = d.req.body[1] ? d.req.body[1] : 1;
+      if (on && !d.enabled) {
+        d.needKey = true;
+        d.nextNs  = now + uint64_t(periodNs * d.decim);
+      }
+      d.enabled = on;
+
+      uint8_t r[PROTO_TCTRL_SIZE];
+      r[PROTO_TCTRL_ENABLED] = d.enabled ? 1 : 0;
+      r[PROTO_TCTRL_DECIM]   = d.decim;
+      protoPutU16(r + PROTO_TCTRL_DROPS, d.drops);
+      protoPutU16(r + PROTO_TCTRL_SEQ,   d.seq);
+      send(d, MSG_TELEM_CTRL | MSG_REPLY, d.req.reqId, r, sizeof(r), true);
+    }
+  }
+}
+
+/** @brief Create a pseudo-terminal pair in raw mode. */
+bool openPty(FakeDevice& d) {
+  d.master = posix_openpt(O_RDWR | O_NOCTTY | O_NONBLOCK);
+  if (d.master < 0 || grantpt(d.master) != 0 || unlockpt(d.master) != 0) return false;
+  const char* name = ptsname(d.master);
+  if (!name) return false;
+  d.path  = name;
+  d.slave = open(name, O_RDWR | O_NOCTTY | O_NONBLOCK);
+  if (d.slave < 0) return false;
+  termios tio{};
+  if (tcgetattr(d.slave, &tio) == 0) {
+    cfmakeraw(&tio);
+    tcsetattr(d.slave, TCSANOW, &tio);
+  }
+  return true;
+}
+
+void usage(const char* argv0) {
+  fprintf(stderr, "usage: %s [-n devices] [-r records/s] [-t seconds] [-b baud] [--always]\n", argv0);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  unsigned count = 8;
+  double rate = 25.0, seconds = 10.0;
+  unsigned baud = 115200;
+  bool always = false;
+
+  static const option longOpts[] = {
+    { "devices", required_argument, nullptr, 'n' },
+    { "rate",    required_argument, nullptr, 'r' },
+    { "time",    required_argument, nullptr, 't' },
+    { "baud",    required_argument, nullptr, 'b' },
+    { "always",  no_argument,       nullptr, 1 },
+    { nullptr, 0, nullptr, 0 }
+  };
+  int c;
+  while ((c = getopt_long(argc, argv, "n:r:t:b:", longOpts, nullptr)) != -1) {
+    switch (c) {
+      case 'n': count = (unsigned)strtoul(optarg, nullptr, 10); break;
+      case 'r': rate = atof(optarg); break;
+      case 't': seconds = atof(optarg); break;
+      case 'b': baud = (unsigned)strtoul(optarg, nullptr, 10); break;
+      case 1:   always = true; break;
+      default:  usage(argv[0]); return 2;
+    }
+  }
+  if (optind != argc || count == 0 || rate <= 0.0 || seconds <= 0.0) {
+    usage(argv[0]);
+    return 2;
+  }
+
+  std::vector<FakeDevice> devs(count);
+  const double periodNs = 1e9 / rate;
+  const uint64_t start = nowNs();
+  for (unsigned i = 0; i < count; ++i) {
+    FakeDevice& d = devs[i];
+    if (!openPty(d)) {
+      fprintf(stderr, "tipfake: pseudo-terminal: %s\n", strerror(errno));
+      return 1;
+    }
+    char name[16];
+    snprintf(name, sizeof(name), "dev%02u", i);
+    d.name    = name;
+    d.rng     = 2463534242u + i;
+    d.cur.i_uA   = 200000;
+    d.cur.vpp_mV = 500;
+    d.enabled = always;
+    d.limited = baud != 0;
+    d.nextNs  = start + (uint64_t)periodNs;
+    printf("%s=%s\n", d.name.c_str(), d.path.c_str());
+  }
+  fflush(stdout);
+
+  std::signal(SIGINT, [](int) { gStop = 1; });
+  std::signal(SIGTERM, [](int) { gStop = 1; });
+  std::vector<pollfd> fds(count);
+  for (unsigned i = 0; i < count; ++i) fds[i] = { devs[i].master, POLLIN, 0 };
+
+  const uint64_t end = start + uint64_t(seconds * 1e9);
+  const double bytesPerNs = baud / 10.0 * 1e-9;
+  uint64_t last = start, drainUntil = 0;
+  for (;;) {
+    poll(fds.data(), fds.size(), 1);
+    const uint64_t now = nowNs();
+    const bool streaming = !gStop && now < end;
+    if (!streaming && !drainUntil) drainUntil = now + DRAIN_MS * 1000000ull;
+
+    bool busy = false;
+    for (FakeDevice& d : devs) {
+      receive(d, now, periodNs);
+      for (; streaming && d.enabled && d.nextNs <= now; d.nextNs += uint64_t(periodNs * d.decim)) {
+        record(d, d.nextNs - start);
+      }
+      // the line carries at most one transmit buffer per gap between loops
+      if (baud) d.credit = std::min(d.credit + (now - last) * bytesPerNs, (double)TX_BUFFER);
+      transmit(d);
+
+      int pending = 0;
+      ioctl(d.slave, FIONREAD, &pending);
+      busy |= !d.tx.empty() || pending > 0;
+    }
+    last = now;
+    if (drainUntil && (!busy || now >= drainUntil)) break;
+  }
+
+  fprintf(stderr, "device,records,sent,dropped,gaps\n");
+  for (FakeDevice& d : devs) {
+    fprintf(stderr, "%s,%llu,%llu,%llu,%llu\n", d.name.c_str(), (unsigned long long)d.records,
+            (unsigned long long)d.sent, (unsigned long long)d.dropped, (unsigned long long)d.gaps);
+    close(d.master);
+    close(d.slave);
+  }
+  return 0;
+}
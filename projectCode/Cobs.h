@@ -0,0 +1,82 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * @brief Consistent Overhead Byte Stuffing (COBS).
+ *
+ * COBS removes all 0x00 bytes from a block at a cost of one byte per 254
+ * bytes (plus one), so 0x00 can be used as an unambiguous frame delimiter on
+ * the serial line. A receiver that loses sync simply waits for the next 0x00.
+ *
+ * Header-only and free of Arduino dependencies; shared by the firmware and
+ * the host tools.
+ */
+
+/**
+ * @brief Worst-case encoded size of a block.
+ *
+ * @param n Unencoded length.
+ * @return Maximum encoded length (without the 0x00 delimiter).
+ */
+constexpr size_t cobsMaxEncoded(size_t n) { return n + n / 254 + 1; }
+
+/**
+ * @brief Encode a block.
+ *
+ * @param src  Input data.
+ * @param len  Input length.
+ * @param dst  Output buffer with room for cobsMaxEncoded(len) bytes; must not
+ *             overlap src.
+ * @return Encoded length (no delimiter is appended).
+ */
+inline size_t cobsEncode(const uint8_t* src, size_t len, uint8_t* dst) {
+  size_t  out     = 1;   // first code byte is at dst[0]
+  size_t  codePos = 0;
+  uint8_t code    = 1;
+
+  for (size_t i = 0; i < len; ++i) {
+    if (src[i] == 0) {
+      dst[codePos] = code;
+      codePos = out++;
+      code = 1;
+    } else {
+      dst[out++] = src[i];
+      if (++code == 0xFF) {
+        dst[codePos] = code;
+        codePos = out++;
+        code = 1;
+      }
+    }
+  }
+  dst[codePos] = code;
+  return out;
+}
+
+/**
+ * @brief Decode a block (without its 0x00 delimiter).
+ *
+ * The output is never longer than the input and is written behind the read
+ * position, so decoding in place (dst == src) is allowed.
+ *
+ * @param src  Encoded data.
+ * @param len  Encoded length.
+ * @param dst  Output buffer (may be src).
+ * @return Decoded length, or 0 if the input is malformed.
+ */
+inline size_t cobsDecode(const uint8_t* src, size_t len, uint8_t* dst) {
+  size_t in = 0, out = 0;
+
+  while (in < len) {
+    uint8_t code = src[in++];
+    if (code == 0 || in + code - 1 > len) return 0;
+
+    for (uint8_t i = 1; i < code; ++i) {
+      uint8_t b = src[in++];
+      if (b == 0) return 0;
+      dst[out++] = b;
+    }
+    if (code != 0xFF && in < len) dst[out++] = 0;
+  }
+  return out;
+}
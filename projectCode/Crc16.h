@@ -0,0 +1,45 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * @brief CRC-16/CCITT-FALSE helpers (polynomial 0x1021, initial value 0xFFFF).
+ *
+ * Used to validate the records stored in EEPROM (parameters, run history)
+ * and the frames of the serial protocol (ProtocolDefs.h). The bitwise form
+ * is used on purpose: it needs no lookup table, so it costs no flash or RAM
+ * beyond the code itself, and the records and frames it protects are only a
+ * few dozen bytes long.
+ */
+
+/** @brief Initial CRC value. */
+static constexpr uint16_t CRC16_INIT = 0xFFFF;
+
+/**
+ * @brief Feed one byte into a running CRC.
+ *
+ * @param crc  CRC so far (start with CRC16_INIT).
+ * @param b    Next data byte.
+ * @return Updated CRC.
+ */
+inline uint16_t crc16Update(uint16_t crc, uint8_t b) {
+  crc ^= (uint16_t)b << 8;
+  for (uint8_t i = 0; i < 8; ++i) {
+    crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+  }
+  return crc;
+}
+
+/**
+ * @brief Compute the CRC of a memory block.
+ *
+ * @param data  Pointer to the data.
+ * @param len   Number of bytes.
+ * @param crc   Initial value (allows chaining several blocks).
+ * @return CRC of the block.
+ */
+inline uint16_t crc16(const void* data, size_t len, uint16_t crc = CRC16_INIT) {
+  const uint8_t* p = static_cast<const uint8_t*>(data);
+  while (len--) crc = crc16Update(crc, *p++);
+  return crc;
+}
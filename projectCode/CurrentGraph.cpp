@@ -0,0 +1,137 @@
+#include "CurrentGraph.h"
+
+/**
+ * @file CurrentGraph.cpp
+ * @brief Implementation of the CGRAM-based current bar graph and sparkline.
+ *
+ * The widget keeps a copy of the bitmaps it last sent to CGRAM. Every update
+ * recomputes the bitmaps of the glyphs marked dirty and queues only the
+ * contiguous range of pixel rows that actually changed.
+ */
+
+/**
+ * @brief Start drawing the widget on an LCD row.
+ *
+ * @param row LCD row (0 or 1).
+ */
+void CurrentGraph::begin(uint8_t row) {
+  row_ = row;
+  memset(spark_, 0, sizeof(spark_));
+  periodMax_   = 0;
+  lastPointMs_ = millis();
+  bar_         = 0xFF;
+
+  glyphUnknown_ = 0xFF;
+  glyphDirty_   = (uint8_t)((1u << GLYPHS) - 1);
+
+  // Sparkline cells show the glyph codes; their bitmaps carry the data.
+  lcd_.setCursor(0, row_);
+  for (uint8_t c = 0; c < SPARK_CELLS; ++c) {
+    lcd_.write((char)(glyph0_ + c));
+  }
+  lcd_.write(' ');
+}
+
+/**
+ * @brief Convert a current into a pixel level.
+ *
+ * @param I_A       Current in amperes.
+ * @param maxLevel  Highest level.
+ * @return Rounded level in [0, maxLevel].
+ */
+uint8_t CurrentGraph::level_(float I_A, uint8_t maxLevel) const {
+  if (fullScale_ <= 0.0f || I_A <= 0.0f) return 0;
+  SIM_CYCLES(760);   // fdiv, fmul, fadd, fcmp, float -> uint8_t
+  float l = I_A / fullScale_ * maxLevel + 0.5f;
+  if (l >= maxLevel) return maxLevel;
+  return (uint8_t)l;
+}
+
+/**
+ * @brief Feed a new current value.
+ *
+ * @param I_A Current in amperes.
+ */
+void CurrentGraph::update(float I_A) {
+  // Bar graph: redraw only on a change of the pixel level.
+  uint8_t b = level_(I_A, BAR_PIXELS);
+  if (b != bar_) {
+    bar_ = b;
+    drawBar_();
+    glyphDirty_ |= (uint8_t)(1u << SPARK_CELLS);   // partial-cell glyph
+  }
+
+  // Sparkline: one point per period, keeping the peak of the period.
+  uint8_t p = level_(I_A, 8);
+  if (p > periodMax_) periodMax_ = p;
+
+  uint32_t now = millis();
+  if ((uint32_t)(now - lastPointMs_) >= sparkMs_) {
+    lastPointMs_ = now;
+    memmove(spark_, spark_ + 1, SPARK_POINTS - 1);
+    spark_[SPARK_POINTS - 1] = periodMax_;
+    periodMax_ = 0;
+    glyphDirty_ |= (uint8_t)((1u << SPARK_CELLS) - 1);
+  }
+
+  if (glyphDirty_) flushGlyphs_();
+}
+
+/**
+ * @brief Draw the bar cells: full blocks, one partial glyph, then blanks.
+ */
+void CurrentGraph::drawBar_() {
+  uint8_t full = bar_ / 5;
+  uint8_t part = bar_ % 5;
+
+  lcd_.setCursor(BAR_COL, row_);
+  for (uint8_t c = 0; c < BAR_CELLS; ++c) {
+    if (c < full)                  lcd_.write((char)0xFF);
+    else if (c == full && part)    lcd_.write((char)(glyph0_ + SPARK_CELLS));
+    else                           lcd_.write(' ');
+  }
+}
+
+/**
+ * @brief Recompute dirty glyphs and queue their changed pixel rows.
+ */
+void CurrentGraph::flushGlyphs_() {
+  for (uint8_t g = 0; g < GLYPHS; ++g) {
+    uint8_t bit = (uint8_t)(1u << g);
+    if (!(glyphDirty_ & bit)) continue;
+
+    uint8_t rows[8];
+    if (g < SPARK_CELLS) {
+      // Two points per cell: pixel columns 0-1 and 3-4, filled from the bottom.
+      uint8_t l0 = spark_[2 * g];
+      uint8_t l1 = spark_[2 * g + 1];
+      for (uint8_t r = 0; r < 8; ++r) {
+        uint8_t h = 8 - r;   // height a point needs to light row r
+        rows[r] = (uint8_t)((l0 >= h ? 0x18 : 0) | (l1 >= h ? 0x03 : 0));
+      }
+    } else {
+      // Partially filled bar cell: 'part' columns lit from the left.
+      uint8_t part = (bar_ == 0xFF) ? 0 : bar_ % 5;
+      uint8_t m = (uint8_t)((0x1F << (5 - part)) & 0x1F);
+      for (uint8_t r = 0; r < 8; ++r) rows[r] = m;
+    }
+
+    // Contiguous range of rows that differ from what CGRAM holds.
+    int8_t first = -1, last = -1;
+    for (uint8_t r = 0; r < 8; ++r) {
+      if ((glyphUnknown_ & bit) || rows[r] != glyphRows_[g][r]) {
+        if (first < 0) first = r;
+        last = r;
+      }
+    }
+
+    if (first >= 0) {
+      uint8_t n = (uint8_t)(last - first + 1);
+      if (lcd_.outputFree() < n + 1) return;   // no room: retry on next update()
+      lcd_.setGlyphRows(glyph0_ + g, first, rows + first, n);
+      memcpy(glyphRows_[g], rows, 8);
+      glyphUnknown_ &= (uint8_t)~bit;
+    }
+    glyphDirty_ &= (uint8_t)~bit;
+  }
+}
@@ -0,0 +1,144 @@
+#pragma once
+#include <Arduino.h>
+#include "Lcd1602.h"
+
+/**
+ * @brief Live current display built from LCD custom characters.
+ *
+ * CurrentGraph draws one LCD row as:
+ *
+ *     col  0..3   : 8-point sparkline of recent RMS values (2 points per cell),
+ *     col  4      : blank separator,
+ *     col  5..15  : horizontal bar graph of the latest value (5 px per cell).
+ *
+ * It uses 5 CGRAM glyphs (4 for the sparkline, 1 for the partially filled
+ * bar cell); full bar cells use the built-in block character 0xFF.
+ *
+ * Rendering is incremental:
+ *  - the row's character cells go through the Lcd1602 framebuffer, so only
+ *    cells whose glyph code changes are sent,
+ *  - glyph bitmaps are cached and only changed pixel rows are rewritten in
+ *    CGRAM (the cells showing a glyph update by themselves).
+ * If the LCD output queue has no room, glyph updates are deferred to a later
+ * update() call instead of blocking.
+ */
+class CurrentGraph {
+public:
+  /** @brief Number of points in the sparkline. */
+  static constexpr uint8_t SPARK_POINTS = 8;
+
+  /** @brief Number of LCD cells used by the sparkline (2 points per cell). */
+  static constexpr uint8_t SPARK_CELLS  = SPARK_POINTS / 2;
+
+  /** @brief First column of the bar graph. */
+  static constexpr uint8_t BAR_COL      = SPARK_CELLS + 1;
+
+  /** @brief Number of LCD cells used by the bar graph. */
+  static constexpr uint8_t BAR_CELLS    = Lcd1602::COLS - BAR_COL;
+
+  /** @brief Bar graph resolution in pixels. */
+  static constexpr uint8_t BAR_PIXELS   = BAR_CELLS * 5;
+
+  /** @brief Number of CGRAM glyphs used by the widget. */
+  static constexpr uint8_t GLYPHS       = SPARK_CELLS + 1;
+
+  /**
+   * @brief Construct a new CurrentGraph.
+   *
+   * @param lcd           LCD to draw on.
+   * @param fullScale_A   Current shown as a full bar / full-height point (A).
+   * @param sparkPeriodMs Time between two sparkline points (ms).
+   * @param firstGlyph    First CGRAM slot used (slots firstGlyph..firstGlyph+4).
+   */
+  CurrentGraph(Lcd1602& lcd, float fullScale_A, uint16_t sparkPeriodMs = 250, uint8_t firstGlyph = 0)
+    : lcd_(lcd), fullScale_(fullScale_A), sparkMs_(sparkPeriodMs), glyph0_(firstGlyph) {}
+
+  /**
+   * @brief Start drawing on the given LCD row.
+   *
+   * Clears the sparkline history, places the glyph codes in the sparkline
+   * cells and forces all glyph rows to be written on the next update()
+   * (another screen may have redefined the glyphs in between).
+   *
+   * @param row LCD row (0 or 1) to use.
+   */
+  void begin(uint8_t row);
+
+  /**
+   * @brief Feed the latest RMS current and refresh the display incrementally.
+   *
+   * Cheap enough to call on every loop pass: the bar is redrawn only when its
+   * pixel level changes, a sparkline point is appended every sparkPeriodMs
+   * (the maximum seen during the period), and CGRAM rows are written only
+   * when they differ from the cached bitmaps.
+   *
+   * @param I_A Current in amperes.
+   */
+  void update(float I_A);
+
+  /**
+   * @brief Change the full-scale current.
+   *
+   * @param fullScale_A Current corresponding to a full bar (A).
+   */
+  void setFullScale(float fullScale_A) { fullScale_ = fullScale_A; }
+
+private:
+  /**
+   * @brief Map a current to a pixel level 0..maxLevel.
+   *
+   * @param I_A       Current in amperes.
+   * @param maxLevel  Highest level.
+   * @return Level clamped to [0, maxLevel].
+   */
+  uint8_t level_(float I_A, uint8_t maxLevel) const;
+
+  /**
+   * @brief Write the bar cells for the current bar level into the framebuffer.
+   */
+  void drawBar_();
+
+  /**
+   * @brief Compute glyph bitmaps and queue changed CGRAM rows.
+   *
+   * Glyphs whose rows cannot be queued because the LCD output queue is full
+   * stay pending and are retried on the next call.
+   */
+  void flushGlyphs_();
+
+  /** @brief LCD used for output. */
+  Lcd1602& lcd_;
+
+  /** @brief Full-scale current (A). */
+  float fullScale_;
+
+  /** @brief Sparkline point period (ms). */
+  uint16_t sparkMs_;
+
+  /** @brief First CGRAM slot used. */
+  uint8_t glyph0_;
+
+  /** @brief LCD row the widget is drawn on. */
+  uint8_t row_ = 1;
+
+  /** @brief Sparkline levels (0..8), oldest first. */
+  uint8_t spark_[SPARK_POINTS];
+
+  /** @brief Highest level seen during the current sparkline period. */
+  uint8_t periodMax_ = 0;
+
+  /** @brief millis() timestamp of the last sparkline point. */
+  uint32_t lastPointMs_ = 0;
+
+  /** @brief Current bar level in pixels (0..BAR_PIXELS), 0xFF = not drawn yet. */
+  uint8_t bar_ = 0xFF;
+
+  /** @brief Cached bitmaps of the glyphs as last queued to the LCD. */
+  uint8_t glyphRows_[GLYPHS][8];
+
+  /** @brief Bit i set = glyph i may differ from its cached bitmap. */
+  uint8_t glyphDirty_ = 0;
+
+  /** @brief Bit i set = CGRAM content of glyph i is unknown and must be written fully. */
+  uint8_t glyphUnknown_ = 0xFF;
+};
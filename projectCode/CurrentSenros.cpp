@@ -14,6 +14,7 @@
  */
 
 #include "CurrentSensor.h"
+#include "SimCycles.h"
 
 /**
  * @brief Constructs a new CurrentSensor instance.
@@ -58,15 +59,63 @@ void CurrentSensor::begin() {
   unsigned long now = micros();
   windowStart_    = now;
   nextSampleTime_ = now;
+  resetWindow_();
+}
+
+/**
+ * @brief Resets the statistics accumulated for the current integration window.
+ */
+void CurrentSensor::resetWindow_() {
   adcMin_ = 1023;
   adcMax_ = 0;
 
-  // Reset RMS statistics for the current window.
   sumV_ = 0.0f;
   sumV2_ = 0.0f;
   nSamples_ = 0;
 }
 
+/**
+ * @brief Changes the integration window and sampling interval at runtime.
+ *
+ * If the sensor is running, the request is latched and applied by update()
+ * when the current window closes, so the window in progress keeps its
+ * original length and the next one starts seamlessly at its end. If the
+ * sensor is disabled, there is no window in progress: the new timing is
+ * applied at once and the window is restarted from now.
+ *
+ * Zero values are rejected (replaced by 1 µs) to keep the scheduling
+ * arithmetic in update() well defined.
+ *
+ * @param window_us    New integration window in microseconds.
+ * @param interval_us  New sampling interval in microseconds.
+ */
+void CurrentSensor::setTiming(unsigned long window_us, unsigned long interval_us) {
+  if (window_us == 0)   window_us = 1;
+  if (interval_us == 0) interval_us = 1;
+
+  if (!enabled_) {
+    sampleWindow_us_   = window_us;
+    sampleInterval_us_ = interval_us;
+    timingPending_     = false;
+
+    unsigned long now = micros();
+    windowStart_    = now;
+    nextSampleTime_ = now;
+    resetWindow_();
+    return;
+  }
+
+  // Already running with this timing: drop any older pending request.
+  if (window_us == sampleWindow_us_ && interval_us == sampleInterval_us_) {
+    timingPending_ = false;
+    return;
+  }
+
+  pendingWindow_us_   = window_us;
+  pendingInterval_us_ = interval_us;
+  timingPending_      = true;
+}
+
 /**
  * @brief Performs one non-blocking update step of the RMS measurement.
  *
@@ -83,6 +132,8 @@ void CurrentSensor::begin() {
  *    micros() overflow.
  *  - The AC RMS is computed as sqrt( <v^2> - <v>^2 ), i.e. the RMS of the
  *    AC component after removing DC offset, and then scaled by k_cal_.
+ *  - A timing change requested through setTiming() takes effect when the
+ *    current window closes.
  */
 void CurrentSensor::update() {
   if (!enabled_) {
@@ -97,6 +148,7 @@ void CurrentSensor::update() {
     nextSampleTime_ += sampleInterval_us_;
     int adc = analogRead(pin_);
     //adc = 750;
+    SIM_CYCLES(1100);   // float conversion, Vref/adcMax division, two fadd, two fmul
 
     if (adc < adcMin_) adcMin_ = adc;
     if (adc > adcMax_) adcMax_ = adc;
@@ -111,6 +163,7 @@ void CurrentSensor::update() {
   // Check if the current integration window has elapsed.
   if ((int32_t)(now - windowStart_) >= (int32_t)sampleWindow_us_) {
     windowStart_ += sampleWindow_us_;
+    SIM_CYCLES(2700);   // Vpp, two means, variance, sqrtf, calibration
 
     // Compute peak-to-peak span and corresponding voltage.
     int span = adcMax_ - adcMin_;
@@ -132,12 +185,17 @@ void CurrentSensor::update() {
     }
 
     // Reset statistics for the next integration window.
-    adcMin_ = 1023;
-    adcMax_ = 0;
-
-    sumV_ = 0.0f;
-    sumV2_ = 0.0f;
-    nSamples_ = 0;
+    resetWindow_();
+    ++windowSeq_;
+
+    // Apply a pending timing change at the window boundary. windowStart_ has
+    // already been advanced to the end of the closed window, so the new window
+    // starts exactly there and the sampling phase is preserved.
+    if (timingPending_) {
+      sampleWindow_us_   = pendingWindow_us_;
+      sampleInterval_us_ = pendingInterval_us_;
+      timingPending_     = false;
+    }
   }
 }
 
@@ -152,6 +210,7 @@ void CurrentSensor::update() {
  * @return The corrected RMS current in amperes, guaranteed to be non-negative.
  */
 float CurrentSensor::correctedIrms() const {
+    SIM_CYCLES(160);
     float I = Irms_ - baselineCurrent;
     if (I < 0.0f) I = 0.0f; // Clamp negative results caused by noise or offsets.
     return I;
@@ -11,6 +11,19 @@
  */
 extern float baselineCurrent;
 
+/**
+ * @brief Sampling configuration (window length and sample interval) of a CurrentSensor.
+ *
+ * Different phases of the etching process need different trade-offs between
+ * noise and latency: a long window gives a quiet reading (baseline), a short
+ * window reacts faster (end of etching). A SensorTiming bundles both values
+ * so that modes can switch between named profiles with a single call.
+ */
+struct SensorTiming {
+  unsigned long window_us;    ///< Duration of the RMS integration window (µs).
+  unsigned long interval_us;  ///< Time between consecutive ADC samples (µs).
+};
+
 /**
  * @brief Non-blocking RMS current measurement helper class.
  *
@@ -119,7 +132,70 @@ public:
    */
   bool isEnabled() const { return enabled_; }
 
+  /**
+   * @brief Change the integration window and sampling interval at runtime.
+   *
+   * While the sensor is running, the new timing is only latched and becomes
+   * effective at the next window boundary: the window in progress is finished
+   * with its original length, and the next window starts exactly where it
+   * ended. This keeps the sampling phase continuous and never produces a
+   * truncated or mixed-length window.
+   *
+   * While the sensor is disabled, the new timing is applied immediately and
+   * the window is restarted.
+   *
+   * @param window_us    New integration window in microseconds (> 0).
+   * @param interval_us  New sampling interval in microseconds (> 0).
+   */
+  void setTiming(unsigned long window_us, unsigned long interval_us);
+
+  /**
+   * @brief Convenience overload taking a SensorTiming profile.
+   *
+   * @param t Timing profile to apply (see setTiming(unsigned long, unsigned long)).
+   */
+  void setTiming(const SensorTiming& t) { setTiming(t.window_us, t.interval_us); }
+
+  /**
+   * @brief Get the integration window currently in effect.
+   *
+   * A change requested through setTiming() is not reflected here until it
+   * has been applied at the next window boundary.
+   *
+   * @return Window length in microseconds.
+   */
+  unsigned long windowUs() const { return sampleWindow_us_; }
+
+  /**
+   * @brief Get the sampling interval currently in effect.
+   *
+   * @return Sampling interval in microseconds.
+   */
+  unsigned long sampleIntervalUs() const { return sampleInterval_us_; }
+
+  /**
+   * @brief Sequence number of the last completed window.
+   *
+   * Incremented each time a window closes and new Irms/Vpp values become
+   * available; consumers compare it with a stored copy to detect new results.
+   *
+   * @return Window counter (wraps at 65536).
+   */
+  uint16_t windowSeq() const { return windowSeq_; }
+
+  /**
+   * @brief End time of the last completed window.
+   *
+   * @return micros() timestamp at which the last window closed (nominal).
+   */
+  unsigned long windowEndUs() const { return windowStart_; }
+
 private:
+  /**
+   * @brief Reset the per-window statistics (min/max and RMS accumulators).
+   */
+  void resetWindow_();
+
   /** @brief Analog input pin used for sensor reading. */
   uint8_t pin_;
 
@@ -141,6 +217,15 @@ private:
   /** @brief Sampling interval in microseconds between ADC reads. */
   unsigned long sampleInterval_us_;
 
+  /** @brief Window length requested by setTiming(), applied at the next window boundary. */
+  unsigned long pendingWindow_us_   = 0;
+
+  /** @brief Sampling interval requested by setTiming(), applied at the next window boundary. */
+  unsigned long pendingInterval_us_ = 0;
+
+  /** @brief True while a timing change is waiting for the current window to close. */
+  bool timingPending_ = false;
+
   /** @brief Timestamp of the next scheduled ADC sample (in microseconds). */
   unsigned long nextSampleTime_ = 0;
 
@@ -159,6 +244,9 @@ private:
   /** @brief Last computed RMS current in amperes (uncorrected). */
   float Irms_ = 0.0f;
 
+  /** @brief Number of completed windows (see windowSeq()). */
+  uint16_t windowSeq_ = 0;
+
   /**
    * @brief Accumulator of voltage samples Σ v for RMS computation.
    *
@@ -0,0 +1,168 @@
+#include "DiagMode.h"
+
+/**
+ * @file DiagMode.cpp
+ * @brief Implementation of the diagnostics screens.
+ */
+
+#if LOOP_PROFILE || STEP_JITTER
+
+#if LOOP_PROFILE
+/** @brief Four-letter probe labels, indexed by PROF_*. */
+static const char PROBE_NAMES[PROF_PROBES][5] PROGMEM = {
+    "LOOP", "SENS", "KEYS", "MODE", "STEP", "LCD ", "HOST", "STOR"
+};
+#endif
+
+/**
+ * @brief Show the first screen.
+ */
+void DiagMode::begin() {
+    sel_        = 0;
+    page_       = 0;
+    needRedraw_ = true;
+}
+
+/**
+ * @brief Cleanup when leaving the mode.
+ */
+void DiagMode::end() {
+    lcd_.clear();
+}
+
+/**
+ * @brief Draw the selected screen (see the class description for the layouts).
+ */
+void DiagMode::draw() {
+    lcd_.clear();
+    lcd_.setCursor(0, 0);
+    if (sel_ < PROBE_SCREENS) drawProbe(sel_);
+    else                      drawJitter();
+}
+
+/**
+ * @brief Draw a profiler probe.
+ *
+ * @param id Probe (PROF_*).
+ */
+void DiagMode::drawProbe(uint8_t id) {
+#if LOOP_PROFILE
+    const ProfProbe& p = gLoopProfiler.probe(id);
+    char name[5];
+    memcpy_P(name, PROBE_NAMES[id], sizeof(name));
+
+    lcd_.print(name);
+
+    if (page_ == 0) {
+        lcd_.print(F(" avg "));
+        if (p.count) lcd_.print(p.total * (PROF_TICK_NS / 1000.0f) / p.count, 1);
+        else         lcd_.write('-');
+        lcd_.write('u');
+        lcd_.setCursor(0, 1);
+        lcd_.print(F("max "));
+        lcd_.print((unsigned long)(((uint32_t)p.max * PROF_TICK_NS + 999) / 1000));
+        lcd_.print(F("us"));
+        return;
+    }
+
+    lcd_.print(F(" n "));
+    lcd_.print((unsigned long)p.count);
+    lcd_.setCursor(0, 1);
+    uint16_t full = 0;
+    for (uint8_t i = 0; i < PROF_HIST_BINS; ++i) if (p.hist[i] > full) full = p.hist[i];
+    for (uint8_t i = 0; i < PROF_HIST_BINS && i < Lcd1602::COLS; ++i) {
+        uint16_t h = p.hist[i];
+        lcd_.write(h ? (char)('0' + ((uint32_t)h * 9 + full - 1) / full) : '.');
+    }
+#else
+    (void)id;
+#endif
+}
+
+/**
+ * @brief Draw the step recorder figures.
+ */
+void DiagMode::drawJitter() {
+#if STEP_JITTER
+    StepJitter* j = stepper_.jitter();
+    if (!j) {
+        lcd_.print(F("STEP <none>"));
+        return;
+    }
+    StepJitterStats st;
+    j->service();
+    j->stats(st);
+
+    if (page_ == 0) {
+        lcd_.print(F("STEP T "));
+        lcd_.print((unsigned long)st.period_us);
+        lcd_.print(F("us"));
+        lcd_.setCursor(0, 1);
+        lcd_.print(F("sd "));
+        lcd_.print(st.sd_us, 1);
+        lcd_.print(F(" mx "));
+        lcd_.print((unsigned long)st.maxDev_us);
+    } else {
+        lcd_.print(F("late "));
+        lcd_.print((unsigned long)st.late);
+        lcd_.print(F(" lost "));
+        lcd_.print((unsigned long)st.lost);
+        lcd_.setCursor(0, 1);
+        lcd_.print(F("avg "));
+        if (st.mean_us >= 0.0f) lcd_.write('+');
+        lcd_.print(st.mean_us, 1);
+        lcd_.print(F(" n "));
+        lcd_.print((unsigned long)st.intervals);
+    }
+#endif
+}
+
+/**
+ * @brief Execute one step of the diagnostics UI.
+ *
+ * @return true when the mode should end.
+ */
+bool DiagMode::step() {
+    KeyEvent ev;
+    if (keys_.next(ev) && (ev.type == KeyEventType::Press || ev.type == KeyEventType::Repeat)) {
+        switch (ev.key) {
+        case Key::UP:
+            sel_ = sel_ ? sel_ - 1 : SCREENS - 1;
+            needRedraw_ = true;
+            break;
+        case Key::DOWN:
+            sel_ = (sel_ + 1) % SCREENS;
+            needRedraw_ = true;
+            break;
+        case Key::RIGHT:
+            page_       = page_ ? 0 : 1;
+            needRedraw_ = true;
+            break;
+        case Key::LEFT:
+            if (ev.type == KeyEventType::Press) {
+#if LOOP_PROFILE
+                gLoopProfiler.clearAll();
+#endif
+#if STEP_JITTER
+                if (stepper_.jitter()) stepper_.jitter()->clear();
+#endif
+                needRedraw_ = true;
+            }
+            break;
+        case Key::SELECT:
+            return ev.type == KeyEventType::Press;
+        default:
+            break;
+        }
+    }
+
+    uint32_t now = millis();
+    if (needRedraw_ || now - lastDrawMs_ >= REDRAW_MS) {
+        draw();
+        lastDrawMs_ = now;
+        needRedraw_ = false;
+    }
+    return false;
+}
+
+#endif
@@ -0,0 +1,128 @@
+#pragma once
+#include "LoopProfiler.h"
+#include "StepJitter.h"
+
+#if LOOP_PROFILE || STEP_JITTER
+#include "IMode.h"
+#include "Lcd1602.h"
+#include "KeypadShield.h"
+#include "StepperDriver.h"
+#include <Arduino.h>
+
+/**
+ * @brief LCD view of the diagnostic recorders (LOOP_PROFILE / STEP_JITTER builds).
+ *
+ * With LOOP_PROFILE, one screen per profiler probe:
+ * - Page 1: "LOOP avg 512.5u" / "max 1234us"
+ * - Page 2: "LOOP n 65534"    / log2 histogram, one column per bin
+ *
+ * In the histogram column k shows bin k (see PROF_HIST_BINS: column 1 is
+ * 0.5 µs, column 2 is 1 µs, column 3 is 2 µs ... column 15 is 8 ms and more)
+ * as a digit 1..9 relative to the fullest bin, '.' for an empty bin.
+ * Outer probes include the cost of the probes inside them (see
+ * LoopProfiler.h): LOOP reads about 9 µs high, MODE about 1.3 µs.
+ *
+ * With STEP_JITTER, a screen for the step recorder (StepJitter):
+ * - Page 1: "STEP T 166666us" / "sd 12.3 mx 456"  (commanded period, error sd and max)
+ * - Page 2: "late 3 lost 0"   / "avg +1.2 n 1234" (late steps, mean error, intervals)
+ *
+ * UP/DOWN: previous/next screen, RIGHT: switch page, LEFT: clear all
+ * recorders, SELECT: back to the menu.
+ */
+class DiagMode : public IMode {
+public:
+    /**
+     * @brief Construct a new DiagMode instance.
+     *
+     * @param lcd      LCD used for the diagnostics screens.
+     * @param keys     Keypad used for navigation.
+     * @param stepper  Stepper driver whose jitter recorder is shown (STEP_JITTER).
+     */
+    DiagMode(Lcd1602& lcd, KeypadShield& keys, StepperDriver& stepper)
+        : lcd_(lcd), keys_(keys), stepper_(stepper) {}
+
+    /**
+     * @brief Name of this mode.
+     *
+     * @return Constant C-string "DIAG".
+     */
+    const char* name() const override { return "DIAG"; }
+
+    /**
+     * @brief Get the capability descriptor of this mode.
+     *
+     * @return Reads the keypad itself (incl. SELECT), needs no sensor or stepper.
+     */
+    ModeCaps caps() const override { return { ModeId::Diag, MODE_OWNS_SELECT, 250 }; }
+
+    /**
+     * @brief Show the first screen.
+     */
+    void begin() override;
+
+    /**
+     * @brief Execute one non-blocking step of the diagnostics UI.
+     *
+     * @return true when SELECT was pressed.
+     */
+    bool step() override;
+
+    /**
+     * @brief Cleanup when leaving the mode (clears the LCD).
+     */
+    void end() override;
+
+private:
+    /** @brief Interval between redraws of the live figures (ms). */
+    static constexpr uint16_t REDRAW_MS = 500;
+
+#if LOOP_PROFILE
+    /** @brief Screens of the profiler probes. */
+    static constexpr uint8_t PROBE_SCREENS = PROF_PROBES;
+#else
+    static constexpr uint8_t PROBE_SCREENS = 0;
+#endif
+
+    /** @brief Number of screens (probes, then the step recorder). */
+    static constexpr uint8_t SCREENS = PROBE_SCREENS + (STEP_JITTER ? 1 : 0);
+
+    /**
+     * @brief Draw the selected screen.
+     */
+    void draw();
+
+    /**
+     * @brief Draw a profiler probe screen.
+     *
+     * @param id Probe (PROF_*).
+     */
+    void drawProbe(uint8_t id);
+
+    /**
+     * @brief Draw the step recorder screen.
+     */
+    void drawJitter();
+
+    /** @brief LCD used for output. */
+    Lcd1602&      lcd_;
+
+    /** @brief Keypad used for input. */
+    KeypadShield& keys_;
+
+    /** @brief Stepper driver (jitter recorder). */
+    StepperDriver& stepper_;
+
+    /** @brief Selected screen. */
+    uint8_t sel_ = 0;
+
+    /** @brief Page shown (0 or 1). */
+    uint8_t page_ = 0;
+
+    /** @brief millis() of the last redraw. */
+    uint32_t lastDrawMs_ = 0;
+
+    /** @brief Screen must be redrawn on the next step(). */
+    bool needRedraw_ = true;
+};
+
+#endif
@@ -0,0 +1,49 @@
+#pragma once
+#include <stdint.h>
+
+/**
+ * @brief Allocation of the 1 KB EEPROM of the ATmega328P.
+ *
+ * All persistent data lives at fixed addresses defined here, so that the
+ * individual stores never overlap. Regions are sized for wear-leveling: each
+ * one holds several copies (slots) of its record that are written in turn.
+ */
+
+/** @brief Start of the parameter store region (AllParams records). */
+static constexpr uint16_t EE_PARAMS_ADDR  = 0;
+
+/** @brief Size of one parameter record slot in bytes. */
+static constexpr uint16_t EE_PARAMS_SLOT  = 48;
+
+/** @brief Number of parameter record slots (round-robin). */
+static constexpr uint8_t  EE_PARAMS_SLOTS = 4;
+
+/** @brief First address after the parameter store region. */
+static constexpr uint16_t EE_PARAMS_END   = EE_PARAMS_ADDR + EE_PARAMS_SLOT * EE_PARAMS_SLOTS;
+
+/** @brief Start of the recipe profile region (ProfileStore records). */
+static constexpr uint16_t EE_PROFILES_ADDR  = EE_PARAMS_END;
+
+/** @brief Size of one profile slot in bytes. */
+static constexpr uint16_t EE_PROFILE_SLOT   = 48;
+
+/** @brief Number of named profiles. */
+static constexpr uint8_t  EE_PROFILE_SLOTS  = 6;
+
+/** @brief First address after the profile region. */
+static constexpr uint16_t EE_PROFILES_END   = EE_PROFILES_ADDR + EE_PROFILE_SLOT * EE_PROFILE_SLOTS;
+
+/** @brief Start of the run history region (RunLog records, upper half of the EEPROM). */
+static constexpr uint16_t EE_RUNS_ADDR  = 512;
+
+/** @brief Size of one run record slot in bytes. */
+static constexpr uint16_t EE_RUN_SLOT   = 16;
+
+/** @brief Number of run record slots (circular, oldest overwritten first). */
+static constexpr uint8_t  EE_RUN_SLOTS  = 32;
+
+/** @brief First address after the run history region. */
+static constexpr uint16_t EE_RUNS_END   = EE_RUNS_ADDR + EE_RUN_SLOT * EE_RUN_SLOTS;
+
+static_assert(EE_RUNS_ADDR >= EE_PROFILES_END, "run history overlaps the profiles");
+static_assert(EE_RUNS_END <= 1024, "run history exceeds the EEPROM");
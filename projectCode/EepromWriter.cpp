@@ -0,0 +1,77 @@
+#include "EepromWriter.h"
+
+#if defined(__AVR__)
+#include <avr/eeprom.h>
+#else
+#include <EEPROM.h>
+#endif
+
+/**
+ * @file EepromWriter.cpp
+ * @brief Implementation of the byte-per-call EEPROM writer.
+ *
+ * On AVR the avr-libc primitives are used directly: eeprom_is_ready() tells
+ * whether the previous write cycle has finished, and eeprom_write_byte() only
+ * starts a cycle and returns. On other targets the Arduino EEPROM library is
+ * used, which is always "ready".
+ */
+
+/**
+ * @brief Start writing a block.
+ *
+ * @param addr  EEPROM destination address.
+ * @param src   Source data in RAM; must stay valid until busy() is false.
+ * @param len   Number of bytes.
+ * @return false if the writer is still busy with another block.
+ */
+bool EepromWriter::start(uint16_t addr, const uint8_t* src, uint16_t len) {
+  if (busy()) return false;
+  addr_ = addr;
+  src_  = src;
+  left_ = len;
+  return true;
+}
+
+/**
+ * @brief Handle at most one byte of the current block.
+ *
+ * The byte is compared with the EEPROM content first; a write cycle is
+ * started only if it differs.
+ */
+void EepromWriter::service() {
+  if (left_ == 0) return;
+
+#if defined(__AVR__)
+  if (!eeprom_is_ready()) return;
+  uint8_t* p = (uint8_t*)(uintptr_t)addr_;
+  if (eeprom_read_byte(p) != *src_) {
+    eeprom_write_byte(p, *src_);
+    ++written_;
+  }
+#else
+  if (EEPROM.read(addr_) != *src_) {
+    EEPROM.write(addr_, *src_);
+    ++written_;
+  }
+#endif
+
+  ++addr_;
+  ++src_;
+  --left_;
+}
+
+/**
+ * @brief Read a block synchronously.
+ *
+ * @param addr  EEPROM source address.
+ * @param dst   Destination buffer.
+ * @param len   Number of bytes.
+ */
+void EepromWriter::read(uint16_t addr, void* dst, uint16_t len) {
+#if defined(__AVR__)
+  eeprom_read_block(dst, (const void*)(uintptr_t)addr, len);
+#else
+  uint8_t* d = static_cast<uint8_t*>(dst);
+  for (uint16_t i = 0; i < len; ++i) d[i] = EEPROM.read(addr + i);
+#endif
+}
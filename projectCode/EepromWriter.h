@@ -0,0 +1,69 @@
+#pragma once
+#include <Arduino.h>
+
+/**
+ * @brief Non-blocking EEPROM block writer.
+ *
+ * Writing one EEPROM byte takes ~3.3 ms on the ATmega328P. The usual
+ * EEPROM.put() waits for each byte in turn, which would stall sampling and
+ * stepping for the whole record. EepromWriter instead copies a block one
+ * byte per service() call, and only when the EEPROM has finished the
+ * previous write (eeprom_is_ready()), so the main loop never waits.
+ *
+ * Bytes that already hold the right value are skipped without a write
+ * cycle, which saves time and EEPROM wear.
+ *
+ * The writer handles one block at a time. The source buffer must stay valid
+ * and unchanged until busy() returns false.
+ */
+class EepromWriter {
+public:
+  /**
+   * @brief Start writing a block.
+   *
+   * @param addr  EEPROM destination address.
+   * @param src   Source data in RAM (not copied).
+   * @param len   Number of bytes.
+   * @return false if a previous block is still being written.
+   */
+  bool start(uint16_t addr, const uint8_t* src, uint16_t len);
+
+  /**
+   * @brief Write the next byte if the EEPROM is ready.
+   *
+   * Call frequently from loop(). Returns immediately when idle, while the
+   * EEPROM is still busy, or after one compare (and possibly one write).
+   */
+  void service();
+
+  /** @brief True while a block is being written. */
+  bool busy() const { return left_ != 0; }
+
+  /** @brief Number of bytes actually written (not skipped) since power-on. */
+  uint32_t bytesWritten() const { return written_; }
+
+  /**
+   * @brief Read a block synchronously.
+   *
+   * Reading is fast (a few cycles per byte), so this is used for loading at
+   * boot. Waits for a pending write cycle to finish first.
+   *
+   * @param addr  EEPROM source address.
+   * @param dst   Destination buffer.
+   * @param len   Number of bytes.
+   */
+  static void read(uint16_t addr, void* dst, uint16_t len);
+
+private:
+  /** @brief Next EEPROM address to write. */
+  uint16_t addr_ = 0;
+
+  /** @brief Next source byte. */
+  const uint8_t* src_ = nullptr;
+
+  /** @brief Bytes left in the current block. */
+  uint16_t left_ = 0;
+
+  /** @brief Statistics: bytes for which a write cycle was started. */
+  uint32_t written_ = 0;
+};
@@ -0,0 +1,14 @@
+#include "EventLog.h"
+
+/**
+ * @file EventLog.cpp
+ * @brief Storage of the global event log.
+ */
+
+static_assert(sizeof(LogEntry) == PROTO_LOG_ENTRY_SIZE, "LogEntry must match the dump format");
+static_assert(EVENT_LOG_SIZE <= 255, "EventLog uses 8-bit indices");
+
+/**
+ * @brief Global event log instance.
+ */
+EventLog gEventLog;
@@ -0,0 +1,107 @@
+#pragma once
+#include <Arduino.h>
+#include "ProtocolDefs.h"
+
+/**
+ * @brief Number of entries kept by EventLog (<= 255). Override with -D.
+ *
+ * 16 entries take 96 bytes of SRAM, enough for the end of a run (the
+ * threshold crossings, relay changes and last state transitions). Raise it
+ * where the RAM is available.
+ */
+#ifndef EVENT_LOG_SIZE
+#define EVENT_LOG_SIZE 16
+#endif
+
+/**
+ * @brief One event log entry (6 bytes).
+ */
+struct LogEntry {
+  uint8_t t[3];  ///< Low 24 bits of millis() (little endian, wraps after ~4.6 h).
+  uint8_t id;    ///< Event ID (EV_* in ProtocolDefs.h).
+  int16_t arg;   ///< Event argument.
+};
+
+/**
+ * @brief In-RAM ring of timestamped events.
+ *
+ * The modes log state transitions, relay changes, threshold crossings and
+ * limit hits, so the course of a run can be reconstructed after the fact
+ * (HostLink MSG_LOG_DUMP, `tipctl log`). When the ring is full the oldest
+ * entry is overwritten and counted.
+ *
+ * log() is inline and only stores six bytes; it is meant to be called from
+ * the main loop, not from interrupts.
+ */
+class EventLog {
+public:
+  /**
+   * @brief Append an event.
+   *
+   * @param id   Event ID (EV_*).
+   * @param arg  Event argument.
+   */
+  void log(uint8_t id, int16_t arg = 0) {
+    uint32_t  t = millis();
+    LogEntry& e = buf_[head_];
+    e.t[0] = (uint8_t)t;
+    e.t[1] = (uint8_t)(t >> 8);
+    e.t[2] = (uint8_t)(t >> 16);
+    e.id   = id;
+    e.arg  = arg;
+    if (++head_ == EVENT_LOG_SIZE) head_ = 0;
+    if (count_ < EVENT_LOG_SIZE) ++count_;
+    else                         ++lost_;
+  }
+
+  /** @brief Number of entries stored. */
+  uint8_t count() const { return count_; }
+
+  /** @brief Entries overwritten since power-on. */
+  uint16_t lost() const { return lost_; }
+
+  /**
+   * @brief Access an entry.
+   *
+   * @param i  Index, 0 = oldest (i < count()).
+   * @return The entry.
+   */
+  const LogEntry& at(uint8_t i) const {
+    uint16_t k = (uint16_t)head_ + EVENT_LOG_SIZE - count_ + i;
+    if (k >= EVENT_LOG_SIZE) k -= EVENT_LOG_SIZE;
+    if (k >= EVENT_LOG_SIZE) k -= EVENT_LOG_SIZE;
+    return buf_[k];
+  }
+
+  /** @brief Remove all entries. */
+  void clear() { head_ = 0; count_ = 0; }
+
+private:
+  /** @brief Entry storage. */
+  LogEntry buf_[EVENT_LOG_SIZE];
+
+  /** @brief Index of the next entry to write. */
+  uint8_t head_ = 0;
+
+  /** @brief Entries stored. */
+  uint8_t count_ = 0;
+
+  /** @brief Overwritten entries. */
+  uint16_t lost_ = 0;
+};
+
+/** @brief The event log written by the modes and the controller. */
+extern EventLog gEventLog;
+
+/**
+ * @brief Convert a current to the mA argument of an event (saturating).
+ *
+ * @param amps  Current (A).
+ * @return Current in mA.
+ */
+inline int16_t evMilliAmps(float amps) {
+  float mA = amps * 1000.0f;
+  if (mA >  32767.0f) return  32767;
+  if (mA < -32768.0f) return -32768;
+  return (int16_t)mA;
+}
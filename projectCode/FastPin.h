@@ -0,0 +1,69 @@
+#pragma once
+#include <Arduino.h>
+#include "SimCycles.h"
+
+/**
+ * @brief Minimal fast digital output helper.
+ *
+ * digitalWrite() costs several microseconds on AVR because it looks up the
+ * port and bit mask and checks for PWM on every call. FastPin resolves the
+ * output register and mask once in attach() and then writes the pin with a
+ * single read-modify-write of the port register (a few cycles).
+ *
+ * On non-AVR targets it falls back to digitalWrite(), so code using FastPin
+ * stays portable; the host simulation charges it at the AVR cost.
+ */
+class FastPin {
+public:
+  /**
+   * @brief Bind the helper to a pin and configure it as an output (LOW).
+   *
+   * @param pin Arduino pin number.
+   */
+  void attach(uint8_t pin) {
+    pin_ = pin;
+#if defined(__AVR__)
+    out_  = portOutputRegister(digitalPinToPort(pin));
+    mask_ = digitalPinToBitMask(pin);
+#endif
+    pinMode(pin, OUTPUT);
+    write(false);
+  }
+
+  /**
+   * @brief Drive the pin HIGH (true) or LOW (false).
+   *
+   * The port update is done with interrupts disabled so that an ISR writing
+   * another pin of the same port cannot be lost in the read-modify-write.
+   *
+   * @param high Desired output level.
+   */
+  inline void write(bool high) {
+#if defined(__AVR__)
+    uint8_t sreg = SREG;
+    cli();
+    if (high) *out_ |= mask_;
+    else      *out_ &= (uint8_t)~mask_;
+    SREG = sreg;
+#elif defined(HOST_HAL)
+    hal::fastPinWrite(pin_, high ? HIGH : LOW);
+#else
+    digitalWrite(pin_, high ? HIGH : LOW);
+#endif
+  }
+
+  /** @brief Arduino pin number this helper is bound to. */
+  uint8_t pin() const { return pin_; }
+
+private:
+  /** @brief Arduino pin number. */
+  uint8_t pin_ = 0;
+
+#if defined(__AVR__)
+  /** @brief Output (PORTx) register of the pin. */
+  volatile uint8_t* out_ = nullptr;
+
+  /** @brief Bit mask of the pin inside its port register. */
+  uint8_t mask_ = 0;
+#endif
+};
@@ -0,0 +1,175 @@
+#include "Hd44780.h"
+
+/**
+ * @file Hd44780.cpp
+ * @brief Implementation of the queued, non-blocking HD44780 driver.
+ *
+ * Bytes written to the display are stored in a ring buffer together with
+ * their RS flag. service() takes them out one at a time, but only after the
+ * execution time of the previous byte has elapsed, so the main loop never
+ * waits for the LCD controller.
+ */
+
+/**
+ * @brief Construct a new Hd44780 driver; pins are configured in begin().
+ *
+ * @param rs  Register Select pin.
+ * @param en  Enable pin.
+ * @param d4  Data line D4.
+ * @param d5  Data line D5.
+ * @param d6  Data line D6.
+ * @param d7  Data line D7.
+ */
+Hd44780::Hd44780(uint8_t rs, uint8_t en, uint8_t d4, uint8_t d5, uint8_t d6, uint8_t d7)
+  : pRS_(rs), pEN_(en), pD_{d4, d5, d6, d7} {}
+
+/**
+ * @brief Run the HD44780 power-on initialization sequence for 4-bit mode.
+ *
+ * The sequence follows the datasheet ("initialization by instruction"):
+ * three times 0x3 in 8-bit mode, then 0x2 to switch to 4-bit mode, followed
+ * by function set, display control, clear and entry mode. This function
+ * blocks and must only be used from setup().
+ */
+void Hd44780::begin() {
+  rs_.attach(pRS_);
+  en_.attach(pEN_);
+  for (uint8_t i = 0; i < 4; ++i) d_[i].attach(pD_[i]);
+
+  head_ = tail_ = 0;
+
+  delay(50);                 // power-on wait (> 40 ms after Vcc rises)
+
+  sendNibble_(0x03); delayMicroseconds(4500);
+  sendNibble_(0x03); delayMicroseconds(4500);
+  sendNibble_(0x03); delayMicroseconds(150);
+  sendNibble_(0x02); delayMicroseconds(150);   // now in 4-bit mode
+
+  sendByte_(0x28, false); delayMicroseconds(EXEC_US);   // 4-bit, 2 lines, 5x8 font
+  sendByte_(0x0C, false); delayMicroseconds(EXEC_US);   // display on, cursor off, blink off
+  sendByte_(0x01, false); delayMicroseconds(CLEAR_US);  // clear display
+  sendByte_(0x06, false); delayMicroseconds(EXEC_US);   // increment, no display shift
+
+  lastTx_ = micros();
+  busyUs_ = EXEC_US;
+}
+
+/**
+ * @brief Queue an instruction byte.
+ *
+ * @param cmd HD44780 instruction.
+ */
+void Hd44780::command(uint8_t cmd) {
+  push_(cmd, false);
+}
+
+/**
+ * @brief Queue a character (data byte).
+ *
+ * @param ch Character code.
+ * @return Always 1, as required by Print.
+ */
+size_t Hd44780::write(uint8_t ch) {
+  push_(ch, true);
+  return 1;
+}
+
+/**
+ * @brief Append a byte and its RS flag to the ring buffer.
+ *
+ * If the ring is full, the oldest entry is sent synchronously first. This is
+ * the only place where the driver may wait for the LCD.
+ *
+ * @param v   Byte value.
+ * @param rs  True for data, false for an instruction.
+ */
+void Hd44780::push_(uint8_t v, bool rs) {
+  while (freeSlots() == 0) {
+    drainOne_();
+  }
+
+  uint8_t h = head_;
+  buf_[h] = v;
+  if (rs) rsBits_[h >> 3] |=  (uint8_t)(1u << (h & 7));
+  else    rsBits_[h >> 3] &= (uint8_t)~(1u << (h & 7));
+  head_ = (uint8_t)((h + 1) & MASK);
+}
+
+/**
+ * @brief Send the next queued byte if the LCD has finished the previous one.
+ *
+ * Costs a micros() call when the LCD is still busy and one byte transfer
+ * (a few µs with FastPin) otherwise.
+ */
+void Hd44780::service() {
+  if (idle()) return;
+  if ((uint32_t)(micros() - lastTx_) < busyUs_) return;
+  sendNext_();
+}
+
+/**
+ * @brief Send all queued bytes, waiting for the LCD between them.
+ */
+void Hd44780::flush() {
+  while (!idle()) {
+    drainOne_();
+  }
+}
+
+/**
+ * @brief Wait for the LCD execution time to elapse, then send one byte.
+ */
+void Hd44780::drainOne_() {
+  while ((uint32_t)(micros() - lastTx_) < busyUs_) {
+    // wait for the previous instruction to complete
+  }
+  sendNext_();
+}
+
+/**
+ * @brief Pop the oldest byte from the ring and transmit it.
+ *
+ * Records the transmit time and the execution time the controller needs
+ * for this byte (clear and return-home take ~1.5 ms, everything else ~40 µs).
+ */
+void Hd44780::sendNext_() {
+  SIM_CYCLES(40);
+  uint8_t t  = tail_;
+  uint8_t v  = buf_[t];
+  bool    rs = (rsBits_[t >> 3] >> (t & 7)) & 1;
+  tail_ = (uint8_t)((t + 1) & MASK);
+
+  sendByte_(v, rs);
+
+  lastTx_ = micros();
+  busyUs_ = (!rs && v <= 0x03) ? CLEAR_US : EXEC_US;
+}
+
+/**
+ * @brief Transfer one byte as two 4-bit nibbles.
+ *
+ * @param v   Byte value.
+ * @param rs  Register select level (true = data).
+ */
+void Hd44780::sendByte_(uint8_t v, bool rs) {
+  rs_.write(rs);
+  sendNibble_(v >> 4);
+  sendNibble_(v & 0x0F);
+}
+
+/**
+ * @brief Place a nibble on D4..D7 and latch it with an EN pulse.
+ *
+ * The HD44780 needs EN high for at least 450 ns and latches on the falling
+ * edge; a 1 µs pulse keeps a comfortable margin.
+ *
+ * @param n Nibble value (bits 0..3).
+ */
+void Hd44780::sendNibble_(uint8_t n) {
+  for (uint8_t i = 0; i < 4; ++i) {
+    d_[i].write((n >> i) & 1);
+  }
+  en_.write(true);
+  delayMicroseconds(1);
+  en_.write(false);
+}
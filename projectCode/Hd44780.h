@@ -0,0 +1,155 @@
+#pragma once
+#include <Arduino.h>
+#include "FastPin.h"
+
+/**
+ * @brief Non-blocking 4-bit HD44780 LCD driver with a transmit queue.
+ *
+ * The stock LiquidCrystal library busy-waits after every byte (~40 µs) and
+ * after clear()/home() (~1.6 ms), which stalls sampling and stepping whenever
+ * the UI prints something. Hd44780 instead:
+ *  - queues commands and characters in a small ring buffer,
+ *  - sends at most one byte per service() call, and only once the controller's
+ *    execution time for the previous byte has elapsed (checked with micros()),
+ *  - drives the bus through FastPin, so one byte (two nibbles) costs only a
+ *    few microseconds of CPU time.
+ *
+ * service() must be called frequently from loop(). Printing is done through
+ * the inherited Print interface, so all usual print() overloads are available.
+ *
+ * If the queue is full, write() falls back to draining one entry in a
+ * blocking way; with the queue size below this only happens when a large
+ * amount of text is written in a single loop pass.
+ */
+class Hd44780 : public Print {
+public:
+  /** @brief Number of queued bytes (commands + characters); must be a power of two. */
+  static constexpr uint8_t QUEUE_SIZE = 64;
+
+  /**
+   * @brief Construct a new Hd44780 driver.
+   *
+   * @param rs  Register Select pin.
+   * @param en  Enable pin.
+   * @param d4  Data line D4.
+   * @param d5  Data line D5.
+   * @param d6  Data line D6.
+   * @param d7  Data line D7.
+   */
+  Hd44780(uint8_t rs, uint8_t en, uint8_t d4, uint8_t d5, uint8_t d6, uint8_t d7);
+
+  /**
+   * @brief Initialize the controller (4-bit mode, 2 lines, display on, cleared).
+   *
+   * This runs the power-on initialization sequence synchronously (~60 ms of
+   * delays) and is meant to be called once from setup().
+   */
+  void begin();
+
+  /**
+   * @brief Queue a raw instruction byte (RS = 0).
+   *
+   * @param cmd HD44780 instruction (e.g. 0x01 = clear, 0x80 | addr = set DDRAM address).
+   */
+  void command(uint8_t cmd);
+
+  /**
+   * @brief Queue a data byte (RS = 1); used by all Print::print() overloads.
+   *
+   * @param ch Character code to write at the current address.
+   * @return Always 1.
+   */
+  size_t write(uint8_t ch) override;
+  using Print::write;
+
+  /**
+   * @brief Send the next queued byte if the controller is ready.
+   *
+   * Never waits: if the previous byte is still being executed by the LCD or
+   * the queue is empty, it returns immediately.
+   */
+  void service();
+
+  /**
+   * @brief Block until the queue is empty.
+   *
+   * Intended for situations where the display content must be visible before
+   * a deliberate blocking section (e.g. before a long delay()).
+   */
+  void flush();
+
+  /** @brief True if no bytes are waiting to be sent. */
+  bool idle() const { return head_ == tail_; }
+
+  /** @brief Number of free entries in the queue. */
+  uint8_t freeSlots() const { return (uint8_t)(QUEUE_SIZE - 1 - ((head_ - tail_) & MASK)); }
+
+private:
+  /** @brief Index mask for the power-of-two ring. */
+  static constexpr uint8_t MASK = QUEUE_SIZE - 1;
+
+  /** @brief Execution time of a normal instruction or data write (µs, with margin). */
+  static constexpr uint16_t EXEC_US  = 40;
+
+  /** @brief Execution time of clear / return home (µs, with margin). */
+  static constexpr uint16_t CLEAR_US = 1600;
+
+  /**
+   * @brief Append one byte to the queue, draining one entry first if full.
+   *
+   * @param v   Byte value.
+   * @param rs  True for data (RS = 1), false for an instruction.
+   */
+  void push_(uint8_t v, bool rs);
+
+  /**
+   * @brief Wait until the controller is ready and send the oldest queued byte.
+   */
+  void drainOne_();
+
+  /**
+   * @brief Pop the oldest queued byte and put it on the bus.
+   *
+   * Caller must make sure the queue is not empty and the LCD is ready.
+   */
+  void sendNext_();
+
+  /**
+   * @brief Put one byte on the bus as two nibbles (high nibble first).
+   *
+   * @param v   Byte value.
+   * @param rs  Register select level.
+   */
+  void sendByte_(uint8_t v, bool rs);
+
+  /**
+   * @brief Put one nibble on D4..D7 and pulse EN.
+   *
+   * @param n Nibble value (low 4 bits used).
+   */
+  void sendNibble_(uint8_t n);
+
+  /** @brief Bus pins. */
+  uint8_t pRS_, pEN_, pD_[4];
+
+  /** @brief Fast output helpers for the bus pins. */
+  FastPin rs_, en_, d_[4];
+
+  /** @brief Queued byte values. */
+  uint8_t buf_[QUEUE_SIZE];
+
+  /** @brief One bit per queue slot: 1 = data (RS HIGH), 0 = instruction. */
+  uint8_t rsBits_[QUEUE_SIZE / 8];
+
+  /** @brief Write index of the ring. */
+  volatile uint8_t head_ = 0;
+
+  /** @brief Read index of the ring. */
+  volatile uint8_t tail_ = 0;
+
+  /** @brief micros() timestamp of the last byte put on the bus. */
+  uint32_t lastTx_ = 0;
+
+  /** @brief Time (µs) the controller needs to execute the last byte. */
+  uint16_t busyUs_ = 0;
+};
@@ -0,0 +1,101 @@
+#include "HistoryMode.h"
+
+/**
+ * @file HistoryMode.cpp
+ * @brief Implementation of the run history screen.
+ */
+
+/**
+ * @brief Show the newest run.
+ */
+void HistoryMode::begin() {
+    sel_        = 0;
+    page_       = 0;
+    needRedraw_ = true;
+}
+
+/**
+ * @brief Cleanup when leaving the mode.
+ */
+void HistoryMode::end() {
+    lcd_.clear();
+}
+
+/**
+ * @brief Draw the selected run (see the class description for the layout).
+ */
+void HistoryMode::draw() {
+    uint8_t n = runs_.count();
+    uint8_t rec[PROTO_RUN_SIZE];
+
+    lcd_.clear();
+    if (n == 0) {
+        lcd_.title2(F("RUN HISTORY"), F("<empty>"));
+        return;
+    }
+    if (!runs_.read(n - 1 - sel_, rec)) {
+        lcd_.title2(F("RUN HISTORY"), F("<unreadable>"));
+        return;
+    }
+
+    lcd_.setCursor(0, 0);
+    lcd_.write('#');
+    lcd_.print((unsigned long)protoGetU16(rec + PROTO_RUN_SEQ));
+    lcd_.print(rec[PROTO_RUN_MODE_ID] == (uint8_t)ModeId::Mod2 ? F(" M2 ") : F(" M1 "));
+    lcd_.print(rec[PROTO_RUN_RESULT] == RUN_OK ? F("OK") : F("ABT"));
+    if (rec[PROTO_RUN_RETRIES]) {
+        lcd_.print(F(" r"));
+        lcd_.print((int)rec[PROTO_RUN_RETRIES]);
+    }
+
+    lcd_.setCursor(0, 1);
+    if (page_ == 0) {
+        lcd_.write('Z');
+        lcd_.print(protoGetU16(rec + PROTO_RUN_SURFACE_Z) / 100.0f, 2);
+        lcd_.write(' ');
+        lcd_.print((unsigned long)((protoGetU16(rec + PROTO_RUN_ETCH_TIME) + 5) / 10));
+        lcd_.print(F("s "));
+        float mA = protoGetU16(rec + PROTO_RUN_END_I) / 100.0f;
+        lcd_.print(mA, mA < 10.0f ? 1 : 0);
+        lcd_.write('m');
+    } else {
+        lcd_.write('P');
+        lcd_.print(protoGetU16(rec + PROTO_RUN_PLUNGE) / 100.0f, 2);
+        lcd_.print(F(" pulses "));
+        lcd_.print((int)rec[PROTO_RUN_PULSES]);
+    }
+}
+
+/**
+ * @brief Execute one step of the history UI.
+ *
+ * @return true when the mode should end.
+ */
+bool HistoryMode::step() {
+    KeyEvent ev;
+    if (keys_.next(ev) && (ev.type == KeyEventType::Press || ev.type == KeyEventType::Repeat)) {
+        switch (ev.key) {
+        case Key::UP:
+            if (sel_ > 0) { sel_--; needRedraw_ = true; }
+            break;
+        case Key::DOWN:
+            if (sel_ + 1 < runs_.count()) { sel_++; needRedraw_ = true; }
+            break;
+        case Key::RIGHT:
+            page_       = page_ ? 0 : 1;
+            needRedraw_ = true;
+            break;
+        case Key::LEFT:
+        case Key::SELECT:
+            return ev.type == KeyEventType::Press;
+        default:
+            break;
+        }
+    }
+
+    if (needRedraw_) {
+        draw();
+        needRedraw_ = false;
+    }
+    return false;
+}
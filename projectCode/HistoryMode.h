@@ -0,0 +1,85 @@
+#pragma once
+#include "IMode.h"
+#include "Lcd1602.h"
+#include "KeypadShield.h"
+#include "RunLog.h"
+#include <Arduino.h>
+
+/**
+ * @brief LCD summary of the run history stored by RunLog.
+ *
+ * One run per screen, newest first:
+ * - Line 0: "#<run> M1 OK r2"  (run number, mode, result, validation retries)
+ * - Line 1, page 1: "Z34.56 123s 4.5m"  (surface Z, etch time, end current in mA)
+ * - Line 1, page 2: "P0.20 pulses 12"   (plunge depth, 9 V pulses)
+ *
+ * UP/DOWN: newer/older run, RIGHT: switch page, LEFT or SELECT: back to
+ * the menu.
+ */
+class HistoryMode : public IMode {
+public:
+    /**
+     * @brief Construct a new HistoryMode instance.
+     *
+     * @param lcd   LCD used for the history screens.
+     * @param keys  Keypad used for navigation.
+     * @param runs  EEPROM run history.
+     */
+    HistoryMode(Lcd1602& lcd, KeypadShield& keys, RunLog& runs)
+        : lcd_(lcd), keys_(keys), runs_(runs) {}
+
+    /**
+     * @brief Name of this mode.
+     *
+     * @return Constant C-string "HIST".
+     */
+    const char* name() const override { return "HIST"; }
+
+    /**
+     * @brief Get the capability descriptor of this mode.
+     *
+     * @return Reads the keypad itself (incl. SELECT), needs no sensor or stepper.
+     */
+    ModeCaps caps() const override { return { ModeId::History, MODE_OWNS_SELECT, 100 }; }
+
+    /**
+     * @brief Show the newest run.
+     */
+    void begin() override;
+
+    /**
+     * @brief Execute one non-blocking step of the history UI.
+     *
+     * @return true when LEFT or SELECT was pressed.
+     */
+    bool step() override;
+
+    /**
+     * @brief Cleanup when leaving the mode (clears the LCD).
+     */
+    void end() override;
+
+private:
+    /**
+     * @brief Draw the selected run.
+     */
+    void draw();
+
+    /** @brief LCD used for output. */
+    Lcd1602&      lcd_;
+
+    /** @brief Keypad used for input. */
+    KeypadShield& keys_;
+
+    /** @brief EEPROM run history. */
+    RunLog&       runs_;
+
+    /** @brief Selected run, 0 = newest. */
+    uint8_t sel_ = 0;
+
+    /** @brief Page shown on line 1 (0 or 1). */
+    uint8_t page_ = 0;
+
+    /** @brief Screen must be redrawn on the next step(). */
+    bool needRedraw_ = true;
+};
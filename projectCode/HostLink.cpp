@@ -0,0 +1,304 @@
+#include "HostLink.h"
+#include "TelemetryStreamer.h"
+#include "EventLog.h"
+#include "RunLog.h"
+#include "Crc16.h"
+#include "ParamTable.h"
+#include "LoopProfiler.h"
+
+/**
+ * @file HostLink.cpp
+ * @brief Implementation of the framed binary serial protocol (device side).
+ */
+
+/**
+ * @brief Collect received bytes into frames and handle complete frames.
+ *
+ * At most RX_BUDGET bytes are taken per call so that a burst from the host
+ * cannot hold up the main loop.
+ */
+void HostLink::service() {
+  for (uint8_t n = 0; n < RX_BUDGET && io_.available() > 0; ++n) {
+    uint8_t b = (uint8_t)io_.read();
+
+    if (b == 0) {
+      if (rxOverflow_)      ++rxErrors_;
+      else if (rxLen_ > 0)  handleFrame_();
+      rxLen_      = 0;
+      rxOverflow_ = false;
+      continue;
+    }
+
+    if (rxLen_ < sizeof(rxBuf_)) rxBuf_[rxLen_++] = b;
+    else                         rxOverflow_ = true;
+  }
+}
+
+/**
+ * @brief Decode the collected frame in place, verify it and dispatch it.
+ */
+void HostLink::handleFrame_() {
+  uint8_t len = (uint8_t)cobsDecode(rxBuf_, rxLen_, rxBuf_);
+  if (len < PROTO_HEADER + 2) {
+    ++rxErrors_;
+    return;
+  }
+
+  len -= 2;
+  if (crc16(rxBuf_, len) != protoGetU16(rxBuf_ + len)) {
+    ++rxErrors_;
+    return;
+  }
+
+  uint8_t type  = rxBuf_[1];
+  uint8_t reqId = rxBuf_[2];
+  if (rxBuf_[0] != PROTO_VERSION) {
+    nack_(type, reqId, ERR_VERSION);
+    return;
+  }
+  dispatch_(type, reqId, rxBuf_ + PROTO_HEADER, len - PROTO_HEADER);
+}
+
+/**
+ * @brief Execute a request and send the reply.
+ *
+ * @param type   Request type.
+ * @param reqId  Request ID.
+ * @param body   Request body.
+ * @param len    Body length.
+ */
+void HostLink::dispatch_(uint8_t type, uint8_t reqId, const uint8_t* body, uint8_t len) {
+  uint8_t out[PROTO_MAX_BODY];
+
+  switch (type) {
+    case MSG_PING:
+      out[0] = PROTO_VERSION;
+      out[1] = PARAM_COUNT;
+      out[2] = ctrl_.modeCount();
+      send(type | MSG_REPLY, reqId, out, 3);
+      break;
+
+    case MSG_STATUS: {
+      uint8_t idx = ctrl_.currentIndex();
+      protoPutU32(out + PROTO_STATUS_T_MS, millis());
+      out[PROTO_STATUS_RUNNING] = ctrl_.isRunning() ? 1 : 0;
+      out[PROTO_STATUS_MODE]    = idx;
+      out[PROTO_STATUS_MODE_ID] = (uint8_t)ctrl_.mode(idx)->caps().id;
+      out[PROTO_STATUS_SENSOR]  = current_.isEnabled() ? 1 : 0;
+      protoPutF32(out + PROTO_STATUS_I_A,  current_.correctedIrms());
+      protoPutF32(out + PROTO_STATUS_Z_MM, stepper_.positionMm());
+      send(type | MSG_REPLY, reqId, out, PROTO_STATUS_SIZE);
+      break;
+    }
+
+    case MSG_PARAM_GET:
+      if (len != 1)                { nack_(type, reqId, ERR_BAD_LENGTH); break; }
+      if (body[0] >= PARAM_COUNT)  { nack_(type, reqId, ERR_BAD_ARG);    break; }
+      sendParam_(type, reqId, body[0]);
+      break;
+
+    case MSG_PARAM_SET: {
+      if (len != 5)                { nack_(type, reqId, ERR_BAD_LENGTH); break; }
+      if (body[0] >= PARAM_COUNT)  { nack_(type, reqId, ERR_BAD_ARG);    break; }
+      float v = protoGetF32(body + 1);
+      if (v != v)                  { nack_(type, reqId, ERR_BAD_ARG);    break; }   // NaN
+      ParamDesc d;
+      paramDesc(body[0], d);
+      paramSet(d, v);
+      sendParam_(type, reqId, body[0]);
+      break;
+    }
+
+    case MSG_PARAM_SAVE:
+      store_.requestSave();
+      ack_(type, reqId);
+      break;
+
+    case MSG_MODE_START:
+      if (len != 1)                    { nack_(type, reqId, ERR_BAD_LENGTH); break; }
+      if (body[0] >= ctrl_.modeCount()) { nack_(type, reqId, ERR_BAD_ARG);    break; }
+      if (ctrl_.startMode(body[0])) ack_(type, reqId);
+      else                          nack_(type, reqId, ERR_BUSY);
+      break;
+
+    case MSG_MODE_STOP:
+      if (ctrl_.stopMode()) ack_(type, reqId);
+      else                  nack_(type, reqId, ERR_BUSY);
+      break;
+
+    case MSG_TELEM_CTRL:
+      if (!telem_)                 { nack_(type, reqId, ERR_UNKNOWN_TYPE); break; }
+      if (len != 2)                { nack_(type, reqId, ERR_BAD_LENGTH);   break; }
+      telem_->setEnabled(body[0] != 0, body[1]);
+      out[PROTO_TCTRL_ENABLED] = telem_->enabled() ? 1 : 0;
+      out[PROTO_TCTRL_DECIM]   = telem_->decimation();
+      protoPutU16(out + PROTO_TCTRL_DROPS, telem_->drops());
+      protoPutU16(out + PROTO_TCTRL_SEQ,   telem_->sequence());
+      send(type | MSG_REPLY, reqId, out, PROTO_TCTRL_SIZE);
+      break;
+
+    case MSG_LOG_DUMP: {
+      if (len != 1)                { nack_(type, reqId, ERR_BAD_LENGTH); break; }
+      uint8_t count = gEventLog.count();
+      uint8_t first = body[0] < count ? body[0] : count;
+      uint8_t n     = count - first;
+      if (n > PROTO_LOG_MAX_ENTRIES) n = PROTO_LOG_MAX_ENTRIES;
+
+      protoPutU32(out + PROTO_LOG_T_MS, millis());
+      out[PROTO_LOG_COUNT] = count;
+      out[PROTO_LOG_FIRST] = first;
+      protoPutU16(out + PROTO_LOG_LOST, gEventLog.lost());
+      uint8_t* p = out + PROTO_LOG_ENTRIES;
+      for (uint8_t i = 0; i < n; ++i, p += PROTO_LOG_ENTRY_SIZE) {
+        const LogEntry& e = gEventLog.at(first + i);
+        memcpy(p, e.t, 3);
+        p[3] = e.id;
+        protoPutU16(p + 4, (uint16_t)e.arg);
+      }
+      send(type | MSG_REPLY, reqId, out, PROTO_LOG_ENTRIES + n * PROTO_LOG_ENTRY_SIZE);
+      break;
+    }
+
+    case MSG_RUN_READ: {
+      if (!runs_)                  { nack_(type, reqId, ERR_UNKNOWN_TYPE); break; }
+      if (len != 1)                { nack_(type, reqId, ERR_BAD_LENGTH);   break; }
+      uint8_t count = runs_->count();
+      uint8_t first = body[0] < count ? body[0] : count;
+      uint8_t n     = 0;
+      // records are copied as stored; an unreadable one (being written) is left out
+      for (uint8_t i = first; i < count && i - first < PROTO_RUNS_MAX; ++i) {
+        if (runs_->read(i, out + PROTO_RUNS_RECORDS + n * PROTO_RUN_SIZE)) ++n;
+      }
+      out[PROTO_RUNS_COUNT] = count;
+      out[PROTO_RUNS_FIRST] = first;
+      send(type | MSG_REPLY, reqId, out, PROTO_RUNS_RECORDS + n * PROTO_RUN_SIZE);
+      break;
+    }
+
+#if LOOP_PROFILE
+    case MSG_PROF_DUMP: {
+      if (len != 2)                { nack_(type, reqId, ERR_BAD_LENGTH); break; }
+      if (body[0] >= PROF_PROBES)  { nack_(type, reqId, ERR_BAD_ARG);    break; }
+      const ProfProbe& p = gLoopProfiler.probe(body[0]);
+      out[PROTO_PROF_PROBE]  = body[0];
+      out[PROTO_PROF_PROBES] = PROF_PROBES;
+      protoPutU16(out + PROTO_PROF_COUNT, p.count);
+      protoPutU32(out + PROTO_PROF_TOTAL, p.total);
+      protoPutU16(out + PROTO_PROF_MAX,   p.max);
+      for (uint8_t i = 0; i < PROF_HIST_BINS; ++i) protoPutU16(out + PROTO_PROF_HIST + 2 * i, p.hist[i]);
+      if (body[1]) gLoopProfiler.clear(body[0]);
+      send(type | MSG_REPLY, reqId, out, PROTO_PROF_SIZE);
+      break;
+    }
+#endif
+
+#if STEP_JITTER
+    case MSG_STEP_JITTER: {
+      StepJitter* j = stepper_.jitter();
+      if (!j)                      { nack_(type, reqId, ERR_UNKNOWN_TYPE); break; }
+      if (len != 1)                { nack_(type, reqId, ERR_BAD_LENGTH);   break; }
+      StepJitterStats st;
+      j->service();
+      j->stats(st);
+      protoPutU32(out + PROTO_JIT_INTERVALS, st.intervals);
+      protoPutU32(out + PROTO_JIT_PERIOD_US, st.period_us);
+      protoPutF32(out + PROTO_JIT_MEAN_US,   st.mean_us);
+      protoPutF32(out + PROTO_JIT_SD_US,     st.sd_us);
+      protoPutU32(out + PROTO_JIT_MAXDEV_US, st.maxDev_us);
+      protoPutU32(out + PROTO_JIT_LATE,      st.late);
+      protoPutU16(out + PROTO_JIT_LOST,      st.lost);
+      out[PROTO_JIT_RECENT_N] = PROTO_JIT_RECENT_MAX;
+      for (uint8_t i = 0; i < PROTO_JIT_RECENT_MAX; ++i) protoPutU32(out + PROTO_JIT_RECENT + 4 * i, j->recentInterval(i));
+      if (body[0]) j->clear();
+      send(type | MSG_REPLY, reqId, out, PROTO_JIT_RECENT + 4 * PROTO_JIT_RECENT_MAX);
+      break;
+    }
+#endif
+
+    default:
+      nack_(type, reqId, ERR_UNKNOWN_TYPE);
+      break;
+  }
+}
+
+/**
+ * @brief Send the descriptor and current value of a parameter.
+ *
+ * @param type   Request type.
+ * @param reqId  Request ID.
+ * @param idx    Parameter table index.
+ */
+void HostLink::sendParam_(uint8_t type, uint8_t reqId, uint8_t idx) {
+  uint8_t   out[PROTO_PARAM_SIZE];
+  ParamDesc d;
+  paramDesc(idx, d);
+
+  out[PROTO_PARAM_INDEX]    = idx;
+  out[PROTO_PARAM_TYPE]     = (uint8_t)d.type;
+  out[PROTO_PARAM_DECIMALS] = d.decimals;
+  protoPutF32(out + PROTO_PARAM_VALUE, paramGet(d));
+  protoPutF32(out + PROTO_PARAM_MIN,   d.minVal);
+  protoPutF32(out + PROTO_PARAM_MAX,   d.maxVal);
+  memcpy(out + PROTO_PARAM_NAME, d.name, sizeof(d.name));
+
+  send(type | MSG_REPLY, reqId, out, PROTO_PARAM_SIZE);
+}
+
+/**
+ * @brief Send MSG_ACK for a request.
+ *
+ * @param type   Request type.
+ * @param reqId  Request ID.
+ */
+void HostLink::ack_(uint8_t type, uint8_t reqId) {
+  send(MSG_ACK, reqId, &type, 1);
+}
+
+/**
+ * @brief Send MSG_NACK for a request.
+ *
+ * @param type   Request type.
+ * @param reqId  Request ID.
+ * @param err    Error code.
+ */
+void HostLink::nack_(uint8_t type, uint8_t reqId, uint8_t err) {
+  uint8_t out[2] = { type, err };
+  send(MSG_NACK, reqId, out, 2);
+}
+
+/**
+ * @brief Build, encode and queue one frame.
+ *
+ * The frame is only queued if its lane can take all of it; a partial frame
+ * would be worse than none, because the host discards it anyway and loses
+ * sync until the next delimiter.
+ *
+ * @param type   Message type.
+ * @param reqId  Request ID.
+ * @param body   Body bytes.
+ * @param len    Body length.
+ * @param lane   TX lane.
+ * @return false if the frame was dropped.
+ */
+bool HostLink::send(uint8_t type, uint8_t reqId, const uint8_t* body, uint8_t len, TxLane lane) {
+  if (len > PROTO_MAX_BODY) return false;
+
+  uint8_t raw[PROTO_MAX_FRAME];
+  raw[0] = PROTO_VERSION;
+  raw[1] = type;
+  raw[2] = reqId;
+  memcpy(raw + PROTO_HEADER, body, len);
+  uint8_t n = PROTO_HEADER + len;
+  protoPutU16(raw + n, crc16(raw, n));
+  n += 2;
+
+  uint8_t enc[PROTO_MAX_ENCODED];
+  uint8_t m = (uint8_t)cobsEncode(raw, n, enc);
+  enc[m++] = 0;
+
+  if (!tx_.tryWrite(lane, enc, m)) {
+    ++txDrops_;
+    return false;
+  }
+  return true;
+}
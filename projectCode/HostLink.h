@@ -0,0 +1,168 @@
+#pragma once
+#include <Arduino.h>
+#include "ProtocolDefs.h"
+#include "ModeController.h"
+#include "CurrentSensor.h"
+#include "StepperDriver.h"
+#include "ParamStore.h"
+#include "SerialTx.h"
+
+class TelemetryStreamer;
+class RunLog;
+
+/**
+ * @brief Binary command/status link to a host over a serial port.
+ *
+ * Implements the device side of the protocol in ProtocolDefs.h: COBS framed
+ * messages with CRC16, request IDs and versioned types. Supported requests
+ * are ping, status, parameter get/set/save, mode start/stop, event log
+ * dump, loop profiler and step jitter readout (LOOP_PROFILE / STEP_JITTER
+ * builds) and, once attached, telemetry control (TelemetryStreamer) and run
+ * history readout (RunLog).
+ *
+ * Everything is non-blocking:
+ *  - service() takes at most RX_BUDGET bytes out of the serial RX buffer per
+ *    call and collects them until a 0x00 delimiter completes a frame,
+ *  - frames are queued whole on a SerialTx lane (replies on the critical
+ *    lane, telemetry on the bulk lane); if the lane has no room the frame
+ *    is dropped and counted, and the host retries after its timeout.
+ *
+ * Malformed frames (COBS error, bad CRC, too long) are discarded and counted.
+ */
+class HostLink {
+public:
+  /** @brief Maximum number of RX bytes processed per service() call. */
+  static constexpr uint8_t RX_BUDGET = 32;
+
+  /**
+   * @brief Construct a new HostLink.
+   *
+   * @param io       Serial port (already started with begin()), for receiving.
+   * @param tx       Transmit path on the same port.
+   * @param ctrl     Mode controller, for status and mode start/stop.
+   * @param current  Current sensor, for status.
+   * @param stepper  Stepper driver, for status.
+   * @param store    Parameter store, for MSG_PARAM_SAVE.
+   */
+  HostLink(Stream& io, SerialTx& tx, ModeController& ctrl, CurrentSensor& current, StepperDriver& stepper,
+           ParamStore& store)
+    : io_(io), tx_(tx), ctrl_(ctrl), current_(current), stepper_(stepper), store_(store) {}
+
+  /**
+   * @brief Process received bytes and answer complete requests.
+   *
+   * Call frequently from loop().
+   */
+  void service();
+
+  /**
+   * @brief Queue one frame if it fits into its TX lane.
+   *
+   * @param type   Message type.
+   * @param reqId  Request ID (0 for unsolicited frames).
+   * @param body   Body bytes.
+   * @param len    Body length (<= PROTO_MAX_BODY).
+   * @param lane   TX lane (replies and events are critical).
+   * @return false if the frame was dropped.
+   */
+  bool send(uint8_t type, uint8_t reqId, const uint8_t* body, uint8_t len,
+            TxLane lane = TxLane::Critical);
+
+  /**
+   * @brief Attach the telemetry streamer controlled by MSG_TELEM_CTRL.
+   *
+   * @param telem  Streamer (sends its records through this link).
+   */
+  void attachTelemetry(TelemetryStreamer& telem) { telem_ = &telem; }
+
+  /**
+   * @brief Attach the run history read by MSG_RUN_READ.
+   *
+   * @param runs  Run history.
+   */
+  void attachRunLog(RunLog& runs) { runs_ = &runs; }
+
+  /** @brief Number of received frames discarded as malformed. */
+  uint16_t rxErrors() const { return rxErrors_; }
+
+  /** @brief Number of frames dropped because their TX lane was full. */
+  uint16_t txDrops() const { return txDrops_; }
+
+private:
+  /**
+   * @brief Decode, check and dispatch the frame collected in rxBuf_.
+   */
+  void handleFrame_();
+
+  /**
+   * @brief Execute one request.
+   *
+   * @param type   Request type.
+   * @param reqId  Request ID to echo.
+   * @param body   Request body.
+   * @param len    Body length.
+   */
+  void dispatch_(uint8_t type, uint8_t reqId, const uint8_t* body, uint8_t len);
+
+  /**
+   * @brief Reply with the description and value of a parameter.
+   *
+   * @param type   Request type (reply type is type | MSG_REPLY).
+   * @param reqId  Request ID.
+   * @param idx    Parameter table index (must be valid).
+   */
+  void sendParam_(uint8_t type, uint8_t reqId, uint8_t idx);
+
+  /**
+   * @brief Reply with MSG_ACK.
+   *
+   * @param type   Acknowledged request type.
+   * @param reqId  Request ID.
+   */
+  void ack_(uint8_t type, uint8_t reqId);
+
+  /**
+   * @brief Reply with MSG_NACK.
+   *
+   * @param type   Rejected request type.
+   * @param reqId  Request ID.
+   * @param err    Error code (ERR_*).
+   */
+  void nack_(uint8_t type, uint8_t reqId, uint8_t err);
+
+  /** @brief Serial port (receive side). */
+  Stream& io_;
+
+  /** @brief Transmit path. */
+  SerialTx& tx_;
+
+  /** @brief Mode controller. */
+  ModeController& ctrl_;
+
+  /** @brief Current sensor. */
+  CurrentSensor& current_;
+
+  /** @brief Stepper driver. */
+  StepperDriver& stepper_;
+
+  /** @brief Parameter store. */
+  ParamStore& store_;
+
+  /** @brief Telemetry streamer, or nullptr. */
+  TelemetryStreamer* telem_ = nullptr;
+
+  /** @brief Run history, or nullptr. */
+  RunLog* runs_ = nullptr;
+
+  /** @brief Encoded bytes of the frame being received. */
+  uint8_t rxBuf_[PROTO_MAX_ENCODED];
+
+  /** @brief Number of bytes in rxBuf_. */
+  uint8_t rxLen_ = 0;
+
+  /** @brief Frame too long: skip bytes until the next delimiter. */
+  bool rxOverflow_ = false;
+
+  /** @brief Statistics. */
+  uint16_t rxErrors_ = 0, txDrops_ = 0;
+};
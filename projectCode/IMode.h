@@ -1,6 +1,34 @@
 #pragma once
 #include <Arduino.h>
 
+/**
+ * @brief Compact integer identity of a mode.
+ *
+ * Lets the controller and diagnostics identify a mode without comparing
+ * name strings.
+ */
+enum class ModeId : uint8_t { Home, Mod1, Mod2, Jog, Param, Profile, History, Diag, Other };
+
+/** @name Mode capability flags (ModeCaps::flags)
+ *  @{
+ */
+/** @brief The mode handles SELECT itself; the controller must not abort it on SELECT. */
+constexpr uint8_t MODE_OWNS_SELECT   = 0x01;
+/** @brief The controller enables the current sensor while the mode runs. */
+constexpr uint8_t MODE_NEEDS_SENSOR  = 0x02;
+/** @brief The controller enables the stepper driver on entry and stops it on exit. */
+constexpr uint8_t MODE_NEEDS_STEPPER = 0x04;
+/** @} */
+
+/**
+ * @brief Static description of a mode, queried once when the mode is started.
+ */
+struct ModeCaps {
+  ModeId   id;           ///< Integer identity of the mode.
+  uint8_t  flags;        ///< Combination of MODE_* capability flags.
+  uint16_t uiRefreshMs;  ///< LCD refresh interval to use while the mode runs (ms).
+};
+
 /**
  * @brief Interface for non-blocking machine modes.
  *
@@ -29,6 +57,27 @@ struct IMode {
      */
     virtual const char* name() const = 0;
 
+    /**
+     * @brief Get the identity and capability descriptor of the mode.
+     *
+     * Queried once by the controller when the mode is started; it decides
+     * whether SELECT aborts the mode, which peripherals the controller
+     * enables on its behalf, and how often the LCD is refreshed.
+     *
+     * @return Capability descriptor of the mode.
+     */
+    virtual ModeCaps caps() const = 0;
+
+    /**
+     * @brief Current phase of the mode's internal state machine.
+     *
+     * Reported in telemetry so a recorded run can be split into its phases.
+     * Modes without internal phases return 0.
+     *
+     * @return Mode-specific phase number.
+     */
+    virtual uint8_t phase() const { return 0; }
+
     /**
      * @brief Initialize the mode.
      *
@@ -6,8 +6,9 @@
  *
  * The KeypadShield class reads a resistor-ladder style keypad connected to a single
  * analog input pin. Each button press produces a distinct voltage level, which is
- * mapped to a key code using configurable ADC thresholds. The class includes
- * debouncing logic and provides edge-triggered events for newly pressed keys.
+ * mapped to a key code using configurable ADC thresholds. The class samples the
+ * ADC at a fixed rate, debounces the readings and turns them into a queue of
+ * press, release, autorepeat and long-press events.
  */
 
 /**
@@ -15,19 +16,23 @@
  *
  * @param analogPin  Analog pin connected to the keypad resistor ladder.
  * @param debounceMs Debounce time in milliseconds used to confirm a stable key state.
+ * @param samplePeriodMs Interval between two ADC samples in milliseconds.
  */
-KeypadShield::KeypadShield(uint8_t analogPin, uint16_t debounceMs)
-  : aPin_(analogPin), dbMs_(debounceMs) {}
+KeypadShield::KeypadShield(uint8_t analogPin, uint16_t debounceMs, uint8_t samplePeriodMs)
+  : aPin_(analogPin), dbMs_(debounceMs), sampleMs_(samplePeriodMs) {}
 
 /**
  * @brief Initialize the keypad shield state.
  *
  * This method should be called once (typically in setup()). It resets the internal
- * stable and last key states and initializes the timestamp used for debouncing.
+ * stable and last key states, empties the event queue and initializes the
+ * timestamps used for sampling and debouncing.
  */
 void KeypadShield::begin(){
   stable_ = last_ = Key::NONE; 
-  lastChange_ = millis();
+  suppress_ = false;
+  head_ = tail_ = 0;
+  lastChange_ = lastSample_ = millis();
 }
 
 /**
@@ -72,86 +77,95 @@ Key KeypadShield::classify_(int a) const {
 }
 
 /**
- * @brief Clear any stored key state and reset the debounce timer.
+ * @brief Discard queued events and ignore the key that is currently held.
  *
- * After calling this function, the keypad behaves as if no key has been pressed
- * yet: the stable and last keys are set to Key::NONE and the debounce timer is
- * restarted.
+ * The debounced state is kept, so the held key is not detected as a new
+ * press; instead it is suppressed until it has been released.
  */
 void KeypadShield::clear() {
-  stable_ = last_ = Key::NONE;
-  lastChange_ = millis();
+  head_ = tail_ = 0;
+  suppress_ = (stable_ != Key::NONE);
 }
 
 /**
- * @brief Poll the keypad and return a newly detected key press (edge).
+ * @brief Take the oldest event out of the queue.
  *
- * This method performs a non-blocking read of the analog pin, classifies the
- * current raw key, and applies a debounce mechanism:
- *  - If the raw key state changes, the debounce timer is reset.
- *  - Only when the raw state remains unchanged for at least dbMs_ milliseconds
- *    is the stable state updated.
- *  - The method returns a non-NONE key only when a new stable key is detected
- *    (i.e., edge detection on key press). If no new key press event occurs,
- *    Key::NONE is returned.
- *
- * Typical usage: call poll() in the main loop and react only when the return
- * value is not Key::NONE.
- *
- * @return The newly detected key press (Key::RIGHT, Key::LEFT, etc.) or
- *         Key::NONE if no new key press occurred.
+ * @param ev  Receives the event.
+ * @return true if an event was available.
  */
-Key KeypadShield::poll(){
-
-/*
-#if SIMULATE_KEYS
-  if (Serial.available()) {
-    char c = Serial.read();
-    auto mapChar = [](char ch)->Key {
-      switch (ch) {
-        case 'r': return Key::RIGHT;
-        case 'l': return Key::LEFT;
-        case 'u': return Key::UP;
-        case 'd': return Key::DOWN;
-        case 's': return Key::SELECT;
-        default:  return Key::NONE;
-      }
-    };
-
-    if (c == '0') {
-      // Release event – no key is pressed
-      stable_ = last_ = Key::NONE;
-      lastChange_ = millis();
-      return Key::NONE;
-    }
+bool KeypadShield::next(KeyEvent& ev) {
+  if (head_ == tail_) return false;
+  ev = queue_[tail_];
+  tail_ = (uint8_t)((tail_ + 1) & MASK);
+  return true;
+}
 
-    Key k = mapChar(c);
-    if (k != Key::NONE) {
-      // Update stable state so that stable() works correctly for modes using it
-      last_ = stable_ = k;
-      lastChange_ = millis();
-      return k;  // Generate an immediate edge event
-    }
-    // Unknown character: no event
-    return Key::NONE;
+/**
+ * @brief Append an event to the ring, or count it as dropped if the ring is full.
+ *
+ * @param key        Key of the event.
+ * @param type       Kind of event.
+ * @param t          Timestamp in ms.
+ * @param afterLong  Release after a LongPress.
+ */
+void KeypadShield::push_(Key key, KeyEventType type, uint32_t t, bool afterLong) {
+  uint8_t h = (uint8_t)((head_ + 1) & MASK);
+  if (h == tail_) {
+    ++dropped_;
+    return;
   }
+  queue_[head_] = { key, type, afterLong, t };
+  head_ = h;
+}
 
-  // If there is no serial input, do not read the analog pin in simulation mode
-  // (to avoid noise-based false keys).
-  return Key::NONE;
-#endif
-*/
+/**
+ * @brief Sample the keypad at the configured rate and generate events.
+ *
+ * Debouncing works as before, but on the sample grid: the raw key must stay
+ * unchanged for at least dbMs_ milliseconds before it becomes the stable key.
+ * A stable change produces a Release for the previous key (if any) and a
+ * Press for the new one. While a key is held:
+ *  - after longMs_ one LongPress event is queued,
+ *  - direction keys (not SELECT) produce Repeat events after repDelayMs_,
+ *    then every repRateMs_.
+ * A key suppressed by clear() produces no events until it is released.
+ */
+void KeypadShield::update(){
+  uint32_t now = millis();
+  if ((uint32_t)(now - lastSample_) < sampleMs_) return;
+  lastSample_ = now;
 
-  Key fell = Key::NONE;
   Key raw = classify_(analogRead(aPin_));
   if (raw != last_) {
     last_ = raw; 
-    lastChange_ = millis();
+    lastChange_ = now;
   }
-  if ((millis() - lastChange_) >= dbMs_ && stable_ != last_) {
+
+  if ((uint32_t)(now - lastChange_) >= dbMs_ && stable_ != last_) {
     Key prev = stable_; 
     stable_ = last_;
-    if (prev != stable_ && stable_ != Key::NONE) fell = stable_;
+
+    if (prev != Key::NONE && !suppress_) push_(prev, KeyEventType::Release, now, longSent_);
+    suppress_ = false;
+
+    if (stable_ != Key::NONE) {
+      push_(stable_, KeyEventType::Press, now);
+      pressMs_      = now;
+      nextRepeatMs_ = now + repDelayMs_;
+      longSent_     = false;
+    }
+    return;
+  }
+
+  if (stable_ == Key::NONE || suppress_) return;
+
+  if (!longSent_ && (uint32_t)(now - pressMs_) >= longMs_) {
+    longSent_ = true;
+    push_(stable_, KeyEventType::LongPress, now);
+  }
+
+  if (stable_ != Key::SELECT && (int32_t)(now - nextRepeatMs_) >= 0) {
+    nextRepeatMs_ += repRateMs_;
+    push_(stable_, KeyEventType::Repeat, now);
   }
-  return fell;
 }
@@ -12,67 +12,100 @@
  */
 enum class Key : uint8_t { NONE, RIGHT, UP, DOWN, LEFT, SELECT };
 
+/**
+ * @brief Kind of a keypad event.
+ *
+ *  - Press     : a key became pressed (after debouncing).
+ *  - Release   : the pressed key was released.
+ *  - Repeat    : autorepeat while a direction key is held.
+ *  - LongPress : the key has been held for the long-press time (sent once per hold).
+ */
+enum class KeyEventType : uint8_t { Press, Release, Repeat, LongPress };
+
+/**
+ * @brief One entry of the keypad event queue.
+ */
+struct KeyEvent {
+  Key          key;        ///< Key the event refers to.
+  KeyEventType type;       ///< Kind of event.
+  bool         afterLong;  ///< Release only: the hold already produced a LongPress.
+  uint32_t     t_ms;       ///< millis() timestamp of the sample that produced the event.
+};
+
 /**
  * @brief Non-blocking keypad handler for analog-resistor ladder shields.
  *
  * KeypadShield reads an analog input connected to a keypad (e.g. DFR0009) where
  * each key press produces a distinct voltage level. Internally, it:
+ *  - samples the ADC at a fixed, low rate (default every 10 ms) instead of on
+ *    every loop pass, so the ~112 µs analogRead() is paid only ~100 times/s,
  *  - classifies raw ADC readings into Key values using configurable thresholds,
  *  - applies time-based debouncing,
- *  - provides edge-triggered key events via poll(),
+ *  - turns the debounced state into press, release, autorepeat and long-press
+ *    events with timestamps, stored in a small queue read with next(),
  *  - exposes the current stable key state via stable().
  *
- * The class is intended to be polled frequently from the main loop without
- * blocking delays.
+ * update() must be called frequently from the main loop; it returns
+ * immediately between two sample slots. Events that do not fit into the
+ * queue are dropped and counted (see dropped()).
  */
 class KeypadShield {
   
 public:
+  /** @brief Number of queued events; must be a power of two. */
+  static constexpr uint8_t QUEUE_SIZE = 8;
+
   /**
    * @brief Construct a new KeypadShield object.
    *
    * @param analogPin   Analog pin connected to the keypad resistor ladder.
    * @param debounceMs  Debounce interval in milliseconds used to confirm that a
    *                    key state is stable before generating events.
+   * @param samplePeriodMs Interval between two ADC samples in milliseconds.
    */
-  explicit KeypadShield(uint8_t analogPin, uint16_t debounceMs = 50);
+  explicit KeypadShield(uint8_t analogPin, uint16_t debounceMs = 50, uint8_t samplePeriodMs = 10);
 
   /**
    * @brief Initialize the keypad shield.
    *
    * This method should be called once (typically in setup()). It resets the
-   * internal key state and initializes the debounce timer.
+   * internal key state, empties the event queue and initializes the timers.
    */
   void begin();
 
   /**
-   * @brief Poll the keypad and return a single key-press edge event.
+   * @brief Sample the keypad if the sample period has elapsed and queue events.
    *
-   * This function:
-   *  - reads the analog input,
-   *  - classifies the reading as a logical key,
+   * On each sample slot this function:
+   *  - reads the analog input and classifies the reading as a logical key,
    *  - applies debouncing based on debounceMs,
-   *  - returns a key value only when a new stable key press is detected.
+   *  - queues Press/Release events on stable changes,
+   *  - queues Repeat events for held direction keys and one LongPress event
+   *    per hold.
    *
-   * It returns Key::NONE if no new key press event has occurred since the
-   * previous call. It does not block and should be called regularly in the main
-   * loop.
+   * Between slots it only compares millis() and returns.
+   */
+  void update();
+
+  /**
+   * @brief Take the oldest event out of the queue.
    *
-   * @return The newly detected key press (e.g. Key::RIGHT, Key::SELECT) or
-   *         Key::NONE if no new event is available.
+   * @param ev  Receives the event if one is available.
+   * @return true if an event was returned, false if the queue is empty.
    */
-  Key poll();
+  bool next(KeyEvent& ev);
 
   /**
    * @brief Get the current stable key state.
    *
    * This returns the debounced key that is currently considered pressed. It
    * remains non-NONE as long as the key is held down and the analog reading
-   * remains within the corresponding threshold range.
+   * remains within the corresponding threshold range. A key held across
+   * clear() is reported as Key::NONE until it is released.
    *
    * @return The current stable key (or Key::NONE if no key is pressed).
    */
-  Key stable() const { return stable_; }
+  Key stable() const { return suppress_ ? Key::NONE : stable_; }
 
   /**
    * @brief Set the ADC thresholds used to classify keys.
@@ -91,14 +124,32 @@ public:
   void setThresholds(int right, int up, int down, int left, int select);
 
   /**
-   * @brief Clear all stored key state and reset debouncing.
+   * @brief Configure autorepeat timing for the direction keys.
    *
-   * After calling this, the keypad behaves as if no key has previously been
-   * pressed: stable_ and last_ are reset to Key::NONE, and the debounce timer
-   * is restarted.
+   * @param delayMs  Hold time before the first Repeat event.
+   * @param rateMs   Interval between subsequent Repeat events.
+   */
+  void setRepeat(uint16_t delayMs, uint16_t rateMs) { repDelayMs_ = delayMs; repRateMs_ = rateMs; }
+
+  /**
+   * @brief Configure the hold time that produces a LongPress event.
+   *
+   * @param ms Long-press time in milliseconds.
+   */
+  void setLongPress(uint16_t ms) { longMs_ = ms; }
+
+  /**
+   * @brief Discard queued events and ignore the key currently held.
+   *
+   * Used when the screen owner changes (e.g. a mode starts or stops): the
+   * key that caused the change produces no further events, not even its
+   * Release, and stable() reports Key::NONE until it has been released.
    */
   void clear();
 
+  /** @brief Number of events lost because the queue was full. */
+  uint16_t dropped() const { return dropped_; }
+
 private:
   /**
    * @brief Classify a raw ADC reading into a Key value.
@@ -112,12 +163,31 @@ private:
    */
   Key classify_(int adc) const;
 
+  /**
+   * @brief Append an event to the queue (or count it as dropped).
+   *
+   * @param key        Key of the event.
+   * @param type       Kind of event.
+   * @param t          Timestamp in ms.
+   * @param afterLong  Release after a LongPress.
+   */
+  void push_(Key key, KeyEventType type, uint32_t t, bool afterLong = false);
+
+  /** @brief Index mask for the power-of-two ring. */
+  static constexpr uint8_t MASK = QUEUE_SIZE - 1;
+
   /** @brief Analog pin connected to the keypad resistor ladder. */
   uint8_t aPin_;
 
   /** @brief Debounce interval in milliseconds. */
   uint16_t dbMs_;
 
+  /** @brief Interval between ADC samples in milliseconds. */
+  uint8_t sampleMs_;
+
+  /** @brief millis() timestamp of the last ADC sample. */
+  uint32_t lastSample_ = 0;
+
   /** @brief Last time (in ms) when the raw key state changed, used for debouncing. */
   uint32_t lastChange_ = 0;
 
@@ -127,6 +197,33 @@ private:
   /** @brief Last instantaneous (raw, non-debounced) key state. */
   Key last_ = Key::NONE;
 
+  /** @brief True while the key held during clear() has not been released yet. */
+  bool suppress_ = false;
+
+  /** @brief Time (ms) at which the stable key became pressed. */
+  uint32_t pressMs_ = 0;
+
+  /** @brief Time (ms) at which the next Repeat event is due. */
+  uint32_t nextRepeatMs_ = 0;
+
+  /** @brief True once the current hold has produced its LongPress event. */
+  bool longSent_ = false;
+
+  /** @brief Autorepeat delay and rate (ms). */
+  uint16_t repDelayMs_ = 500, repRateMs_ = 150;
+
+  /** @brief Long-press time (ms). */
+  uint16_t longMs_ = 2000;
+
+  /** @brief Event ring buffer. */
+  KeyEvent queue_[QUEUE_SIZE];
+
+  /** @brief Write / read index of the ring. */
+  uint8_t head_ = 0, tail_ = 0;
+
+  /** @brief Number of events dropped because the queue was full. */
+  uint16_t dropped_ = 0;
+
   /** @brief ADC thresholds used to distinguish keys. */
   int thRight_ = 60, thUp_ = 200, thDown_ = 400, thLeft_ = 600, thSel_ = 800;
 };
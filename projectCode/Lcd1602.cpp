@@ -1,16 +1,20 @@
 #include "Lcd1602.h"
+#include "LoopProfiler.h"
 
 /**
  * @file Lcd1602.cpp
  * @brief Implementation of a wrapper class for a 16x2 HD44780-compatible LCD with PWM backlight control.
  *
- * This class extends the standard LiquidCrystal interface by:
+ * This class provides a LiquidCrystal-like interface on top of the queued
+ * Hd44780 driver by:
  *  - providing unified print/write forwarding,
  *  - adding software-controlled PWM backlight brightness,
  *  - offering convenience drawing routines such as title2().
  *
- * It does not alter the behavior of the underlying LiquidCrystal object, only
- * wraps it to simplify usage and centralize LCD-related utilities.
+ * All drawing calls write into a RAM framebuffer. service() diffs it against
+ * the content already on the display and queues only the changed cells; the
+ * queued bytes are then sent one per loop pass, so the UI never stalls the
+ * main loop and unchanged text costs no bus traffic.
  */
 
 /**
@@ -34,61 +38,154 @@ Lcd1602::Lcd1602(uint8_t rs,uint8_t en,uint8_t d4,uint8_t d5,uint8_t d6,uint8_t
  * @brief Initialize the LCD hardware and set the initial backlight state.
  *
  * This function configures the backlight pin as output, applies the stored
- * backlight PWM value, and initializes the underlying LiquidCrystal instance
- * for a 16×2 display.
+ * backlight PWM value, and initializes the underlying HD44780 controller
+ * for a 16×2 display (blocking, setup() only). The controller is cleared by
+ * its initialization, so both framebuffers start out as blank lines.
  */
 void Lcd1602::begin(){
   pinMode(blPin_, OUTPUT);
   setBacklight(blVal_);
-  lcd_.begin(16,2);
+  lcd_.begin();
+
+  memset(fb_, ' ', sizeof(fb_));
+  memset(shown_, ' ', sizeof(shown_));
+  col_ = row_ = 0;
+  dirty_ = false;
+  lastDiffMs_ = millis();
 }
 
 /**
- * @brief Clear the LCD screen.
+ * @brief Send queued bytes and, when due, queue the next framebuffer diff.
+ *
+ * A new diff is only computed once the previous one has been completely
+ * transmitted; this keeps the driver queue from overflowing (a full-screen
+ * diff needs at most 32 characters plus 16 address instructions).
  */
-void Lcd1602::clear(){ lcd_.clear(); }
+void Lcd1602::service(){
+  lcd_.service();
+
+  if (!dirty_ || !lcd_.idle()) return;
+  if ((uint32_t)(millis() - lastDiffMs_) < refreshMs_) return;
+
+  pushDiff_();
+}
+
+/**
+ * @brief Push pending framebuffer changes now and block until they are displayed.
+ */
+void Lcd1602::flush(){
+  lcd_.flush();
+  if (dirty_) pushDiff_();
+  lcd_.flush();
+}
 
 /**
- * @brief Set the cursor position on the LCD.
+ * @brief Queue the cells that differ between fb_ and shown_.
+ *
+ * The HD44780 auto-increments its address after every character, so a run
+ * of changed cells needs a single address instruction.
+ */
+void Lcd1602::pushDiff_(){
+  SIM_CYCLES(ROWS * COLS * 10);   // framebuffer compare
+  for (uint8_t r = 0; r < ROWS; ++r) {
+    bool addrOk = false;   // LCD address points at (r, c)?
+    for (uint8_t c = 0; c < COLS; ++c) {
+      if (fb_[r][c] == shown_[r][c]) {
+        addrOk = false;
+        continue;
+      }
+      if (!addrOk) {
+        lcd_.command(0x80 | ((r ? 0x40 : 0x00) + c));
+        addrOk = true;
+      }
+      lcd_.write((uint8_t)fb_[r][c]);
+      shown_[r][c] = fb_[r][c];
+    }
+  }
+  dirty_ = false;
+  lastDiffMs_ = millis();
+}
+
+/**
+ * @brief Store a character in the framebuffer at the cursor and advance it.
+ *
+ * Writes outside the visible 16×2 area are dropped, matching what a 16×2
+ * display shows for text that runs past the last column.
+ *
+ * @param ch Character code.
+ */
+void Lcd1602::put_(uint8_t ch){
+  if (col_ < COLS && row_ < ROWS) {
+    if (fb_[row_][col_] != (char)ch) {
+      fb_[row_][col_] = (char)ch;
+      dirty_ = true;
+    }
+  }
+  if (col_ < 255) col_++;
+}
+
+/**
+ * @brief Clear the framebuffer and move the cursor to (0, 0).
+ *
+ * No LCD instruction is issued; the blanked cells are sent by the next diff
+ * like any other change, which avoids the 1.5 ms clear instruction.
+ */
+void Lcd1602::clear(){
+  for (uint8_t r = 0; r < ROWS; ++r) {
+    for (uint8_t c = 0; c < COLS; ++c) {
+      if (fb_[r][c] != ' ') {
+        fb_[r][c] = ' ';
+        dirty_ = true;
+      }
+    }
+  }
+  col_ = row_ = 0;
+}
+
+/**
+ * @brief Set the framebuffer cursor position.
  *
  * @param c  Column index (0–15).
  * @param r  Row index (0–1).
  */
-void Lcd1602::setCursor(uint8_t c,uint8_t r){ lcd_.setCursor(c,r); }
+void Lcd1602::setCursor(uint8_t c,uint8_t r){
+  col_ = c;
+  row_ = r;
+}
 
 /**
  * @brief Print a RAM-resident C-string to the display.
  *
  * @param s  Null-terminated character string.
  */
-void Lcd1602::print(const char* s){ lcd_.print(s); }
+void Lcd1602::print(const char* s){ out_.print(s); }
 
 /**
  * @brief Print a PROGMEM (flash-resident) string to the display.
  *
  * @param s  Flash string wrapped in __FlashStringHelper.
  */
-void Lcd1602::print(const __FlashStringHelper* s){ lcd_.print(s); }
+void Lcd1602::print(const __FlashStringHelper* s){ out_.print(s); }
 
 /**
  * @brief Overload: print a signed integer.
  */
-void Lcd1602::print(int v){ lcd_.print(v); }
+void Lcd1602::print(int v){ out_.print(v); }
 
 /**
  * @brief Overload: print an unsigned 8-bit integer.
  */
-void Lcd1602::print(uint8_t v){ lcd_.print(v); }
+void Lcd1602::print(uint8_t v){ out_.print(v); }
 
 /**
  * @brief Overload: print a signed long integer.
  */
-void Lcd1602::print(long v){ lcd_.print(v); }
+void Lcd1602::print(long v){ out_.print(v); }
 
 /**
  * @brief Overload: print an unsigned long integer.
  */
-void Lcd1602::print(unsigned long v){ lcd_.print(v); }
+void Lcd1602::print(unsigned long v){ out_.print(v); }
 
 /**
  * @brief Overload: print a floating-point number with precision.
@@ -96,14 +193,34 @@ void Lcd1602::print(unsigned long v){ lcd_.print(v); }
  * @param v     Floating-point value.
  * @param prec  Number of digits after the decimal point.
  */
-void Lcd1602::print(float v, uint8_t prec) { lcd_.print(v, prec); }
+void Lcd1602::print(float v, uint8_t prec) { out_.print(v, prec); }
 
 /**
  * @brief Write a single raw character to the display.
  *
  * @param ch  Character to write.
  */
-void Lcd1602::write(char ch){ lcd_.write(ch); }
+void Lcd1602::write(char ch){ put_((uint8_t)ch); }
+
+/**
+ * @brief Queue CGRAM rows of a custom character.
+ *
+ * Sets the CGRAM address to the first row and writes the bitmaps; the LCD
+ * auto-increments the address between rows. The next framebuffer diff always
+ * starts with a DDRAM address instruction, so no explicit switch back to
+ * DDRAM is needed.
+ *
+ * @param slot      Glyph index (0–7).
+ * @param firstRow  First pixel row (0–7).
+ * @param rows      Row bitmaps (low 5 bits used).
+ * @param count     Number of rows.
+ */
+void Lcd1602::setGlyphRows(uint8_t slot, uint8_t firstRow, const uint8_t* rows, uint8_t count){
+  lcd_.command(0x40 | ((slot & 0x07) << 3) | (firstRow & 0x07));
+  for (uint8_t i = 0; i < count; ++i) {
+    lcd_.write((uint8_t)(rows[i] & 0x1F));
+  }
+}
 
 /**
  * @brief Set the LCD backlight brightness using PWM.
@@ -111,19 +228,27 @@ void Lcd1602::write(char ch){ lcd_.write(ch); }
  * The backlight value is stored internally. If invertBL was set in the
  * constructor, the PWM duty cycle is inverted (pwm = 255 - pwm) before writing.
  *
+ * In LOOP_PROFILE builds Timer1 is the profiler's time base, so the backlight
+ * is only switched: any non-zero duty cycle turns it fully on.
+ *
  * @param pwm  PWM duty cycle (0–255) for backlight brightness.
  */
 void Lcd1602::setBacklight(uint8_t pwm){
   blVal_ = pwm;
   if(inv_) pwm = 255 - pwm;
+#if LOOP_PROFILE
+  digitalWrite(blPin_, pwm ? HIGH : LOW);
+#else
   analogWrite(blPin_, pwm);
+#endif
 }
 
 /**
  * @brief Display a two-line title, clearing the screen before writing.
  *
- * This convenience function clears the LCD, places the cursor at the beginning
- * of line 0 and line 1, and writes two provided flash-resident strings.
+ * This convenience function clears the framebuffer, places the cursor at the
+ * beginning of line 0 and line 1, and writes two provided flash-resident strings.
+ * If the new title equals what is already shown, no LCD traffic results.
  *
  * @param l1  First line text (flash-resident).
  * @param l2  Second line text (flash-resident).
@@ -131,9 +256,9 @@ void Lcd1602::setBacklight(uint8_t pwm){
 void Lcd1602::title2(const __FlashStringHelper* l1,
                      const __FlashStringHelper* l2)
 {
-    lcd_.clear();
-    lcd_.setCursor(0,0);
-    lcd_.print(l1);
-    lcd_.setCursor(0,1);
-    lcd_.print(l2);
+    clear();
+    setCursor(0,0);
+    out_.print(l1);
+    setCursor(0,1);
+    out_.print(l2);
 }
@@ -1,18 +1,22 @@
 #pragma once
 #include <Arduino.h>
-#include <LiquidCrystal.h>
+#include "Hd44780.h"
 
 /**
  * @brief Wrapper class for a 16x2 HD44780-compatible LCD with PWM backlight control.
  *
- * This class encapsulates a LiquidCrystal instance and adds:
+ * This class encapsulates a queued, non-blocking Hd44780 driver and adds:
  *  - convenient print overloads,
  *  - PWM-based backlight brightness control,
  *  - an optional inversion mode for shields with reversed backlight polarity,
  *  - helper formatting utilities such as title2().
  *
- * It is designed as a drop-in usability enhancement over the standard
- * LiquidCrystal API.
+ * It keeps the familiar LiquidCrystal-style API, but drawing calls only write
+ * into a 2×16 shadow framebuffer in RAM. service(), which must be called from
+ * loop(), periodically compares the framebuffer with what the display already
+ * shows and queues only the changed cells (plus the cursor moves needed to
+ * reach them). Redrawing a whole screen with mostly identical text therefore
+ * costs no bus traffic, and clear() no longer issues the slow LCD clear.
  */
 class Lcd1602 {
   
@@ -37,12 +41,45 @@ public:
    * @brief Initialize the LCD hardware and backlight subsystem.
    *
    * Configures the backlight pin as output, applies the stored brightness
-   * setting, and initializes the LiquidCrystal driver for a 16×2 display.
+   * setting, and initializes the HD44780 controller for a 16×2 display.
    */
   void begin();
 
+  /** @brief Number of visible columns. */
+  static constexpr uint8_t COLS = 16;
+
+  /** @brief Number of visible rows. */
+  static constexpr uint8_t ROWS = 2;
+
+  /**
+   * @brief Push framebuffer changes to the display; call on every loop pass.
+   *
+   * Sends at most one queued byte per call. When the previous update has
+   * been fully transmitted, the framebuffer is dirty and the refresh interval
+   * has elapsed, the changed cells are diffed into the output queue. Never
+   * waits for the LCD.
+   */
+  void service();
+
   /**
-   * @brief Clear the LCD display.
+   * @brief Immediately push all framebuffer changes and wait until they are shown.
+   *
+   * Only needed before deliberately blocking sections of code.
+   */
+  void flush();
+
+  /**
+   * @brief Set the minimum time between two framebuffer diffs.
+   *
+   * Changes made within one interval are coalesced into a single update,
+   * which bounds the LCD bus traffic regardless of how often the UI redraws.
+   *
+   * @param ms Refresh interval in milliseconds (0 = update as soon as possible).
+   */
+  void setRefreshInterval(uint16_t ms) { refreshMs_ = ms; }
+
+  /**
+   * @brief Clear the framebuffer (all cells become spaces) and home the cursor.
    */
   void clear();
 
@@ -99,10 +136,37 @@ public:
   /**
    * @brief Write a single raw character to the display.
    *
+   * Characters written beyond the last column are discarded.
+   *
    * @param ch Character to write.
    */
   void write(char ch);
 
+  /**
+   * @brief Queue new bitmap rows for a custom (CGRAM) character.
+   *
+   * Writes @p count consecutive pixel rows of glyph @p slot starting at
+   * @p firstRow. Each row uses the low 5 bits (bit 4 = leftmost pixel).
+   * Cells showing character code @p slot update on the display as soon as
+   * the rows are written; the framebuffer itself does not change.
+   *
+   * @param slot      Glyph index (0–7).
+   * @param firstRow  First pixel row to write (0 = top, 7 = bottom).
+   * @param rows      Row bitmaps.
+   * @param count     Number of rows (firstRow + count <= 8).
+   */
+  void setGlyphRows(uint8_t slot, uint8_t firstRow, const uint8_t* rows, uint8_t count);
+
+  /**
+   * @brief Number of bytes that can still be queued without blocking.
+   *
+   * Lets incremental widgets defer their output instead of overflowing the
+   * driver queue.
+   *
+   * @return Free entries in the output queue.
+   */
+  uint8_t outputFree() const { return lcd_.freeSlots(); }
+
   /**
    * @brief Set the backlight brightness using PWM.
    *
@@ -120,16 +184,71 @@ public:
   /**
    * @brief Display two lines of flash-resident text as a title.
    *
-   * Clears the screen, then prints the provided strings on line 0 and line 1.
+   * Clears the framebuffer, then prints the provided strings on line 0 and
+   * line 1. Text longer than 16 characters is truncated.
    *
    * @param l1 First line text (flash-resident).
    * @param l2 Second line text (flash-resident).
    */
-  void Lcd1602::title2(const __FlashStringHelper* l1, const __FlashStringHelper* l2);
+  void title2(const __FlashStringHelper* l1, const __FlashStringHelper* l2);
 
 private:
-  /** @brief Underlying LiquidCrystal driver instance. */
-  LiquidCrystal lcd_;
+  /**
+   * @brief Print adapter that renders formatted output into the framebuffer.
+   *
+   * Lets the print() overloads reuse Arduino's Print number formatting.
+   */
+  class FrameWriter : public Print {
+  public:
+    explicit FrameWriter(Lcd1602& lcd) : lcd_(lcd) {}
+    size_t write(uint8_t ch) override { lcd_.put_(ch); return 1; }
+    using Print::write;
+  private:
+    Lcd1602& lcd_;
+  };
+
+  /**
+   * @brief Store one character at the cursor position and advance the cursor.
+   *
+   * @param ch Character code.
+   */
+  void put_(uint8_t ch);
+
+  /**
+   * @brief Queue the difference between fb_ and shown_ to the driver.
+   *
+   * Walks the cells row by row and emits a "set DDRAM address" instruction
+   * only where the LCD's auto-incremented address does not already point at
+   * the next changed cell.
+   */
+  void pushDiff_();
+
+  /** @brief Underlying queued HD44780 driver instance. */
+  Hd44780 lcd_;
+
+  /** @brief Desired display content, written by the drawing calls. */
+  char fb_[ROWS][COLS];
+
+  /** @brief Content the LCD shows (or will show once the queue has drained). */
+  char shown_[ROWS][COLS];
+
+  /** @brief Framebuffer cursor column (may run past the last column). */
+  uint8_t col_ = 0;
+
+  /** @brief Framebuffer cursor row. */
+  uint8_t row_ = 0;
+
+  /** @brief True when fb_ may differ from shown_. */
+  bool dirty_ = false;
+
+  /** @brief Minimum time between two diffs (ms). */
+  uint16_t refreshMs_ = 40;
+
+  /** @brief millis() timestamp of the last diff. */
+  uint32_t lastDiffMs_ = 0;
+
+  /** @brief Print adapter writing into fb_. */
+  FrameWriter out_{*this};
 
   /** @brief PWM pin controlling the LCD backlight. */
   uint8_t blPin_;
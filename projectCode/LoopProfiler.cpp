@@ -0,0 +1,120 @@
+#include "LoopProfiler.h"
+
+/**
+ * @file LoopProfiler.cpp
+ * @brief Storage and time base of the loop profiler.
+ */
+
+#if LOOP_PROFILE
+
+static_assert(PROTO_PROF_SIZE <= PROTO_MAX_BODY, "MSG_PROF_DUMP reply must fit a frame");
+
+/**
+ * @brief Global loop profiler instance.
+ */
+LoopProfiler gLoopProfiler;
+
+/**
+ * @brief Histogram bin of a duration (see PROF_HIST_BINS).
+ *
+ * Bit length of the high byte plus 8, or of the low byte if the high byte
+ * is 0, found with a short compare chain.
+ *
+ * @param ticks Duration in ticks.
+ * @return Bin index.
+ */
+static uint8_t histBin(uint16_t ticks) {
+  uint8_t v   = (uint8_t)(ticks >> 8);
+  uint8_t bin = 8;
+  if (!v) {
+    v   = (uint8_t)ticks;
+    bin = 0;
+  }
+  if (v >= 16) { v >>= 4; bin += 4; }
+  if (v >= 4)  { v >>= 2; bin += 2; }
+  if (v >= 2)  { v >>= 1; bin += 1; }
+  bin += v;
+  return bin < PROF_HIST_BINS ? bin : PROF_HIST_BINS - 1;
+}
+
+/**
+ * @brief Start the time base and clear all probes.
+ *
+ * Timer1 runs in normal mode at clk/8 with its compare outputs disconnected;
+ * analogWrite() on pin 9/10 would reconnect them, which Lcd1602 avoids in
+ * profiling builds.
+ */
+void LoopProfiler::begin() {
+#if defined(__AVR__)
+  uint8_t sreg = SREG;
+  cli();
+  TCCR1A = 0;
+  TCCR1B = _BV(CS11);
+  TIMSK1 = 0;
+  TCNT1  = 0;
+  SREG = sreg;
+#endif
+  clearAll();
+}
+
+/**
+ * @brief Reset one probe.
+ *
+ * @param id Probe (PROF_*).
+ */
+void LoopProfiler::clear(uint8_t id) {
+  if (id >= PROF_PROBES) return;
+  memset(&probes_[id], 0, sizeof(ProfProbe));
+  pending_ &= (uint8_t)~(1u << id);
+}
+
+/**
+ * @brief Reset all probes.
+ */
+void LoopProfiler::clearAll() {
+  memset(probes_, 0, sizeof(probes_));
+  pending_ = 0;
+}
+
+/**
+ * @brief Fold the passes kept by add() into the statistics.
+ */
+void LoopProfiler::collect() {
+  for (uint8_t id = 0; pending_; ++id) {
+    const uint8_t bit = (uint8_t)(1u << id);
+    if (!(pending_ & bit)) continue;
+    pending_ &= (uint8_t)~bit;
+    record_(id, last_[id]);
+  }
+}
+
+/**
+ * @brief Update the statistics of a probe with one pass.
+ *
+ * @param id     Probe (PROF_*).
+ * @param ticks  Duration in ticks.
+ */
+void LoopProfiler::record_(uint8_t id, uint16_t ticks) {
+  SIM_CYCLES(60);
+  ProfProbe& p = probes_[id];
+  p.total += ticks;
+  if (ticks > p.max) p.max = ticks;
+  ++p.hist[histBin(ticks)];
+  if (++p.count == 0xFFFF) halve_(p);
+}
+
+/**
+ * @brief Halve the accumulated figures of a probe whose count is full.
+ *
+ * Keeps average and histogram shape while bounding the counters; max is
+ * left alone.
+ *
+ * @param p Probe statistics.
+ */
+void LoopProfiler::halve_(ProfProbe& p) {
+  p.count >>= 1;
+  p.total >>= 1;
+  for (uint8_t i = 0; i < PROF_HIST_BINS; ++i) p.hist[i] >>= 1;
+}
+
+#endif
@@ -0,0 +1,163 @@
+#pragma once
+#include <Arduino.h>
+#include "ProtocolDefs.h"
+#include "SimCycles.h"
+
+/**
+ * @file LoopProfiler.h
+ * @brief Cycle-level profile of the main loop (diagnostic builds only).
+ *
+ * Build with -DLOOP_PROFILE=1 to time the sections of loop() listed as
+ * PROF_* in ProtocolDefs.h. Without it (the default) the probe macros expand
+ * to nothing and no code, RAM or timer is used.
+ *
+ * Time base: Timer1, free running at clk/8 (0.5 µs ticks, wraps after
+ * 32.768 ms). A section longer than that is recorded modulo the wrap. Timer1
+ * also drives the PWM of the LCD backlight (pin 10); in a profiling build the
+ * backlight is switched on/off instead of dimmed.
+ *
+ * Cost on the ATmega328P: PROF_BEGIN reads TCNT1 (about 4 cycles);
+ * PROF_END reads it again and only stores the duration (about 15 cycles, under
+ * 1 µs). Count, total, max and histogram are updated by PROF_COLLECT() at the
+ * end of loop(), outside every probe (about 60 cycles per probe that ran).
+ * The table takes PROF_PROBES * 42 bytes of RAM.
+ *
+ * Probes nest: everything runs inside PROF_LOOP, and PROF_STEPPER inside
+ * PROF_MODE (the modes call StepperDriver::update() from step()). The begin
+ * and end of an inner probe, about 20 cycles, count towards every probe
+ * around it, so PROF_LOOP reads about 9 µs high (seven inner probes) and
+ * PROF_MODE about 1.3 µs high while a mode runs.
+ */
+#ifndef LOOP_PROFILE
+#define LOOP_PROFILE 0
+#endif
+
+#if LOOP_PROFILE
+
+#if defined(HOST_HAL)
+namespace hal { uint64_t nowUs(); }
+#endif
+
+/**
+ * @brief Statistics of one probe.
+ */
+struct ProfProbe {
+  uint16_t count;                   ///< Passes (halved together with total and hist at 0xFFFF).
+  uint32_t total;                   ///< Sum of the durations (ticks).
+  uint16_t max;                     ///< Longest pass since the last clear (ticks).
+  uint16_t hist[PROF_HIST_BINS];    ///< log2 histogram of the durations.
+};
+
+/**
+ * @brief Table of per-probe duration statistics.
+ *
+ * add() is inline so that a probe with a constant index compiles to direct
+ * RAM accesses. It is meant for the main loop, not for interrupts.
+ */
+class LoopProfiler {
+public:
+  /**
+   * @brief Start Timer1 as the free-running time base and clear the table.
+   *
+   * Call at the start of setup(), before anything uses pin 10 PWM.
+   */
+  void begin();
+
+  /** @brief Current time in ticks (PROF_TICK_NS). */
+  static inline uint16_t now() {
+#if defined(__AVR__)
+    return TCNT1;
+#elif defined(HOST_HAL)
+    SIM_CYCLES(4);
+    return (uint16_t)(hal::nowUs() * 1000u / PROF_TICK_NS);
+#else
+    return (uint16_t)(micros() * 1000u / PROF_TICK_NS);
+#endif
+  }
+
+  /**
+   * @brief Record one pass of a probe.
+   *
+   * Runs inside the sections around the probe, so it only keeps the
+   * duration until collect(). A second pass of the same probe before that
+   * is folded in at once.
+   *
+   * @param id     Probe (PROF_*).
+   * @param ticks  Duration in ticks.
+   */
+  inline void add(uint8_t id, uint16_t ticks) {
+    SIM_CYCLES(11);
+    const uint8_t bit = (uint8_t)(1u << id);
+    if (pending_ & bit) record_(id, last_[id]);
+    last_[id] = ticks;
+    pending_ |= bit;
+  }
+
+  /**
+   * @brief Fold the passes kept by add() into the statistics.
+   *
+   * Call once per loop() pass, after the outermost probe (PROF_COLLECT()).
+   */
+  void collect();
+
+  /** @brief Statistics of a probe (id < PROF_PROBES). */
+  const ProfProbe& probe(uint8_t id) const { return probes_[id]; }
+
+  /** @brief Reset one probe. */
+  void clear(uint8_t id);
+
+  /** @brief Reset all probes. */
+  void clearAll();
+
+private:
+  /** @brief Update the statistics of a probe with one pass. */
+  void record_(uint8_t id, uint16_t ticks);
+
+  /** @brief Halve count, total and histogram of a probe. */
+  static void halve_(ProfProbe& p);
+
+  /** @brief Statistics per probe. */
+  ProfProbe probes_[PROF_PROBES];
+
+  /** @brief Duration of the last pass of each probe, until collect(). */
+  uint16_t last_[PROF_PROBES];
+
+  /** @brief Probes with a pass in last_ (bit per PROF_*). */
+  uint8_t pending_ = 0;
+
+  static_assert(PROF_PROBES <= 8, "pending_ has one bit per probe");
+};
+
+/** @brief The profiler fed by the PROF_* macros. */
+extern LoopProfiler gLoopProfiler;
+
+/**
+ * @brief Times the rest of the enclosing scope as one pass of a probe.
+ */
+class ProfScope {
+public:
+  explicit ProfScope(uint8_t id) : id_(id), t0_(LoopProfiler::now()) {}
+  ~ProfScope() { gLoopProfiler.add(id_, (uint16_t)(LoopProfiler::now() - t0_)); }
+
+private:
+  uint8_t  id_;
+  uint16_t t0_;
+};
+
+/** @brief Start timing probe p (PROF_* constant) in the current scope. */
+#define PROF_BEGIN(p) const uint16_t prof_t0_##p = LoopProfiler::now()
+/** @brief Record the time since PROF_BEGIN(p) in the same scope. */
+#define PROF_END(p)   gLoopProfiler.add(p, (uint16_t)(LoopProfiler::now() - prof_t0_##p))
+/** @brief Time the rest of the enclosing scope as probe p. */
+#define PROF_SCOPE(p) ProfScope prof_scope_##p(p)
+/** @brief Update the statistics; at the end of loop(), outside every probe. */
+#define PROF_COLLECT() gLoopProfiler.collect()
+
+#else
+
+#define PROF_BEGIN(p)  ((void)0)
+#define PROF_END(p)    ((void)0)
+#define PROF_SCOPE(p)  ((void)0)
+#define PROF_COLLECT() ((void)0)
+
+#endif
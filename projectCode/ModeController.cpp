@@ -1,4 +1,6 @@
 #include "ModeController.h"
+#include "EventLog.h"
+#include "LoopProfiler.h"
 
 /**
  * @file ModeController.cpp
@@ -8,7 +10,8 @@
  *  - browse a set of IMode implementations using LEFT/RIGHT keys,
  *  - start a selected mode with SELECT,
  *  - run the active mode in a non-blocking fashion,
- *  - optionally exit a running mode with SELECT (for non-"JOG"/"PARAM" modes).
+ *  - optionally exit a running mode with SELECT (unless the mode owns SELECT),
+ *  - manage the current sensor, stepper and LCD refresh rate per mode.
  *
  * It uses an Lcd1602 instance for display output and a KeypadShield for key input.
  */
@@ -18,11 +21,14 @@
  *
  * @param lcd        Reference to an Lcd1602 display used for the menu and status.
  * @param keys       Reference to a KeypadShield used for user input.
+ * @param current    Current sensor managed for modes with MODE_NEEDS_SENSOR.
+ * @param stepper    Stepper driver managed for modes with MODE_NEEDS_STEPPER.
  * @param modes      Array of pointers to IMode objects managed by this controller.
  * @param modeCount  Number of entries in the modes array.
  */
-ModeController::ModeController(Lcd1602& lcd, KeypadShield& keys, IMode** modes, uint8_t modeCount)
-  : lcd_(lcd), keys_(keys), modes_(modes), n_(modeCount) {}
+ModeController::ModeController(Lcd1602& lcd, KeypadShield& keys, CurrentSensor& current,
+                               StepperDriver& stepper, IMode** modes, uint8_t modeCount)
+  : lcd_(lcd), keys_(keys), current_(current), stepper_(stepper), modes_(modes), n_(modeCount) {}
 
 /**
  * @brief Initialize the controller and start the default mode.
@@ -61,25 +67,49 @@ void ModeController::drawMenu_(){
 /**
  * @brief Start a mode by index and switch UI state to RUNNING.
  *
- * The mode's begin() method is called once before the first step() invocation.
+ * The mode's capabilities are read once and cached. The stepper driver is
+ * enabled before begin() so the mode can command motion right away; the
+ * current sensor is enabled after begin(), so that a timing profile selected
+ * in begin() is applied to a freshly started window.
  *
  * @param idx  Index of the mode to start (0 <= idx < n_).
  */
 void ModeController::start_(uint8_t idx){
   running_=idx;
+  caps_ = modes_[running_]->caps();
+  gEventLog.log(EV_MODE_START, (int16_t)caps_.id);
+
+  if (caps_.flags & MODE_NEEDS_STEPPER) stepper_.enable(true);
+  lcd_.setRefreshInterval(caps_.uiRefreshMs);
+  keys_.clear();   // the SELECT that started the mode must not reach it
+
   modes_[running_]->begin();
+
+  if (caps_.flags & MODE_NEEDS_SENSOR) current_.setEnabled(true);
   ui_=UiState::RUNNING;
 }
 
 /**
  * @brief Stop the currently running mode and return to the menu.
  *
- * Calls end() on the active mode, sets the UI state back to MENU, and redraws
- * the menu so the user can select a new mode.
+ * Calls end() on the active mode, then puts the shared peripherals in a
+ * safe state: the current sensor is disabled and, for modes that drive the
+ * stepper, motion is stopped while the driver stays enabled to hold position.
+ * Finally the UI state goes back to MENU and the menu is redrawn.
  */
 void ModeController::stop_(){
   modes_[running_]->end();
+  gEventLog.log(EV_MODE_STOP, (int16_t)caps_.id);
+
+  current_.setEnabled(false);
+  if (caps_.flags & MODE_NEEDS_STEPPER) {
+    stepper_.setSpeedMmPerSec(0.0f);
+    stepper_.enable(true);
+  }
+
   ui_=UiState::MENU;
+  keys_.clear();   // nor may the key that ended it reach the menu
+  lcd_.setRefreshInterval(MENU_REFRESH_MS);
   drawMenu_();
 }
 
@@ -87,52 +117,83 @@ void ModeController::stop_(){
  * @brief Main controller loop to be called periodically from the Arduino loop().
  *
  * Behavior:
- *  - Reads the next key event from the keypad.
- *  - If in MENU state:
+ *  - Lets the keypad take its next sample (KeypadShield::update()).
+ *  - If in MENU state, for each queued Press event:
  *      - LEFT  : select previous mode (with wrap-around) and redraw menu.
  *      - RIGHT : select next mode (with wrap-around) and redraw menu.
  *      - SELECT: start the currently selected mode and switch to RUNNING.
  *  - If in RUNNING state:
  *      - Calls step() on the active mode.
- *      - Determines whether the mode is a "JOG" or "PARAM" mode based on its
- *        name; for such modes, SELECT does not trigger a global exit.
- *      - For all other modes, pressing SELECT stops the mode and returns to the
- *        menu.
+ *      - For modes flagged MODE_OWNS_SELECT (cached at start), SELECT does not
+ *        trigger a global exit; such modes read the event queue themselves.
+ *      - For all other modes, the controller drains the event queue and a
+ *        SELECT press stops the mode and returns to the menu.
  *      - If step() returns true, the mode indicates completion and is stopped
  *        automatically.
  */
 void ModeController::loop(){
-  Key k = keys_.poll();
+  PROF_BEGIN(PROF_KEYS);
+  keys_.update();
+  PROF_END(PROF_KEYS);
+  KeyEvent ev;
+
   if(ui_==UiState::MENU){
-    if(k==Key::LEFT){ 
-      selected_ = (selected_==0? n_-1 : selected_-1); 
-      drawMenu_(); 
-    }
-    else if(k==Key::RIGHT){ 
-      selected_ = (selected_+1)%n_; 
-      drawMenu_(); 
-    }
-    else if(k==Key::SELECT){
-      start_(selected_); 
+    while (keys_.next(ev)) {
+      if (ev.type != KeyEventType::Press) continue;
+      if(ev.key==Key::LEFT){ 
+        selected_ = (selected_==0? n_-1 : selected_-1); 
+        drawMenu_(); 
+      }
+      else if(ev.key==Key::RIGHT){ 
+        selected_ = (selected_+1)%n_; 
+        drawMenu_(); 
+      }
+      else if(ev.key==Key::SELECT){
+        start_(selected_); 
+        return;
+      }
     }
   } else { // RUNNING
-    bool done = modes_[running_]->step();
-
-    // Determine if this is a JOG-like mode in which SELECT should not cause a global exit.
-    const char* rn = modes_[running_]->name();
-    bool isJog =
-             (strcmp(rn, "JOG")  == 0) ||
-             (strcmp(rn, "PARAM") == 0);
-
-    // For non-JOG modes, SELECT acts as a global "exit to menu".
-    if (!isJog && k == Key::SELECT) {
-      stop_();
-      return;
+    // Unless the mode handles SELECT itself, SELECT acts as a global "exit to menu".
+    // Such modes do not read the keypad, so their events are consumed here.
+    bool exitReq = false;
+    if (!(caps_.flags & MODE_OWNS_SELECT)) {
+      while (keys_.next(ev)) {
+        if (ev.key == Key::SELECT && ev.type == KeyEventType::Press) exitReq = true;
+      }
     }
 
-    // If the active mode reports completion, stop it and go back to the menu.
-    if (done) {
+    PROF_BEGIN(PROF_MODE);
+    bool done = modes_[running_]->step();
+    PROF_END(PROF_MODE);
+
+    // If SELECT was pressed or the active mode reports completion, go back to the menu.
+    if (exitReq || done) {
       stop_();
     }
   }
 }
+
+/**
+ * @brief Start a mode on remote request.
+ *
+ * @param idx Index of the mode.
+ * @return false if a mode is running or idx is invalid.
+ */
+bool ModeController::startMode(uint8_t idx){
+  if (ui_ != UiState::MENU || idx >= n_) return false;
+  selected_ = idx;
+  start_(idx);
+  return true;
+}
+
+/**
+ * @brief Stop the running mode on remote request.
+ *
+ * @return false if no mode is running.
+ */
+bool ModeController::stopMode(){
+  if (ui_ != UiState::RUNNING) return false;
+  stop_();
+  return true;
+}
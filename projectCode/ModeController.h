@@ -2,6 +2,8 @@
 #include "KeypadShield.h"
 #include "IMode.h"
 #include "Lcd1602.h"
+#include "CurrentSensor.h"
+#include "StepperDriver.h"
 
 /**
  * @brief State machine for menu navigation and mode execution.
@@ -15,6 +17,12 @@
  * operating mode of the system. The controller switches between a menu state
  * (where the user selects a mode) and a running state (where a single mode is
  * active and its step() function is called repeatedly).
+ *
+ * When a mode is started, its capability descriptor (IMode::caps()) is read
+ * once. Based on it the controller enables the current sensor and the stepper
+ * driver for the mode, sets the LCD refresh interval, and decides whether
+ * SELECT aborts the mode; on exit it stops the stepper and disables the
+ * sensor again.
  */
 class ModeController {
 public:
@@ -32,10 +40,13 @@ public:
    *
    * @param lcd        Reference to the LCD helper used to render the menu and status.
    * @param keys       Reference to the keypad handler used for user input.
+   * @param current    Current sensor, enabled for modes with MODE_NEEDS_SENSOR.
+   * @param stepper    Stepper driver, managed for modes with MODE_NEEDS_STEPPER.
    * @param modes      Pointer to an array of IMode* representing all available modes.
    * @param modeCount  Number of elements in the modes array.
    */
-  ModeController(Lcd1602& lcd, KeypadShield& keys, IMode** modes, uint8_t modeCount);
+  ModeController(Lcd1602& lcd, KeypadShield& keys, CurrentSensor& current, StepperDriver& stepper,
+                 IMode** modes, uint8_t modeCount);
 
   /**
    * @brief Initialize the controller and start operation.
@@ -50,7 +61,7 @@ public:
    * @brief Main update function to be called from the Arduino loop().
    *
    * Responsibilities:
-   *  - Reads keypad events.
+   *  - Updates the keypad and reads its events.
    *  - In MENU state: updates the selected mode and handles mode activation.
    *  - In RUNNING state: calls step() on the active mode and interprets its
    *    completion condition or exit key.
@@ -59,6 +70,42 @@ public:
    */
   void loop();
 
+  /**
+   * @brief Start a mode on request of a remote client.
+   *
+   * Behaves like selecting the mode in the menu and pressing SELECT.
+   *
+   * @param idx Index of the mode in menu order.
+   * @return false if a mode is already running or idx is out of range.
+   */
+  bool startMode(uint8_t idx);
+
+  /**
+   * @brief Stop the running mode on request of a remote client.
+   *
+   * Behaves like the global SELECT exit, also for modes that own SELECT.
+   *
+   * @return false if no mode is running.
+   */
+  bool stopMode();
+
+  /** @brief True while a mode is running. */
+  bool isRunning() const { return ui_ == UiState::RUNNING; }
+
+  /** @brief Index of the running mode, or of the mode selected in the menu. */
+  uint8_t currentIndex() const { return isRunning() ? running_ : selected_; }
+
+  /** @brief Number of modes managed by the controller. */
+  uint8_t modeCount() const { return n_; }
+
+  /**
+   * @brief Access a mode by index.
+   *
+   * @param idx Index in menu order (0 <= idx < modeCount()).
+   * @return The mode.
+   */
+  IMode* mode(uint8_t idx) const { return modes_[idx]; }
+
 private:
   /**
    * @brief Draw the current menu screen on the LCD.
@@ -72,7 +119,8 @@ private:
   /**
    * @brief Start the mode at the given index.
    *
-   * Sets the internal running mode index, invokes begin() on the selected mode,
+   * Sets the internal running mode index, reads the mode's capabilities,
+   * prepares the peripherals it needs, invokes begin() on the selected mode,
    * and switches the UI state to RUNNING.
    *
    * @param idx Index into the modes_ array (0 <= idx < n_).
@@ -82,8 +130,8 @@ private:
   /**
    * @brief Stop the currently running mode and return to the menu state.
    *
-   * Invokes end() on the active mode, updates the UI state to MENU, and
-   * refreshes the menu on the LCD.
+   * Invokes end() on the active mode, stops the peripherals managed for it,
+   * updates the UI state to MENU, and refreshes the menu on the LCD.
    */
   void stop_();
 
@@ -93,6 +141,12 @@ private:
   /** @brief Reference to the keypad handler used for user navigation and selection. */
   KeypadShield& keys_;
 
+  /** @brief Current sensor switched on/off on behalf of the modes. */
+  CurrentSensor& current_;
+
+  /** @brief Stepper driver enabled/stopped on behalf of the modes. */
+  StepperDriver& stepper_;
+
   /** @brief Array of pointers to all available modes. */
   IMode** modes_;
 
@@ -107,4 +161,10 @@ private:
 
   /** @brief Index of the mode that is currently running. */
   uint8_t running_ = 0;
+
+  /** @brief Capabilities of the running mode, cached in start_(). */
+  ModeCaps caps_ = { ModeId::Other, 0, MENU_REFRESH_MS };
+
+  /** @brief LCD refresh interval used while the menu is shown (ms). */
+  static constexpr uint16_t MENU_REFRESH_MS = 40;
 };
@@ -1,23 +1,66 @@
 #include "Modes.h"
 #include "Parameters.h" 
+#include "EventLog.h"
 #include <Arduino.h>
 extern float baselineCurrent;
 
+/**
+ * @brief Drive both relay outputs and log the new relay state.
+ *
+ * The relays are active LOW. Every relay change of MOD1/MOD2 goes through
+ * here, so the event log shows exactly when 30 V / 9 V were applied.
+ *
+ * @param pin1    Relay 1 pin.
+ * @param level1  Level of relay 1 (LOW = energized).
+ * @param pin2    Relay 2 pin.
+ * @param level2  Level of relay 2 (LOW = energized).
+ */
+static void setRelays(uint8_t pin1, uint8_t level1, uint8_t pin2, uint8_t level2) {
+  digitalWrite(pin1, level1);
+  digitalWrite(pin2, level2);
+  gEventLog.log(EV_RELAY, (level1 == LOW ? TELEM_RELAY1 : 0) | (level2 == LOW ? TELEM_RELAY2 : 0));
+}
+
+/** @name Current sensor timing profiles
+ *  @{
+ *
+ * Window/interval pairs applied by the modes on state entry. Longer windows
+ * average out more noise, shorter windows react faster; each phase uses the
+ * shortest window it can tolerate.
+ */
+
+/** @brief Quiet, long window for the HOME baseline measurement (5 mains periods). */
+static const SensorTiming TIMING_BASELINE = { 100000UL, 400UL };
+
+#if defined(HOST_HAL)
+/** @brief Medium window for surface detection and 30 V validation. */
+SensorTiming gTimingDetect   = {  40000UL, 200UL };
+
+/** @brief Shortest usable window (one 50 Hz period) for detecting the end of etching. */
+SensorTiming gTimingEtchEnd  = {  20000UL, 200UL };
+#else
+/** @brief Medium window for surface detection and 30 V validation. */
+static const SensorTiming gTimingDetect   = {  40000UL, 200UL };
+
+/** @brief Shortest usable window (one 50 Hz period) for detecting the end of etching. */
+static const SensorTiming gTimingEtchEnd  = {  20000UL, 200UL };
+#endif
+/** @} */
+
 /**
  * @brief Initialize the HOME mode and start the homing procedure.
  *
  * Behavior:
  *  - Displays a homing status message on the LCD.
  *  - Configures the limit switch pin with INPUT_PULLUP.
- *  - Enables the stepper driver and starts moving downward at a fixed speed
- *    until the limit switch is hit.
+ *  - Starts moving downward at a fixed speed until the limit switch is hit
+ *    (the controller has already enabled the stepper driver).
  *  - Initializes all flags and accumulators for the baseline current
  *    measurement that will be performed later at Z = 30 mm.
  */
 void HomeMode::begin() {
   lcd_.title2(F("HOMING..."), F("Moving up"));
   pinMode(limitPin_, INPUT_PULLUP);
-  stepper_.enable(true);
   stepper_.setSpeedMmPerSec(-5.0f);
   homed_ = false;
   baselineMeasuring_ = false;
@@ -43,7 +86,8 @@ void HomeMode::begin() {
  *     - compute the average baseline current,
  *     - store it in the global baselineCurrent,
  *     - display the result.
- *  4. After a short delay, the mode reports completion.
+ *  4. After the result has been shown for 2 s (non-blocking wait), the mode
+ *     reports completion.
  *
  * @return true  when the homing process and baseline measurement are complete,
  * @return false otherwise, meaning the mode should continue to run.
@@ -54,6 +98,7 @@ bool HomeMode::step() {
       stepper_.update();
 
       if (digitalRead(limitPin_) == LOW) {
+          gEventLog.log(EV_HOME_SWITCH);
           stepper_.setSpeedMmPerSec(0.0f);
           stepper_.setPositionMm(0.0f);   // Z = 0
           homed_ = true;
@@ -80,7 +125,8 @@ bool HomeMode::step() {
           // Stop at Z = 30 mm
           stepper_.setSpeedMmPerSec(0.0f);
 
-          // Start the 5 s baseline measurement
+          // Start the 5 s baseline measurement with the long, quiet window
+          current_.setTiming(TIMING_BASELINE);
           current_.setEnabled(true);
           baselineMeasuring_ = true;
           baselineStart_ = now;
@@ -107,6 +153,7 @@ bool HomeMode::step() {
           current_.setEnabled(false);
           baselineMeasuring_ = false;
           baselineDone_ = true;
+          doneStart_ = now;
 
           float I0 = 0.0f;
           if (baselineCount_ > 0) {
@@ -114,6 +161,7 @@ bool HomeMode::step() {
           }
 
           baselineCurrent = I0;   // global baseline
+          gEventLog.log(EV_BASELINE, evMilliAmps(I0));
 
           lcd_.clear();
           lcd_.setCursor(0, 0);
@@ -129,10 +177,10 @@ bool HomeMode::step() {
       return false;
   }
 
-  // Phase 4: measurement finished → exit HOME mode after a short delay
+  // Phase 4: measurement finished → keep the result on screen for 2 s, then exit.
+  // The wait is non-blocking so that the queued LCD output is actually shown.
   if (baselineDone_) {
-      delay(2000);
-      return true;   // HOME mode finished
+      return (now - doneStart_) >= 2000UL;   // HOME mode finished
   }
 
   return false;
@@ -141,12 +189,10 @@ bool HomeMode::step() {
 /**
  * @brief Cleanup performed when leaving HOME mode.
  *
- * Currently:
- *  - Ensures the stepper driver remains enabled.
- *  - Does not change position or speed (the caller is expected to handle this).
+ * Nothing to do: the controller stops the stepper (keeping it enabled) and
+ * disables the current sensor for every mode that exits.
  */
 void HomeMode::end() {
-  stepper_.enable(true);
 }
 
 /**
@@ -156,18 +202,19 @@ void HomeMode::end() {
  *  - Displays mode title on the LCD.
  *  - Configures relay pins and sets them to the initial safe state.
  *  - Resets state machine variables and current averaging helpers.
- *  - Enables the stepper motor and starts moving downward to search for the surface.
- *  - Enables current measurement for threshold-based detection and control.
+ *  - Starts moving downward to search for the surface.
+ *
+ * The stepper driver and the current sensor are enabled by the controller
+ * (see caps()).
  */
 void Mod1Mode::begin() {
   lcd_.title2(F("MOD1: Surface detection"), F("Move down"));
 
   pinMode(relayPin1_, OUTPUT);
   pinMode(relayPin2_, OUTPUT);
-  digitalWrite(relayPin1_, LOW);
-  digitalWrite(relayPin2_, HIGH);
+  setRelays(relayPin1_, LOW, relayPin2_, HIGH);
 
-  st_ = State::MovingDownDetect;
+  enter_(State::MovingDownDetect);
   relayOn_ = false;
   pulseCount_ = 0;
   etchStart_ = 0;
@@ -175,11 +222,10 @@ void Mod1Mode::begin() {
   IavgS_.reset();
 
   bumpedUp1mm_ = false; 
+  run_ = {};
+  run_.mode = ModeId::Mod1;
 
-  stepper_.enable(true);
   stepper_.setSpeedMmPerSec(+1.5f);
-
-  current_.setEnabled(true);
 }
 
 /**
@@ -218,13 +264,14 @@ bool Mod1Mode::step() {
 
   // Global safety limit: immediate abort on out-of-range Z
   if (z <= Z_MIN || z >= Z_MAX) {
+    gEventLog.log(EV_Z_LIMIT, (int16_t)(z * 100.0f));
     stepper_.setSpeedMmPerSec(0.0f);
     current_.setEnabled(false);
-    digitalWrite(relayPin1_, HIGH);
-    digitalWrite(relayPin2_, HIGH);
+    setRelays(relayPin1_, HIGH, relayPin2_, HIGH);
 
     lcd_.title2(F("MOD1: ABORT"), F("Z limit reached"));
-    st_ = State::Done;
+    logRun_(RUN_ABORT_Z_LIMIT);
+    enter_(State::Done);
     return true;
   }
 
@@ -234,10 +281,11 @@ bool Mod1Mode::step() {
     float I = IavgS_.update(Iraw);
 
     if (I >= threshold_) {
+      gEventLog.log(EV_SURFACE, evMilliAmps(I));
+      run_.surfaceZ_mm = z;
       stepper_.setSpeedMmPerSec(0.0f);
       stopTime_ = now;
-      digitalWrite(relayPin1_, HIGH);
-      digitalWrite(relayPin2_, HIGH);
+      setRelays(relayPin1_, HIGH, relayPin2_, HIGH);
 
       lcd_.title2(F("MOD1: Surface detected!"), F(""));
       lcd_.setCursor(0, 1);
@@ -246,7 +294,7 @@ bool Mod1Mode::step() {
       lcd_.print(" A   ");
 
       waitStart_ = now;
-      st_ = State::Wait1;
+      enter_(State::Wait1);
     }
 
     return false;
@@ -262,7 +310,8 @@ bool Mod1Mode::step() {
       lcd_.print("mm");
       
       stepper_.moveRelativeMm(+gParams.mod1.plungeAfterSurface_mm, 1.0f);
-      st_ = State::MoveDown1;
+      run_.plunge_mm = gParams.mod1.plungeAfterSurface_mm;
+      enter_(State::MoveDown1);
     }
     return false;
   }
@@ -271,7 +320,7 @@ bool Mod1Mode::step() {
   if (st_ == State::MoveDown1) {
     if (!stepper_.isBusy()) {
       waitStart_ = now;
-      st_ = State::Wait2;
+      enter_(State::Wait2);
     }
     return false;
   }
@@ -280,15 +329,14 @@ bool Mod1Mode::step() {
   if (st_ == State::Wait2) {
     if (now - waitStart_ >= 1000UL) {
       // 30 V ON only for validation
-      digitalWrite(relayPin1_, HIGH);
-      digitalWrite(relayPin2_, LOW);
+      setRelays(relayPin1_, HIGH, relayPin2_, LOW);
   
       validateStart_ = now;
       Iavg_.reset();
       IavgS_.reset();
   
       lcd_.title2(F("MOD1: Surface Test"), F("Validating..."));
-      st_ = State::Validate30V;
+      enter_(State::Validate30V);
     }
     return false;
   }
@@ -303,20 +351,22 @@ bool Mod1Mode::step() {
   
     // Confirmed surface
     if (I >= CONFIRM_I) {
+      gEventLog.log(EV_CONTACT_OK, evMilliAmps(I));
       lcd_.title2(F("MOD1: 30V ON"), F("Etching..."));
       etchStart_ = now;
-      st_ = State::RelayHold;
+      enter_(State::RelayHold);
       return false;
     }
   
     // False surface: turn off 30 V and resume downward search
     if (now - validateStart_ >= VALIDATE_MS) {
-      digitalWrite(relayPin1_, HIGH);
-      digitalWrite(relayPin2_, HIGH);
+      gEventLog.log(EV_CONTACT_RETRY, evMilliAmps(I));
+      if (run_.retries < 255) ++run_.retries;
+      setRelays(relayPin1_, HIGH, relayPin2_, HIGH);
   
       stepper_.setSpeedMmPerSec(+3.0f);
       lcd_.title2(F("MOD1: Continue"), F("Searching..."));
-      st_ = State::MovingDownDetect;
+      enter_(State::MovingDownDetect);
     }
   
     return false;
@@ -334,8 +384,9 @@ bool Mod1Mode::step() {
     // After pre-etch, start slow upward etching
     stepper_.setSpeedMmPerSec(-gParams.mod1.retractSpeed_mm_s);
   
-    lcd_.title2(F("MOD1: Etching"), F("Rising..."));
-    st_ = State::Etching;
+    lcd_.title2(F("MOD1: Etching"), F(""));
+    graph_.begin(1);
+    enter_(State::Etching);
     return false;
   }
 
@@ -343,16 +394,19 @@ bool Mod1Mode::step() {
   if (st_ == State::Etching) {
     float Iraw = current_.correctedIrms();
     float I = Iavg_.update(Iraw);
+    graph_.update(I);
   
     // When current drops below the etching threshold, stop etching and lift
     if (I < gParams.mod1.etchingThreshold_A) {
+      gEventLog.log(EV_ETCH_END, evMilliAmps(I));
+      run_.etch_ms      = now - etchStart_;
+      run_.endCurrent_A = I;
       stepper_.setSpeedMmPerSec(0.0f);
   
-      digitalWrite(relayPin1_, HIGH);
-      digitalWrite(relayPin2_, HIGH);
+      setRelays(relayPin1_, HIGH, relayPin2_, HIGH);
   
       stepper_.moveRelativeMm(-30.0f, 3.0f);
-      st_ = State::FinalLift;
+      enter_(State::FinalLift);
       return false;
     }
   
@@ -365,7 +419,8 @@ bool Mod1Mode::step() {
     if (!stepper_.isBusy()) {
       current_.setEnabled(false);
       lcd_.title2(F("MOD1: DONE"), F(""));
-      st_ = State::Done;
+      logRun_(RUN_OK);
+      enter_(State::Done);
       return true;
     }
     return false;
@@ -376,21 +431,54 @@ bool Mod1Mode::step() {
 }
 
 /**
- * @brief Cleanup for MOD1 mode.
+ * @brief Switch the MOD1 state machine to a new state.
+ *
+ * Besides updating st_ and logging the transition, this applies the current
+ * sensor timing profile that suits the new phase: the medium window while
+ * searching and validating, the short window while etching so that the
+ * cutoff reacts with minimal latency.
+ * States without an entry here keep the profile that is already active.
  *
- * Ensures:
- *  - stepper speed is set to zero and driver is enabled,
- *  - current measurement is disabled,
- *  - all relays are turned off (safe state).
+ * @param s State to enter.
  */
-void Mod1Mode::end() {
-  stepper_.setSpeedMmPerSec(0.0f);
-  stepper_.enable(true);
+void Mod1Mode::enter_(State s) {
+  st_ = s;
+  gEventLog.log(EV_STATE, ((int16_t)ModeId::Mod1 << 8) | (uint8_t)s);
+
+  switch (s) {
+    case State::MovingDownDetect:
+    case State::Validate30V:
+    case State::RelayHold:
+      current_.setTiming(gTimingDetect);
+      break;
+    case State::Etching:
+      current_.setTiming(gTimingEtchEnd);
+      break;
+    default:
+      break;
+  }
+}
 
-  current_.setEnabled(false);
+/**
+ * @brief Queue the summary of this MOD1 run for the EEPROM run history.
+ *
+ * Only packs the record; RunLog writes it in the background.
+ *
+ * @param result RUN_* result.
+ */
+void Mod1Mode::logRun_(uint8_t result) {
+  run_.result = result;
+  runLog_.record(run_);
+}
 
-  digitalWrite(relayPin1_, HIGH);
-  digitalWrite(relayPin2_, HIGH);
+/**
+ * @brief Cleanup for MOD1 mode.
+ *
+ * Turns all relays off (safe state). The controller stops the stepper and
+ * disables current measurement.
+ */
+void Mod1Mode::end() {
+  setRelays(relayPin1_, HIGH, relayPin2_, HIGH);
 }
 
 /**
@@ -399,27 +487,27 @@ void Mod1Mode::end() {
  * Behavior:
  *  - Displays initial mode information on the LCD.
  *  - Configures relay pins and turns everything off.
- *  - Sets up state machine variables and enables the stepper motor.
+ *  - Sets up state machine variables.
  *  - Begins moving downward to detect the surface using current thresholding.
- *  - Enables current measurement for detection and validation phases.
+ *
+ * The stepper driver and the current sensor are enabled by the controller
+ * (see caps()).
  */
 void Mod2Mode::begin() {
   lcd_.title2(F("MOD2: Surface detection"), F("Move down..."));
 
   pinMode(relayPin1_, OUTPUT);
   pinMode(relayPin2_, OUTPUT);
-  digitalWrite(relayPin1_, HIGH);
-  digitalWrite(relayPin2_, HIGH);
+  setRelays(relayPin1_, HIGH, relayPin2_, HIGH);
 
-  st_ = State::MovingDownDetect;
+  enter_(State::MovingDownDetect);
   relayOn_ = false;
   pulseCount_ = 0;
   etchStart_ = 0;
+  run_ = {};
+  run_.mode = ModeId::Mod2;
 
-  stepper_.enable(true);
   stepper_.setSpeedMmPerSec(+3.0f);
-
-  current_.setEnabled(true);
 }
 
 /**
@@ -458,13 +546,14 @@ bool Mod2Mode::step() {
 
   // Global safety limit: immediate abort if Z is out of bounds
   if (z <= Z_MIN || z >= Z_MAX) {
+    gEventLog.log(EV_Z_LIMIT, (int16_t)(z * 100.0f));
     stepper_.setSpeedMmPerSec(0.0f);
     current_.setEnabled(false);
-    digitalWrite(relayPin1_, HIGH);
-    digitalWrite(relayPin2_, HIGH);
+    setRelays(relayPin1_, HIGH, relayPin2_, HIGH);
 
     lcd_.title2(F("MOD2: ABORT"), F("Z limit reached"));
-    st_ = State::Done;
+    logRun_(RUN_ABORT_Z_LIMIT);
+    enter_(State::Done);
     return true;
   }
 
@@ -473,9 +562,10 @@ bool Mod2Mode::step() {
     float I = current_.correctedIrms();
 
     if (I >= threshold_) {
+      gEventLog.log(EV_SURFACE, evMilliAmps(I));
+      run_.surfaceZ_mm = z;
       stepper_.setSpeedMmPerSec(0.0f);
-      digitalWrite(relayPin1_, HIGH);
-      digitalWrite(relayPin2_, HIGH);
+      setRelays(relayPin1_, HIGH, relayPin2_, HIGH);
 
       lcd_.title2(F("MOD2: Surface detected!"), F(""));
       lcd_.setCursor(0, 1);
@@ -484,7 +574,7 @@ bool Mod2Mode::step() {
       lcd_.print(" A   ");
 
       waitStart_ = now;
-      st_ = State::Wait1;
+      enter_(State::Wait1);
     }
     return false;
   }
@@ -499,7 +589,8 @@ bool Mod2Mode::step() {
       lcd_.print("mm");
       
       stepper_.moveRelativeMm(+gParams.mod2.plungeAfterSurface_mm, 1.0f);
-      st_ = State::MoveDown1;
+      run_.plunge_mm = gParams.mod2.plungeAfterSurface_mm;
+      enter_(State::MoveDown1);
     }
     return false;
   }
@@ -508,7 +599,7 @@ bool Mod2Mode::step() {
   if (st_ == State::MoveDown1) {
     if (!stepper_.isBusy()) {
       waitStart_ = now;
-      st_ = State::Wait2;
+      enter_(State::Wait2);
     }
     return false;
   }
@@ -517,15 +608,14 @@ bool Mod2Mode::step() {
   if (st_ == State::Wait2) {
     if (now - waitStart_ >= 1000UL) {
       // 30 V ON only for validation
-      digitalWrite(relayPin1_, HIGH);
-      digitalWrite(relayPin2_, LOW);
+      setRelays(relayPin1_, HIGH, relayPin2_, LOW);
   
       validateStart_ = now;
       Iavg_.reset();
       IavgS_.reset();
   
       lcd_.title2(F("MOD2: Surface Test"), F("Validating..."));
-      st_ = State::Validate30V;
+      enter_(State::Validate30V);
     }
     return false;
   }
@@ -540,20 +630,23 @@ bool Mod2Mode::step() {
   
     // Confirmed surface
     if (I >= CONFIRM_I) {
-      lcd_.title2(F("MOD2: 30V ON"), F("Etching..."));
+      gEventLog.log(EV_CONTACT_OK, evMilliAmps(I));
+      lcd_.title2(F("MOD2: 30V ON"), F(""));
+      graph_.begin(1);
       etchStart_ = now;
-      st_ = State::RelayHold;
+      enter_(State::RelayHold);
       return false;
     }
   
     // False surface: turn 30 V off and resume downward search
     if (now - validateStart_ >= VALIDATE_MS) {
-      digitalWrite(relayPin1_, HIGH);
-      digitalWrite(relayPin2_, HIGH);
+      gEventLog.log(EV_CONTACT_RETRY, evMilliAmps(I));
+      if (run_.retries < 255) ++run_.retries;
+      setRelays(relayPin1_, HIGH, relayPin2_, HIGH);
   
       stepper_.setSpeedMmPerSec(+3.0f);
       lcd_.title2(F("MOD2: Continue"), F("Searching..."));
-      st_ = State::MovingDownDetect;
+      enter_(State::MovingDownDetect);
     }
   
     return false;
@@ -563,6 +656,7 @@ bool Mod2Mode::step() {
   if (st_ == State::RelayHold) {
     float Iraw = current_.correctedIrms();
     float I = Iavg_.update(Iraw);
+    graph_.update(I);
 
     // Optional pre-etch period of 2 s with 30 V ON
     if (now - etchStart_ < 2000UL) {
@@ -570,9 +664,11 @@ bool Mod2Mode::step() {
     }
 
     // Condition to switch 30 V OFF and proceed
-    if (I <= I <= gParams.mod2.etchingThreshold_A) {
-      digitalWrite(relayPin1_, HIGH);
-      digitalWrite(relayPin2_, HIGH);
+    if (I <= gParams.mod2.etchingThreshold_A) {
+      gEventLog.log(EV_ETCH_END, evMilliAmps(I));
+      run_.etch_ms      = now - etchStart_;
+      run_.endCurrent_A = I;
+      setRelays(relayPin1_, HIGH, relayPin2_, HIGH);
 
       lcd_.title2(F("MOD2: 30V OFF"), F(""));
       lcd_.setCursor(0, 1);
@@ -581,7 +677,7 @@ bool Mod2Mode::step() {
       lcd_.print(" A   ");
 
       waitStart_ = now;
-      st_ = State::Wait3;
+      enter_(State::Wait3);
     }
     return false;
   }
@@ -596,7 +692,7 @@ bool Mod2Mode::step() {
       lcd_.print("mm");
       
       stepper_.moveRelativeMm(+gParams.mod2.plungeAfterEtch_mm, 1.0f);
-      st_ = State::MoveDown2;
+      enter_(State::MoveDown2);
     }
     return false;
   }
@@ -605,7 +701,7 @@ bool Mod2Mode::step() {
   if (st_ == State::MoveDown2) {
     if (!stepper_.isBusy()) {
       waitStart_ = now;
-      st_ = State::Wait4;
+      enter_(State::Wait4);
     }
     return false;
   }
@@ -621,10 +717,9 @@ bool Mod2Mode::step() {
       pulseCount_ = 0;
 
       // 9 V ON (mapping: relay1 LOW, relay2 HIGH)
-      digitalWrite(relayPin1_, LOW);
-      digitalWrite(relayPin2_, HIGH);
+      setRelays(relayPin1_, LOW, relayPin2_, HIGH);
 
-      st_ = State::RelayPulse;
+      enter_(State::RelayPulse);
     }
     return false;
   }
@@ -633,26 +728,25 @@ bool Mod2Mode::step() {
   if (st_ == State::RelayPulse) {
     if (relayOn_) {
       // ON phase
-      if (now - pulseStart_ >= gParams.mod2.pulseOn_s) {
-        digitalWrite(relayPin1_, HIGH);
-        digitalWrite(relayPin2_, HIGH);
+      if (now - pulseStart_ >= (unsigned long)(gParams.mod2.pulseOn_s * 1000.0f)) {
+        setRelays(relayPin1_, HIGH, relayPin2_, HIGH);
         relayOn_ = false;
         pulseStart_ = now;
       }
     } else {
       // OFF phase
-      if (now - pulseStart_ >= gParams.mod2.pulseOff_s) {
+      if (now - pulseStart_ >= (unsigned long)(gParams.mod2.pulseOff_s * 1000.0f)) {
         pulseCount_++;
+        gEventLog.log(EV_PULSE, pulseCount_);
         if (pulseCount_ >= gParams.mod2.pulseCount) {
           // Pulses finished → move up by 30 mm
           lcd_.title2(F("MOD2: DONE"), F(""));
           stepper_.moveRelativeMm(-30.0f, 3.0f);
-          st_ = State::FinalLift;
+          enter_(State::FinalLift);
           return false;
         } else {
           // Next pulse: 9 V ON again
-          digitalWrite(relayPin1_, LOW);
-          digitalWrite(relayPin2_, HIGH);
+          setRelays(relayPin1_, LOW, relayPin2_, HIGH);
           relayOn_ = true;
           pulseStart_ = now;
         }
@@ -664,9 +758,9 @@ bool Mod2Mode::step() {
   // FinalLift: wait for the final 30 mm lift to complete
   if (st_ == State::FinalLift) {
     if (!stepper_.isBusy()) {
-      digitalWrite(relayPin1_, HIGH);
-      digitalWrite(relayPin2_, HIGH);
-      st_ = State::Done;
+      setRelays(relayPin1_, HIGH, relayPin2_, HIGH);
+      logRun_(RUN_OK);
+      enter_(State::Done);
       return true;
     }
     return false;
@@ -676,46 +770,77 @@ bool Mod2Mode::step() {
   return (st_ == State::Done);
 }
 
+/**
+ * @brief Switch the MOD2 state machine to a new state.
+ *
+ * Besides updating st_ and logging the transition, this applies the current
+ * sensor timing profile that suits the new phase: the medium window while
+ * searching and validating, the short window during the 30 V hold, whose end
+ * is detected from a current drop.
+ * States without an entry here keep the profile that is already active.
+ *
+ * @param s State to enter.
+ */
+void Mod2Mode::enter_(State s) {
+  st_ = s;
+  gEventLog.log(EV_STATE, ((int16_t)ModeId::Mod2 << 8) | (uint8_t)s);
+
+  switch (s) {
+    case State::MovingDownDetect:
+    case State::Validate30V:
+      current_.setTiming(gTimingDetect);
+      break;
+    case State::RelayHold:
+      current_.setTiming(gTimingEtchEnd);
+      break;
+    default:
+      break;
+  }
+}
+
+/**
+ * @brief Queue the summary of this MOD2 run for the EEPROM run history.
+ *
+ * Only packs the record; RunLog writes it in the background.
+ *
+ * @param result RUN_* result.
+ */
+void Mod2Mode::logRun_(uint8_t result) {
+  run_.result = result;
+  run_.pulses = pulseCount_;
+  runLog_.record(run_);
+}
+
 /**
  * @brief Cleanup for MOD2 mode.
  *
- * Ensures:
- *  - the stepper motor is stopped and enabled,
- *  - current measurement is disabled,
- *  - all relays are turned off (safe state).
+ * Turns all relays off (safe state). The controller stops the stepper and
+ * disables current measurement.
  */
 void Mod2Mode::end() {
-  stepper_.setSpeedMmPerSec(0.0f);
-  stepper_.enable(true);
-
-  current_.setEnabled(false);
-  digitalWrite(relayPin1_, HIGH);
-  digitalWrite(relayPin2_, HIGH);
+  setRelays(relayPin1_, HIGH, relayPin2_, HIGH);
 }
 
 /**
  * @brief Initialize JogMode for manual up/down positioning.
  *
  * Behavior:
- *  - Resets the local UI tick counter and enables the stepper driver.
+ *  - Resets the local UI tick counter (the controller enables the stepper driver).
  *  - Displays a hint on the LCD that UP/DOWN buttons control motion and SELECT
  *    exits the mode.
- *  - Marks the first step so that a spurious SELECT used to enter the mode can
- *    be cleared.
  */
 void JogMode::begin(){ 
-  uiTick_=0; stepper_.enable(true); 
+  uiTick_=0;
   lcd_.title2(F("JOG (UP/DOWN)"),F("  "));
-  firstStep_ = true;
 }
 
 /**
  * @brief Execute one step of the JogMode.
  *
  * Behavior:
- *  - Reads the stable key state from the keypad.
- *  - On the very first step, ignores a SELECT that might have been used to
- *    enter the mode (to avoid immediate exit).
+ *  - Reads the stable key state from the keypad (motion follows the held key).
+ *  - Drains the keypad event queue, looking for a SELECT press. The SELECT
+ *    used to enter the mode was discarded by the controller.
  *  - Computes the current Z position and applies motion limits [Z_MIN, Z_MAX].
  *  - If UP is pressed and within limits, moves upward (Z decreases).
  *  - If DOWN is pressed and within limits, moves downward (Z increases).
@@ -729,12 +854,10 @@ void JogMode::begin(){
 bool JogMode::step(){
   Key s = keys_.stable();
 
-  if (firstStep_) {
-    if (s == Key::SELECT) {
-      keys_.clear();
-      s = Key::NONE;
-    }
-    firstStep_ = false;
+  bool exitReq = false;
+  KeyEvent ev;
+  while (keys_.next(ev)) {
+    if (ev.key == Key::SELECT && ev.type == KeyEventType::Press) exitReq = true;
   }
 
   float z = stepper_.positionMm();
@@ -774,12 +897,12 @@ bool JogMode::step(){
   }
 
   // SELECT terminates the mode
-  return (s == Key::SELECT);
+  return exitReq;
 }
 
 /**
  * @brief Cleanup for JogMode.
  *
- * Ensures the stepper motor is stopped and enabled when leaving the mode.
+ * Nothing to do: the controller stops the stepper (keeping it enabled).
  */
-void JogMode::end(){ stepper_.setSpeedMmPerSec(0); stepper_.enable(true);}
+void JogMode::end(){}
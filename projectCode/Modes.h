@@ -5,6 +5,8 @@
 #include "StepperDriver.h"
 #include "CurrentSensor.h"
 #include "MovingAverage.h"
+#include "CurrentGraph.h"
+#include "RunLog.h"
 
 /**
  * @brief Moving average type for long-window current averaging.
@@ -32,6 +34,19 @@ using IAvg_s = MovingAverage<20, 1000>;
  */
 extern float baselineCurrent;
 
+#if defined(HOST_HAL)
+/**
+ * @brief Sensor timing profiles of surface detection/validation and of the
+ *        etch end detection (defined in Modes.cpp).
+ *
+ * Applied by MOD1/MOD2 on state entry. Not part of gParams; writable in host
+ * builds so that a harness can try other windows between runs. On the board
+ * they are constants private to Modes.cpp.
+ */
+extern SensorTiming gTimingDetect;
+extern SensorTiming gTimingEtchEnd;
+#endif
+
 /**
  * @brief Homing mode for the Z axis with baseline current measurement.
  *
@@ -63,6 +78,20 @@ public:
    */
   const char* name() const override { return "HOME"; }
 
+  /**
+   * @brief Get the capability descriptor of this mode.
+   *
+   * @return Stepper managed by the controller; the sensor is switched by the mode only for the baseline phase.
+   */
+  ModeCaps caps() const override { return { ModeId::Home, MODE_NEEDS_STEPPER, 100 }; }
+
+  /**
+   * @brief Current homing phase.
+   *
+   * @return 0 = homing, 1 = moving to start / baseline measurement, 2 = done.
+   */
+  uint8_t phase() const override { return homed_ ? (baselineDone_ ? 2 : 1) : 0; }
+
   /**
    * @brief Initialize the HOME mode.
    *
@@ -87,7 +116,8 @@ public:
   /**
    * @brief Cleanup performed when exiting HOME mode.
    *
-   * Typically ensures the stepper driver remains in a safe, enabled state.
+   * Nothing mode-specific is left to undo; the controller stops the stepper
+   * and the current sensor.
    */
   void end() override;
 
@@ -128,6 +158,9 @@ private:
 
   /** @brief Number of RMS samples accumulated into baselineSum_. */
   uint32_t baselineCount_ = 0;
+
+  /** @brief Timestamp (ms) when the baseline result was displayed. */
+  unsigned long doneStart_ = 0;
 };
 
 /**
@@ -158,9 +191,11 @@ public:
    * @param etchingThreshold  Threshold for terminating the etching phase.
    * @param Iavg              Long-window moving average for current monitoring.
    * @param IavgS             Short-window moving average for smoothing/detection.
+   * @param graph             Live current display shown while etching.
+   * @param runLog            Run history receiving a record per finished run.
    */
-  Mod1Mode(Lcd1602& lcd, StepperDriver& stepper, uint8_t relayPin1, uint8_t relayPin2, CurrentSensor& current, float currentThreshold, float etchingThreshold, IAvg_t& Iavg, IAvg_s& IavgS)
-  : lcd_(lcd), stepper_(stepper), relayPin1_(relayPin1), relayPin2_(relayPin2), current_(current), threshold_(currentThreshold), etchingThreshold_(etchingThreshold), Iavg_(Iavg), IavgS_(IavgS){}
+  Mod1Mode(Lcd1602& lcd, StepperDriver& stepper, uint8_t relayPin1, uint8_t relayPin2, CurrentSensor& current, float currentThreshold, float etchingThreshold, IAvg_t& Iavg, IAvg_s& IavgS, CurrentGraph& graph, RunLog& runLog)
+  : lcd_(lcd), stepper_(stepper), relayPin1_(relayPin1), relayPin2_(relayPin2), current_(current), threshold_(currentThreshold), etchingThreshold_(etchingThreshold), Iavg_(Iavg), IavgS_(IavgS), graph_(graph), runLog_(runLog){}
 
   /**
    * @brief Get the name of this mode.
@@ -169,6 +204,30 @@ public:
    */
   const char* name() const override { return "MOD1"; }
 
+  /**
+   * @brief Get the capability descriptor of this mode.
+   *
+   * @return Sensor and stepper managed by the controller; SELECT aborts.
+   */
+  ModeCaps caps() const override { return { ModeId::Mod1, MODE_NEEDS_SENSOR | MODE_NEEDS_STEPPER, 100 }; }
+
+  /**
+   * @brief Current state of the MOD1 state machine.
+   *
+   * @return The State enumerator as a number.
+   */
+  uint8_t phase() const override { return (uint8_t)st_; }
+
+  /**
+   * @brief Change the surface detection threshold (takes effect immediately).
+   *
+   * @param amps  Corrected RMS current that counts as contact (A).
+   */
+  void setSurfaceThreshold(float amps) { threshold_ = amps; }
+
+  /** @brief Surface detection threshold in use (A). */
+  float surfaceThreshold() const { return threshold_; }
+
   /**
    * @brief Initialize MOD1 mode.
    *
@@ -192,8 +251,8 @@ public:
   /**
    * @brief Cleanup performed when leaving MOD1 mode.
    *
-   * Ensures that the stepper is stopped and enabled, current measurement is
-   * disabled, and relay outputs are placed in a safe (OFF) state.
+   * Places the relay outputs in a safe (OFF) state. Stopping the stepper and
+   * disabling current measurement is done centrally by the controller.
    */
   void end() override;
 
@@ -226,6 +285,20 @@ private:
     Done
   };
 
+  /**
+   * @brief Enter a new state and apply its current sensor timing profile.
+   *
+   * @param s State to enter.
+   */
+  void enter_(State s);
+
+  /**
+   * @brief Store the summary of this run in the run history.
+   *
+   * @param result RUN_* result.
+   */
+  void logRun_(uint8_t result);
+
   /** @brief Reference to LCD for on-screen messages and prompts. */
   Lcd1602& lcd_;
 
@@ -255,6 +328,12 @@ private:
 
   /** @brief Short-window moving average for current during detection/validation. */
   IAvg_s& IavgS_;
+
+  /** @brief Live current bar graph / sparkline shown during etching. */
+  CurrentGraph& graph_;
+
+  /** @brief Run history. */
+  RunLog& runLog_;
   
   /** @brief Current state in the MOD1 state machine. */
   State st_ = State::MovingDownDetect;
@@ -284,6 +363,9 @@ private:
    * when current drops below a given threshold (if that behavior is enabled).
    */
   bool bumpedUp1mm_ = false;
+
+  /** @brief Run summary collected for the run history. */
+  RunRecord run_ = {};
 };
 
 /**
@@ -312,6 +394,8 @@ public:
    * @param etchingThreshold  Threshold for decisions during etching/hold phases.
    * @param Iavg              Long-window moving average for current.
    * @param IavgS             Short-window moving average for current.
+   * @param graph             Live current display shown during the 30 V hold.
+   * @param runLog            Run history receiving a record per finished run.
    */
   Mod2Mode(Lcd1602& lcd,
            StepperDriver& stepper,
@@ -321,7 +405,9 @@ public:
            float surfaceThreshold,
            float etchingThreshold,
            IAvg_t& Iavg,
-           IAvg_s& IavgS)
+           IAvg_s& IavgS,
+           CurrentGraph& graph,
+           RunLog& runLog)
     : lcd_(lcd),
       stepper_(stepper),
       relayPin1_(relayPin1),
@@ -330,7 +416,9 @@ public:
       threshold_(surfaceThreshold),
       etchingThreshold_(etchingThreshold),
       Iavg_(Iavg),
-      IavgS_(IavgS) {}
+      IavgS_(IavgS),
+      graph_(graph),
+      runLog_(runLog) {}
 
   /**
    * @brief Get the name of this mode.
@@ -339,6 +427,30 @@ public:
    */
   const char* name() const override { return "MOD2"; }
 
+  /**
+   * @brief Get the capability descriptor of this mode.
+   *
+   * @return Sensor and stepper managed by the controller; SELECT aborts.
+   */
+  ModeCaps caps() const override { return { ModeId::Mod2, MODE_NEEDS_SENSOR | MODE_NEEDS_STEPPER, 100 }; }
+
+  /**
+   * @brief Current state of the MOD2 state machine.
+   *
+   * @return The State enumerator as a number.
+   */
+  uint8_t phase() const override { return (uint8_t)st_; }
+
+  /**
+   * @brief Change the surface detection threshold (takes effect immediately).
+   *
+   * @param amps  Corrected RMS current that counts as contact (A).
+   */
+  void setSurfaceThreshold(float amps) { threshold_ = amps; }
+
+  /** @brief Surface detection threshold in use (A). */
+  float surfaceThreshold() const { return threshold_; }
+
   /**
    * @brief Initialize MOD2 mode.
    *
@@ -362,8 +474,8 @@ public:
   /**
    * @brief Cleanup performed when leaving MOD2 mode.
    *
-   * Stops and enables the stepper, disables current measurement, and switches
-   * relays to a safe OFF configuration.
+   * Switches the relays to a safe OFF configuration. Stopping the stepper and
+   * disabling current measurement is done centrally by the controller.
    */
   void end() override;
 
@@ -400,6 +512,20 @@ private:
     Done
   };
 
+  /**
+   * @brief Enter a new state and apply its current sensor timing profile.
+   *
+   * @param s State to enter.
+   */
+  void enter_(State s);
+
+  /**
+   * @brief Store the summary of this run in the run history.
+   *
+   * @param result RUN_* result.
+   */
+  void logRun_(uint8_t result);
+
   /** @brief Reference to the LCD for user-facing messages. */
   Lcd1602& lcd_;
 
@@ -427,6 +553,12 @@ private:
   /** @brief Short-window moving average for current. */
   IAvg_s& IavgS_;
 
+  /** @brief Live current bar graph / sparkline shown during the 30 V hold. */
+  CurrentGraph& graph_;
+
+  /** @brief Run history. */
+  RunLog& runLog_;
+
   /** @brief Current state in the MOD2 state machine. */
   State st_ = State::MovingDownDetect;
 
@@ -447,6 +579,9 @@ private:
 
   /** @brief Number of 9 V pulse cycles executed. */
   uint8_t pulseCount_ = 0;
+
+  /** @brief Run summary collected for the run history. */
+  RunRecord run_ = {};
 };
 
 /**
@@ -477,12 +612,17 @@ public:
    */
   const char* name() const override { return "JOG"; }
 
+  /**
+   * @brief Get the capability descriptor of this mode.
+   *
+   * @return Handles SELECT itself; stepper managed by the controller.
+   */
+  ModeCaps caps() const override { return { ModeId::Jog, MODE_OWNS_SELECT | MODE_NEEDS_STEPPER, 100 }; }
+
   /**
    * @brief Initialize JogMode.
    *
-   * Shows a hint on the LCD, enables the stepper driver, and resets internal
-   * timing/flags, including a guard for ignoring the initial SELECT that may
-   * have been used to enter the mode.
+   * Shows a hint on the LCD and resets internal timing.
    */
   void begin() override;
 
@@ -490,7 +630,7 @@ public:
    * @brief Execute one step of JOG behavior.
    *
    * Reads the keypad, applies motion within configured limits, updates the
-   * LCD periodically with the current position, and exits when SELECT is held.
+   * LCD periodically with the current position, and exits when SELECT is pressed.
    *
    * @return true  if SELECT is pressed and the mode should exit,
    * @return false otherwise.
@@ -500,7 +640,7 @@ public:
   /**
    * @brief Cleanup performed when leaving JogMode.
    *
-   * Stops the stepper and ensures it remains enabled in a safe state.
+   * Nothing mode-specific is left to undo; the controller stops the stepper.
    */
   void end() override;
 
@@ -521,12 +661,4 @@ private:
    * at a specified interval (e.g. every 200 ms).
    */
   uint32_t uiTick_ = 0;
-
-  /**
-   * @brief Flag indicating that the next step call is the first one.
-   *
-   * Used to ignore a SELECT press that may have been used to enter JogMode,
-   * preventing immediate exit.
-   */
-  bool firstStep_ = true;
 };
@@ -1,5 +1,6 @@
 #include "MovingAverage.h"
 #include <Arduino.h>
+#include "SimCycles.h"
 
 /**
  * @file MovingAverage.cpp
@@ -62,7 +63,7 @@ int16_t MovingAverage<N, SCALE>::toFixed_(float xA) {
  *  - Advances the circular index and, once the buffer has wrapped at least
  *    once, marks it as "filled".
  *  - Computes the average as (sum / denom) / SCALE, where:
- *      - denom is N when the buffer is filled,
+ *      - denom is the window length when the buffer is filled,
  *      - otherwise denom is the number of actually inserted samples.
  *
  * The computation is designed to be O(1) per update and numerically stable for
@@ -73,6 +74,7 @@ int16_t MovingAverage<N, SCALE>::toFixed_(float xA) {
  */
 template<int N, int SCALE>
 float MovingAverage<N, SCALE>::update(float xA) {
+    SIM_CYCLES(1600);   // fmul, two fcmp, lroundf, two int->float, two fdiv
     int16_t xmA = toFixed_(xA);
 
     sum_ -= buf_[idx_];
@@ -80,12 +82,12 @@ float MovingAverage<N, SCALE>::update(float xA) {
     sum_ += xmA;
 
     idx_++;
-    if (idx_ >= N) {
+    if (idx_ >= length()) {
         idx_ = 0;
         filled_ = true;
     }
 
-    int denom = filled_ ? N : idx_;
+    int denom = filled_ ? length() : idx_;
     if (denom <= 0) denom = 1;
 
     return (sum_ / (float)denom) / SCALE;
@@ -94,7 +96,7 @@ float MovingAverage<N, SCALE>::update(float xA) {
 /**
  * @brief Reset the moving average filter to a predefined initial value.
  *
- * All N buffer entries are set to the same fixed-point representation of x0A,
+ * All entries of the window are set to the same fixed-point representation of x0A,
  * and the accumulator sum_ is initialized accordingly. If x0A is non-zero,
  * the buffer is considered "filled" immediately; otherwise, filled_ is false
  * and the effective denominator grows as new samples are added.
@@ -109,7 +111,7 @@ void MovingAverage<N, SCALE>::reset(float x0A) {
     idx_ = 0;
     filled_ = false;
 
-    for (int i = 0; i < N; i++) {
+    for (int i = 0; i < length(); i++) {
         buf_[i] = x0;
         sum_ += x0;
     }
@@ -117,6 +119,21 @@ void MovingAverage<N, SCALE>::reset(float x0A) {
     if (x0 != 0) filled_ = true;
 }
 
+#if defined(HOST_HAL)
+/**
+ * @brief Shorten (or restore) the averaging window.
+ *
+ * @param n  Window length in samples, clamped to 1..N.
+ */
+template<int N, int SCALE>
+void MovingAverage<N, SCALE>::setLength(int n) {
+    if (n < 1) n = 1;
+    if (n > N) n = N;
+    len_ = n;
+    reset();
+}
+#endif
+
 /**
  * @brief Explicit template instantiations.
  *
@@ -40,7 +40,7 @@ public:
      *  - Remove the oldest sample from the accumulator and insert the new one.
      *  - Advance the circular index.
      *  - Compute the current average using the proper denominator:
-     *      - N    when the buffer has been filled at least once,
+     *      - length() when the window has been filled at least once,
      *      - idx_ when still filling for the first time.
      *
      * @param xA   New input sample in floating-point units.
@@ -51,8 +51,8 @@ public:
     /**
      * @brief Reset the filter contents and accumulator.
      *
-     * Fills all N buffer entries with the fixed-point representation of x0A
-     * and resets internal state. If x0A is non-zero, the buffer is considered
+     * Fills the window (length() entries, N by default) with the fixed-point
+     * representation of x0A and resets internal state. If x0A is non-zero, the buffer is considered
      * "filled"; otherwise the denominator will increase gradually until the
      * first wrap-around completes the buffer.
      *
@@ -68,6 +68,26 @@ public:
      */
     bool filled() const { return filled_; }
 
+#if defined(HOST_HAL)
+    /**
+     * @brief Average over fewer samples than the buffer holds (host builds only).
+     *
+     * The window becomes the last n samples (clamped to 1..N) and the filter
+     * is reset to zero. The buffer keeps its size N, so this only shortens
+     * the window; it lets a harness try shorter averages without a rebuild.
+     * The board keeps the compile-time length N.
+     *
+     * @param n  Window length in samples.
+     */
+    void setLength(int n);
+
+    /** @brief Current window length in samples (N unless setLength() was called). */
+    int length() const { return len_; }
+#else
+    /** @brief Window length in samples. */
+    int length() const { return N; }
+#endif
+
 private:
     /**
      * @brief Convert a floating-point input to a fixed-point int16_t sample.
@@ -80,17 +100,22 @@ private:
      */
     static int16_t toFixed_(float xA);
 
-    /** @brief Circular buffer storing the last N scaled samples. */
+    /** @brief Circular buffer storing the last length() scaled samples. */
     int16_t buf_[N];
 
-    /** @brief Current index in the circular buffer (0..N-1). */
+#if defined(HOST_HAL)
+    /** @brief Window length in use (1..N). */
+    int len_ = N;
+#endif
+
+    /** @brief Current index in the circular buffer (0..length()-1). */
     int idx_ = 0;
 
     /** @brief Flag indicating that the buffer has wrapped once. */
     bool filled_ = false;
 
     /**
-     * @brief Accumulated sum of the last N fixed-point samples.
+     * @brief Accumulated sum of the last length() fixed-point samples.
      *
      * Stored as long to safely hold N * max(int16_t) even for typical N values.
      */
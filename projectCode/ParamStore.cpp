@@ -0,0 +1,85 @@
+#include "ParamStore.h"
+#include "Crc16.h"
+
+/**
+ * @file ParamStore.cpp
+ * @brief Implementation of the wear-levelled, CRC-protected parameter store.
+ */
+
+/**
+ * @brief Load the newest valid record into gParams.
+ *
+ * Every slot is read and checked (version, size, CRC). Among the valid ones
+ * the record with the highest sequence number wins; sequence numbers are
+ * compared with wrap-around arithmetic.
+ *
+ * @return true if gParams was loaded from EEPROM, false if no valid record exists.
+ */
+bool ParamStore::load() {
+  bool found = false;
+  Record r;
+
+  for (uint8_t s = 0; s < EE_PARAMS_SLOTS; ++s) {
+    EepromWriter::read(slotAddr_(s), &r, sizeof(r));
+
+    if (r.version != VERSION || r.size != sizeof(AllParams)) continue;
+    if (crc16(&r, offsetof(Record, crc)) != r.crc) continue;
+
+    if (!found || (int16_t)(r.seq - rec_.seq) > 0) {
+      rec_  = r;
+      slot_ = s;
+      found = true;
+    }
+  }
+
+  if (found) {
+    gParams = rec_.params;
+  } else {
+    rec_.params = gParams;   // nothing stored yet: first save gets seq 1
+    rec_.seq    = 0;
+  }
+  return found;
+}
+
+/**
+ * @brief Schedule saving of the current gParams.
+ */
+void ParamStore::requestSave() {
+  pending_ = true;
+  service();
+}
+
+/**
+ * @brief Track the running write and start a pending one when possible.
+ *
+ * A pending save is dropped if gParams still equals the stored record.
+ */
+void ParamStore::service() {
+  if (writing_) {
+    if (writer_.busy()) return;
+    writing_ = false;
+  }
+  if (pending_ && !writer_.busy()) {
+    pending_ = false;
+    // unchanged since the last stored record: nothing to write
+    if (memcmp(&rec_.params, &gParams, sizeof(AllParams)) == 0) return;
+    startWrite_();
+  }
+}
+
+/**
+ * @brief Build the next record from gParams and hand it to the writer.
+ *
+ * The record goes to the slot after the current one, never over it.
+ */
+void ParamStore::startWrite_() {
+  rec_.seq     = (uint16_t)(rec_.seq + 1);
+  rec_.version = VERSION;
+  rec_.size    = sizeof(AllParams);
+  rec_.params  = gParams;
+  rec_.crc     = crc16(&rec_, offsetof(Record, crc));
+
+  slot_ = (uint8_t)((slot_ + 1) % EE_PARAMS_SLOTS);
+  writer_.start(slotAddr_(slot_), reinterpret_cast<const uint8_t*>(&rec_), sizeof(rec_));
+  writing_ = true;
+}
@@ -0,0 +1,107 @@
+#pragma once
+#include <Arduino.h>
+#include "Parameters.h"
+#include "EepromWriter.h"
+#include "EepromLayout.h"
+
+/**
+ * @brief Persistent storage of gParams in EEPROM.
+ *
+ * Each save writes a complete record
+ *
+ *     seq (2) | version (1) | size (1) | AllParams | crc16 (2)
+ *
+ * into the next of EE_PARAMS_SLOTS slots (round-robin wear-leveling). The
+ * slot holding the current record is never touched by a save, so a reset in
+ * the middle of a write leaves a record with a bad CRC next to the intact
+ * previous one: the commit is atomic.
+ *
+ * load() reads all slots once at boot and takes the valid record with the
+ * highest sequence number. Records written by a firmware with a different
+ * layout (version or size mismatch) are ignored, and the compiled defaults
+ * stay in effect.
+ *
+ * Saving is non-blocking: requestSave() snapshots gParams into a RAM copy of
+ * the record and hands it to the EepromWriter, which is serviced from loop().
+ */
+class ParamStore {
+public:
+  /** @brief Layout version of the stored record; bump when AllParams changes. */
+  static constexpr uint8_t VERSION = 1;
+
+  /**
+   * @brief Construct a new ParamStore.
+   *
+   * @param writer  Non-blocking EEPROM writer used for saving.
+   */
+  explicit ParamStore(EepromWriter& writer) : writer_(writer) {}
+
+  /**
+   * @brief Load the newest valid record into gParams.
+   *
+   * @return true if a valid record was found, false if defaults are kept.
+   */
+  bool load();
+
+  /**
+   * @brief Schedule saving of the current gParams.
+   *
+   * Nothing is written if gParams equals the last stored record. If a write
+   * is already in progress, the save is started as soon as it has finished
+   * (with the gParams content of that moment).
+   */
+  void requestSave();
+
+  /**
+   * @brief Start a pending save once the writer is free.
+   *
+   * Call frequently from loop() (after EepromWriter::service()).
+   */
+  void service();
+
+  /** @brief True while a save is pending or being written. */
+  bool saving() const { return pending_ || writing_; }
+
+  /** @brief Sequence number of the current record. */
+  uint16_t sequence() const { return rec_.seq; }
+
+private:
+  /** @brief Record as stored in one EEPROM slot. */
+  struct Record {
+    uint16_t  seq;      ///< Incremented by each save (wraps).
+    uint8_t   version;  ///< Layout version (VERSION).
+    uint8_t   size;     ///< sizeof(AllParams) at the time of writing.
+    AllParams params;   ///< Stored parameters.
+    uint16_t  crc;      ///< CRC16 over all preceding fields.
+  };
+
+  static_assert(sizeof(Record) <= EE_PARAMS_SLOT, "parameter record does not fit into an EEPROM slot");
+
+  /**
+   * @brief Fill rec_ from gParams with the next sequence number and start writing.
+   */
+  void startWrite_();
+
+  /**
+   * @brief EEPROM address of a slot.
+   *
+   * @param slot Slot index (0..EE_PARAMS_SLOTS-1).
+   * @return Start address.
+   */
+  static uint16_t slotAddr_(uint8_t slot) { return EE_PARAMS_ADDR + (uint16_t)slot * EE_PARAMS_SLOT; }
+
+  /** @brief EEPROM writer shared with other stores. */
+  EepromWriter& writer_;
+
+  /** @brief RAM copy of the current (or currently written) record. */
+  Record rec_ = {};
+
+  /** @brief Slot holding rec_. */
+  uint8_t slot_ = EE_PARAMS_SLOTS - 1;
+
+  /** @brief A save was requested but not started yet. */
+  bool pending_ = false;
+
+  /** @brief rec_ is being written by writer_. */
+  bool writing_ = false;
+};
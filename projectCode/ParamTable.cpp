@@ -0,0 +1,77 @@
+#include "ParamTable.h"
+#include <stddef.h>
+
+/**
+ * @file ParamTable.cpp
+ * @brief Flash-resident descriptor table of the editable parameters.
+ *
+ * Ranges are chosen to cover sensible process settings while rejecting
+ * typos that would drive the tip into the holder or make a phase endless.
+ */
+
+/** @brief Shorthand for the byte offset of a member of AllParams. */
+#define PARAM_OFS(member) ((uint8_t)offsetof(AllParams, member))
+
+const ParamDesc PARAM_TABLE[] PROGMEM = {
+  // name           units   grp type              dec offset                                  min     max
+  { "M1 PLUNGE",    "mm",   0, ParamType::Float, 3, PARAM_OFS(mod1.plungeAfterSurface_mm), 0.0f,   20.0f  },
+  { "M1 Ithr",      "A",    0, ParamType::Float, 3, PARAM_OFS(mod1.etchingThreshold_A),    0.0f,   2.0f   },
+  { "M1 RET SPD",   "mm/s", 0, ParamType::Float, 3, PARAM_OFS(mod1.retractSpeed_mm_s),     0.0f,   5.0f   },
+  { "M2 PLUNGE",    "mm",   1, ParamType::Float, 3, PARAM_OFS(mod2.plungeAfterSurface_mm), 0.0f,   20.0f  },
+  { "M2 Ithr",      "A",    1, ParamType::Float, 3, PARAM_OFS(mod2.etchingThreshold_A),    0.0f,   2.0f   },
+  { "M2 PLUNGE2",   "mm",   1, ParamType::Float, 3, PARAM_OFS(mod2.plungeAfterEtch_mm),    0.0f,   20.0f  },
+  { "M2 PULSE NUM", "",     1, ParamType::Int,   0, PARAM_OFS(mod2.pulseCount),            1.0f,   255.0f },
+  { "M2 PULSE ON",  "s",    1, ParamType::Float, 3, PARAM_OFS(mod2.pulseOn_s),             0.01f,  60.0f  },
+  { "M2 PULSE OFF", "s",    1, ParamType::Float, 3, PARAM_OFS(mod2.pulseOff_s),            0.01f,  60.0f  },
+};
+
+const uint8_t PARAM_COUNT = sizeof(PARAM_TABLE) / sizeof(PARAM_TABLE[0]);
+
+/**
+ * @brief Copy a descriptor from flash into RAM.
+ *
+ * @param idx  Table index.
+ * @param d    Receives the descriptor.
+ */
+void paramDesc(uint8_t idx, ParamDesc& d) {
+  memcpy_P(&d, &PARAM_TABLE[idx], sizeof(ParamDesc));
+}
+
+/**
+ * @brief Read a parameter value from gParams.
+ *
+ * @param d Descriptor of the parameter.
+ * @return Current value as float.
+ */
+float paramGet(const ParamDesc& d) {
+  const uint8_t* p = reinterpret_cast<const uint8_t*>(&gParams) + d.offset;
+  if (d.type == ParamType::Int) {
+    int v;
+    memcpy(&v, p, sizeof(v));
+    return (float)v;
+  }
+  float v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+/**
+ * @brief Clamp a value to the parameter range and store it in gParams.
+ *
+ * @param d  Descriptor of the parameter.
+ * @param v  Requested value.
+ * @return Stored value.
+ */
+float paramSet(const ParamDesc& d, float v) {
+  if (v < d.minVal) v = d.minVal;
+  if (v > d.maxVal) v = d.maxVal;
+
+  uint8_t* p = reinterpret_cast<uint8_t*>(&gParams) + d.offset;
+  if (d.type == ParamType::Int) {
+    int iv = (int)(v + 0.5f);
+    memcpy(p, &iv, sizeof(iv));
+    return (float)iv;
+  }
+  memcpy(p, &v, sizeof(v));
+  return v;
+}
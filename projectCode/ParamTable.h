@@ -0,0 +1,63 @@
+#pragma once
+#include <Arduino.h>
+#include "Parameters.h"
+
+/**
+ * @brief Storage type of a parameter inside AllParams.
+ */
+enum class ParamType : uint8_t { Float, Int };
+
+/**
+ * @brief Description of one editable parameter.
+ *
+ * The table of descriptors (PARAM_TABLE) lives in flash and drives the
+ * on-device editor: label, units, number of decimals shown/edited, valid
+ * range and the location of the value inside gParams. Adding a parameter
+ * means adding a field to AllParams and one row to the table.
+ */
+struct ParamDesc {
+  char      name[13];   ///< LCD label (row 0), e.g. "M1 PLUNGE".
+  char      units[5];   ///< Units printed after the value, e.g. "mm"; empty if none.
+  uint8_t   group;      ///< Parameter group: 0 = MOD1, 1 = MOD2.
+  ParamType type;       ///< Storage type of the value.
+  uint8_t   decimals;   ///< Digits after the decimal point (0 for Int).
+  uint8_t   offset;     ///< Byte offset of the value inside AllParams.
+  float     minVal;     ///< Smallest allowed value.
+  float     maxVal;     ///< Largest allowed value.
+};
+
+/** @brief Number of parameter groups (MOD1, MOD2). */
+static constexpr uint8_t PARAM_GROUPS = 2;
+
+/** @brief Descriptor table in flash (read with paramDesc()). */
+extern const ParamDesc PARAM_TABLE[] PROGMEM;
+
+/** @brief Number of entries in PARAM_TABLE. */
+extern const uint8_t PARAM_COUNT;
+
+/**
+ * @brief Copy a descriptor from flash.
+ *
+ * @param idx  Table index (0..PARAM_COUNT-1).
+ * @param d    Receives the descriptor.
+ */
+void paramDesc(uint8_t idx, ParamDesc& d);
+
+/**
+ * @brief Read the current value of a parameter from gParams.
+ *
+ * @param d Descriptor of the parameter.
+ * @return Value (Int parameters are converted to float exactly).
+ */
+float paramGet(const ParamDesc& d);
+
+/**
+ * @brief Write a parameter in gParams, clamped to its range.
+ *
+ * Int parameters are rounded to the nearest integer.
+ *
+ * @param d  Descriptor of the parameter.
+ * @param v  New value.
+ * @return The value actually stored (after clamping/rounding).
+ */
+float paramSet(const ParamDesc& d, float v);
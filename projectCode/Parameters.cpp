@@ -10,8 +10,9 @@
  * retract distances), current thresholds, timing settings, and pulse-generation
  * parameters used during surface detection, etching, or post-processing steps.
  *
- * The values defined here represent the default configuration and may be
- * overridden or adjusted at runtime if the system supports parameter editing.
+ * The values defined here represent the default configuration. At boot they
+ * are replaced by the last saved values if ParamStore finds a valid record in
+ * EEPROM, and they can be edited at runtime in ParametersMode.
  */
 
 /**
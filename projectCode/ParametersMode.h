@@ -3,18 +3,23 @@
 #include "Lcd1602.h"
 #include "KeypadShield.h"
 #include "Parameters.h"
+#include "ParamTable.h"
+#include "ParamStore.h"
 #include <Arduino.h>
 
 /**
  * @brief Interactive on-device editor for MOD1/MOD2 parameters.
  *
  * ParametersMode implements an IMode-based, non-blocking UI to inspect and edit
- * the configurable parameters stored in gParams (for MOD1 and MOD2). It uses:
+ * the configurable parameters stored in gParams (for MOD1 and MOD2). The list
+ * of parameters, their labels, units, precision and valid ranges come from the
+ * descriptor table PARAM_TABLE (ParamTable.h); this class contains no
+ * per-parameter code. It uses:
  *
  * - A 16x2 LCD (Lcd1602) to display the current screen:
  *   - mode selection: choose MOD1 or MOD2,
  *   - parameter selection: choose which parameter to edit,
- *   - float or integer editors: digit-by-digit editing.
+ *   - editor: digit-by-digit editing of the value.
  * - A KeypadShield for input (UP, DOWN, LEFT, RIGHT, SELECT).
  *
  * Navigation / interaction summary:
@@ -22,15 +27,21 @@
  *     - UP/DOWN/LEFT/RIGHT: toggle between MOD1 and MOD2.
  *     - Short SELECT: enter parameter selection for the chosen mode.
  *     - Long SELECT (>= 2 s): exit ParametersMode (step() returns true).
+ * - Short SELECT means a SELECT release that did not produce a long press;
+ *   UP/DOWN/LEFT/RIGHT act on press and on autorepeat while held.
  * - In parameter selection:
  *     - UP/DOWN: move between parameters of the current mode.
- *     - Short SELECT: enter editor (float or int depending on parameter).
+ *     - Short SELECT: enter the editor.
  *     - Long SELECT: return to mode selection.
- * - In editors:
+ * - In the editor:
  *     - LEFT/RIGHT: move cursor between digits.
  *     - UP/DOWN: increment/decrement the digit under the cursor.
  *     - Short SELECT: save and return to parameter selection.
  *     - Long SELECT: save and return to mode selection.
+ *   Saved values are clamped to the range given in the descriptor table.
+ *
+ * Edited values take effect in gParams immediately; they are written to
+ * EEPROM (ParamStore) when the mode is left.
  */
 class ParametersMode : public IMode {
 public:
@@ -39,9 +50,10 @@ public:
      *
      * @param lcd   Reference to the LCD used for all parameter UI screens.
      * @param keys  Reference to the keypad used for editing and navigation.
+     * @param store Parameter store used to persist the edited values.
      */
-    ParametersMode(Lcd1602& lcd, KeypadShield& keys)
-        : lcd_(lcd), keys_(keys) {}
+    ParametersMode(Lcd1602& lcd, KeypadShield& keys, ParamStore& store)
+        : lcd_(lcd), keys_(keys), store_(store) {}
 
     /**
      * @brief Name of this mode.
@@ -50,21 +62,28 @@ public:
      */
     const char* name() const override { return "PARAM"; }
 
+    /**
+     * @brief Get the capability descriptor of this mode.
+     *
+     * @return Handles SELECT itself (short/long press), needs no sensor or
+     *         stepper, and refreshes the LCD quickly for the editor cursor.
+     */
+    ModeCaps caps() const override { return { ModeId::Param, MODE_OWNS_SELECT, 40 }; }
+
     /**
      * @brief Initialize the parameter editing mode.
      *
      * Resets the internal state machine to mode-selection, clears the display,
-     * initializes selection indices and flags, and draws the initial
-     * "Select MODE" screen.
+     * initializes selection indices, and draws the initial "Select MODE" screen.
      */
     void begin() override;
 
     /**
      * @brief Execute one non-blocking step of the parameter editing logic.
      *
-     * Reads the current stable key state from the keypad, updates the internal
-     * UI state (mode selection, parameter selection, or editor), performs
-     * long-press detection for SELECT, and updates the LCD as needed.
+     * Takes the next keypad event, updates the internal UI state (mode
+     * selection, parameter selection, or editor), and updates the LCD as
+     * needed.
      *
      * @return true  if the user has requested to exit parameter mode
      *               (long SELECT in mode-selection state),
@@ -75,8 +94,8 @@ public:
     /**
      * @brief Cleanup when leaving parameter mode.
      *
-     * Currently clears the LCD; this is a hook where persistent storage or
-     * additional actions can be triggered if desired.
+     * Clears the LCD and requests a (non-blocking) save of gParams to EEPROM;
+     * the store skips the write if nothing has changed.
      */
     void end() override;
 
@@ -86,72 +105,49 @@ private:
      *
      * - SelectMode : top level, choose whether to edit MOD1 or MOD2.
      * - SelectParam: list of parameters for the selected mode.
-     * - EditFloat  : digit-based float editor ("XXX.XXX").
-     * - EditInt    : digit-based integer editor ("DDD").
+     * - Edit       : digit-based editor for the selected parameter.
      */
     enum class State {
         SelectMode,
         SelectParam,
-        EditFloat,
-        EditInt
+        Edit
     };
 
+    /** @brief Maximum number of editor characters (digits plus decimal point). */
+    static constexpr uint8_t EDIT_MAX = 8;
+
     /** @brief LCD used for all user interface output. */
     Lcd1602&      lcd_;
 
     /** @brief Keypad used for all navigation and editing input. */
     KeypadShield& keys_;
 
+    /** @brief EEPROM store for gParams. */
+    ParamStore&   store_;
+
     /** @brief Current UI state (mode selection, parameter selection, or editor). */
     State state_ = State::SelectMode;
 
-    /** @brief Selected mode index: 0 = MOD1, 1 = MOD2. */
-    int selectedMode_  = 0;
-
-    /** @brief Selected parameter index within the current mode. */
-    int selectedParam_ = 0;
-
-    /**
-     * @brief Buffer for the float editor representing "XXX.XXX".
-     *
-     * Layout:
-     *  - digits_[0..2]: integer digits (hundreds, tens, ones).
-     *  - digits_[3]   : '.' decimal separator.
-     *  - digits_[4..6]: fractional digits (tenths, hundredths, thousandths).
-     */
-    char digits_[7];
+    /** @brief Selected mode index (parameter group): 0 = MOD1, 1 = MOD2. */
+    uint8_t selectedMode_  = 0;
 
-    /**
-     * @brief Cursor position in the float editor (0..6).
-     *
-     * Values:
-     *  - 0..2: integer digits,
-     *  - 3   : decimal point (not editable),
-     *  - 4..6: fractional digits.
-     */
-    int  cursor_ = 0;
+    /** @brief Selected parameter index within the current group. */
+    uint8_t selectedParam_ = 0;
 
-    /**
-     * @brief Buffer for the integer editor representing "DDD".
-     *
-     * Each entry holds a single digit character: hundreds, tens, ones.
-     */
-    char idigits_[3];
+    /** @brief Descriptor of the parameter being edited (copied from flash). */
+    ParamDesc desc_;
 
     /**
-     * @brief Cursor position in the integer editor (0..2).
+     * @brief Editor buffer, e.g. "03.500" for a value with 2 integer and 3
+     *        fractional digits; the layout follows the descriptor.
      */
-    int  icursor_ = 0;
+    char edit_[EDIT_MAX];
 
-    /**
-     * @brief Timestamp (ms) when SELECT was pressed down for long-press detection.
-     */
-    unsigned long selDownMs_ = 0;
+    /** @brief Number of used characters in edit_. */
+    uint8_t editLen_ = 0;
 
-    /**
-     * @brief Flag indicating whether SELECT is currently being held down.
-     */
-    bool          selHeld_   = false;
+    /** @brief Cursor position in edit_ (never on the decimal point). */
+    uint8_t cursor_  = 0;
 
     /**
      * @brief Flag that indicates the current screen needs to be redrawn.
@@ -161,19 +157,6 @@ private:
      */
     bool needRedraw_ = true;
 
-    /**
-     * @brief Last stable key state for edge/transition detection.
-     */
-    Key  lastKey_    = Key::NONE;
-
-    /**
-     * @brief Flag indicating the first call to step() after begin().
-     *
-     * Used to discard the SELECT press that might have been used to enter
-     * this mode, avoiding immediate exit or unintended actions.
-     */
-    bool firstStep_  = true;
-
     /**
      * @brief Timestamp (ms) used for cursor blink timing.
      */
@@ -184,15 +167,6 @@ private:
      */
     bool          blinkBlock_ = false;
 
-    /**
-     * @brief Flag to ignore the next SELECT release after a long-press event.
-     *
-     * When a long press triggers a state change (e.g., exit to mode selection),
-     * the corresponding SELECT release event should not be interpreted as a
-     * short press. This flag prevents such accidental transitions.
-     */
-    bool ignoreSelectRelease_;
-
     // --- internal helpers ---
 
     /**
@@ -205,79 +179,54 @@ private:
     /**
      * @brief Draw the currently selected parameter and its value.
      *
-     * Uses selectedMode_ and selectedParam_ to look up the appropriate
-     * parameter name and value in gParams and display them on the LCD.
+     * Looks up the descriptor of the selected parameter and prints its label,
+     * current value (with the configured decimals) and units.
      */
     void drawSelectParam();
 
     /**
-     * @brief Initialize the float editor with an initial value.
+     * @brief Table index of the n-th parameter of the selected group.
      *
-     * Clamps the value to [0.000, 999.999], converts it to a fixed "XXX.XXX"
-     * representation in digits_, resets the cursor and flags the editor for
-     * redraw.
-     *
-     * @param value Initial floating-point value to edit.
+     * @param n Index within the group.
+     * @return Index into PARAM_TABLE, or PARAM_COUNT if out of range.
      */
-    void startEditFloat(float value);
+    uint8_t tableIndex(uint8_t n) const;
 
     /**
-     * @brief Convert the current float editor digits into a floating-point value.
+     * @brief Number of parameters in the selected group.
      *
-     * @return The value represented by digits_ in units of "XXX.XXX".
+     * @return Parameter count.
      */
-    float floatFromDigits() const;
+    uint8_t groupCount() const;
 
     /**
-     * @brief Initialize the integer editor with an initial value.
-     *
-     * Clamps the value to [0, 999] and writes it into idigits_ as "DDD". Also
-     * resets the cursor and requests a redraw.
+     * @brief Initialize the editor for the selected parameter.
      *
-     * @param value Initial integer value to edit.
+     * Loads the descriptor, lays out edit_ with as many integer digits as the
+     * maximum value needs and desc_.decimals fractional digits, fills it with
+     * the current value and requests a redraw.
      */
-    void startEditInt(int value);
+    void startEdit();
 
     /**
-     * @brief Convert the current integer editor digits into an integer value.
+     * @brief Convert the editor digits into a value.
      *
-     * @return The integer represented by idigits_ (0..999).
+     * @return The value represented by edit_.
      */
-    int  intFromDigits() const;
+    float valueFromDigits() const;
 
     /**
-     * @brief Update the float editor based on the given key and redraw.
-     *
-     * Responds to UP/DOWN/LEFT/RIGHT by updating digits_ and cursor, then
-     * redraws the parameter label and the "XXX.XXX" value on the LCD.
-     *
-     * @param k Current key (UP/DOWN/LEFT/RIGHT or NONE).
+     * @brief Store the edited value (clamped to its range) in gParams.
      */
-    void updateFloatEditor(Key k);
+    void commitEdit();
 
     /**
-     * @brief Update the integer editor based on the given key and redraw.
+     * @brief Update the editor based on the given key and redraw.
      *
-     * Responds to UP/DOWN/LEFT/RIGHT by updating idigits_ and cursor, then
-     * redraws the parameter label and "DDD" value on the LCD.
+     * Responds to UP/DOWN/LEFT/RIGHT by updating edit_ and the cursor, then
+     * redraws the parameter label and the value on the LCD.
      *
      * @param k Current key (UP/DOWN/LEFT/RIGHT or NONE).
      */
-    void updateIntEditor(Key k);
-
-    /**
-     * @brief Detect a long SELECT press based on current key and timestamp.
-     *
-     * When the stable key is SELECT, this function:
-     *  - Starts timing when first pressed (selHeld_ = true, selDownMs_ set),
-     *  - Returns true once the duration exceeds 2000 ms,
-     *  - Resets selHeld_ after reporting a long-press event.
-     * Any non-SELECT key resets selHeld_ and cancels a pending long press.
-     *
-     * @param stableKey  Current stable key state from the keypad.
-     * @param now        Current timestamp in milliseconds from millis().
-     * @return true  if a long-press event has been detected,
-     * @return false otherwise.
-     */
-    bool checkLongPress(Key stableKey, unsigned long now);
+    void updateEditor(Key k);
 };
@@ -0,0 +1,214 @@
+#include "ProfileMode.h"
+
+/**
+ * @file ProfileMode.cpp
+ * @brief Implementation of the recipe profile screen.
+ */
+
+/**
+ * @brief Characters available in the name editor, in UP order.
+ */
+static const char NAME_CHARS[] PROGMEM = " ABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789.-";
+
+/** @brief Number of characters in NAME_CHARS. */
+static const uint8_t NAME_CHAR_COUNT = sizeof(NAME_CHARS) - 1;
+
+/**
+ * @brief Step a character forward or backward through NAME_CHARS.
+ *
+ * Characters not in the set start from the blank.
+ *
+ * @param c    Current character.
+ * @param dir  +1 for the next character, -1 for the previous one.
+ * @return New character.
+ */
+static char nextNameChar(char c, int8_t dir) {
+    uint8_t i = 0;
+    while (i < NAME_CHAR_COUNT && (char)pgm_read_byte(&NAME_CHARS[i]) != c) ++i;
+    if (i == NAME_CHAR_COUNT) i = 0;
+    i = (uint8_t)((i + NAME_CHAR_COUNT + dir) % NAME_CHAR_COUNT);
+    return (char)pgm_read_byte(&NAME_CHARS[i]);
+}
+
+/**
+ * @brief Show the profile list, starting at the first profile.
+ */
+void ProfileMode::begin() {
+    state_      = State::List;
+    sel_        = 0;
+    needRedraw_ = true;
+}
+
+/**
+ * @brief Cleanup when leaving the mode.
+ */
+void ProfileMode::end() {
+    lcd_.clear();
+}
+
+/**
+ * @brief Draw the list screen.
+ *
+ * Line 0: "PROFILE n/6" plus '*' if the profile equals the active parameters.
+ * Line 1: profile name or "<empty>".
+ */
+void ProfileMode::drawList() {
+    char n[ProfileStore::NAME_LEN + 1];
+    bool valid = profiles_.name(sel_, n);
+
+    lcd_.clear();
+    lcd_.setCursor(0, 0);
+    lcd_.print(F("PROFILE "));
+    lcd_.print((int)(sel_ + 1));
+    lcd_.write('/');
+    lcd_.print((int)ProfileStore::COUNT);
+    if (valid && profiles_.matches(sel_)) lcd_.print(F(" *"));
+
+    lcd_.setCursor(0, 1);
+    if (valid) lcd_.print(n);
+    else       lcd_.print(F("<empty>"));
+}
+
+/**
+ * @brief Draw the name editor.
+ *
+ * Line 0: "SAVE AS n:"
+ * Line 1: the name being edited.
+ */
+void ProfileMode::drawName() {
+    lcd_.clear();
+    lcd_.setCursor(0, 0);
+    lcd_.print(F("SAVE AS "));
+    lcd_.print((int)(sel_ + 1));
+    lcd_.write(':');
+    lcd_.setCursor(0, 1);
+    lcd_.print(name_);
+}
+
+/**
+ * @brief Execute one step of the profile UI.
+ *
+ * Key input comes from the keypad event queue, decoded as in ParametersMode:
+ * direction keys on Press/Repeat, short SELECT on a Release that did not
+ * follow a LongPress, long SELECT on the LongPress event.
+ *
+ * @return true when the mode should end.
+ */
+bool ProfileMode::step() {
+    Key  s          = Key::NONE;
+    bool shortPress = false;
+    bool longPress  = false;
+
+    KeyEvent ev;
+    if (keys_.next(ev)) {
+        if (ev.key == Key::SELECT) {
+            shortPress = (ev.type == KeyEventType::Release && !ev.afterLong);
+            longPress  = (ev.type == KeyEventType::LongPress);
+        } else if (ev.type == KeyEventType::Press || ev.type == KeyEventType::Repeat) {
+            s = ev.key;
+        }
+    }
+
+    switch (state_) {
+
+    case State::List:
+        if (needRedraw_) {
+            drawList();
+            needRedraw_ = false;
+        }
+
+        if (s == Key::UP && sel_ > 0) {
+            sel_--;
+            needRedraw_ = true;
+        }
+        if (s == Key::DOWN && sel_ + 1 < ProfileStore::COUNT) {
+            sel_++;
+            needRedraw_ = true;
+        }
+        if (s == Key::LEFT) {
+            return true;
+        }
+
+        if (shortPress && profiles_.load(sel_)) {
+            params_.requestSave();   // the loaded recipe survives a reset
+            lcd_.title2(F("Profile loaded"), F(""));
+            lcd_.setCursor(0, 1);
+            profiles_.name(sel_, name_);
+            lcd_.print(name_);
+            ts_    = millis();
+            state_ = State::Loaded;
+        }
+
+        if (longPress) {
+            // start from the stored name, or "P<n>" for an empty slot
+            if (!profiles_.name(sel_, name_)) {
+                name_[0] = 'P';
+                name_[1] = (char)('1' + sel_);
+                name_[2] = '\0';
+            }
+            uint8_t n = strlen(name_);
+            while (n < ProfileStore::NAME_LEN) name_[n++] = ' ';
+            name_[n] = '\0';
+
+            cursor_     = 0;
+            ts_         = millis();
+            blinkBlock_ = false;
+            state_      = State::Name;
+            needRedraw_ = true;
+        }
+        break;
+
+    case State::Name:
+        if (needRedraw_) {
+            drawName();
+            needRedraw_ = false;
+        }
+
+        if (s == Key::LEFT && cursor_ > 0)                          cursor_--;
+        if (s == Key::RIGHT && cursor_ + 1 < ProfileStore::NAME_LEN) cursor_++;
+        if (s == Key::UP)   name_[cursor_] = nextNameChar(name_[cursor_], +1);
+        if (s == Key::DOWN) name_[cursor_] = nextNameChar(name_[cursor_], -1);
+        if (s != Key::NONE) {
+            needRedraw_ = true;
+            ts_         = millis();
+            blinkBlock_ = false;
+        }
+
+        // short SELECT saves; if a previous profile is still being written,
+        // stay in the editor so the user can simply press again
+        if (shortPress && profiles_.save(sel_, name_)) {
+            state_      = State::List;
+            needRedraw_ = true;
+        }
+        if (longPress) {
+            state_      = State::List;   // cancel
+            needRedraw_ = true;
+        }
+
+        // cursor blinking
+        if (state_ == State::Name && !needRedraw_) {
+            unsigned long dt = millis() - ts_;
+            if (!blinkBlock_ && dt >= 1000UL) {
+                blinkBlock_ = true;
+                ts_         = millis();
+                lcd_.setCursor(cursor_, 1);
+                lcd_.write((char)255);
+            }
+            else if (blinkBlock_ && dt >= 200UL) {
+                blinkBlock_ = false;
+                ts_         = millis();
+                lcd_.setCursor(cursor_, 1);
+                lcd_.write(name_[cursor_]);
+            }
+        }
+        break;
+
+    case State::Loaded:
+        if (millis() - ts_ >= CONFIRM_MS) {
+            return true;
+        }
+        break;
+    }
+
+    return false;
+}
@@ -0,0 +1,131 @@
+#pragma once
+#include "IMode.h"
+#include "Lcd1602.h"
+#include "KeypadShield.h"
+#include "ProfileStore.h"
+#include "ParamStore.h"
+#include <Arduino.h>
+
+/**
+ * @brief Quick selection, loading and saving of named recipe profiles.
+ *
+ * Screens:
+ * - Profile list (one profile per screen):
+ *     - Line 0: "PROFILE n/6", followed by '*' if the profile equals the
+ *       parameters currently in effect.
+ *     - Line 1: profile name, or "<empty>".
+ *     - UP/DOWN: previous/next profile.
+ *     - Short SELECT: load the profile into gParams (bulk copy), persist it
+ *       as the active parameter set and return to the menu.
+ *     - Long SELECT: save the current parameters into this profile (opens
+ *       the name editor).
+ *     - LEFT: return to the menu without changes.
+ * - Name editor:
+ *     - LEFT/RIGHT: move the cursor, UP/DOWN: change the character.
+ *     - Short SELECT: save, long SELECT: cancel; both return to the list.
+ *
+ * Switching recipes therefore takes two keypresses on the list screen
+ * (UP/DOWN to the profile, SELECT).
+ */
+class ProfileMode : public IMode {
+public:
+    /**
+     * @brief Construct a new ProfileMode instance.
+     *
+     * @param lcd       LCD used for the profile screens.
+     * @param keys      Keypad used for navigation and name editing.
+     * @param profiles  EEPROM profile store.
+     * @param params    Parameter store; a loaded profile is saved as the active set.
+     */
+    ProfileMode(Lcd1602& lcd, KeypadShield& keys, ProfileStore& profiles, ParamStore& params)
+        : lcd_(lcd), keys_(keys), profiles_(profiles), params_(params) {}
+
+    /**
+     * @brief Name of this mode.
+     *
+     * @return Constant C-string "PROF".
+     */
+    const char* name() const override { return "PROF"; }
+
+    /**
+     * @brief Get the capability descriptor of this mode.
+     *
+     * @return Handles SELECT itself, needs no sensor or stepper, fast refresh
+     *         for the name editor cursor.
+     */
+    ModeCaps caps() const override { return { ModeId::Profile, MODE_OWNS_SELECT, 40 }; }
+
+    /**
+     * @brief Show the profile list, starting at the first profile.
+     */
+    void begin() override;
+
+    /**
+     * @brief Execute one non-blocking step of the profile UI.
+     *
+     * @return true when the mode should return to the menu (profile loaded
+     *         or LEFT pressed), false otherwise.
+     */
+    bool step() override;
+
+    /**
+     * @brief Cleanup when leaving the mode (clears the LCD).
+     */
+    void end() override;
+
+private:
+    /**
+     * @brief UI states.
+     *
+     * - List   : browse profiles, load or start saving.
+     * - Name   : edit the name for saving.
+     * - Loaded : confirmation message, then back to the menu.
+     */
+    enum class State { List, Name, Loaded };
+
+    /** @brief Time the "loaded" confirmation stays on screen (ms). */
+    static constexpr uint16_t CONFIRM_MS = 1000;
+
+    /**
+     * @brief Draw the list screen for the selected profile.
+     */
+    void drawList();
+
+    /**
+     * @brief Draw the name editor.
+     */
+    void drawName();
+
+    /** @brief LCD used for output. */
+    Lcd1602&      lcd_;
+
+    /** @brief Keypad used for input. */
+    KeypadShield& keys_;
+
+    /** @brief EEPROM profile store. */
+    ProfileStore& profiles_;
+
+    /** @brief Active parameter set store. */
+    ParamStore&   params_;
+
+    /** @brief Current UI state. */
+    State state_ = State::List;
+
+    /** @brief Selected profile index. */
+    uint8_t sel_ = 0;
+
+    /** @brief Name being edited (NUL-terminated, blank-padded while editing). */
+    char name_[ProfileStore::NAME_LEN + 1];
+
+    /** @brief Cursor position in the name editor. */
+    uint8_t cursor_ = 0;
+
+    /** @brief Screen must be redrawn on the next step(). */
+    bool needRedraw_ = true;
+
+    /** @brief Timestamp (ms) for cursor blinking / confirmation timeout. */
+    unsigned long ts_ = 0;
+
+    /** @brief Cursor blink state: true = block character shown. */
+    bool blinkBlock_ = false;
+};
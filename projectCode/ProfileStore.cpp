@@ -0,0 +1,107 @@
+#include "ProfileStore.h"
+#include "Crc16.h"
+
+/**
+ * @file ProfileStore.cpp
+ * @brief Implementation of the named recipe profile store.
+ */
+
+/**
+ * @brief Read a slot and check version, size and CRC.
+ *
+ * @param idx  Profile index.
+ * @param r    Receives the record.
+ * @return true if the record is valid.
+ */
+bool ProfileStore::read_(uint8_t idx, Record& r) const {
+  if (idx >= COUNT) return false;
+  EepromWriter::read(slotAddr_(idx), &r, sizeof(r));
+  if (r.version != VERSION || r.size != sizeof(AllParams)) return false;
+  return crc16(&r, offsetof(Record, crc)) == r.crc;
+}
+
+/**
+ * @brief Read the name of a profile.
+ *
+ * @param idx   Profile index.
+ * @param name  Receives the NUL-terminated name without trailing blanks.
+ * @return true if the slot holds a valid profile.
+ */
+bool ProfileStore::name(uint8_t idx, char name[NAME_LEN + 1]) const {
+  Record r;
+  name[0] = '\0';
+  if (!read_(idx, r)) return false;
+
+  uint8_t n = NAME_LEN;
+  while (n > 0 && r.name[n - 1] == ' ') --n;
+  memcpy(name, r.name, n);
+  name[n] = '\0';
+  return true;
+}
+
+/**
+ * @brief Copy a profile into gParams in one block.
+ *
+ * @param idx Profile index.
+ * @return false if the slot holds no valid profile.
+ */
+bool ProfileStore::load(uint8_t idx) const {
+  Record r;
+  if (!read_(idx, r)) return false;
+  gParams = r.params;
+  return true;
+}
+
+/**
+ * @brief Compare a profile with gParams.
+ *
+ * @param idx Profile index.
+ * @return true if the profile is valid and identical to gParams.
+ */
+bool ProfileStore::matches(uint8_t idx) const {
+  Record r;
+  if (!read_(idx, r)) return false;
+  return memcmp(&r.params, &gParams, sizeof(AllParams)) == 0;
+}
+
+/**
+ * @brief Build a profile record from gParams and schedule it for writing.
+ *
+ * If a previous profile record is still being written, rec_ must not be
+ * touched and the call is rejected.
+ *
+ * @param idx   Profile index.
+ * @param name  Profile name.
+ * @return false if nothing was scheduled.
+ */
+bool ProfileStore::save(uint8_t idx, const char* name) {
+  if (writing_ || idx >= COUNT) return false;
+
+  uint8_t n = 0;
+  for (; n < NAME_LEN && name[n]; ++n) rec_.name[n] = name[n];
+  for (; n < NAME_LEN; ++n) rec_.name[n] = ' ';
+
+  rec_.version = VERSION;
+  rec_.size    = sizeof(AllParams);
+  rec_.params  = gParams;
+  rec_.crc     = crc16(&rec_, offsetof(Record, crc));
+
+  slot_    = idx;
+  pending_ = true;
+  service();
+  return true;
+}
+
+/**
+ * @brief Track the running write and start a pending one when possible.
+ */
+void ProfileStore::service() {
+  if (writing_) {
+    if (writer_.busy()) return;
+    writing_ = false;
+  }
+  if (pending_ && writer_.start(slotAddr_(slot_), reinterpret_cast<const uint8_t*>(&rec_), sizeof(rec_))) {
+    pending_ = false;
+    writing_ = true;
+  }
+}
@@ -0,0 +1,131 @@
+#pragma once
+#include <Arduino.h>
+#include "Parameters.h"
+#include "EepromWriter.h"
+#include "EepromLayout.h"
+
+/**
+ * @brief Named recipe profiles (complete AllParams sets) in EEPROM.
+ *
+ * Each of EE_PROFILE_SLOTS slots holds one record
+ *
+ *     AllParams | name (8) | version (1) | size (1) | crc16 (2)
+ *
+ * A profile is activated with a single bulk copy of the stored AllParams
+ * into gParams; saving copies gParams into a slot under a name. Slots that
+ * were never written (or hold an incompatible/corrupt record) read as empty.
+ *
+ * Saving is non-blocking and shares the EepromWriter with ParamStore: the
+ * record is snapshotted into RAM and written from loop() once the writer is
+ * free.
+ */
+class ProfileStore {
+public:
+  /** @brief Number of profiles. */
+  static constexpr uint8_t COUNT    = EE_PROFILE_SLOTS;
+
+  /** @brief Maximum length of a profile name. */
+  static constexpr uint8_t NAME_LEN = 8;
+
+  /** @brief Layout version of the stored record; bump when AllParams changes. */
+  static constexpr uint8_t VERSION  = 1;
+
+  /**
+   * @brief Construct a new ProfileStore.
+   *
+   * @param writer Non-blocking EEPROM writer used for saving.
+   */
+  explicit ProfileStore(EepromWriter& writer) : writer_(writer) {}
+
+  /**
+   * @brief Read the name of a profile.
+   *
+   * @param idx   Profile index (0..COUNT-1).
+   * @param name  Receives the NUL-terminated name (trailing blanks removed);
+   *              empty if the slot holds no valid profile.
+   * @return true if the slot holds a valid profile.
+   */
+  bool name(uint8_t idx, char name[NAME_LEN + 1]) const;
+
+  /**
+   * @brief Activate a profile: copy its parameters into gParams.
+   *
+   * @param idx Profile index.
+   * @return false (and gParams unchanged) if the slot holds no valid profile.
+   */
+  bool load(uint8_t idx) const;
+
+  /**
+   * @brief Check whether a profile holds exactly the parameters in gParams.
+   *
+   * @param idx Profile index.
+   * @return true if the slot is valid and equal to gParams.
+   */
+  bool matches(uint8_t idx) const;
+
+  /**
+   * @brief Save gParams as a profile.
+   *
+   * The record is built immediately; it is written once the EEPROM writer
+   * is free. A second save before the first has started replaces it.
+   *
+   * @param idx   Profile index.
+   * @param name  Profile name (up to NAME_LEN characters, padded with blanks).
+   * @return false if a previous profile is still being written (nothing saved).
+   */
+  bool save(uint8_t idx, const char* name);
+
+  /**
+   * @brief Start a pending save once the writer is free.
+   *
+   * Call frequently from loop() (after EepromWriter::service()).
+   */
+  void service();
+
+  /** @brief True while a save is pending or being written. */
+  bool saving() const { return pending_ || writing_; }
+
+private:
+  /** @brief Record as stored in one EEPROM slot. */
+  struct Record {
+    AllParams params;          ///< Stored parameters (first, so no padding is needed).
+    char      name[NAME_LEN];  ///< Blank-padded name, not NUL-terminated.
+    uint8_t   version;         ///< Layout version (VERSION).
+    uint8_t   size;            ///< sizeof(AllParams) at the time of writing.
+    uint16_t  crc;             ///< CRC16 over all preceding fields.
+  };
+
+  static_assert(sizeof(Record) <= EE_PROFILE_SLOT, "profile record does not fit into an EEPROM slot");
+
+  /**
+   * @brief Read and validate a slot.
+   *
+   * @param idx  Profile index.
+   * @param r    Receives the record.
+   * @return true if version, size and CRC are valid.
+   */
+  bool read_(uint8_t idx, Record& r) const;
+
+  /**
+   * @brief EEPROM address of a slot.
+   *
+   * @param idx Profile index.
+   * @return Start address.
+   */
+  static uint16_t slotAddr_(uint8_t idx) { return EE_PROFILES_ADDR + (uint16_t)idx * EE_PROFILE_SLOT; }
+
+  /** @brief EEPROM writer shared with other stores. */
+  EepromWriter& writer_;
+
+  /** @brief Record waiting to be written or being written. */
+  Record rec_;
+
+  /** @brief Slot rec_ is written to. */
+  uint8_t slot_ = 0;
+
+  /** @brief rec_ holds a save that has not been started yet. */
+  bool pending_ = false;
+
+  /** @brief rec_ is being written by writer_. */
+  bool writing_ = false;
+};
@@ -0,0 +1,300 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "Cobs.h"
+
+/**
+ * @file ProtocolDefs.h
+ * @brief Binary serial protocol shared by the firmware and the host tools.
+ *
+ * Frame on the wire:
+ *
+ *     COBS( version | type | reqId | body... | crc16 ) | 0x00
+ *
+ *  - version : PROTO_VERSION of the sender; frames with another version are
+ *              answered with MSG_NACK / ERR_VERSION.
+ *  - type    : message type (MSG_*). Replies use the request type | 0x80.
+ *  - reqId   : chosen by the host, echoed in the reply. Unsolicited frames
+ *              sent by the device use reqId 0.
+ *  - crc16   : CRC-16/CCITT-FALSE (Crc16.h) over version..body, little endian.
+ *
+ * All multi-byte values are little endian; floats are IEEE-754 binary32
+ * (the native format of both AVR and x86/ARM hosts).
+ *
+ * This header has no Arduino dependencies.
+ */
+
+/** @brief Protocol version carried in every frame. */
+static constexpr uint8_t PROTO_VERSION      = 1;
+
+/** @brief Size of version + type + reqId. */
+static constexpr uint8_t PROTO_HEADER       = 3;
+
+/** @brief Maximum body length. */
+static constexpr uint8_t PROTO_MAX_BODY     = 45;
+
+/** @brief Maximum unencoded frame (header + body + CRC). */
+static constexpr uint8_t PROTO_MAX_FRAME    = PROTO_HEADER + PROTO_MAX_BODY + 2;
+
+/** @brief Maximum encoded frame including the 0x00 delimiter. */
+static constexpr uint8_t PROTO_MAX_ENCODED  = (uint8_t)(cobsMaxEncoded(PROTO_MAX_FRAME) + 1);
+
+/** @brief Bit set in the type of a reply. */
+static constexpr uint8_t MSG_REPLY          = 0x80;
+
+/** @name Message types
+ *  @{ */
+/** Request: no body. Reply MSG_PING|MSG_REPLY: u8 protoVersion, u8 paramCount, u8 modeCount. */
+static constexpr uint8_t MSG_PING           = 0x01;
+/** Request: no body. Reply MSG_STATUS|MSG_REPLY: see PROTO_STATUS_*. */
+static constexpr uint8_t MSG_STATUS         = 0x02;
+/** Request: u8 index. Reply MSG_PARAM_GET|MSG_REPLY: see PROTO_PARAM_*. */
+static constexpr uint8_t MSG_PARAM_GET      = 0x03;
+/** Request: u8 index, f32 value. Reply as MSG_PARAM_GET (value after clamping). */
+static constexpr uint8_t MSG_PARAM_SET      = 0x04;
+/** Request: no body. Persists the parameters to EEPROM. Reply MSG_ACK. */
+static constexpr uint8_t MSG_PARAM_SAVE     = 0x05;
+/** Request: u8 mode index (menu order). Reply MSG_ACK or MSG_NACK. */
+static constexpr uint8_t MSG_MODE_START     = 0x06;
+/** Request: no body. Stops the running mode. Reply MSG_ACK. */
+static constexpr uint8_t MSG_MODE_STOP      = 0x07;
+/** Request: u8 enable, u8 decimation (>= 1). Reply MSG_TELEM_CTRL|MSG_REPLY: see PROTO_TCTRL_*. */
+static constexpr uint8_t MSG_TELEM_CTRL     = 0x08;
+/** Request: u8 first entry (0 = oldest). Reply MSG_LOG_DUMP|MSG_REPLY: see PROTO_LOG_*. */
+static constexpr uint8_t MSG_LOG_DUMP       = 0x09;
+/** Request: u8 first record (0 = oldest). Reply MSG_RUN_READ|MSG_REPLY: see PROTO_RUNS_*. */
+static constexpr uint8_t MSG_RUN_READ       = 0x0A;
+/** Request: u8 probe (PROF_*), u8 clear (1 = reset the probe after reading). Reply MSG_PROF_DUMP|MSG_REPLY: see PROTO_PROF_*.
+ *  Only in firmware built with LOOP_PROFILE, otherwise answered with ERR_UNKNOWN_TYPE. */
+static constexpr uint8_t MSG_PROF_DUMP      = 0x0B;
+/** Request: u8 clear (1 = reset the statistics after reading). Reply MSG_STEP_JITTER|MSG_REPLY: see PROTO_JIT_*.
+ *  Only in firmware built with STEP_JITTER, otherwise answered with ERR_UNKNOWN_TYPE. */
+static constexpr uint8_t MSG_STEP_JITTER    = 0x0C;
+/** Unsolicited (reqId 0): absolute telemetry record, see PROTO_TKEY_*. */
+static constexpr uint8_t MSG_TELEM_KEY      = 0x20;
+/** Unsolicited (reqId 0): telemetry record relative to the previous one, see PROTO_TDELTA_*. */
+static constexpr uint8_t MSG_TELEM_DELTA    = 0x21;
+/** Reply: u8 request type. */
+static constexpr uint8_t MSG_ACK            = 0x7E;
+/** Reply: u8 request type, u8 error code (ERR_*). */
+static constexpr uint8_t MSG_NACK           = 0x7F;
+/** @} */
+
+/** @name Error codes carried by MSG_NACK
+ *  @{ */
+static constexpr uint8_t ERR_UNKNOWN_TYPE   = 1;  ///< Message type not supported.
+static constexpr uint8_t ERR_BAD_LENGTH     = 2;  ///< Body length does not match the type.
+static constexpr uint8_t ERR_BAD_ARG        = 3;  ///< Index or value out of range.
+static constexpr uint8_t ERR_BUSY           = 4;  ///< Not possible in the current state.
+static constexpr uint8_t ERR_VERSION        = 5;  ///< Frame version differs from PROTO_VERSION.
+/** @} */
+
+/** @name MSG_STATUS reply body (offsets)
+ *  @{ */
+static constexpr uint8_t PROTO_STATUS_T_MS    = 0;   ///< u32 device millis().
+static constexpr uint8_t PROTO_STATUS_RUNNING = 4;   ///< u8  1 if a mode is running.
+static constexpr uint8_t PROTO_STATUS_MODE    = 5;   ///< u8  index of the running (or selected) mode.
+static constexpr uint8_t PROTO_STATUS_MODE_ID = 6;   ///< u8  ModeId of that mode.
+static constexpr uint8_t PROTO_STATUS_SENSOR  = 7;   ///< u8  1 if the current sensor is enabled.
+static constexpr uint8_t PROTO_STATUS_I_A     = 8;   ///< f32 baseline-corrected RMS current (A).
+static constexpr uint8_t PROTO_STATUS_Z_MM    = 12;  ///< f32 stepper position (mm).
+static constexpr uint8_t PROTO_STATUS_SIZE    = 16;
+/** @} */
+
+/** @name MSG_PARAM_GET / MSG_PARAM_SET reply body (offsets)
+ *  @{ */
+static constexpr uint8_t PROTO_PARAM_INDEX    = 0;   ///< u8  table index.
+static constexpr uint8_t PROTO_PARAM_TYPE     = 1;   ///< u8  0 = float, 1 = int.
+static constexpr uint8_t PROTO_PARAM_DECIMALS = 2;   ///< u8  decimals shown on the LCD.
+static constexpr uint8_t PROTO_PARAM_VALUE    = 3;   ///< f32 current value.
+static constexpr uint8_t PROTO_PARAM_MIN      = 7;   ///< f32 minimum.
+static constexpr uint8_t PROTO_PARAM_MAX      = 11;  ///< f32 maximum.
+static constexpr uint8_t PROTO_PARAM_NAME     = 15;  ///< char[13] NUL-terminated label.
+static constexpr uint8_t PROTO_PARAM_SIZE     = 28;
+/** @} */
+
+/** @name Little-endian field helpers
+ *  @{ */
+inline void     protoPutU16(uint8_t* p, uint16_t v) { p[0] = (uint8_t)v; p[1] = (uint8_t)(v >> 8); }
+inline void     protoPutU32(uint8_t* p, uint32_t v) { for (uint8_t i = 0; i < 4; ++i) p[i] = (uint8_t)(v >> (8 * i)); }
+inline void     protoPutF32(uint8_t* p, float v)    { uint32_t u; memcpy(&u, &v, 4); protoPutU32(p, u); }
+inline uint16_t protoGetU16(const uint8_t* p)       { return (uint16_t)(p[0] | ((uint16_t)p[1] << 8)); }
+inline uint32_t protoGetU32(const uint8_t* p)       { uint32_t v = 0; for (uint8_t i = 0; i < 4; ++i) v |= (uint32_t)p[i] << (8 * i); return v; }
+inline float    protoGetF32(const uint8_t* p)       { uint32_t u = protoGetU32(p); float v; memcpy(&v, &u, 4); return v; }
+/** @} */
+
+/** @name MSG_TELEM_CTRL reply body (offsets)
+ *  @{ */
+static constexpr uint8_t PROTO_TCTRL_ENABLED  = 0;   ///< u8  1 if streaming.
+static constexpr uint8_t PROTO_TCTRL_DECIM    = 1;   ///< u8  one record every N sensor windows.
+static constexpr uint8_t PROTO_TCTRL_DROPS    = 2;   ///< u16 records dropped since power-on.
+static constexpr uint8_t PROTO_TCTRL_SEQ      = 4;   ///< u16 sequence number of the next record.
+static constexpr uint8_t PROTO_TCTRL_SIZE     = 6;
+/** @} */
+
+/** @name Telemetry record flags (PROTO_TKEY_FLAGS / PROTO_TDELTA_FLAGS)
+ *  @{ */
+static constexpr uint8_t TELEM_RELAY1         = 0x01;  ///< Relay 1 energized (pin LOW).
+static constexpr uint8_t TELEM_RELAY2         = 0x02;  ///< Relay 2 energized (pin LOW).
+static constexpr uint8_t TELEM_SENSOR         = 0x04;  ///< Current sensor enabled.
+static constexpr uint8_t TELEM_RUNNING        = 0x08;  ///< A mode is running.
+/** @} */
+
+/** @name MSG_TELEM_KEY body (offsets)
+ *
+ * A key record carries absolute values. It is sent first, periodically,
+ * after a dropped record and whenever a delta does not fit.
+ *  @{ */
+static constexpr uint8_t PROTO_TKEY_SEQ       = 0;   ///< u16 record sequence number.
+static constexpr uint8_t PROTO_TKEY_T_US      = 2;   ///< u32 end of the sensor window (device micros()).
+static constexpr uint8_t PROTO_TKEY_WINDOW    = 6;   ///< u16 sensor window sequence number.
+static constexpr uint8_t PROTO_TKEY_I_UA      = 8;   ///< i32 raw RMS current (µA).
+static constexpr uint8_t PROTO_TKEY_VPP_MV    = 12;  ///< u16 peak-to-peak voltage (mV).
+static constexpr uint8_t PROTO_TKEY_STEPS     = 14;  ///< i32 stepper position (steps).
+static constexpr uint8_t PROTO_TKEY_MODE_ID   = 18;  ///< u8  ModeId of the running/selected mode.
+static constexpr uint8_t PROTO_TKEY_PHASE     = 19;  ///< u8  IMode::phase().
+static constexpr uint8_t PROTO_TKEY_FLAGS     = 20;  ///< u8  TELEM_* flags.
+static constexpr uint8_t PROTO_TKEY_DROPS     = 21;  ///< u16 records dropped since power-on.
+static constexpr uint8_t PROTO_TKEY_SIZE      = 23;
+/** @} */
+
+/** @name MSG_TELEM_DELTA body (offsets)
+ *
+ * Values are differences to the previous record the receiver got (key or
+ * delta); time is in units of PROTO_TDELTA_T_UNIT_US.
+ *  @{ */
+static constexpr uint8_t PROTO_TDELTA_SEQ     = 0;   ///< u16 record sequence number.
+static constexpr uint8_t PROTO_TDELTA_DT      = 2;   ///< u16 time step (PROTO_TDELTA_T_UNIT_US units).
+static constexpr uint8_t PROTO_TDELTA_DWINDOW = 4;   ///< u8  window sequence step.
+static constexpr uint8_t PROTO_TDELTA_DI_UA   = 5;   ///< i16 current step (µA).
+static constexpr uint8_t PROTO_TDELTA_DVPP_MV = 7;   ///< i16 Vpp step (mV).
+static constexpr uint8_t PROTO_TDELTA_DSTEPS  = 9;   ///< i16 position step (steps).
+static constexpr uint8_t PROTO_TDELTA_PHASE   = 11;  ///< u8  IMode::phase() (absolute).
+static constexpr uint8_t PROTO_TDELTA_FLAGS   = 12;  ///< u8  TELEM_* flags (absolute).
+static constexpr uint8_t PROTO_TDELTA_SIZE    = 13;
+
+/** Time unit of PROTO_TDELTA_DT. */
+static constexpr uint16_t PROTO_TDELTA_T_UNIT_US = 100;
+/** @} */
+
+/** @name MSG_LOG_DUMP reply body (offsets)
+ *
+ * The header is followed by up to PROTO_LOG_MAX_ENTRIES entries of
+ * PROTO_LOG_ENTRY_SIZE bytes, starting at the requested entry. The host
+ * repeats the request with first += entries until first >= count.
+ *  @{ */
+static constexpr uint8_t PROTO_LOG_T_MS       = 0;   ///< u32 device millis() when the reply was built.
+static constexpr uint8_t PROTO_LOG_COUNT      = 4;   ///< u8  entries in the log.
+static constexpr uint8_t PROTO_LOG_FIRST      = 5;   ///< u8  index of the first entry in this reply.
+static constexpr uint8_t PROTO_LOG_LOST       = 6;   ///< u16 entries overwritten since power-on.
+static constexpr uint8_t PROTO_LOG_ENTRIES    = 8;   ///< Start of the entries.
+static constexpr uint8_t PROTO_LOG_ENTRY_SIZE = 6;   ///< u24 t_ms (low 24 bits of millis()), u8 id, i16 arg.
+static constexpr uint8_t PROTO_LOG_MAX_ENTRIES = (PROTO_MAX_BODY - PROTO_LOG_ENTRIES) / PROTO_LOG_ENTRY_SIZE;
+/** @} */
+
+/** @name Event log IDs (EV_*) and the meaning of their argument
+ *  @{ */
+static constexpr uint8_t EV_BOOT              = 1;   ///< Power-on; arg: 0.
+static constexpr uint8_t EV_MODE_START        = 2;   ///< Mode started; arg: ModeId.
+static constexpr uint8_t EV_MODE_STOP         = 3;   ///< Mode stopped; arg: ModeId.
+static constexpr uint8_t EV_STATE             = 4;   ///< State entered; arg: ModeId << 8 | state.
+static constexpr uint8_t EV_RELAY             = 5;   ///< Relay outputs changed; arg: TELEM_RELAY1/2 bits.
+static constexpr uint8_t EV_SURFACE           = 6;   ///< Surface threshold crossed; arg: current (mA).
+static constexpr uint8_t EV_CONTACT_OK        = 7;   ///< 30 V validation confirmed; arg: current (mA).
+static constexpr uint8_t EV_CONTACT_RETRY     = 8;   ///< 30 V validation failed, search resumes; arg: current (mA).
+static constexpr uint8_t EV_ETCH_END          = 9;   ///< Etch-end threshold crossed; arg: current (mA).
+static constexpr uint8_t EV_Z_LIMIT           = 10;  ///< Soft Z limit abort; arg: Z (0.01 mm).
+static constexpr uint8_t EV_HOME_SWITCH       = 11;  ///< Homing limit switch hit; arg: 0.
+static constexpr uint8_t EV_BASELINE          = 12;  ///< Baseline measured; arg: I0 (mA).
+static constexpr uint8_t EV_PULSE             = 13;  ///< 9 V pulse finished; arg: pulse number.
+static constexpr uint8_t EV_RUN_LOST          = 14;  ///< Run record dropped, EEPROM busy; arg: runs lost since power-on.
+/** @} */
+
+/** @name Run history record (PROTO_RUN_*)
+ *
+ * Stored in EEPROM exactly as sent over the link (RunLog).
+ *  @{ */
+static constexpr uint8_t PROTO_RUN_SEQ        = 0;   ///< u16 run number.
+static constexpr uint8_t PROTO_RUN_MODE_ID    = 2;   ///< u8  ModeId (Mod1 / Mod2).
+static constexpr uint8_t PROTO_RUN_RESULT     = 3;   ///< u8  RUN_* result.
+static constexpr uint8_t PROTO_RUN_SURFACE_Z  = 4;   ///< u16 Z at surface detection (0.01 mm).
+static constexpr uint8_t PROTO_RUN_PLUNGE     = 6;   ///< u16 plunge depth after the surface (0.01 mm).
+static constexpr uint8_t PROTO_RUN_ETCH_TIME  = 8;   ///< u16 duration of the 30 V etch (0.1 s).
+static constexpr uint8_t PROTO_RUN_END_I      = 10;  ///< u16 current at the end of the etch (10 µA).
+static constexpr uint8_t PROTO_RUN_RETRIES    = 12;  ///< u8  failed 30 V contact validations.
+static constexpr uint8_t PROTO_RUN_PULSES     = 13;  ///< u8  9 V pulses applied (MOD2).
+static constexpr uint8_t PROTO_RUN_CRC        = 14;  ///< u16 CRC16 over bytes 0..13.
+static constexpr uint8_t PROTO_RUN_SIZE       = 16;
+
+static constexpr uint8_t RUN_OK               = 0;   ///< Completed normally.
+static constexpr uint8_t RUN_ABORT_Z_LIMIT    = 1;   ///< Aborted at the soft Z limit.
+/** @} */
+
+/** @name MSG_RUN_READ reply body (offsets)
+ *
+ * The header is followed by the valid records among first ..
+ * first + PROTO_RUNS_MAX - 1 (PROTO_RUN_SIZE bytes each, oldest first). The
+ * host repeats the request with first += PROTO_RUNS_MAX until first >= count.
+ *  @{ */
+static constexpr uint8_t PROTO_RUNS_COUNT     = 0;   ///< u8  records stored.
+static constexpr uint8_t PROTO_RUNS_FIRST     = 1;   ///< u8  index of the first record in this reply.
+static constexpr uint8_t PROTO_RUNS_RECORDS   = 2;   ///< Start of the records.
+static constexpr uint8_t PROTO_RUNS_MAX       = (PROTO_MAX_BODY - PROTO_RUNS_RECORDS) / PROTO_RUN_SIZE;
+/** @} */
+
+/** @name Loop profiler probes (PROF_*)
+ *
+ * Sections of loop() timed by LoopProfiler. Probes may nest (PROF_STEPPER
+ * runs inside PROF_MODE, everything inside PROF_LOOP).
+ *  @{ */
+static constexpr uint8_t PROF_LOOP            = 0;   ///< One loop() pass.
+static constexpr uint8_t PROF_SENSOR          = 1;   ///< CurrentSensor::update().
+static constexpr uint8_t PROF_KEYS            = 2;   ///< KeypadShield::update() (keypad poll).
+static constexpr uint8_t PROF_MODE            = 3;   ///< step() of the running mode.
+static constexpr uint8_t PROF_STEPPER         = 4;   ///< StepperDriver::update().
+static constexpr uint8_t PROF_LCD             = 5;   ///< Lcd1602::service().
+static constexpr uint8_t PROF_HOST            = 6;   ///< Host link, telemetry and serial TX service.
+static constexpr uint8_t PROF_STORE           = 7;   ///< EEPROM writer and the persistent stores.
+static constexpr uint8_t PROF_PROBES          = 8;
+
+/** Histogram bins per probe: bin 0 holds 0 ticks, bin k (1..14) holds
+ *  2^(k-1) .. 2^k - 1 ticks, bin 15 everything from 2^14 ticks (8.192 ms). */
+static constexpr uint8_t PROF_HIST_BINS       = 16;
+
+/** Duration of one profiler tick (ns). */
+static constexpr uint16_t PROF_TICK_NS        = 500;
+/** @} */
+
+/** @name MSG_PROF_DUMP reply body (offsets)
+ *
+ * Durations are in PROF_TICK_NS ticks. When the pass count of a probe
+ * reaches 0xFFFF, count, total and histogram are halved, so the figures
+ * describe roughly the last 32k..64k passes.
+ *  @{ */
+static constexpr uint8_t PROTO_PROF_PROBE     = 0;   ///< u8  probe (PROF_*).
+static constexpr uint8_t PROTO_PROF_PROBES    = 1;   ///< u8  number of probes (PROF_PROBES).
+static constexpr uint8_t PROTO_PROF_COUNT     = 2;   ///< u16 passes.
+static constexpr uint8_t PROTO_PROF_TOTAL     = 4;   ///< u32 sum of the durations (ticks).
+static constexpr uint8_t PROTO_PROF_MAX       = 8;   ///< u16 longest pass (ticks) since the last clear.
+static constexpr uint8_t PROTO_PROF_HIST      = 10;  ///< u16[PROF_HIST_BINS] log2 histogram.
+static constexpr uint8_t PROTO_PROF_SIZE      = PROTO_PROF_HIST + 2 * PROF_HIST_BINS;
+/** @} */
+
+/** @name MSG_STEP_JITTER reply body (offsets)
+ *
+ * Step interval error against the commanded period (StepJitter), followed
+ * by the intervals of the latest steps, newest first (0 = first step of a
+ * sequence).
+ *  @{ */
+static constexpr uint8_t PROTO_JIT_INTERVALS  = 0;   ///< u32 intervals analysed.
+static constexpr uint8_t PROTO_JIT_PERIOD_US  = 4;   ///< u32 commanded period of the latest step (µs).
+static constexpr uint8_t PROTO_JIT_MEAN_US    = 8;   ///< f32 mean error (µs, positive = late).
+static constexpr uint8_t PROTO_JIT_SD_US      = 12;  ///< f32 standard deviation of the error (µs).
+static constexpr uint8_t PROTO_JIT_MAXDEV_US  = 16;  ///< u32 largest absolute error (µs).
+static constexpr uint8_t PROTO_JIT_LATE       = 20;  ///< u32 steps later than 10 % of their period.
+static constexpr uint8_t PROTO_JIT_LOST       = 24;  ///< u16 steps not analysed (ring overflow).
+static constexpr uint8_t PROTO_JIT_RECENT_N   = 26;  ///< u8  number of recent intervals that follow.
+static constexpr uint8_t PROTO_JIT_RECENT     = 27;  ///< u32[] recent intervals (µs).
+static constexpr uint8_t PROTO_JIT_RECENT_MAX = (PROTO_MAX_BODY - PROTO_JIT_RECENT) / 4;
+/** @} */
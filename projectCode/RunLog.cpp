@@ -0,0 +1,138 @@
+#include "RunLog.h"
+#include "Crc16.h"
+#include "EventLog.h"
+
+/**
+ * @file RunLog.cpp
+ * @brief Implementation of the EEPROM run history.
+ */
+
+static_assert(PROTO_RUN_SIZE == EE_RUN_SLOT, "run record must fill one EEPROM slot");
+
+/**
+ * @brief Convert a value to a saturated unsigned 16-bit field.
+ *
+ * @param v      Value in natural units.
+ * @param scale  Field units per natural unit.
+ * @return Field value.
+ */
+static uint16_t toU16(float v, float scale) {
+  float f = v * scale + 0.5f;
+  if (f <= 0.0f)     return 0;
+  if (f >= 65535.0f) return 65535;
+  return (uint16_t)f;
+}
+
+/**
+ * @brief Read a slot and check its CRC.
+ *
+ * @param slot  Slot index.
+ * @param rec   Receives the record bytes.
+ * @return true if the record is valid.
+ */
+bool RunLog::readSlot_(uint8_t slot, uint8_t rec[PROTO_RUN_SIZE]) {
+  EepromWriter::read(slotAddr_(slot), rec, PROTO_RUN_SIZE);
+  return crc16(rec, PROTO_RUN_CRC) == protoGetU16(rec + PROTO_RUN_CRC);
+}
+
+/**
+ * @brief Scan the EEPROM for the stored history.
+ *
+ * The valid record with the highest run number (wrap-around comparison) is
+ * the newest. The history is the unbroken chain of valid records with
+ * consecutive run numbers that ends there; anything older is ignored.
+ */
+void RunLog::load() {
+  uint8_t  rec[PROTO_RUN_SIZE];
+  uint16_t newestSeq = 0;
+  bool     found = false;
+  uint8_t  newest = 0;
+
+  for (uint8_t s = 0; s < COUNT; ++s) {
+    if (!readSlot_(s, rec)) continue;
+    uint16_t seq = protoGetU16(rec + PROTO_RUN_SEQ);
+    if (!found || (int16_t)(seq - newestSeq) > 0) {
+      newestSeq = seq;
+      newest    = s;
+      found     = true;
+    }
+  }
+
+  count_ = 0;
+  if (!found) return;
+
+  head_ = (uint8_t)((newest + 1) % COUNT);
+  seq_  = (uint16_t)(newestSeq + 1);
+
+  uint8_t s = newest;
+  while (count_ < COUNT && readSlot_(s, rec) &&
+         protoGetU16(rec + PROTO_RUN_SEQ) == (uint16_t)(newestSeq - count_)) {
+    ++count_;
+    s = (s == 0) ? COUNT - 1 : s - 1;
+  }
+}
+
+/**
+ * @brief Read a stored record.
+ *
+ * @param i    Index, 0 = oldest.
+ * @param rec  Receives the record bytes.
+ * @return false if i is out of range or the slot is not valid.
+ */
+bool RunLog::read(uint8_t i, uint8_t rec[PROTO_RUN_SIZE]) const {
+  if (i >= count_) return false;
+  return readSlot_((uint8_t)((head_ + COUNT - count_ + i) % COUNT), rec);
+}
+
+/**
+ * @brief Pack a run into the free record buffer and schedule it.
+ *
+ * The waiting buffer is never the one being written, so it can always be
+ * filled; a record still waiting there is lost.
+ *
+ * @param r  Run summary.
+ */
+void RunLog::record(const RunRecord& r) {
+  if (pending_) {
+    ++lost_;
+    gEventLog.log(EV_RUN_LOST, (int16_t)lost_);
+  }
+
+  uint8_t* rec = rec_[next_];
+  protoPutU16(rec + PROTO_RUN_SEQ, seq_);
+  rec[PROTO_RUN_MODE_ID] = (uint8_t)r.mode;
+  rec[PROTO_RUN_RESULT]  = r.result;
+  protoPutU16(rec + PROTO_RUN_SURFACE_Z, toU16(r.surfaceZ_mm, 100.0f));
+  protoPutU16(rec + PROTO_RUN_PLUNGE,    toU16(r.plunge_mm, 100.0f));
+  protoPutU16(rec + PROTO_RUN_ETCH_TIME, toU16(r.etch_ms, 0.01f));
+  protoPutU16(rec + PROTO_RUN_END_I,     toU16(r.endCurrent_A, 1e5f));
+  rec[PROTO_RUN_RETRIES] = r.retries;
+  rec[PROTO_RUN_PULSES]  = r.pulses;
+  protoPutU16(rec + PROTO_RUN_CRC, crc16(rec, PROTO_RUN_CRC));
+
+  pending_ = true;
+  service();
+}
+
+/**
+ * @brief Track the running write and start a pending one when possible.
+ *
+ * The history bookkeeping advances when the write starts: a record that is
+ * interrupted by a reset fails its CRC at the next load() and is skipped.
+ * The started buffer stays untouched until the write ends; the next record
+ * goes to the other one.
+ */
+void RunLog::service() {
+  if (writing_) {
+    if (writer_.busy()) return;
+    writing_ = false;
+  }
+  if (pending_ && writer_.start(slotAddr_(head_), rec_[next_], PROTO_RUN_SIZE)) {
+    pending_ = false;
+    writing_ = true;
+    next_    = (uint8_t)(next_ ^ 1);
+    head_    = (uint8_t)((head_ + 1) % COUNT);
+    seq_     = (uint16_t)(seq_ + 1);
+    if (count_ < COUNT) ++count_;
+  }
+}
@@ -0,0 +1,138 @@
+#pragma once
+#include <Arduino.h>
+#include "IMode.h"
+#include "ProtocolDefs.h"
+#include "EepromWriter.h"
+#include "EepromLayout.h"
+
+/**
+ * @brief Summary of one etching run, in natural units.
+ */
+struct RunRecord {
+  ModeId   mode;          ///< Mode that ran (Mod1 / Mod2).
+  uint8_t  result;        ///< RUN_* result.
+  float    surfaceZ_mm;   ///< Z at surface detection.
+  float    plunge_mm;     ///< Plunge depth used after the surface.
+  uint32_t etch_ms;       ///< Duration of the 30 V etch.
+  float    endCurrent_A;  ///< Current at the end of the etch.
+  uint8_t  retries;       ///< Failed contact validations.
+  uint8_t  pulses;        ///< 9 V pulses applied.
+};
+
+/**
+ * @brief Circular history of run records in EEPROM.
+ *
+ * Each run is stored as a 16-byte record (PROTO_RUN_* layout, CRC16) in the
+ * next of EE_RUN_SLOTS slots, so the oldest run is overwritten first and
+ * every slot sees one write per EE_RUN_SLOTS runs. Records carry a run
+ * number; load() finds the newest one at boot.
+ *
+ * Writing is non-blocking and shares the EepromWriter with the other
+ * stores: record() only packs the data into RAM, and service() hands it to
+ * the writer once it is free. One record can wait while another is being
+ * written; see record() for when a run is lost.
+ */
+class RunLog {
+public:
+  /** @brief Number of runs kept. */
+  static constexpr uint8_t COUNT = EE_RUN_SLOTS;
+
+  /**
+   * @brief Construct a new RunLog.
+   *
+   * @param writer  Non-blocking EEPROM writer.
+   */
+  explicit RunLog(EepromWriter& writer) : writer_(writer) {}
+
+  /**
+   * @brief Scan the EEPROM for the stored history.
+   *
+   * Call once from setup().
+   */
+  void load();
+
+  /** @brief Number of valid records stored. */
+  uint8_t count() const { return count_; }
+
+  /**
+   * @brief Read a stored record.
+   *
+   * @param i    Index, 0 = oldest (i < count()).
+   * @param rec  Receives the record bytes (PROTO_RUN_* layout).
+   * @return false if the slot no longer holds a valid record.
+   */
+  bool read(uint8_t i, uint8_t rec[PROTO_RUN_SIZE]) const;
+
+  /**
+   * @brief Append a run.
+   *
+   * The record is written in the background, also while the previous one
+   * is still being written. If a record is already waiting (the writer has
+   * been busy with the previous run or with other stores since it was
+   * recorded) the new run replaces it, and the replaced run is lost. Runs
+   * take minutes and a record seconds, so this needs an EEPROM kept busy
+   * for a whole run. Each loss is counted (lost()) and logged as
+   * EV_RUN_LOST.
+   *
+   * @param r  Run summary.
+   */
+  void record(const RunRecord& r);
+
+  /**
+   * @brief Start a pending write once the writer is free.
+   *
+   * Call frequently from loop() (after EepromWriter::service()).
+   */
+  void service();
+
+  /** @brief True while a record is pending or being written. */
+  bool saving() const { return pending_ || writing_; }
+
+  /** @brief Runs lost since power-on (see record()). */
+  uint16_t lost() const { return lost_; }
+
+private:
+  /**
+   * @brief Read a slot and check its CRC.
+   *
+   * @param slot  Slot index.
+   * @param rec   Receives the record bytes.
+   * @return true if the record is valid.
+   */
+  static bool readSlot_(uint8_t slot, uint8_t rec[PROTO_RUN_SIZE]);
+
+  /**
+   * @brief EEPROM address of a slot.
+   *
+   * @param slot Slot index.
+   * @return Start address.
+   */
+  static uint16_t slotAddr_(uint8_t slot) { return EE_RUNS_ADDR + (uint16_t)slot * EE_RUN_SLOT; }
+
+  /** @brief EEPROM writer shared with other stores. */
+  EepromWriter& writer_;
+
+  /** @brief Record buffers: one being written, one waiting. */
+  uint8_t rec_[2][PROTO_RUN_SIZE];
+
+  /** @brief Buffer of the waiting record (the other one is being written). */
+  uint8_t next_ = 0;
+
+  /** @brief Slot the next record goes to. */
+  uint8_t head_ = 0;
+
+  /** @brief Valid records, ending at the slot before head_. */
+  uint8_t count_ = 0;
+
+  /** @brief Run number of the next record. */
+  uint16_t seq_ = 1;
+
+  /** @brief rec_[next_] holds a record that has not been started yet. */
+  bool pending_ = false;
+
+  /** @brief The other buffer is being written by writer_. */
+  bool writing_ = false;
+
+  /** @brief Runs lost since power-on. */
+  uint16_t lost_ = 0;
+};
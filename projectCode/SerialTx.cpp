@@ -0,0 +1,97 @@
+#include "SerialTx.h"
+
+/**
+ * @file SerialTx.cpp
+ * @brief Implementation of the two-lane non-blocking serial TX path.
+ */
+
+static_assert(SERIAL_TX_CRITICAL_SIZE <= 255, "SerialTx ring uses 8-bit indices");
+
+/**
+ * @brief Construct a new SerialTx.
+ *
+ * @param out  Serial port.
+ */
+SerialTx::SerialTx(Print& out) : out_(out) {}
+
+/**
+ * @brief Queue or write a block if it fits completely.
+ *
+ * A bulk block goes straight to the serial buffer, and only between
+ * critical blocks with nothing critical waiting, so it can neither delay
+ * nor split a critical one.
+ *
+ * @param lane  Priority lane.
+ * @param data  Block bytes.
+ * @param len   Block length.
+ * @return false if the block was dropped.
+ */
+bool SerialTx::tryWrite(TxLane lane, const uint8_t* data, uint8_t len) {
+  if (lane == TxLane::Critical) return queueCritical_(data, len);
+
+  service();
+  if (len == 0 || count_ != 0 || left_ != 0 || out_.availableForWrite() < len) {
+    ++bulkDrops_;
+    return false;
+  }
+  out_.write(data, len);
+  return true;
+}
+
+/**
+ * @brief Copy a block into the critical ring, behind its length byte.
+ *
+ * @param data  Block bytes.
+ * @param len   Block length.
+ * @return false if the block was dropped.
+ */
+bool SerialTx::queueCritical_(const uint8_t* data, uint8_t len) {
+  if (len == 0 || (uint16_t)len + 1 > (uint16_t)(SERIAL_TX_CRITICAL_SIZE - count_)) {
+    ++critDrops_;
+    return false;
+  }
+
+  uint16_t t = head_ + count_;
+  if (t >= SERIAL_TX_CRITICAL_SIZE) t -= SERIAL_TX_CRITICAL_SIZE;
+  uint8_t tail = (uint8_t)t;
+  buf_[tail] = len;
+  for (uint8_t i = 0; i < len; ++i) {
+    if (++tail == SERIAL_TX_CRITICAL_SIZE) tail = 0;
+    buf_[tail] = data[i];
+  }
+  count_ += len + 1;
+  if (count_ > highWater_) highWater_ = count_;
+
+  service();
+  return true;
+}
+
+/**
+ * @brief Move queued critical bytes into the serial buffer without blocking.
+ *
+ * Bytes are handed over in contiguous runs of the ring, limited by the free
+ * space reported by availableForWrite().
+ */
+void SerialTx::service() {
+  int room = out_.availableForWrite();
+
+  while (room > 0) {
+    if (left_ == 0) {
+      if (!count_) return;
+      left_ = buf_[head_];
+      if (++head_ == SERIAL_TX_CRITICAL_SIZE) head_ = 0;
+      --count_;
+    }
+
+    uint8_t n = left_;
+    if (n > SERIAL_TX_CRITICAL_SIZE - head_) n = SERIAL_TX_CRITICAL_SIZE - head_;   // up to the end of the ring
+    if (n > room)                            n = (uint8_t)room;
+
+    out_.write(buf_ + head_, n);
+    head_ += n;
+    if (head_ == SERIAL_TX_CRITICAL_SIZE) head_ = 0;
+    count_ -= n;
+    left_  -= n;
+    room   -= n;
+  }
+}
@@ -0,0 +1,100 @@
+#pragma once
+#include <Arduino.h>
+
+/** @brief Size of the critical TX lane (bytes, <= 255). Override with -D. */
+#ifndef SERIAL_TX_CRITICAL_SIZE
+#define SERIAL_TX_CRITICAL_SIZE 64
+#endif
+
+/**
+ * @brief Priority of a block written through SerialTx.
+ *
+ * - Critical: replies and events; queued, always sent before bulk data.
+ * - Bulk:     telemetry; written only when no critical block is waiting.
+ */
+enum class TxLane : uint8_t { Critical, Bulk };
+
+/**
+ * @brief Non-blocking serial transmit path with two priority lanes.
+ *
+ * Print::write() on a full HardwareSerial buffer waits until the UART has
+ * drained enough bytes, which stalls the stepper and sensor timing.
+ * SerialTx never waits: tryWrite() takes a whole block or rejects it and
+ * counts a drop. From the HardwareSerial buffer the core's UDRE interrupt
+ * shifts the bytes out.
+ *
+ * Only the critical lane has a ring of its own. service() moves its bytes
+ * into the HardwareSerial buffer as far as availableForWrite() allows. The
+ * bulk lane has no storage of its own, to save SRAM: a bulk block is written
+ * straight into the HardwareSerial buffer (the core's 64-byte TX ring) if it
+ * fits there completely and no critical byte is waiting, and dropped
+ * otherwise.
+ *
+ * Blocks are never interleaved, so each block (e.g. one protocol frame)
+ * reaches the wire contiguously. Each critical block costs one extra byte in
+ * the ring for its length.
+ */
+class SerialTx {
+public:
+  /**
+   * @brief Construct a new SerialTx.
+   *
+   * @param out  Serial port (already started with begin()).
+   */
+  explicit SerialTx(Print& out);
+
+  /**
+   * @brief Queue or write a block if it fits completely.
+   *
+   * Also calls service(), so a critical block that fits into the hardware
+   * buffer starts transmitting immediately.
+   *
+   * @param lane  Priority lane.
+   * @param data  Block bytes.
+   * @param len   Block length (1..254).
+   * @return false if the block was dropped.
+   */
+  bool tryWrite(TxLane lane, const uint8_t* data, uint8_t len);
+
+  /**
+   * @brief Move queued bytes into the serial buffer without blocking.
+   *
+   * Call frequently from loop().
+   */
+  void service();
+
+  /** @brief Blocks dropped on a lane because there was no room. */
+  uint16_t drops(TxLane lane) const { return lane == TxLane::Critical ? critDrops_ : bulkDrops_; }
+
+  /** @brief Bytes queued on the critical lane (including length bytes). */
+  uint8_t pending() const { return count_; }
+
+  /** @brief Highest fill level the critical lane has reached (bytes). */
+  uint8_t highWater() const { return highWater_; }
+
+private:
+  /** @brief Queue a block on the critical lane. */
+  bool queueCritical_(const uint8_t* data, uint8_t len);
+
+  /** @brief Serial port. */
+  Print& out_;
+
+  /** @brief Critical lane ring. */
+  uint8_t buf_[SERIAL_TX_CRITICAL_SIZE];
+
+  /** @brief Index of the oldest queued byte. */
+  uint8_t head_ = 0;
+
+  /** @brief Bytes queued. */
+  uint8_t count_ = 0;
+
+  /** @brief Maximum of count_. */
+  uint8_t highWater_ = 0;
+
+  /** @brief Bytes of the current critical block still to send. */
+  uint8_t left_ = 0;
+
+  /** @brief Rejected blocks per lane. */
+  uint16_t critDrops_ = 0;
+  uint16_t bulkDrops_ = 0;
+};
@@ -0,0 +1,23 @@
+#pragma once
+#include <Arduino.h>
+
+/**
+ * @file SimCycles.h
+ * @brief Execution cost annotations for the host simulation.
+ *
+ * The host build (host/hal) advances its virtual clock by the AVR cost of
+ * every Arduino call. Work that does not go through the Arduino API, mainly
+ * soft-float arithmetic, is charged with SIM_CYCLES(n) at the place where it
+ * happens; n is the estimated cycle count on the ATmega328P at -Os.
+ *
+ * On the target SIM_CYCLES() expands to nothing.
+ */
+#if defined(HOST_HAL)
+namespace hal {
+void chargeCycles(uint32_t cycles);
+void fastPinWrite(uint8_t pin, uint8_t level);
+}
+#define SIM_CYCLES(n) ::hal::chargeCycles(n)
+#else
+#define SIM_CYCLES(n) ((void)0)
+#endif
@@ -0,0 +1,83 @@
+#include "StepJitter.h"
+#include <math.h>
+
+/**
+ * @file StepJitter.cpp
+ * @brief Analysis of the recorded step timestamps.
+ */
+
+/**
+ * @brief Accumulate the interval errors of the steps recorded since the last call.
+ */
+void StepJitter::service() {
+  uint8_t pending = (uint8_t)(head_ - done_);
+  if (pending == 0) return;
+  if (pending > STEP_JITTER_RING) {
+    // overwritten before they were analysed
+    lost_ += pending - STEP_JITTER_RING;
+    done_ = (uint8_t)(head_ - STEP_JITTER_RING);
+    prevValid_ = false;
+  }
+
+  while (done_ != head_) {
+    Entry e = ring_[done_ & MASK];
+    ++done_;
+    uint32_t period = e.period & ~FIRST;
+    if (prevValid_ && !(e.period & FIRST) && period == prev_.period) {
+      int32_t  err = (int32_t)(e.t_us - prev_.t_us - period);
+      uint32_t dev = err < 0 ? (uint32_t)-err : (uint32_t)err;
+      ++n_;
+      sum_  += (float)err;
+      sum2_ += (float)err * (float)err;
+      if (dev > maxDev_) maxDev_ = dev;
+      if (err > 0 && (uint32_t)err > period / 10) ++late_;
+    }
+    prev_.t_us   = e.t_us;
+    prev_.period = period;
+    prevValid_   = true;
+    period_      = period;
+  }
+}
+
+/**
+ * @brief Fill in the summary of the analysed steps.
+ *
+ * @param s Receives the statistics.
+ */
+void StepJitter::stats(StepJitterStats& s) const {
+  s.intervals = n_;
+  s.period_us = period_;
+  s.mean_us   = n_ ? sum_ / n_ : 0.0f;
+  float var   = n_ ? sum2_ / n_ - s.mean_us * s.mean_us : 0.0f;
+  s.sd_us     = var > 0.0f ? sqrtf(var) : 0.0f;
+  s.maxDev_us = maxDev_;
+  s.late      = late_;
+  s.lost      = lost_;
+}
+
+/**
+ * @brief Reset the statistics.
+ *
+ * Steps already in the ring but not analysed yet are still counted by the
+ * next service().
+ */
+void StepJitter::clear() {
+  n_ = late_ = maxDev_ = 0;
+  sum_ = sum2_ = 0.0f;
+  lost_ = 0;
+}
+
+/**
+ * @brief Interval between a recent step and the one before it.
+ *
+ * @param i  0 = latest step.
+ * @return Interval (µs), or 0 if the step started a sequence or is not in the ring.
+ */
+uint32_t StepJitter::recentInterval(uint8_t i) const {
+  if ((uint16_t)i + 1 >= STEP_JITTER_RING) return 0;
+  const Entry& e = ring_[(uint8_t)(head_ - 1 - i) & MASK];
+  const Entry& p = ring_[(uint8_t)(head_ - 2 - i) & MASK];
+  // never written (period 0) or first of a sequence: no interval
+  if (e.period == 0 || (e.period & FIRST)) return 0;
+  return e.t_us - p.t_us;
+}
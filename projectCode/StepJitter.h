@@ -0,0 +1,133 @@
+#pragma once
+#include <Arduino.h>
+
+/** @brief Number of step timestamps kept by StepJitter (power of two, <= 128). Override with -D. */
+#ifndef STEP_JITTER_RING
+#define STEP_JITTER_RING 16
+#endif
+
+/**
+ * @brief Enables the step recorder in StepperDriver, its DIAG page and
+ *        MSG_STEP_JITTER. Off by default. Override with -D.
+ */
+#ifndef STEP_JITTER
+#define STEP_JITTER 0
+#endif
+
+/**
+ * @brief Summary of the step timing recorded by StepJitter.
+ *
+ * The error of a step is its interval to the previous step minus the period
+ * that was commanded for it (µs, positive = late).
+ */
+struct StepJitterStats {
+  uint32_t intervals;   ///< Step intervals analysed.
+  uint32_t period_us;   ///< Commanded period of the latest step.
+  float    mean_us;     ///< Mean error.
+  float    sd_us;       ///< Standard deviation of the error.
+  uint32_t maxDev_us;   ///< Largest absolute error.
+  uint32_t late;        ///< Steps later than 10 % of their period.
+  uint16_t lost;        ///< Steps not analysed because the ring overflowed.
+};
+
+/**
+ * @brief Step timing recorder and jitter analyser.
+ *
+ * onStep() only stores the timestamp and commanded period of a step in a
+ * small ring, so recording adds a few cycles to the step path. service(),
+ * called from the main loop, walks the new entries and accumulates the
+ * interval error against the commanded period.
+ *
+ * An interval is only counted between two consecutive steps with the same
+ * commanded period and no gap() in between; a start from standstill or a
+ * change of speed begins a new sequence. If service() falls more than
+ * STEP_JITTER_RING steps behind, the overwritten steps are counted as lost
+ * and the sequence restarts.
+ *
+ * The class has no hardware dependencies; the host simulation feeds it from
+ * the simulated STEP pin.
+ */
+class StepJitter {
+public:
+  /**
+   * @brief Record one step.
+   *
+   * @param t_us       Time of the step (micros()).
+   * @param period_us  Period commanded for this step.
+   */
+  void onStep(uint32_t t_us, uint32_t period_us) {
+    Entry& e = ring_[head_ & MASK];
+    e.t_us   = t_us;
+    e.period = period_us | (gap_ ? FIRST : 0);
+    gap_ = false;
+    ++head_;
+  }
+
+  /**
+   * @brief Mark a break in the step sequence (standstill, new move).
+   */
+  void gap() { gap_ = true; }
+
+  /**
+   * @brief Analyse the steps recorded since the last call.
+   *
+   * Call from loop(); cheap when no step was recorded.
+   */
+  void service();
+
+  /**
+   * @brief Current summary (after service()).
+   *
+   * @param s Receives the statistics.
+   */
+  void stats(StepJitterStats& s) const;
+
+  /** @brief Reset the statistics (the ring is kept). */
+  void clear();
+
+  /**
+   * @brief Interval of a recent step.
+   *
+   * @param i  0 = latest step.
+   * @return Interval to the step before it (µs), 0 if it started a sequence
+   *         or is not recorded.
+   */
+  uint32_t recentInterval(uint8_t i) const;
+
+private:
+  static_assert((STEP_JITTER_RING & (STEP_JITTER_RING - 1)) == 0 && STEP_JITTER_RING <= 128,
+                "STEP_JITTER_RING must be a power of two <= 128");
+
+  /** @brief Ring index mask. */
+  static constexpr uint8_t MASK = STEP_JITTER_RING - 1;
+
+  /** @brief Period flag: the step starts a new sequence. */
+  static constexpr uint32_t FIRST = 0x80000000UL;
+
+  /** @brief One recorded step. */
+  struct Entry {
+    uint32_t t_us;    ///< micros() of the step.
+    uint32_t period;  ///< Commanded period (µs), FIRST if it starts a sequence.
+  };
+
+  /** @brief Recorded steps. */
+  Entry ring_[STEP_JITTER_RING] = {};
+
+  /** @brief Steps recorded (free running, the ring index is head_ & MASK). */
+  uint8_t head_ = 0;
+
+  /** @brief Steps analysed. */
+  uint8_t done_ = 0;
+
+  /** @brief The next step starts a new sequence. */
+  bool gap_ = true;
+
+  /** @brief Previous analysed step (valid unless prevValid_ is false). */
+  Entry prev_ = { 0, 0 };
+  bool  prevValid_ = false;
+
+  /** @brief Accumulated statistics. */
+  uint32_t n_ = 0, late_ = 0, maxDev_ = 0, period_ = 0;
+  float    sum_ = 0.0f, sum2_ = 0.0f;
+  uint16_t lost_ = 0;
+};
@@ -1,4 +1,5 @@
 #include "StepperDriver.h"
+#include "LoopProfiler.h"
 #include <math.h>
 
 /**
@@ -166,25 +167,41 @@ void StepperDriver::moveRelativeMm(float dx_mm, float v_mm_s) {
  *  - If the speed is too low (< 1 step/s), no steps are produced.
  *  - Stepping is driven by a simple time comparison against tNextStep_ using
  *    micros(), taking overflow into account via signed subtraction.
+ *  - With STEP_JITTER, each step (time and commanded period) is passed to
+ *    the attached StepJitter; standstill and a fresh start mark a gap.
  */
 void StepperDriver::update() {
+  PROF_SCOPE(PROF_STEPPER);
+
   // no motion
   if (motion_ == Motion::Idle && speed_mm_s_ == 0.0f) {
     tNextStep_ = micros();
+#if STEP_JITTER
+    if (jitter_) jitter_->gap();
+#endif
     return;
   }
 
   // mm/s -> steps/s -> period
+  SIM_CYCLES(800);   // fabsf, fmul, fcmp, fdiv, float -> uint32_t
   float v = fabsf(speed_mm_s_);
   float stepsPerSec = v * stepsPerMm_;
   if (stepsPerSec < 1.0f) return; // too slow, do not step
   uint32_t period_us = (uint32_t)(1000000.0f / stepsPerSec);
 
   uint32_t now = micros();
-  if (tNextStep_ == 0) tNextStep_ = now; // first start
+  if (tNextStep_ == 0) {                  // first start
+    tNextStep_ = now;
+#if STEP_JITTER
+    if (jitter_) jitter_->gap();
+#endif
+  }
   if ((int32_t)(now - tNextStep_) >= 0) {
     tNextStep_ = now + period_us;
     stepOnce_();
+#if STEP_JITTER
+    if (jitter_) jitter_->onStep(now, period_us);
+#endif
 
     // in target-position mode, check if we reached the target
     if (motion_ == Motion::ToTarget) {
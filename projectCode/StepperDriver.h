@@ -1,5 +1,7 @@
 #pragma once
 #include <Arduino.h>
+#include "SimCycles.h"
+#include "StepJitter.h"
 
 /**
  * @brief Non-blocking stepper motor driver with position and velocity control.
@@ -98,7 +100,14 @@ public:
    *
    * @return Current position in millimeters.
    */
-  float positionMm() const          { return pos_steps_ / stepsPerMm_; }
+  float positionMm() const          { SIM_CYCLES(560); return pos_steps_ / stepsPerMm_; }
+
+  /**
+   * @brief Get the current software position in steps.
+   *
+   * @return Position counter in (micro)steps.
+   */
+  long  positionSteps() const       { return pos_steps_; }
 
   /**
    * @brief Get the internal conversion factor from millimeters to steps.
@@ -116,6 +125,13 @@ public:
    */
   float defaultSpeed() const        { return default_mm_s_; }
 
+  /**
+   * @brief Get the commanded speed.
+   *
+   * @return Signed speed in mm/s (0 when idle).
+   */
+  float speedMmPerSec() const       { return speed_mm_s_; }
+
   // --- Non-blocking position moves ---
 
   /**
@@ -151,6 +167,21 @@ public:
    */
   bool isBusy() const { return motion_ == Motion::ToTarget; }
 
+#if STEP_JITTER
+  /**
+   * @brief Record every emitted step in a jitter recorder.
+   *
+   * update() passes the time and commanded period of each step and marks
+   * standstill and new moves as gaps.
+   *
+   * @param j Recorder (its service() must be called from loop()).
+   */
+  void attachJitter(StepJitter& j) { jitter_ = &j; }
+
+  /** @brief Attached jitter recorder, or nullptr. */
+  StepJitter* jitter() const { return jitter_; }
+#endif
+
 private:
   /**
    * @brief Emit a single step pulse and update the internal position counter.
@@ -185,4 +216,8 @@ private:
   Motion motion_ = Motion::Idle; ///< Current motion mode.
 
   long   target_steps_ = 0;      ///< Target position in steps for ToTarget mode.
+
+#if STEP_JITTER
+  StepJitter* jitter_ = nullptr; ///< Step recorder, or nullptr.
+#endif
 };
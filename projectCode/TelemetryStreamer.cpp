@@ -0,0 +1,138 @@
+#include "TelemetryStreamer.h"
+
+/**
+ * @file TelemetryStreamer.cpp
+ * @brief Implementation of the key/delta telemetry stream.
+ */
+
+/**
+ * @brief Start or stop streaming.
+ *
+ * Enabling always starts with a key record, so the host can decode the
+ * stream without any earlier context.
+ *
+ * @param on          True to stream.
+ * @param decimation  One record every N completed sensor windows (0 is treated as 1).
+ */
+void TelemetryStreamer::setEnabled(bool on, uint8_t decimation) {
+  decim_     = decimation ? decimation : 1;
+  decimLeft_ = 1;
+  if (on && !enabled_) {
+    needKey_    = true;
+    lastWindow_ = current_.windowSeq();
+  }
+  enabled_ = on;
+}
+
+/**
+ * @brief Emit a record if the sensor has completed a new window.
+ */
+void TelemetryStreamer::service() {
+  if (!enabled_) return;
+  uint16_t win = current_.windowSeq();
+  if (win == lastWindow_) return;
+  lastWindow_ = win;
+  if (--decimLeft_) return;
+  decimLeft_ = decim_;
+
+  Sample s;
+  // Time is kept at the resolution of the delta records, so a key record
+  // and a reconstructed delta chain agree exactly.
+  s.t_us   = current_.windowEndUs() / PROTO_TDELTA_T_UNIT_US * PROTO_TDELTA_T_UNIT_US;
+  s.window = win;
+  s.i_uA   = (int32_t)(current_.lastIrms() * 1e6f);
+  s.vpp_mV = (uint16_t)(current_.lastVpp() * 1000.0f);
+  s.steps  = stepper_.positionSteps();
+
+  IMode*  mode   = ctrl_.mode(ctrl_.currentIndex());
+  uint8_t modeId = (uint8_t)mode->caps().id;
+  uint8_t phase  = ctrl_.isRunning() ? mode->phase() : 0;
+  uint8_t flags = 0;
+  if (digitalRead(relay1_) == LOW) flags |= TELEM_RELAY1;
+  if (digitalRead(relay2_) == LOW) flags |= TELEM_RELAY2;
+  if (current_.isEnabled())        flags |= TELEM_SENSOR;
+  if (ctrl_.isRunning())           flags |= TELEM_RUNNING;
+
+  // Delta records carry no mode ID, so a mode change needs a key record.
+  bool sent = false;
+  if (needKey_ || sinceKey_ >= KEY_INTERVAL || modeId != baseModeId_ ||
+      !sendDelta_(s, phase, flags, sent)) {
+    sent = sendKey_(s, modeId, phase, flags);
+  }
+
+  // A lost record breaks the delta chain: the next one must be a key record.
+  if (!sent) {
+    ++drops_;
+    needKey_ = true;
+  }
+  ++seq_;
+}
+
+/**
+ * @brief Send a key record and make it the new delta base.
+ *
+ * @param s       Sample.
+ * @param modeId  ModeId of the running/selected mode.
+ * @param phase   Mode phase.
+ * @param flags   TELEM_* flags.
+ * @return true if sent.
+ */
+bool TelemetryStreamer::sendKey_(const Sample& s, uint8_t modeId, uint8_t phase, uint8_t flags) {
+  uint8_t out[PROTO_TKEY_SIZE];
+  protoPutU16(out + PROTO_TKEY_SEQ,    seq_);
+  protoPutU32(out + PROTO_TKEY_T_US,   s.t_us);
+  protoPutU16(out + PROTO_TKEY_WINDOW, s.window);
+  protoPutU32(out + PROTO_TKEY_I_UA,   (uint32_t)s.i_uA);
+  protoPutU16(out + PROTO_TKEY_VPP_MV, s.vpp_mV);
+  protoPutU32(out + PROTO_TKEY_STEPS,  (uint32_t)s.steps);
+  out[PROTO_TKEY_MODE_ID] = modeId;
+  out[PROTO_TKEY_PHASE]   = phase;
+  out[PROTO_TKEY_FLAGS]   = flags;
+  protoPutU16(out + PROTO_TKEY_DROPS,  drops_);
+
+  if (!link_.send(MSG_TELEM_KEY, 0, out, PROTO_TKEY_SIZE, TxLane::Bulk)) return false;
+  base_       = s;
+  baseModeId_ = modeId;
+  sinceKey_   = 0;
+  needKey_  = false;
+  return true;
+}
+
+/**
+ * @brief Try to send a delta record against base_.
+ *
+ * @param s      Sample.
+ * @param phase  Mode phase.
+ * @param flags  TELEM_* flags.
+ * @param sent   Set to true if the frame was written.
+ * @return false if a difference does not fit (a key record is needed).
+ */
+bool TelemetryStreamer::sendDelta_(const Sample& s, uint8_t phase, uint8_t flags, bool& sent) {
+  uint32_t dt  = (s.t_us - base_.t_us) / PROTO_TDELTA_T_UNIT_US;
+  uint16_t dw  = (uint16_t)(s.window - base_.window);
+  int32_t  di  = s.i_uA - base_.i_uA;
+  int32_t  dv  = (int32_t)s.vpp_mV - (int32_t)base_.vpp_mV;
+  int32_t  ds  = s.steps - base_.steps;
+
+  if (dt > 0xFFFF || dw > 0xFF ||
+      di < -32768 || di > 32767 ||
+      dv < -32768 || dv > 32767 ||
+      ds < -32768 || ds > 32767) return false;
+
+  uint8_t out[PROTO_TDELTA_SIZE];
+  protoPutU16(out + PROTO_TDELTA_SEQ,     seq_);
+  protoPutU16(out + PROTO_TDELTA_DT,      (uint16_t)dt);
+  out[PROTO_TDELTA_DWINDOW] = (uint8_t)dw;
+  protoPutU16(out + PROTO_TDELTA_DI_UA,   (uint16_t)(int16_t)di);
+  protoPutU16(out + PROTO_TDELTA_DVPP_MV, (uint16_t)(int16_t)dv);
+  protoPutU16(out + PROTO_TDELTA_DSTEPS,  (uint16_t)(int16_t)ds);
+  out[PROTO_TDELTA_PHASE] = phase;
+  out[PROTO_TDELTA_FLAGS] = flags;
+
+  sent = link_.send(MSG_TELEM_DELTA, 0, out, PROTO_TDELTA_SIZE, TxLane::Bulk);
+  if (sent) {
+    base_ = s;
+    ++sinceKey_;
+  }
+  return true;
+}
@@ -0,0 +1,146 @@
+#pragma once
+#include <Arduino.h>
+#include "HostLink.h"
+#include "CurrentSensor.h"
+#include "StepperDriver.h"
+#include "ModeController.h"
+
+/**
+ * @brief Streams one compact telemetry record per sensor window to the host.
+ *
+ * Each record holds the window's raw RMS current and Vpp, the stepper
+ * position, the running mode and its phase, and the relay/sensor flags, all
+ * with the window's end timestamp. Records are sent as unsolicited HostLink
+ * frames in two fixed-size forms (see ProtocolDefs.h):
+ *  - key records with absolute values (23 bytes),
+ *  - delta records relative to the previous record (13 bytes).
+ * A key record is sent first, every KEY_INTERVAL records, after a drop and
+ * whenever the mode changes or a difference does not fit into a delta field.
+ *
+ * Streaming never blocks: records go to the bulk lane of SerialTx, behind
+ * protocol replies, and only as complete frames. A record that does not fit
+ * is dropped and counted; its sequence number is skipped, so the host
+ * can see exactly where records are missing.
+ */
+class TelemetryStreamer {
+public:
+  /** @brief A key record is forced after this many delta records. */
+  static constexpr uint8_t KEY_INTERVAL = 32;
+
+  /**
+   * @brief Construct a new TelemetryStreamer.
+   *
+   * @param link       Host link used for sending.
+   * @param current    Current sensor (window results).
+   * @param stepper    Stepper driver (position).
+   * @param ctrl       Mode controller (mode and phase).
+   * @param relayPin1  Relay 1 control pin (active LOW).
+   * @param relayPin2  Relay 2 control pin (active LOW).
+   */
+  TelemetryStreamer(HostLink& link, CurrentSensor& current, StepperDriver& stepper,
+                    ModeController& ctrl, uint8_t relayPin1, uint8_t relayPin2)
+    : link_(link), current_(current), stepper_(stepper), ctrl_(ctrl),
+      relay1_(relayPin1), relay2_(relayPin2) {}
+
+  /**
+   * @brief Start or stop streaming.
+   *
+   * @param on          True to stream.
+   * @param decimation  Send one record every N completed sensor windows (>= 1).
+   */
+  void setEnabled(bool on, uint8_t decimation = 1);
+
+  /** @brief True while streaming. */
+  bool enabled() const { return enabled_; }
+
+  /** @brief Current decimation factor. */
+  uint8_t decimation() const { return decim_; }
+
+  /** @brief Records dropped because the bulk TX lane was full. */
+  uint16_t drops() const { return drops_; }
+
+  /** @brief Sequence number the next record will get. */
+  uint16_t sequence() const { return seq_; }
+
+  /**
+   * @brief Emit a record if the sensor has completed a new window.
+   *
+   * Call from loop() after CurrentSensor::update(). Costs a single compare
+   * when no new window is available.
+   */
+  void service();
+
+private:
+  /** @brief Values of one record in transmitted units. */
+  struct Sample {
+    uint32_t t_us;    ///< Window end time (µs), quantized like the receiver's copy.
+    uint16_t window;  ///< Window sequence number.
+    int32_t  i_uA;    ///< Raw RMS current (µA).
+    uint16_t vpp_mV;  ///< Peak-to-peak voltage (mV).
+    int32_t  steps;   ///< Stepper position (steps).
+  };
+
+  /**
+   * @brief Send a key record and make it the new delta base.
+   *
+   * @param s       Sample.
+   * @param modeId  ModeId of the running/selected mode.
+   * @param phase   Mode phase.
+   * @param flags   TELEM_* flags.
+   * @return true if sent.
+   */
+  bool sendKey_(const Sample& s, uint8_t modeId, uint8_t phase, uint8_t flags);
+
+  /**
+   * @brief Try to send a delta record against base_.
+   *
+   * @param s      Sample.
+   * @param phase  Mode phase.
+   * @param flags  TELEM_* flags.
+   * @param sent   Set to true if the frame was written.
+   * @return false if a difference does not fit (a key record is needed).
+   */
+  bool sendDelta_(const Sample& s, uint8_t phase, uint8_t flags, bool& sent);
+
+  /** @brief Host link. */
+  HostLink& link_;
+
+  /** @brief Current sensor. */
+  CurrentSensor& current_;
+
+  /** @brief Stepper driver. */
+  StepperDriver& stepper_;
+
+  /** @brief Mode controller. */
+  ModeController& ctrl_;
+
+  /** @brief Relay pins. */
+  uint8_t relay1_, relay2_;
+
+  /** @brief Streaming enabled. */
+  bool enabled_ = false;
+
+  /** @brief Decimation factor and countdown. */
+  uint8_t decim_ = 1, decimLeft_ = 1;
+
+  /** @brief Last sensor window seen. */
+  uint16_t lastWindow_ = 0;
+
+  /** @brief Next record sequence number. */
+  uint16_t seq_ = 0;
+
+  /** @brief Records dropped. */
+  uint16_t drops_ = 0;
+
+  /** @brief Delta records since the last key record. */
+  uint8_t sinceKey_ = 0;
+
+  /** @brief The next record must be a key record. */
+  bool needKey_ = true;
+
+  /** @brief Last record known to the receiver (delta base). */
+  Sample base_ = {};
+
+  /** @brief Mode ID sent in the last key record. */
+  uint8_t baseModeId_ = 0xFF;
+};
@@ -6,8 +6,22 @@
 #include "StepperDriver.h"
 #include "CurrentSensor.h"
 #include "MovingAverage.h"
+#include "CurrentGraph.h"
 #include "ParametersMode.h"
 #include "Parameters.h"
+#include "EepromWriter.h"
+#include "ParamStore.h"
+#include "ProfileStore.h"
+#include "ProfileMode.h"
+#include "RunLog.h"
+#include "HistoryMode.h"
+#include "EventLog.h"
+#include "SerialTx.h"
+#include "HostLink.h"
+#include "TelemetryStreamer.h"
+#include "LoopProfiler.h"
+#include "StepJitter.h"
+#include "DiagMode.h"
 
 /**
  * @file main.ino
@@ -18,6 +32,7 @@
  *  - a keypad shield (KeypadShield),
  *  - a TMC2209-based stepper driver (StepperDriver),
  *  - a current sensor (CurrentSensor) with RMS/AC processing,
+ *  - a live current bar graph / sparkline on the LCD (CurrentGraph),
  *  - several logical operating modes (HomeMode, Mod1Mode, Mod2Mode, JogMode, ParametersMode),
  *  - and a ModeController implementing a simple menu-driven UI.
  *
@@ -87,6 +102,16 @@ constexpr uint8_t PIN_RELAY1 = A1;
 constexpr uint8_t PIN_RELAY2 = A2;
 /** @} */
 
+/** @name Host serial link
+ *  @{
+ *
+ * Baud rate of the USB serial port. 1000000 is exact on a 16 MHz AVR (U2X)
+ * and gives telemetry about 8x the headroom of 115200; the host tool must be
+ * started with the same rate (tipctl -b).
+ */
+constexpr uint32_t HOST_BAUD = 115200;
+/** @} */
+
 /** @name Current measurement and thresholds
  *  @{
  *
@@ -98,6 +123,7 @@ const uint8_t PIN_I_SENSOR = A3;       ///< Analog input used for the current se
 const float I_THRESHOLD = 0.05f;       ///< Surface detection threshold (A).
 const float I_ETCHING_THRESHOLD1 = 0.05f; ///< Etching threshold for MOD1 (A).
 const float I_ETCHING_THRESHOLD2 = 0.05f; ///< Etching threshold for MOD2 (A).
+const float I_GRAPH_FULL_SCALE = 1.0f;   ///< Current shown as a full bar on the LCD graph (A).
 /** @} */
 
 // ---------------------- Peripheral instances ----------------------
@@ -123,6 +149,13 @@ KeypadShield keys(BTN_ADC, 80);
  */
 StepperDriver stepper(PIN_STEP, PIN_DIR, PIN_EN, STEPS_PER_REV, MICROSTEPS, LEAD_MM, MAX_MM_S);
 
+#if STEP_JITTER
+/**
+ * @brief Step timing recorder attached to the stepper (STEP_JITTER builds only).
+ */
+StepJitter stepJitter;
+#endif
+
 /**
  * @brief Global current sensor instance used for surface detection and etching logic.
  *
@@ -132,9 +165,17 @@ StepperDriver stepper(PIN_STEP, PIN_DIR, PIN_EN, STEPS_PER_REV, MICROSTEPS, LEAD
  *  - ADC maximum value,
  *  - calibration factor (A/V),
  *  - sampling window and sampling interval (microseconds).
+ *
+ * The window and interval given here are only the initial profile; the modes
+ * switch to phase-specific profiles at runtime via CurrentSensor::setTiming().
  */
 CurrentSensor currentSensor(PIN_I_SENSOR, 5.0f, 1023.0f, 2.545f, 40000UL, 200UL);
 
+/**
+ * @brief Live current bar graph and sparkline (LCD row 1) used while etching.
+ */
+CurrentGraph currentGraph(lcd, I_GRAPH_FULL_SCALE);
+
 // ---------------------- RMS helpers for current ----------------------
 
 /**
@@ -147,6 +188,18 @@ IAvg_t Iavg;
  */
 IAvg_s IavgS;
 
+// ---------------------- Persistent storage ----------------------
+
+/**
+ * @brief Non-blocking EEPROM writer shared by the persistent stores.
+ */
+EepromWriter eepromWriter;
+
+/**
+ * @brief Run history in EEPROM (one record per MOD1/MOD2 run).
+ */
+RunLog runLog(eepromWriter);
+
 // ---------------------- Mode instances ----------------------
 
 /**
@@ -165,7 +218,9 @@ Mod1Mode mod1 (lcd,
                I_THRESHOLD,
                I_ETCHING_THRESHOLD1,
                Iavg,
-               IavgS);
+               IavgS,
+               currentGraph,
+               runLog);
 
 /**
  * @brief MOD2: surface detection and pulsed processing (30 V validation, 9 V pulses).
@@ -178,17 +233,46 @@ Mod2Mode mod2 (lcd,
                I_THRESHOLD,
                I_ETCHING_THRESHOLD2,
                Iavg,
-               IavgS);
+               IavgS,
+               currentGraph,
+               runLog);
 
 /**
  * @brief Jog mode: manual UP/DOWN jog with position display.
  */
 JogMode   jog(lcd, keys, stepper);
 
+/**
+ * @brief EEPROM persistence of gParams (loaded in setup(), saved when PARAM is left).
+ */
+ParamStore paramStore(eepromWriter);
+
 /**
  * @brief Parameter mode: interactive editor for MOD1/MOD2 parameters.
  */
-ParametersMode paramMode(lcd, keys);
+ParametersMode paramMode(lcd, keys, paramStore);
+
+/**
+ * @brief Named recipe profiles stored in EEPROM.
+ */
+ProfileStore profileStore(eepromWriter);
+
+/**
+ * @brief Profile mode: quick recipe switching and saving.
+ */
+ProfileMode profileMode(lcd, keys, profileStore, paramStore);
+
+/**
+ * @brief History mode: summary of the stored runs.
+ */
+HistoryMode historyMode(lcd, keys, runLog);
+
+#if LOOP_PROFILE || STEP_JITTER
+/**
+ * @brief Diagnostics mode: loop profiler and step jitter figures (diagnostic builds only).
+ */
+DiagMode diagMode(lcd, keys, stepper);
+#endif
 
 /**
  * @brief Array of all available modes in menu order.
@@ -199,16 +283,39 @@ ParametersMode paramMode(lcd, keys);
  *  2. MOD2        - surface detection + validation + pulsed processing.
  *  3. JOG         - manual jog mode.
  *  4. PARAM       - parameter editor.
+ *  5. PROF        - recipe profile selection.
+ *  6. HIST        - run history.
+ *  7. DIAG        - loop profiler / step jitter (LOOP_PROFILE or STEP_JITTER builds only).
  */
-IMode* modes[] = { &home, &mod1, &mod2, &jog, &paramMode };
+IMode* modes[] = { &home, &mod1, &mod2, &jog, &paramMode, &profileMode, &historyMode
+#if LOOP_PROFILE || STEP_JITTER
+                 , &diagMode
+#endif
+};
 
 /**
  * @brief Global mode controller handling menu navigation and mode execution.
  *
  * It uses the LCD for display output, the keypad for navigation, and the modes
- * array above as the list of selectable/launchable modes.
+ * array above as the list of selectable/launchable modes. The current sensor and
+ * stepper are passed in so the controller can enable/stop them per mode.
+ */
+ModeController ctrl(lcd, keys, currentSensor, stepper, modes, sizeof(modes) / sizeof(modes[0]));
+
+/**
+ * @brief Non-blocking transmit path of the USB serial port (critical and bulk lanes).
+ */
+SerialTx serialTx(Serial);
+
+/**
+ * @brief Binary command/status protocol on the USB serial port.
+ */
+HostLink hostLink(Serial, serialTx, ctrl, currentSensor, stepper, paramStore);
+
+/**
+ * @brief Per-window telemetry stream to the host (off until requested).
  */
-ModeController ctrl(lcd, keys, modes, 5);
+TelemetryStreamer telemetry(hostLink, currentSensor, stepper, ctrl, PIN_RELAY1, PIN_RELAY2);
 
 // ---------------------- Arduino lifecycle ----------------------
 
@@ -216,18 +323,34 @@ ModeController ctrl(lcd, keys, modes, 5);
  * @brief Arduino setup function.
  *
  * Performs one-time initialization of:
- *  - serial port (for optional diagnostics),
+ *  - serial port (binary host protocol, see HostLink),
  *  - LCD (backlight and geometry),
  *  - keypad debounce state,
  *  - current sensor (sampling state),
+ *  - parameters (loaded from EEPROM if a valid record exists),
+ *  - run history (newest record located in EEPROM),
  *  - mode controller (which automatically starts HOME mode).
+ *
+ * A LOOP_PROFILE build first takes over Timer1 as the profiler time base;
+ * a STEP_JITTER build attaches the step recorder to the stepper.
  */
 void setup() {
-  Serial.begin(115200);
+#if LOOP_PROFILE
+  gLoopProfiler.begin();
+#endif
+  Serial.begin(HOST_BAUD);
+  gEventLog.log(EV_BOOT);
 
   lcd.begin();
   keys.begin();
   currentSensor.begin();
+  paramStore.load();   // saved parameters replace the compiled defaults
+  runLog.load();
+  hostLink.attachTelemetry(telemetry);
+  hostLink.attachRunLog(runLog);
+#if STEP_JITTER
+  stepper.attachJitter(stepJitter);
+#endif
   ctrl.begin();    // HOME starts automatically
 }
 
@@ -236,12 +359,50 @@ void setup() {
  *
  * This function:
  *  - updates the current sensor (non-blocking, time-window based),
- *  - advances the mode state machine through ModeController::loop().
+ *  - advances the mode state machine through ModeController::loop(),
+ *  - handles host protocol requests received on the serial port,
+ *  - streams a telemetry record when a sensor window completes (if enabled),
+ *  - tops up the serial TX buffer from the queued frames,
+ *  - sends at most one queued byte to the LCD,
+ *  - writes at most one byte of a pending EEPROM record,
+ *  - analyses the recorded steps (STEP_JITTER builds).
  *
  * It must run as frequently as possible to ensure responsive UI and smooth
  * stepping. No blocking delays should be introduced here.
+ *
+ * The PROF_* probes time its sections in LOOP_PROFILE builds (LoopProfiler.h)
+ * and compile to nothing otherwise.
  */
 void loop() {
+  PROF_BEGIN(PROF_LOOP);
+
+  PROF_BEGIN(PROF_SENSOR);
   currentSensor.update();
+  PROF_END(PROF_SENSOR);
+
   ctrl.loop();
+
+  PROF_BEGIN(PROF_HOST);
+  hostLink.service();
+  telemetry.service();
+  serialTx.service();
+  PROF_END(PROF_HOST);
+
+  PROF_BEGIN(PROF_LCD);
+  lcd.service();
+  PROF_END(PROF_LCD);
+
+  PROF_BEGIN(PROF_STORE);
+  eepromWriter.service();
+  paramStore.service();
+  runLog.service();
+  profileStore.service();
+  PROF_END(PROF_STORE);
+
+#if STEP_JITTER
+  stepJitter.service();
+#endif
+
+  PROF_END(PROF_LOOP);
+  PROF_COLLECT();
 }